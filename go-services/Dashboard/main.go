@@ -30,6 +30,12 @@ type AgentsInfo struct {
 	Honeypots   int `json:"honeypots"`
 }
 
+// Перцентили задержек по этапам, присылаются балансировщиком как есть
+type LatencyInfo struct {
+	Stages   json.RawMessage `json:"stages"`
+	Backends json.RawMessage `json:"backends"`
+}
+
 type SSEClient struct {
 	ID      string
 	Channel chan []byte
@@ -39,6 +45,7 @@ var (
 	requests   []BalancerRequest
 	clients    = make(map[string]*ClientInfo)
 	agents     = AgentsInfo{RealServers: 3, Honeypots: 5}
+	latency    LatencyInfo
 	mu         sync.Mutex
 	sseClients = make(map[*SSEClient]bool)
 	sseMutex   sync.Mutex
@@ -65,6 +72,9 @@ func main() {
 	// API для обновления информации об агентах
 	http.HandleFunc("/api/agents", handleAgentsUpdate)
 
+	// API для обновления задержек по этапам
+	http.HandleFunc("/api/latency", handleLatencyUpdate)
+
 	// Запуск сервера
 	log.Fatal(http.ListenAndServe(":8081", nil))
 }
@@ -220,6 +230,28 @@ func handleAgentsUpdate(w http.ResponseWriter, r *http.Request) {
 	json.NewEncoder(w).Encode(map[string]string{"status": "updated"})
 }
 
+func handleLatencyUpdate(w http.ResponseWriter, r *http.Request) {
+	if r.Method != "POST" {
+		http.Error(w, "Method not allowed", http.StatusMethodNotAllowed)
+		return
+	}
+
+	var newLatency LatencyInfo
+	if err := json.NewDecoder(r.Body).Decode(&newLatency); err != nil {
+		http.Error(w, "Invalid JSON", http.StatusBadRequest)
+		return
+	}
+
+	mu.Lock()
+	latency = newLatency
+	mu.Unlock()
+
+	broadcastToSSEClients("latency_update", newLatency)
+
+	w.WriteHeader(http.StatusOK)
+	json.NewEncoder(w).Encode(map[string]string{"status": "updated"})
+}
+
 func handleSSE(w http.ResponseWriter, r *http.Request) {
 	// Устанавливаем заголовки для SSE
 	w.Header().Set("Content-Type", "text/event-stream")
@@ -273,6 +305,7 @@ func handleSSE(w http.ResponseWriter, r *http.Request) {
 			"legitClients":    legitClients,
 			"maliciousClients": maliciousClients,
 			"agents":          agents,
+			"latency":         latency,
 		},
 	}
 	mu.Unlock()
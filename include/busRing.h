@@ -0,0 +1,302 @@
+/*
+ * Filename: d:\HeavenGate\include\busRing.h
+ * Path: d:\HeavenGate\include
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+// Wire format of the DataBus event export and a header-only consumer for it.
+//
+// The producer (BusExporter) owns a broadcast ring in POSIX shared memory:
+//
+//   RingHeader | data[capacity]
+//
+// Frames are FrameHeader | source name | CBOR payload, padded to 64 bytes, and
+// never straddle the end of the buffer (a PADDING_TYPE frame fills the gap).
+// The producer never waits for readers. It publishes tail_intent, writes the
+// frame, then advances tail and latest; a reader copies a frame and re-checks
+// tail_intent to detect that it was overwritten meanwhile. A reader that falls
+// a whole ring behind is lapped: it jumps to the newest frame and counts the
+// loss, the skipped frames show up as a gap in FrameHeader::sequence.
+//
+// The Unix socket fallback (SOCK_SEQPACKET) carries the same frames, one per
+// message, without padding frames.
+
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace busring {
+
+constexpr uint64_t MAGIC = 0x31474E4952474248ull; // "HBGRING1"
+constexpr uint32_t VERSION = 1;
+constexpr uint16_t PADDING_TYPE = 0xFFFF;
+// Frames start on cache lines, which also leaves room for a padding header at the wrap
+constexpr size_t FRAME_ALIGNMENT = 64;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "ring counters must be lock-free to live in shared memory");
+
+enum RingState : uint32_t {
+    RING_INITIALIZING = 0,
+    RING_ACTIVE = 1,
+    RING_CLOSED = 2, // the producer stopped, readers should reopen
+};
+
+struct RingHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t capacity; // bytes of frame data, a power of two
+    uint64_t producer_pid;
+    std::atomic<uint32_t> state;
+
+    // Producer-written counters, each on its own cache line
+    alignas(64) std::atomic<uint64_t> tail_intent;
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<uint64_t> latest; // position of the newest complete frame
+};
+
+struct FrameHeader {
+    uint32_t length; // whole frame including this header and padding
+    uint16_t type;   // BusEventType, or PADDING_TYPE
+    uint16_t source_size;
+    uint32_t payload_size;
+    uint32_t reserved;
+    uint64_t sequence; // per producer, consecutive across ring and socket
+    uint64_t id;
+    uint64_t correlation_id;
+    int64_t timestamp_ns; // system_clock since epoch
+};
+static_assert(sizeof(FrameHeader) == 48, "frame header layout changed");
+
+inline size_t data_offset() {
+    return (sizeof(RingHeader) + 63) & ~size_t{63};
+}
+
+inline size_t frame_length(size_t source_size, size_t payload_size) {
+    return (sizeof(FrameHeader) + source_size + payload_size + FRAME_ALIGNMENT - 1) & ~(FRAME_ALIGNMENT - 1);
+}
+
+// A decoded frame; views point into the reader's buffer and die with the next read
+struct Frame {
+    uint16_t type;
+    uint64_t sequence;
+    uint64_t id;
+    uint64_t correlation_id;
+    int64_t timestamp_ns;
+    std::string_view source;
+    const uint8_t* payload;
+    size_t payload_size;
+};
+
+inline bool decode_frame(const uint8_t* data, size_t size, Frame& out) {
+    if (size < sizeof(FrameHeader)) return false;
+    FrameHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (sizeof(FrameHeader) + header.source_size + header.payload_size > size) return false;
+
+    out.type = header.type;
+    out.sequence = header.sequence;
+    out.id = header.id;
+    out.correlation_id = header.correlation_id;
+    out.timestamp_ns = header.timestamp_ns;
+    out.source = std::string_view(reinterpret_cast<const char*>(data + sizeof(FrameHeader)), header.source_size);
+    out.payload = data + sizeof(FrameHeader) + header.source_size;
+    out.payload_size = header.payload_size;
+    return true;
+}
+
+#if defined(__linux__)
+
+// Tails a shared-memory ring. poll() makes no syscalls; single-threaded use only.
+class RingReader {
+public:
+    RingReader() = default;
+    ~RingReader() { close(); }
+
+    RingReader(const RingReader&) = delete;
+    RingReader& operator=(const RingReader&) = delete;
+
+    // Attaches to the ring and starts at its tail (new frames only)
+    bool open(const std::string& name) {
+        close();
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < data_offset()) {
+            ::close(fd);
+            return false;
+        }
+        void* map = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) return false;
+
+        map_ = static_cast<const uint8_t*>(map);
+        map_size_ = static_cast<size_t>(info.st_size);
+        header_ = reinterpret_cast<const RingHeader*>(map_);
+        if (header_->magic != MAGIC || header_->version != VERSION ||
+            header_->state.load(std::memory_order_acquire) != RING_ACTIVE ||
+            data_offset() + header_->capacity > map_size_) {
+            close();
+            return false;
+        }
+        data_ = map_ + data_offset();
+        capacity_ = header_->capacity;
+        cursor_ = header_->tail.load(std::memory_order_acquire);
+        return true;
+    }
+
+    void close() {
+        if (map_ != nullptr) {
+            munmap(const_cast<uint8_t*>(map_), map_size_);
+        }
+        map_ = nullptr;
+        header_ = nullptr;
+    }
+
+    bool is_open() const { return header_ != nullptr; }
+    // True once the producer has shut down; reopen to follow a restarted producer
+    bool closed() const { return header_ == nullptr || header_->state.load(std::memory_order_acquire) == RING_CLOSED; }
+
+    // Calls handler(const Frame&) for up to `limit` frames, returns how many were handled
+    template <typename Handler>
+    size_t poll(Handler&& handler, size_t limit = SIZE_MAX) {
+        size_t handled = 0;
+        while (header_ != nullptr && handled < limit) {
+            uint64_t tail = header_->tail.load(std::memory_order_acquire);
+            if (cursor_ == tail) break;
+            if (tail - cursor_ > capacity_) {
+                resync();
+                continue;
+            }
+
+            size_t offset = static_cast<size_t>(cursor_ & (capacity_ - 1));
+            FrameHeader header;
+            std::memcpy(&header, data_ + offset, sizeof(header));
+            if (header.length < sizeof(FrameHeader) || header.length > capacity_ - offset) {
+                // Torn by a producer that lapped us
+                resync();
+                continue;
+            }
+            buffer_.resize(header.length);
+            std::memcpy(buffer_.data(), data_ + offset, header.length);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->tail_intent.load(std::memory_order_relaxed) > cursor_ + capacity_) {
+                resync();
+                continue;
+            }
+            cursor_ += header.length;
+            if (header.type == PADDING_TYPE) continue;
+
+            Frame frame;
+            if (!decode_frame(buffer_.data(), buffer_.size(), frame)) continue;
+            if (last_sequence_ != 0 && frame.sequence > last_sequence_ + 1) {
+                skipped_ += frame.sequence - last_sequence_ - 1;
+            }
+            last_sequence_ = frame.sequence;
+            handler(static_cast<const Frame&>(frame));
+            ++handled;
+        }
+        return handled;
+    }
+
+    // Times this reader fell a whole ring behind
+    uint64_t lapped() const { return lapped_; }
+    // Frames lost to laps, derived from sequence gaps
+    uint64_t skipped() const { return skipped_; }
+
+private:
+    const uint8_t* map_{nullptr};
+    size_t map_size_{0};
+    const RingHeader* header_{nullptr};
+    const uint8_t* data_{nullptr};
+    uint64_t capacity_{0};
+    uint64_t cursor_{0};
+    uint64_t last_sequence_{0};
+    uint64_t lapped_{0};
+    uint64_t skipped_{0};
+    std::vector<uint8_t> buffer_;
+
+    void resync() {
+        ++lapped_;
+        cursor_ = header_->latest.load(std::memory_order_acquire);
+    }
+};
+
+// Fallback for readers that cannot map the ring, e.g. across mount namespaces
+class SocketReader {
+public:
+    SocketReader() = default;
+    ~SocketReader() { close(); }
+
+    SocketReader(const SocketReader&) = delete;
+    SocketReader& operator=(const SocketReader&) = delete;
+
+    bool connect(const std::string& path) {
+        close();
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        fd_ = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) return false;
+        if (::connect(fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            close();
+            return false;
+        }
+        buffer_.resize(MAX_FRAME);
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    // Blocks for the next frame; false when the producer disconnects
+    bool read(Frame& frame) {
+        while (fd_ >= 0) {
+            ssize_t received = ::recv(fd_, buffer_.data(), buffer_.size(), 0);
+            if (received <= 0) {
+                if (received < 0 && errno == EINTR) continue;
+                close();
+                return false;
+            }
+            if (decode_frame(buffer_.data(), static_cast<size_t>(received), frame)) return true;
+        }
+        return false;
+    }
+
+    int fd() const { return fd_; }
+
+    static constexpr size_t MAX_FRAME = 64 * 1024;
+
+private:
+    int fd_{-1};
+    std::vector<uint8_t> buffer_;
+};
+
+#endif // __linux__
+
+} // namespace busring
@@ -10,8 +10,11 @@
 #ifndef DASHBOARDAPI_HPP
 #define DASHBOARDAPI_HPP
 
+#include <functional>
 #include <string>
 #include "../common/Confparcer.h"
+#include "../../thirdparty/json.hpp"
+#include "../../thirdparty/asio/include/asio.hpp"
 
 class DashboardAPI {
 public:
@@ -34,6 +37,13 @@ public:
                                    bool is_malicious,
                                    int* err = nullptr);
     std::string callAgentChange(const int& real_size, const int& honey_size, int* err = nullptr);
+    // Per-stage latency percentiles, see LoadBalancer::get_latency_summary()
+    std::string callLatencyUpdate(const nlohmann::json& latency, int* err = nullptr);
+
+    // Runs `call` on the dashboard's own thread, one at a time. The calls above block
+    // for up to the cURL timeout and must not hold a Runtime worker, which also runs
+    // the io_context.
+    void post(std::function<void()> call);
 
     DashboardAPI() = default;
     ~DashboardAPI() = default;
@@ -44,6 +54,8 @@ private:
     // Prevent copying
     DashboardAPI(const DashboardAPI&) = delete;
     DashboardAPI& operator=(const DashboardAPI&) = delete;
+
+    asio::thread_pool sender_{1};
 };
 
 #endif // DASHBOARDAPI_HPP
@@ -20,8 +20,12 @@
 #include <cstring>
 #include <thread>
 #include <atomic>
+#include <mutex>
+#include <utility>
 #include "../common/generic.h"
 #include "../common/logger.h"
+#include "../common/Scheduler.h"
+#include "../common/Confparcer.h"
 #if ISLINUX
 #include <unistd.h>
 #include <sys/wait.h>
@@ -38,9 +42,24 @@ private:
     size_t pid = 0;
     int timeout_seconds = 10;
     std::atomic<bool> is_running{false};
-    std::unique_ptr<std::thread> monitor_thread;
+    // Periodic waitpid(WNOHANG) on the Scheduler instead of a thread blocked in waitpid.
+    // Written from the owner's thread and from the task itself, under monitor_mutex;
+    // cancel() runs outside it, since it waits for a running task
+    TaskId monitor_task{INVALID_TASK};
+    std::mutex monitor_mutex;
 
-    void monitor_process(); // Мониторинг процесса в отдельном потоке
+    static std::chrono::milliseconds MONITOR_INTERVAL() {
+        static std::chrono::milliseconds value(Confparcer::SETTING<size_t>("COMPONENT_MONITOR_MS", 1000));
+        return value;
+    }
+
+    void start_monitor();
+    void stop_monitor();
+    bool monitoring();
+#if ISLINUX
+    bool spawn(); // fork + exec без мониторинга
+#endif
+    void monitor_process(); // Проверка состояния процесса, вызывается планировщиком
 
 public:
     size_t proc_pid;
@@ -86,14 +105,17 @@ inline AppComponent::AppComponent(AppComponent&& other) noexcept
     , pid(other.pid)
     , timeout_seconds(other.timeout_seconds)
     , is_running(other.is_running.load())
-    , monitor_thread(std::move(other.monitor_thread))
     , proc_pid(other.proc_pid)
     , type(other.type)
     , name(std::move(other.name))
 {
+    // The monitor task captures `this`, re-arm it for the new owner
+    bool monitored = other.monitoring();
+    other.stop_monitor();
     other.pid = 0;
     other.proc_pid = 0;
     other.is_running = false;
+    if (monitored) start_monitor();
 }
 
 // Оператор перемещения
@@ -101,15 +123,14 @@ inline AppComponent& AppComponent::operator=(AppComponent&& other) noexcept {
     if (this != &other) {
         // Останавливаем текущий процесс если запущен
         stop();
-        if (monitor_thread && monitor_thread->joinable()) {
-            monitor_thread->join();
-        }
-        
+        stop_monitor();
+
+        bool monitored = other.monitoring();
+        other.stop_monitor();
         path = std::move(other.path);
         pid = other.pid;
         timeout_seconds = other.timeout_seconds;
         is_running = other.is_running.load();
-        monitor_thread = std::move(other.monitor_thread);
         proc_pid = other.proc_pid;
         type = other.type;
         name = std::move(other.name);
@@ -117,6 +138,7 @@ inline AppComponent& AppComponent::operator=(AppComponent&& other) noexcept {
         other.pid = 0;
         other.proc_pid = 0;
         other.is_running = false;
+        if (monitored) start_monitor();
     }
     return *this;
 }
@@ -124,30 +146,60 @@ inline AppComponent& AppComponent::operator=(AppComponent&& other) noexcept {
 inline AppComponent::~AppComponent()
 {
     stop();
-    // Ждем завершения мониторингового потока если он запущен
-    if (monitor_thread && monitor_thread->joinable()) {
-        monitor_thread->join();
+    // Отменяем мониторинг, после возврата cancel() задача уже не выполняется
+    stop_monitor();
+}
+
+inline void AppComponent::start_monitor() {
+    TaskId previous;
+    {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        previous = std::exchange(monitor_task, Scheduler::the().schedule_every(MONITOR_INTERVAL(),
+                                                                               [this]() { monitor_process(); }));
+    }
+    if (previous != INVALID_TASK) {
+        Scheduler::the().cancel(previous);
     }
 }
 
+inline void AppComponent::stop_monitor() {
+    TaskId task;
+    {
+        std::lock_guard<std::mutex> lock(monitor_mutex);
+        task = std::exchange(monitor_task, INVALID_TASK);
+    }
+    if (task != INVALID_TASK) {
+        Scheduler::the().cancel(task);
+    }
+}
+
+inline bool AppComponent::monitoring() {
+    std::lock_guard<std::mutex> lock(monitor_mutex);
+    return monitor_task != INVALID_TASK;
+}
+
 inline void AppComponent::monitor_process() {
 #if ISLINUX
     int status;
     pid_t monitored_pid = this->pid;
     
-    // Ждем завершения процесса
-    waitpid(monitored_pid, &status, 0);
+    // Процесс ещё работает
+    if (monitored_pid == 0 || waitpid(monitored_pid, &status, WNOHANG) != monitored_pid) {
+        return;
+    }
     
     if (WIFEXITED(status)) {
         int exit_code = WEXITSTATUS(status);
         if (exit_code != 0 || exit_code != 15 || exit_code != 9) {
             LOG_ERROR("Service " + name + " Exited with: " + std::to_string(exit_code) + " Code. Restarting!");
-            // Перезапускаем в том же потоке мониторинга
+            // Перезапускаем без run(): эта же задача следит за новым процессом, а
+            // новая задача, поставленная отсюда, пережила бы параллельный stop()
             is_running = false;
-            run();
+            spawn();
         } else {
             LOG_INFO("Service " + name + " Stopped gracefully.");
             is_running = false;
+            stop_monitor();
         }
     } else if (WIFSIGNALED(status)) {
         int signal = WTERMSIG(status);
@@ -157,6 +209,7 @@ inline void AppComponent::monitor_process() {
         }
         else{LOG_INFO("Service " + name + " Terminated by signal: " + std::to_string(signal));}
         is_running = false;
+        stop_monitor();
     }
 #endif
 }
@@ -167,10 +220,27 @@ inline bool AppComponent::run() {
         LOG_WARN("Service " + name + " is already running");
         return true;
     }
+    if (!spawn()) return false;
 
+    // Запускаем мониторинг через планировщик
+    start_monitor();
+    return true;
+#else
+    LOG_ERROR("run() not implemented for this platform");
+    // TODO: Implement for other platforms
+    TODO();
+    return false;
+#endif
+}
+
+#if ISLINUX
+inline bool AppComponent::spawn() {
     pid_t child_pid = fork();
     if (child_pid == 0) {
-        // Дочерний процесс
+        // Дочерний процесс: main() блокирует SIGINT/SIGTERM, а маска сохраняется через exec
+        sigset_t signals;
+        sigemptyset(&signals);
+        sigprocmask(SIG_SETMASK, &signals, nullptr);
         execl(path.c_str(), "", NULL); // FIXME: Приложение ориентируется на cwd, запуск из другой директории не запустит dashboard
         // Если execl вернул управление - ошибка
         LOG_ERROR("Failed to run " + name + ": " + std::string(strerror(errno)));
@@ -183,26 +253,14 @@ inline bool AppComponent::run() {
         is_running = true;
         
         LOG_INFO("Service " + name + " started with PID: " + std::to_string(child_pid));
-        
-        // Запускаем мониторинг в отдельном потоке
-        if (monitor_thread && monitor_thread->joinable()) {
-            monitor_thread->join();
-        }
-        monitor_thread = std::make_unique<std::thread>(&AppComponent::monitor_process, this);
-        
         return true;
     }
     else {
         LOG_ERROR("Failed to run " + name + " - Fork failed: " + std::string(strerror(errno)));
         return false;
     }
-#else
-    LOG_ERROR("run() not implemented for this platform");
-    // TODO: Implement for other platforms
-    TODO();
-    return false;
-#endif
 }
+#endif
 
 inline bool AppComponent::stop() {
 #if ISLINUX
@@ -224,6 +282,9 @@ inline bool AppComponent::stop() {
         return false;
     }
 
+    // Остановка ожидаемая, перезапуск из monitor_process() не нужен
+    stop_monitor();
+
     // Send SIGTERM for graceful shutdown
     LOG_INFO("Sending SIGTERM to process " + name + "[" + std::to_string(pid) + "]");
     if (kill(pid, SIGTERM) != 0) {
@@ -234,14 +295,13 @@ inline bool AppComponent::stop() {
     // Wait for process termination
     for (int i = 0; i < timeout_seconds; i++) {
         sleep(1);
-        if (kill(pid, 0) != 0) {
-            if (errno == ESRCH) {
-                LOG_INFO("Process " + name + "[" + std::to_string(pid) + "]" + " terminated gracefully.");
-                is_running = false;
-                pid = 0;
-                proc_pid = 0;
-                return true;
-            }
+        // Reap the child ourselves, a zombie still answers kill(pid, 0)
+        if (waitpid(pid, nullptr, WNOHANG) == static_cast<pid_t>(pid) || (kill(pid, 0) != 0 && errno == ESRCH)) {
+            LOG_INFO("Process " + name + "[" + std::to_string(pid) + "]" + " terminated gracefully.");
+            is_running = false;
+            pid = 0;
+            proc_pid = 0;
+            return true;
         }
     }
 
@@ -254,7 +314,7 @@ inline bool AppComponent::stop() {
     
     sleep(1); // Give time for SIGKILL to process
     
-    if (kill(pid, 0) == 0) {
+    if (waitpid(pid, nullptr, WNOHANG) != static_cast<pid_t>(pid) && kill(pid, 0) == 0) {
         LOG_ERROR("Process " + name + "[" + std::to_string(pid) + "]" + " still running after SIGKILL!");
         return false;
     }
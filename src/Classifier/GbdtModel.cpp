@@ -0,0 +1,244 @@
+/*
+ * Filename: d:\HeavenGate\src\Classifier\GbdtModel.cpp
+ * Path: d:\HeavenGate\src\Classifier
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "GbdtModel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+
+namespace classifier {
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+struct Node {
+    bool leaf{false};
+    uint16_t feature{0};
+    float threshold{0};
+    int yes{-1};
+    int no{-1};
+    float value{0};
+};
+
+inline float logistic(float margin) {
+    return 1.0f / (1.0f + std::exp(-margin));
+}
+
+} // namespace
+
+GbdtModel GbdtModel::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open model file " + path);
+    return parse(file, path);
+}
+
+GbdtModel GbdtModel::parse(std::istream& input, const std::string& name) {
+    GbdtModel model;
+    // Trees in id order, nodes by id
+    std::map<int, std::map<int, Node>> trees;
+
+    std::string line;
+    size_t number = 0;
+    while (std::getline(input, line)) {
+        ++number;
+        auto fail = [&](const std::string& reason) {
+            throw std::runtime_error(name + ":" + std::to_string(number) + ": " + reason);
+        };
+        auto to_int = [&](const std::string& key, const std::string& value) {
+            char* end = nullptr;
+            long result = std::strtol(value.c_str(), &end, 10);
+            if (*end != '\0' || result < 0 || result > std::numeric_limits<int>::max()) {
+                fail("bad " + key + " '" + value + "'");
+            }
+            return static_cast<int>(result);
+        };
+        auto to_float = [&](const std::string& key, const std::string& value) {
+            char* end = nullptr;
+            float result = std::strtof(value.c_str(), &end);
+            if (*end != '\0' || !std::isfinite(result)) fail("bad " + key + " '" + value + "'");
+            return result;
+        };
+
+        Node node;
+        int tree = -1;
+        int id = -1;
+        bool any_field = false;
+        bool has_feature = false;
+        bool has_threshold = false;
+        std::string_view rest(line);
+        while (true) {
+            while (!rest.empty() && is_space(rest.front())) rest.remove_prefix(1);
+            if (rest.empty() || rest.front() == '#') break;
+            size_t end = 0;
+            while (end < rest.size() && !is_space(rest[end])) ++end;
+            std::string_view field = rest.substr(0, end);
+            rest.remove_prefix(end);
+
+            size_t equals = field.find('=');
+            if (equals == std::string_view::npos || equals == 0) {
+                fail("expected name=value, got '" + std::string(field) + "'");
+            }
+            std::string key(field.substr(0, equals));
+            std::string value(field.substr(equals + 1));
+            if (value.empty()) fail("empty value for " + key);
+
+            if (key == "base_score") {
+                model.base_score_ = to_float(key, value);
+            } else if (key == "tree") {
+                tree = to_int(key, value);
+            } else if (key == "node") {
+                id = to_int(key, value);
+            } else if (key == "feature") {
+                auto feature = feature_from_name(value);
+                if (!feature) fail("unknown feature " + value);
+                node.feature = *feature;
+                has_feature = true;
+            } else if (key == "threshold") {
+                node.threshold = to_float(key, value);
+                has_threshold = true;
+            } else if (key == "yes") {
+                node.yes = to_int(key, value);
+            } else if (key == "no") {
+                node.no = to_int(key, value);
+            } else if (key == "leaf") {
+                node.value = to_float(key, value);
+                node.leaf = true;
+            } else {
+                fail("unknown field " + key);
+            }
+            any_field = true;
+        }
+        if (!any_field || (tree < 0 && id < 0)) continue;
+
+        if (tree < 0 || id < 0) fail("a node needs tree= and node=");
+        if (!node.leaf && (!has_feature || !has_threshold || node.yes < 0 || node.no < 0)) {
+            fail("a split needs feature=, threshold=, yes= and no=");
+        }
+        if (!trees[tree].emplace(id, node).second) fail("node " + std::to_string(id) + " defined twice");
+    }
+
+    for (const auto& [tree_id, nodes] : trees) {
+        auto fail = [&, tree_id = tree_id](const std::string& reason) {
+            throw std::runtime_error(name + ": tree " + std::to_string(tree_id) + ": " + reason);
+        };
+        if (nodes.count(0) == 0) fail("no root node 0");
+
+        // Depth of the subtree under `id`; a cycle shows up as a path longer than MAX_DEPTH
+        auto depth_of = [&](auto& self, int id, unsigned level) -> unsigned {
+            auto node = nodes.find(id);
+            if (node == nodes.end()) fail("missing node " + std::to_string(id));
+            if (level > MAX_DEPTH) fail("deeper than " + std::to_string(MAX_DEPTH) + " levels, or cyclic");
+            if (node->second.leaf) return 0;
+            return 1 + std::max(self(self, node->second.yes, level + 1), self(self, node->second.no, level + 1));
+        };
+        unsigned depth = depth_of(depth_of, 0, 0);
+
+        Tree tree;
+        tree.nodes = static_cast<uint32_t>(model.features_.size());
+        tree.leaves = static_cast<uint32_t>(model.leaves_.size());
+        tree.depth = depth;
+        size_t internal = (size_t{1} << depth) - 1;
+        // Padding splits send everything to `yes`
+        model.features_.resize(model.features_.size() + internal, 0);
+        model.thresholds_.resize(model.thresholds_.size() + internal, std::numeric_limits<float>::infinity());
+        model.leaves_.resize(model.leaves_.size() + (internal + 1), 0.0f);
+
+        uint16_t* features = model.features_.data() + tree.nodes;
+        float* thresholds = model.thresholds_.data() + tree.nodes;
+        float* leaves = model.leaves_.data() + tree.leaves;
+        auto place = [&](auto& self, int id, size_t position, unsigned level) -> void {
+            const Node& node = nodes.at(id);
+            if (!node.leaf) {
+                features[position] = node.feature;
+                thresholds[position] = node.threshold;
+                self(self, node.yes, 2 * position + 1, level + 1);
+                self(self, node.no, 2 * position + 2, level + 1);
+                return;
+            }
+            // Every leaf slot below `position`
+            size_t first = position;
+            size_t count = 1;
+            for (unsigned below = level; below < depth; ++below) {
+                first = 2 * first + 1;
+                count *= 2;
+            }
+            for (size_t i = 0; i < count; ++i) {
+                leaves[first - internal + i] = node.value;
+            }
+        };
+        place(place, 0, 0, 0);
+        model.trees_.push_back(tree);
+    }
+
+    if (model.trees_.empty()) throw std::runtime_error(name + ": no trees");
+    return model;
+}
+
+float GbdtModel::predict(const FeatureVector& row) const {
+    float margin = base_score_;
+    for (const Tree& tree : trees_) {
+        const uint16_t* features = features_.data() + tree.nodes;
+        const float* thresholds = thresholds_.data() + tree.nodes;
+        uint32_t node = 0;
+        for (uint32_t level = 0; level < tree.depth; ++level) {
+            node = 2 * node + 1 + (row[features[node]] >= thresholds[node]);
+        }
+        margin += leaves_[tree.leaves + node - ((1u << tree.depth) - 1)];
+    }
+    return logistic(margin);
+}
+
+void GbdtModel::predict(const FeatureVector* rows, size_t count, float* scores) const {
+    for (size_t i = 0; i < count; ++i) scores[i] = base_score_;
+
+    for (const Tree& tree : trees_) {
+        const uint16_t* features = features_.data() + tree.nodes;
+        const float* thresholds = thresholds_.data() + tree.nodes;
+        const float* leaves = leaves_.data() + tree.leaves - ((1u << tree.depth) - 1);
+        size_t i = 0;
+        // Four independent walks at a time, their loads overlap
+        for (; i + 4 <= count; i += 4) {
+            const FeatureVector& a = rows[i];
+            const FeatureVector& b = rows[i + 1];
+            const FeatureVector& c = rows[i + 2];
+            const FeatureVector& d = rows[i + 3];
+            uint32_t na = 0, nb = 0, nc = 0, nd = 0;
+            for (uint32_t level = 0; level < tree.depth; ++level) {
+                na = 2 * na + 1 + (a[features[na]] >= thresholds[na]);
+                nb = 2 * nb + 1 + (b[features[nb]] >= thresholds[nb]);
+                nc = 2 * nc + 1 + (c[features[nc]] >= thresholds[nc]);
+                nd = 2 * nd + 1 + (d[features[nd]] >= thresholds[nd]);
+            }
+            scores[i] += leaves[na];
+            scores[i + 1] += leaves[nb];
+            scores[i + 2] += leaves[nc];
+            scores[i + 3] += leaves[nd];
+        }
+        for (; i < count; ++i) {
+            uint32_t node = 0;
+            for (uint32_t level = 0; level < tree.depth; ++level) {
+                node = 2 * node + 1 + (rows[i][features[node]] >= thresholds[node]);
+            }
+            scores[i] += leaves[node];
+        }
+    }
+
+    for (size_t i = 0; i < count; ++i) scores[i] = logistic(scores[i]);
+}
+
+} // namespace classifier
@@ -0,0 +1,65 @@
+/*
+ * Filename: d:\HeavenGate\src\Classifier\GbdtModel.h
+ * Path: d:\HeavenGate\src\Classifier
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+#include "RequestFeatures.h"
+
+namespace classifier {
+
+// A gradient-boosted tree ensemble over FeatureVector, scored as the logistic
+// of base_score plus one leaf per tree.
+//
+// Each tree is padded to a complete binary tree of its depth and stored as
+// flat arrays in heap order, so a step down is node = 2 * node + 1 + (x >= t)
+// with no branch on the data; leaves shallower than the depth are copied into
+// every leaf slot below them. Immutable once loaded.
+class GbdtModel {
+public:
+    // Padded trees take 2^depth leaves, deeper ones are rejected
+    static constexpr unsigned MAX_DEPTH = 12;
+
+    // Lines of `name=value` fields, '#' starts a comment:
+    //   base_score=-1.5
+    //   tree=0 node=0 feature=entropy threshold=4.5 yes=1 no=2
+    //   tree=0 node=1 leaf=-0.4
+    // A split goes to `yes` when the feature is below the threshold, as in
+    // XGBoost text dumps; node 0 is the root of each tree. Throws
+    // std::runtime_error naming the line of the first bad entry.
+    static GbdtModel load(const std::string& path);
+    static GbdtModel parse(std::istream& input, const std::string& name);
+
+    // In [0, 1]
+    float predict(const FeatureVector& row) const;
+    // Scores `count` rows into `scores`, walking each tree over every row
+    // before moving to the next tree
+    void predict(const FeatureVector* rows, size_t count, float* scores) const;
+
+    size_t tree_count() const { return trees_.size(); }
+
+private:
+    struct Tree {
+        // First entry in features_ and thresholds_, and in leaves_
+        uint32_t nodes;
+        uint32_t leaves;
+        uint32_t depth;
+    };
+
+    float base_score_{0};
+    std::vector<Tree> trees_;
+    std::vector<uint16_t> features_;
+    std::vector<float> thresholds_;
+    std::vector<float> leaves_;
+};
+
+} // namespace classifier
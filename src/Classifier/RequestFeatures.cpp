@@ -0,0 +1,371 @@
+/*
+ * Filename: d:\HeavenGate\src\Classifier\RequestFeatures.cpp
+ * Path: d:\HeavenGate\src\Classifier
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "RequestFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include "../LoadBalancer/HttpParser.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HG_FEATURES_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace classifier {
+
+namespace {
+
+constexpr const char* NAMES[] = {
+    "length", "entropy", "control_ratio", "high_ratio", "digit_ratio", "alpha_ratio", "upper_ratio",
+    "space_ratio", "percent_ratio", "special_ratio", "line_count", "max_line_length", "max_token_length",
+    "is_http", "method_length", "target_length", "query_length", "header_count",
+    "is_tls", "connections_per_s", "requests_per_s", "short_connection_ratio", "distinct_ports",
+    "distinct_paths", "connection_share",
+};
+static_assert(std::size(NAMES) == FEATURE_COUNT, "a name for every Feature");
+
+inline unsigned lowest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+inline unsigned highest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+}
+
+// Longest run of set bits in a 16-bit mask without a loop over the runs:
+// ones(j) marks where j set bits start, and ones(c + k) = ones(c) & ones(k) >> c
+// is tried for k = 8, 4, 2, 1
+inline unsigned longest_ones(unsigned mask) {
+    unsigned two = mask & (mask >> 1);
+    unsigned four = two & (two >> 2);
+    unsigned eight = four & (four >> 4);
+    unsigned length = mask != 0;
+    unsigned ones = mask;
+    auto widen = [&length, &ones](unsigned k, unsigned runs) {
+        unsigned wider = ones & (runs >> length);
+        length += wider != 0 ? k : 0;
+        ones = wider != 0 ? wider : ones;
+    };
+    widen(8, eight);
+    widen(4, four);
+    widen(2, two);
+    widen(1, mask);
+    return length;
+}
+
+// Longest run of bytes between stop bytes, fed a block's stop mask at a time
+struct Run {
+    uint32_t current{0};
+    uint32_t longest{0};
+
+    void feed(unsigned stops, unsigned width) {
+        if (stops == 0) {
+            current += width;
+            longest = std::max(longest, current);
+            return;
+        }
+        // The run carried in ends at the first stop, the last one starts the next
+        longest = std::max(longest, current + lowest_bit(stops));
+        longest = std::max(longest, longest_ones(~stops & ((1u << width) - 1)));
+        current = width - 1 - highest_bit(stops);
+    }
+};
+
+struct Counts {
+    uint32_t control{0};
+    uint32_t high{0};
+    uint32_t digit{0};
+    uint32_t upper{0};
+    uint32_t lower{0};
+    uint32_t space{0};
+    uint32_t percent{0};
+    uint32_t special{0};
+    uint32_t newline{0};
+    Run lines;
+    Run tokens;
+};
+
+enum Class : uint16_t {
+    CONTROL = 1 << 0,
+    HIGH = 1 << 1,
+    DIGIT = 1 << 2,
+    UPPER = 1 << 3,
+    LOWER = 1 << 4,
+    SPACE = 1 << 5,
+    PERCENT = 1 << 6,
+    SPECIAL = 1 << 7,
+    NEWLINE = 1 << 8,
+    TOKEN = 1 << 9,
+};
+
+struct ClassTable {
+    uint16_t classes[256]{};
+
+    constexpr ClassTable() {
+        for (int c = 0; c < 0x20; ++c) classes[c] = CONTROL;
+        classes['\t'] = classes['\r'] = 0;
+        classes['\n'] = NEWLINE;
+        classes[0x7f] = CONTROL;
+        for (int c = 0x80; c < 0x100; ++c) classes[c] = HIGH;
+        for (int c = '0'; c <= '9'; ++c) classes[c] = DIGIT | TOKEN;
+        for (int c = 'A'; c <= 'Z'; ++c) classes[c] = UPPER | TOKEN;
+        for (int c = 'a'; c <= 'z'; ++c) classes[c] = LOWER | TOKEN;
+        classes[' '] = SPACE;
+        classes['%'] = PERCENT | TOKEN;
+        classes['-'] = classes['_'] = classes['.'] = TOKEN;
+        for (char c : {'<', '>', '\'', '"', ';', '(', ')', '{', '}', '|', '`', '$', '\\'}) {
+            classes[static_cast<unsigned char>(c)] = SPECIAL;
+        }
+    }
+};
+
+constexpr ClassTable CLASSES;
+
+void count_scalar(const unsigned char* p, const unsigned char* end, Counts& counts) {
+    for (; p < end; ++p) {
+        uint16_t c = CLASSES.classes[*p];
+        counts.control += (c & CONTROL) != 0;
+        counts.high += (c & HIGH) != 0;
+        counts.digit += (c & DIGIT) != 0;
+        counts.upper += (c & UPPER) != 0;
+        counts.lower += (c & LOWER) != 0;
+        counts.space += (c & SPACE) != 0;
+        counts.percent += (c & PERCENT) != 0;
+        counts.special += (c & SPECIAL) != 0;
+        counts.newline += (c & NEWLINE) != 0;
+        counts.lines.feed((c & NEWLINE) != 0, 1);
+        counts.tokens.feed((c & TOKEN) == 0, 1);
+    }
+}
+
+#if HG_FEATURES_SSE2
+// 0xff in the lanes holding a byte in [low, high]
+inline __m128i in_range(__m128i v, unsigned char low, unsigned char high) {
+    __m128i above = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(static_cast<char>(low))), v);
+    __m128i below = _mm_cmpeq_epi8(_mm_min_epu8(v, _mm_set1_epi8(static_cast<char>(high))), v);
+    return _mm_and_si128(above, below);
+}
+
+inline __m128i equals(__m128i v, char c) {
+    return _mm_cmpeq_epi8(v, _mm_set1_epi8(c));
+}
+
+inline unsigned mask_of(__m128i lanes) {
+    return static_cast<unsigned>(_mm_movemask_epi8(lanes));
+}
+
+// Per-lane byte counts of one class, folded into Counts before they wrap
+struct LaneCounts {
+    __m128i control = _mm_setzero_si128();
+    __m128i high = _mm_setzero_si128();
+    __m128i digit = _mm_setzero_si128();
+    __m128i upper = _mm_setzero_si128();
+    __m128i lower = _mm_setzero_si128();
+    __m128i space = _mm_setzero_si128();
+    __m128i percent = _mm_setzero_si128();
+    __m128i special = _mm_setzero_si128();
+    __m128i newline = _mm_setzero_si128();
+};
+
+inline uint32_t lane_sum(__m128i lanes) {
+    __m128i sums = _mm_sad_epu8(lanes, _mm_setzero_si128());
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(sums) + _mm_cvtsi128_si32(_mm_srli_si128(sums, 8)));
+}
+
+void fold(LaneCounts& lanes, Counts& counts) {
+    counts.control += lane_sum(lanes.control);
+    counts.high += lane_sum(lanes.high);
+    counts.digit += lane_sum(lanes.digit);
+    counts.upper += lane_sum(lanes.upper);
+    counts.lower += lane_sum(lanes.lower);
+    counts.space += lane_sum(lanes.space);
+    counts.percent += lane_sum(lanes.percent);
+    counts.special += lane_sum(lanes.special);
+    counts.newline += lane_sum(lanes.newline);
+    lanes = LaneCounts();
+}
+
+// Sixteen bytes per step; the tail goes through the table. A matching lane
+// is 0xff, so subtracting the comparison adds one to that lane's count.
+const unsigned char* count_sse2(const unsigned char* p, const unsigned char* end, Counts& counts) {
+    LaneCounts lanes;
+    unsigned blocks = 0;
+    for (; end - p >= 16; p += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+
+        __m128i digit = in_range(v, '0', '9');
+        __m128i upper = in_range(v, 'A', 'Z');
+        __m128i lower = in_range(v, 'a', 'z');
+        __m128i percent = equals(v, '%');
+        __m128i newline = equals(v, '\n');
+        __m128i whitespace = _mm_or_si128(_mm_or_si128(equals(v, '\t'), equals(v, '\r')), newline);
+        __m128i control = _mm_or_si128(_mm_andnot_si128(whitespace, in_range(v, 0x00, 0x1f)), equals(v, 0x7f));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_or_si128(equals(v, '<'), equals(v, '>')), _mm_or_si128(equals(v, '\''), equals(v, '"'))),
+            _mm_or_si128(_mm_or_si128(equals(v, ';'), equals(v, '(')), _mm_or_si128(equals(v, ')'), equals(v, '{'))));
+        special = _mm_or_si128(special, _mm_or_si128(
+            _mm_or_si128(equals(v, '}'), equals(v, '|')),
+            _mm_or_si128(_mm_or_si128(equals(v, '`'), equals(v, '$')), equals(v, '\\'))));
+        __m128i token = _mm_or_si128(_mm_or_si128(_mm_or_si128(digit, upper), _mm_or_si128(lower, percent)),
+                                     _mm_or_si128(_mm_or_si128(equals(v, '-'), equals(v, '_')), equals(v, '.')));
+
+        lanes.control = _mm_sub_epi8(lanes.control, control);
+        lanes.high = _mm_sub_epi8(lanes.high, _mm_cmplt_epi8(v, _mm_setzero_si128()));
+        lanes.digit = _mm_sub_epi8(lanes.digit, digit);
+        lanes.upper = _mm_sub_epi8(lanes.upper, upper);
+        lanes.lower = _mm_sub_epi8(lanes.lower, lower);
+        lanes.space = _mm_sub_epi8(lanes.space, equals(v, ' '));
+        lanes.percent = _mm_sub_epi8(lanes.percent, percent);
+        lanes.special = _mm_sub_epi8(lanes.special, special);
+        lanes.newline = _mm_sub_epi8(lanes.newline, newline);
+        if (++blocks == 255) {
+            fold(lanes, counts);
+            blocks = 0;
+        }
+
+        counts.lines.feed(mask_of(newline), 16);
+        counts.tokens.feed(~mask_of(token) & 0xffffu, 16);
+    }
+    fold(lanes, counts);
+    return p;
+}
+#endif
+
+// Shannon entropy of the bytes. One histogram: splitting it to keep runs of a
+// byte off each other's increments costs more in clearing and summing than it
+// saves on requests of a few hundred bytes.
+double entropy(const unsigned char* p, size_t size) {
+    if (size == 0) return 0;
+    // MAX_INSPECTED bytes fit 16-bit counts even when all are equal
+    static_assert(MAX_INSPECTED <= 65535, "histogram counts are 16-bit");
+    uint16_t histogram[256] = {};
+    for (size_t i = 0; i < size; ++i) ++histogram[p[i]];
+
+    // c * log2(c) for the small counts most bytes have
+    static const auto table = []() {
+        std::array<float, 256> values{};
+        for (size_t c = 1; c < values.size(); ++c) {
+            values[c] = static_cast<float>(c * std::log2(static_cast<double>(c)));
+        }
+        return values;
+    }();
+
+    // Four sums, so the adds do not wait on each other
+    float sums[4] = {};
+    double large = 0;
+    for (size_t byte = 0; byte < 256; byte += 4) {
+        for (size_t lane = 0; lane < 4; ++lane) {
+            uint32_t count = histogram[byte + lane];
+            if (count < table.size()) {
+                sums[lane] += table[count];
+            } else {
+                large += count * std::log2(static_cast<double>(count));
+            }
+        }
+    }
+    double sum = large + (static_cast<double>(sums[0]) + sums[1]) + (static_cast<double>(sums[2]) + sums[3]);
+    double n = static_cast<double>(size);
+    return std::log2(n) - sum / n;
+}
+
+} // namespace
+
+const char* feature_name(Feature feature) {
+    return feature < FEATURE_COUNT ? NAMES[feature] : "unknown";
+}
+
+std::optional<Feature> feature_from_name(std::string_view name) {
+    for (uint16_t i = 0; i < FEATURE_COUNT; ++i) {
+        if (name == NAMES[i]) return static_cast<Feature>(i);
+    }
+    return std::nullopt;
+}
+
+void extract_request_features(const char* data, size_t size, FeatureVector& out) {
+    size = std::min(size, MAX_INSPECTED);
+    const auto* begin = reinterpret_cast<const unsigned char*>(data);
+    const auto* end = begin + size;
+
+    Counts counts;
+    const unsigned char* p = begin;
+#if HG_FEATURES_SSE2
+    p = count_sse2(p, end, counts);
+#endif
+    count_scalar(p, end, counts);
+
+    float length = static_cast<float>(size);
+    auto ratio = [length](uint32_t count) { return length > 0 ? static_cast<float>(count) / length : 0.0f; };
+    uint32_t letters = counts.upper + counts.lower;
+
+    out[LENGTH] = length;
+    out[ENTROPY] = static_cast<float>(entropy(begin, size));
+    out[CONTROL_RATIO] = ratio(counts.control);
+    out[HIGH_RATIO] = ratio(counts.high);
+    out[DIGIT_RATIO] = ratio(counts.digit);
+    out[ALPHA_RATIO] = ratio(letters);
+    out[UPPER_RATIO] = letters ? static_cast<float>(counts.upper) / static_cast<float>(letters) : 0.0f;
+    out[SPACE_RATIO] = ratio(counts.space);
+    out[PERCENT_RATIO] = ratio(counts.percent);
+    out[SPECIAL_RATIO] = ratio(counts.special);
+    out[LINE_COUNT] = static_cast<float>(counts.newline);
+    out[MAX_LINE_LENGTH] = static_cast<float>(counts.lines.longest);
+    out[MAX_TOKEN_LENGTH] = static_cast<float>(counts.tokens.longest);
+
+    HttpRequestParser parser;
+    bool http = size != 0 && parser.parse(data, size).status == HttpRequestParser::Status::HEAD_COMPLETE;
+    const HttpRequest& request = parser.request();
+    std::string_view target = http ? request.target : std::string_view();
+    size_t query = target.find('?');
+    out[IS_HTTP] = http ? 1.0f : 0.0f;
+    out[METHOD_LENGTH] = http ? static_cast<float>(request.method.size()) : 0.0f;
+    out[TARGET_LENGTH] = static_cast<float>(target.size());
+    out[QUERY_LENGTH] = query == std::string_view::npos ? 0.0f : static_cast<float>(target.size() - query - 1);
+    out[HEADER_COUNT] = http ? static_cast<float>(request.header_count) : 0.0f;
+}
+
+void extract_context_features(const nlohmann::json& payload, FeatureVector& out) {
+    out[IS_TLS] = payload.contains("tls") ? 1.0f : 0.0f;
+
+    auto features = payload.find("features");
+    if (features == payload.end() || !features->is_object()) {
+        for (size_t i = CONNECTIONS_PER_S; i < FEATURE_COUNT; ++i) out[i] = 0;
+        return;
+    }
+    auto number = [&features](const char* name) { return features->value(name, 0.0); };
+    // Under a second of history would turn one connection into a high rate
+    double span = std::max(number("span_s"), 1.0);
+    double connections = number("connections");
+    out[CONNECTIONS_PER_S] = static_cast<float>(connections / span);
+    out[REQUESTS_PER_S] = static_cast<float>(number("requests") / span);
+    out[SHORT_CONNECTION_RATIO] = connections > 0
+        ? static_cast<float>(std::min(1.0, number("short_connections") / connections)) : 0.0f;
+    out[DISTINCT_PORTS] = static_cast<float>(number("distinct_ports"));
+    out[DISTINCT_PATHS] = static_cast<float>(number("distinct_paths"));
+    out[CONNECTION_SHARE] = static_cast<float>(number("connection_share"));
+}
+
+} // namespace classifier
@@ -0,0 +1,67 @@
+/*
+ * Filename: d:\HeavenGate\src\Classifier\RequestFeatures.h
+ * Path: d:\HeavenGate\src\Classifier
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include "../../thirdparty/json.hpp"
+
+namespace classifier {
+
+// Inputs of the statistical model, in the order of a feature vector. Models
+// name them, see feature_from_name().
+enum Feature : uint16_t {
+    // From the first bytes of the request
+    LENGTH,             // bytes
+    ENTROPY,            // Shannon entropy, bits per byte
+    CONTROL_RATIO,      // bytes below 0x20 other than \t \r \n, and 0x7f
+    HIGH_RATIO,         // bytes 0x80 and above
+    DIGIT_RATIO,
+    ALPHA_RATIO,
+    UPPER_RATIO,        // of the letters
+    SPACE_RATIO,
+    PERCENT_RATIO,      // '%', percent-encoding
+    SPECIAL_RATIO,      // < > ' " ; ( ) { } | ` $ backslash
+    LINE_COUNT,
+    MAX_LINE_LENGTH,
+    MAX_TOKEN_LENGTH,   // longest run of letters, digits and - _ . %
+    IS_HTTP,            // 1 when it opens with an HTTP/1.x request line
+    METHOD_LENGTH,
+    TARGET_LENGTH,
+    QUERY_LENGTH,
+    HEADER_COUNT,
+    // From the classification request around them
+    IS_TLS,
+    CONNECTIONS_PER_S,
+    REQUESTS_PER_S,
+    SHORT_CONNECTION_RATIO,
+    DISTINCT_PORTS,
+    DISTINCT_PATHS,
+    CONNECTION_SHARE,
+    FEATURE_COUNT
+};
+
+using FeatureVector = std::array<float, FEATURE_COUNT>;
+
+const char* feature_name(Feature feature);
+std::optional<Feature> feature_from_name(std::string_view name);
+
+// Fills the request-byte features of `out`, LENGTH to HEADER_COUNT. Looks at
+// most at the first MAX_INSPECTED bytes.
+void extract_request_features(const char* data, size_t size, FeatureVector& out);
+
+// Fills the rest from a REQUEST_FOR_CLASSIFICATION payload, its "tls" and
+// "features" objects; missing ones leave zeros
+void extract_context_features(const nlohmann::json& payload, FeatureVector& out);
+
+constexpr size_t MAX_INSPECTED = 16 * 1024;
+
+} // namespace classifier
@@ -0,0 +1,160 @@
+/*
+ * Filename: d:\HeavenGate\src\Classifier\StatisticalClassifier.cpp
+ * Path: d:\HeavenGate\src\Classifier
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "StatisticalClassifier.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
+#include "../DataBus/DataBus.h"
+#include "../Runtime/Runtime.h"
+#include "../common/logger.h"
+
+namespace classifier {
+
+namespace {
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - since).count());
+}
+
+} // namespace
+
+StatisticalClassifier::StatisticalClassifier(DataBus& bus)
+    : bus_(bus) {}
+
+StatisticalClassifier::~StatisticalClassifier() {
+    stop();
+}
+
+bool StatisticalClassifier::start() {
+    if (running_.load()) return true;
+    if (MODEL_PATH().empty()) return false;
+
+    try {
+        model_ = GbdtModel::load(MODEL_PATH());
+    } catch (const std::exception& e) {
+        LOG_ERROR("Classifier model not loaded: " + std::string(e.what()));
+        return false;
+    }
+
+    running_ = true;
+    // Only queues the request, scoring happens on the Runtime
+    SubscribeOptions options;
+    options.mode = DeliveryMode::INLINE;
+    options.name = "statistical_classifier";
+    options.filter.where_present("request_data");
+    subscription_ = bus_.subscribe(BusEventType::REQUEST_FOR_CLASSIFICATION, [this](const Event& event) {
+        enqueue(event);
+    }, options);
+
+    LOG_INFO("Statistical classifier started with " + std::to_string(model_->tree_count()) +
+             " trees from " + MODEL_PATH());
+    return true;
+}
+
+void StatisticalClassifier::stop() {
+    if (!running_.exchange(false)) return;
+    bus_.unsubscribe(subscription_);
+
+    // A stopped Runtime drops posted batches, their requests time out
+    std::unique_lock<std::mutex> lock(pending_mutex_);
+    while (flushes_ != 0 && Runtime::the().running()) {
+        flushes_done_.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    pending_.clear();
+}
+
+void StatisticalClassifier::enqueue(const Event& event) {
+    auto data = event.data.find("request_data");
+    if (event.correlation_id == INVALID_CORRELATION_ID || data == event.data.end() || !data->is_string()) return;
+
+    Pending pending{event.correlation_id, data->get<std::string>(), {}};
+    extract_context_features(event.data, pending.row);
+
+    bool post = false;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        if (!running_.load()) return;
+        pending_.push_back(std::move(pending));
+        if (!flush_posted_) {
+            flush_posted_ = true;
+            ++flushes_;
+            post = true;
+        }
+    }
+    if (post) {
+        Runtime::the().post([this]() { flush(); });
+    }
+}
+
+void StatisticalClassifier::flush() {
+    std::vector<Pending> batch;
+    {
+        std::lock_guard<std::mutex> lock(pending_mutex_);
+        batch.swap(pending_);
+        // Arrivals from here on post the next batch
+        flush_posted_ = false;
+    }
+
+    const size_t chunk = std::max<size_t>(1, MAX_BATCH());
+    std::vector<FeatureVector> rows(std::min(chunk, batch.size()));
+    std::vector<float> scores(rows.size());
+    for (size_t first = 0; first < batch.size(); first += chunk) {
+        size_t count = std::min(chunk, batch.size() - first);
+
+        auto started = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            Pending& pending = batch[first + i];
+            rows[i] = pending.row;
+            extract_request_features(pending.data.data(), pending.data.size(), rows[i]);
+        }
+        auto extracted = std::chrono::steady_clock::now();
+        model_->predict(rows.data(), count, scores.data());
+        model_ns_.add(elapsed_ns(extracted));
+        feature_ns_.add(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(extracted - started).count()));
+        batches_.increment();
+        rows_.add(count);
+
+        for (size_t i = 0; i < count; ++i) {
+            bool is_malicious = scores[i] >= THRESHOLD();
+            (is_malicious ? malicious_ : benign_).increment();
+            // No client_ip: this answers the request only, it is not a broadcast verdict
+            bus_.respond(BusEventType::REQUEST_CLASSIFIED, "statistical_classifier", batch[first + i].correlation_id, {
+                {"classification", is_malicious ? "malicious" : "benign"},
+                {"score", scores[i]},
+                {"classifier", "gbdt"}
+            });
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(pending_mutex_);
+    --flushes_;
+    flushes_done_.notify_all();
+}
+
+void StatisticalClassifier::collect_metrics(metrics::OpenMetricsWriter& writer) const {
+    using metrics::MetricType;
+    writer.family("heavengate_classifier_verdicts", MetricType::COUNTER, "Requests answered by the statistical classifier");
+    writer.counter("heavengate_classifier_verdicts", malicious_.value(), {{"classification", "malicious"}});
+    writer.counter("heavengate_classifier_verdicts", benign_.value(), {{"classification", "benign"}});
+    writer.family("heavengate_classifier_batches", MetricType::COUNTER, "Passes of the trees over queued requests");
+    writer.counter("heavengate_classifier_batches", batches_.value());
+    writer.family("heavengate_classifier_batch_rows", MetricType::COUNTER, "Requests scored in those passes");
+    writer.counter("heavengate_classifier_batch_rows", rows_.value());
+    writer.family("heavengate_classifier_feature_seconds", MetricType::COUNTER, "Time spent extracting features");
+    writer.float_counter("heavengate_classifier_feature_seconds", static_cast<double>(feature_ns_.value()) / 1e9);
+    writer.family("heavengate_classifier_model_seconds", MetricType::COUNTER, "Time spent evaluating the trees");
+    writer.float_counter("heavengate_classifier_model_seconds", static_cast<double>(model_ns_.value()) / 1e9);
+}
+
+} // namespace classifier
@@ -0,0 +1,99 @@
+/*
+ * Filename: d:\HeavenGate\src\Classifier\StatisticalClassifier.h
+ * Path: d:\HeavenGate\src\Classifier
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "GbdtModel.h"
+#include "RequestFeatures.h"
+#include "../DataBus/BusEvent.h"
+#include "../DataBus/subscriptionID.h"
+#include "../common/Confparcer.h"
+#include "../Metrics/OpenMetrics.h"
+#include "../Metrics/ShardedCounter.h"
+
+class DataBus;
+
+namespace classifier {
+
+// Answers REQUEST_FOR_CLASSIFICATION in process with the score of a GbdtModel,
+// next to or instead of an external classifier; the first answer to a request
+// wins. Requests are queued on the bus worker and scored on the Runtime in
+// batches of whatever arrived since the last one, so a burst of new
+// connections costs one pass of the trees instead of one per connection.
+class StatisticalClassifier {
+public:
+    // GbdtModel file, empty disables the classifier
+    static std::string MODEL_PATH() {
+        static std::string value = Confparcer::SETTING<std::string>("CLASSIFIER_MODEL", "");
+        return value;
+    }
+    // Scores at or above it are malicious
+    static double THRESHOLD() {
+        static double value = Confparcer::SETTING<double>("CLASSIFIER_THRESHOLD", 0.5);
+        return value;
+    }
+    // Rows scored per pass of the trees
+    static size_t MAX_BATCH() {
+        static size_t value = Confparcer::SETTING<size_t>("CLASSIFIER_MAX_BATCH", 256);
+        return value;
+    }
+
+    explicit StatisticalClassifier(DataBus& bus);
+    ~StatisticalClassifier();
+
+    StatisticalClassifier(const StatisticalClassifier&) = delete;
+    StatisticalClassifier& operator=(const StatisticalClassifier&) = delete;
+
+    // Returns false when disabled or when the model does not load
+    bool start();
+    // Waits for a batch being scored; call before the Runtime stops
+    void stop();
+    void collect_metrics(metrics::OpenMetricsWriter& writer) const;
+
+    const GbdtModel* model() const { return model_ ? &*model_ : nullptr; }
+
+private:
+    struct Pending {
+        uint64_t correlation_id;
+        std::string data;
+        // Context features filled, request ones by the batch
+        FeatureVector row;
+    };
+
+    DataBus& bus_;
+    std::optional<GbdtModel> model_;
+    SubscriptionId subscription_{0};
+    std::atomic<bool> running_{false};
+
+    std::mutex pending_mutex_;
+    std::vector<Pending> pending_;
+    bool flush_posted_{false};
+    // Batches posted or running; stop() waits for zero
+    size_t flushes_{0};
+    std::condition_variable flushes_done_;
+
+    metrics::ShardedCounter malicious_;
+    metrics::ShardedCounter benign_;
+    metrics::ShardedCounter batches_;
+    metrics::ShardedCounter rows_;
+    metrics::ShardedCounter feature_ns_;
+    metrics::ShardedCounter model_ns_;
+
+    void enqueue(const Event& event);
+    void flush();
+};
+
+} // namespace classifier
@@ -10,6 +10,8 @@
 #pragma once
 #include <string>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include "../../thirdparty/json.hpp"
 
 enum BusEventType {SERVICE_HEALTH_UPDATE,
@@ -21,11 +23,39 @@ enum BusEventType {SERVICE_HEALTH_UPDATE,
                     REQUEST_FOR_CLASSIFICATION
 
                 };
+
+constexpr size_t BUS_EVENT_TYPE_COUNT = REQUEST_FOR_CLASSIFICATION + 1;
+
+inline const char* bus_event_type_name(BusEventType type) {
+    switch (type) {
+        case SERVICE_HEALTH_UPDATE: return "SERVICE_HEALTH_UPDATE";
+        case REQUEST_CLASSIFIED: return "REQUEST_CLASSIFIED";
+        case REQUEST_PROCESSED: return "REQUEST_PROCESSED";
+        case SERVICE_REGISTERED: return "SERVICE_REGISTERED";
+        case REQUEST_ROUTED: return "REQUEST_ROUTED";
+        case NEW_CLIENT_CONNECTION: return "NEW_CLIENT_CONNECTION";
+        case REQUEST_FOR_CLASSIFICATION: return "REQUEST_FOR_CLASSIFICATION";
+    }
+    return "UNKNOWN";
+}
+
+// Interned publisher name, see DataBus::source_name()
+using SourceId = uint16_t;
+
+// Move-only envelope; DataBus recycles them through EventPool
 struct Event {
-    BusEventType type;
-    std::string source;
-    std::string id;
-    nlohmann::json data;
+    BusEventType type{SERVICE_HEALTH_UPDATE};
+    SourceId source{0};
+    uint64_t id{0};
+    // Non-zero for requests and for the responses answering them
+    uint64_t correlation_id{0};
+    bool is_request{false};
     std::chrono::system_clock::time_point timestamp;
-    std::string correlation_id;
+    nlohmann::json data;
+
+    Event() = default;
+    Event(Event&&) = default;
+    Event& operator=(Event&&) = default;
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
 };
\ No newline at end of file
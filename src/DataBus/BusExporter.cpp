@@ -0,0 +1,386 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\BusExporter.cpp
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "BusExporter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <sstream>
+
+#include "DataBus.h"
+#include "../common/generic.h"
+#include "../common/logger.h"
+
+#if ISLINUX
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+BusExporter::BusExporter(DataBus& bus)
+    : bus_(bus) {
+    std::stringstream stream(EVENTS());
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+
+        bool known = false;
+        for (size_t i = 0; i < BUS_EVENT_TYPE_COUNT; ++i) {
+            if (name == bus_event_type_name(static_cast<BusEventType>(i))) {
+                selected_[i] = true;
+                known = true;
+            }
+        }
+        if (!known && !name.empty()) {
+            LOG_WARN("Unknown event type in BUS_EXPORT_EVENTS: " + name);
+        }
+    }
+}
+
+BusExporter::~BusExporter() {
+    stop();
+}
+
+bool BusExporter::start() {
+#if ISLINUX
+    if (running_.load()) return true;
+    if (std::find(selected_.begin(), selected_.end(), true) == selected_.end()) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(export_mutex_);
+        bool ring = open_ring();
+        bool socket = !SOCKET_PATH().empty() && open_socket();
+        if (!ring && !socket) return false;
+    }
+
+    running_ = true;
+    if (listen_fd_ >= 0) {
+        accept_thread_ = std::thread(&BusExporter::accept_loop, this);
+    }
+
+    for (size_t i = 0; i < BUS_EVENT_TYPE_COUNT; ++i) {
+        if (!selected_[i]) continue;
+        SubscribeOptions options;
+        options.mode = DeliveryMode::INLINE;
+        options.name = "bus_exporter";
+        subscriptions_.push_back(bus_.subscribe(static_cast<BusEventType>(i), [this](const Event& event) {
+            export_event(event);
+        }, options));
+    }
+    LOG_INFO("Bus exporter started on " + SHM_NAME() +
+             (SOCKET_PATH().empty() ? std::string() : " and " + SOCKET_PATH()));
+    return true;
+#else
+    LOG_WARN("Bus exporter is only supported on Linux");
+    return false;
+#endif
+}
+
+void BusExporter::stop() {
+    if (!running_.exchange(false)) return;
+
+    for (auto id : subscriptions_) {
+        bus_.unsubscribe(id);
+    }
+    subscriptions_.clear();
+
+    if (accept_thread_.joinable()) {
+        accept_thread_.join();
+    }
+
+    // An inline callback may still be running, the lock waits for it
+    std::lock_guard<std::mutex> lock(export_mutex_);
+    close_ring();
+    close_socket();
+}
+
+void BusExporter::export_event(const Event& event) {
+    std::lock_guard<std::mutex> lock(export_mutex_);
+    if (header_ == nullptr && client_count_.load() == 0) return;
+
+    const std::string& source = bus_.source_name(event.source);
+
+    frame_.resize(sizeof(busring::FrameHeader));
+    frame_.insert(frame_.end(), source.begin(), source.end());
+    nlohmann::json::to_cbor(event.data, frame_);
+
+    size_t payload_size = frame_.size() - sizeof(busring::FrameHeader) - source.size();
+    size_t used = frame_.size();
+    size_t length = busring::frame_length(source.size(), payload_size);
+    bool to_ring = header_ != nullptr && length <= capacity_ / 4;
+    bool to_clients = client_count_.load() != 0 && used <= busring::SocketReader::MAX_FRAME;
+    if (!to_ring && !to_clients) {
+        frames_oversized++;
+        return;
+    }
+    frame_.resize(length);
+
+    busring::FrameHeader header{};
+    header.length = static_cast<uint32_t>(length);
+    header.type = static_cast<uint16_t>(event.type);
+    header.source_size = static_cast<uint16_t>(source.size());
+    header.payload_size = static_cast<uint32_t>(payload_size);
+    header.sequence = ++sequence_;
+    header.id = event.id;
+    header.correlation_id = event.correlation_id;
+    header.timestamp_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        event.timestamp.time_since_epoch()).count();
+    std::memcpy(frame_.data(), &header, sizeof(header));
+
+    if (to_ring) {
+        write_ring(frame_.data(), length);
+    }
+    if (to_clients) {
+        send_clients(frame_.data(), used);
+    }
+    frames_exported++;
+    bytes_exported += length;
+}
+
+void BusExporter::write_ring(const uint8_t* frame, size_t length) {
+    uint64_t position = header_->tail.load(std::memory_order_relaxed);
+    size_t offset = static_cast<size_t>(position & (capacity_ - 1));
+    size_t remaining = static_cast<size_t>(capacity_) - offset;
+
+    if (length > remaining) {
+        // Frames never wrap: fill the end of the buffer and start over at offset 0
+        header_->tail_intent.store(position + remaining + length, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        busring::FrameHeader padding{};
+        padding.length = static_cast<uint32_t>(remaining);
+        padding.type = busring::PADDING_TYPE;
+        std::memcpy(data_ + offset, &padding, sizeof(padding));
+        position += remaining;
+        offset = 0;
+    } else {
+        header_->tail_intent.store(position + length, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    std::memcpy(data_ + offset, frame, length);
+    header_->tail.store(position + length, std::memory_order_release);
+    header_->latest.store(position, std::memory_order_release);
+}
+
+void BusExporter::send_clients(const uint8_t* frame, size_t length) {
+#if ISLINUX
+    size_t slow_limit = SLOW_LIMIT();
+    for (auto it = clients_.begin(); it != clients_.end();) {
+        ssize_t sent = ::send(it->fd, frame, length, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent >= 0) {
+            it->consecutive_drops = 0;
+            ++it;
+            continue;
+        }
+        if ((errno == EAGAIN || errno == EWOULDBLOCK) && ++it->consecutive_drops <= slow_limit) {
+            socket_frames_dropped++;
+            ++it;
+            continue;
+        }
+
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            socket_clients_dropped++;
+            LOG_WARN("Bus exporter disconnected a slow socket reader");
+        }
+        ::close(it->fd);
+        it = clients_.erase(it);
+        client_count_ = clients_.size();
+    }
+#else
+    (void)frame;
+    (void)length;
+#endif
+}
+
+#if ISLINUX
+namespace {
+
+// True when the ring named `name` was closed or its producer has exited; `owner`
+// says who holds it otherwise. A segment that is not a bus ring is never stale.
+bool ring_is_stale(const std::string& name, std::string& owner) {
+    int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        // Unlinked since, nothing to take over
+        return errno == ENOENT;
+    }
+    busring::RingHeader header;
+    ssize_t got = ::pread(fd, &header, sizeof(header), 0);
+    ::close(fd);
+    if (got != static_cast<ssize_t>(sizeof(header)) || header.magic != busring::MAGIC) {
+        owner = "another program or a producer still starting";
+        return false;
+    }
+    if (header.state.load(std::memory_order_acquire) == busring::RING_CLOSED) return true;
+
+    pid_t pid = static_cast<pid_t>(header.producer_pid);
+    // EPERM: alive, under another user
+    if (pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM)) {
+        owner = "process " + std::to_string(pid);
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+#endif
+
+bool BusExporter::open_ring() {
+#if ISLINUX
+    std::string name = SHM_NAME();
+    uint64_t capacity = 1;
+    while (capacity < std::max<size_t>(RING_MB(), 1) * 1024 * 1024) capacity <<= 1;
+
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        // Replaces only a ring whose producer is gone, readers still mapping it
+        // stop seeing new frames and should reopen after a quiet period
+        std::string owner;
+        if (!ring_is_stale(name, owner)) {
+            LOG_ERROR("Bus export ring " + name + " is in use by " + owner +
+                      ", set BUS_EXPORT_SHM to another name");
+            return false;
+        }
+        ::shm_unlink(name.c_str());
+        fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    }
+    if (fd < 0) {
+        LOG_ERROR("Cannot create bus export ring " + name + ": " + std::strerror(errno));
+        return false;
+    }
+
+    size_t size = busring::data_offset() + static_cast<size_t>(capacity);
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        LOG_ERROR("Cannot size bus export ring " + name + ": " + std::strerror(errno));
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Cannot map bus export ring " + name + ": " + std::strerror(errno));
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+
+    map_ = static_cast<uint8_t*>(map);
+    map_size_ = size;
+    header_ = new (map_) busring::RingHeader{};
+    header_->magic = busring::MAGIC;
+    header_->version = busring::VERSION;
+    header_->header_size = sizeof(busring::RingHeader);
+    header_->capacity = capacity;
+    header_->producer_pid = static_cast<uint64_t>(::getpid());
+    data_ = map_ + busring::data_offset();
+    capacity_ = capacity;
+    header_->state.store(busring::RING_ACTIVE, std::memory_order_release);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BusExporter::close_ring() {
+#if ISLINUX
+    if (map_ == nullptr) return;
+
+    header_->state.store(busring::RING_CLOSED, std::memory_order_release);
+    munmap(map_, map_size_);
+    ::shm_unlink(SHM_NAME().c_str());
+    map_ = nullptr;
+    header_ = nullptr;
+    data_ = nullptr;
+#endif
+}
+
+bool BusExporter::open_socket() {
+#if ISLINUX
+    std::string path = SOCKET_PATH();
+    sockaddr_un address{};
+    if (path.size() >= sizeof(address.sun_path)) {
+        LOG_ERROR("BUS_EXPORT_SOCKET path is too long: " + path);
+        return false;
+    }
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    listen_fd_ = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR("Cannot create bus export socket: " + std::string(std::strerror(errno)));
+        return false;
+    }
+    ::unlink(path.c_str());
+    if (::bind(listen_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listen_fd_, 16) != 0) {
+        LOG_ERROR("Cannot listen on bus export socket " + path + ": " + std::strerror(errno));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void BusExporter::close_socket() {
+#if ISLINUX
+    for (const auto& client : clients_) {
+        ::close(client.fd);
+    }
+    clients_.clear();
+    client_count_ = 0;
+
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        ::unlink(SOCKET_PATH().c_str());
+        listen_fd_ = -1;
+    }
+#endif
+}
+
+void BusExporter::accept_loop() {
+#if ISLINUX
+    while (running_.load()) {
+        pollfd listener{listen_fd_, POLLIN, 0};
+        int ready = ::poll(&listener, 1, 200);
+        if (ready <= 0) continue;
+
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) continue;
+
+        std::lock_guard<std::mutex> lock(export_mutex_);
+        clients_.push_back(SocketClient{fd});
+        client_count_ = clients_.size();
+    }
+#endif
+}
+
+void BusExporter::collect_metrics(metrics::OpenMetricsWriter& writer) const {
+    using metrics::MetricType;
+    writer.family("heavengate_bus_export_frames", MetricType::COUNTER, "Events exported to external readers");
+    writer.counter("heavengate_bus_export_frames", frames_exported.load());
+    writer.family("heavengate_bus_export_bytes", MetricType::COUNTER, "Bytes of exported frames");
+    writer.counter("heavengate_bus_export_bytes", bytes_exported.load());
+    writer.family("heavengate_bus_export_oversized", MetricType::COUNTER, "Events too large to export");
+    writer.counter("heavengate_bus_export_oversized", frames_oversized.load());
+    writer.family("heavengate_bus_export_socket_clients", MetricType::GAUGE, "Connected socket readers");
+    writer.gauge("heavengate_bus_export_socket_clients", static_cast<double>(client_count_.load()));
+    writer.family("heavengate_bus_export_socket_dropped", MetricType::COUNTER, "Frames a slow socket reader missed");
+    writer.counter("heavengate_bus_export_socket_dropped", socket_frames_dropped.load());
+    writer.family("heavengate_bus_export_socket_disconnects", MetricType::COUNTER, "Socket readers disconnected for being slow");
+    writer.counter("heavengate_bus_export_socket_disconnects", socket_clients_dropped.load());
+}
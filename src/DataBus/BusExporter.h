@@ -0,0 +1,109 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\BusExporter.h
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../include/busRing.h"
+#include "BusEvent.h"
+#include "subscriptionID.h"
+#include "../common/Confparcer.h"
+#include "../Metrics/OpenMetrics.h"
+
+class DataBus;
+
+// Exports selected bus events to other processes, see include/busRing.h for the
+// format and the consumer side. Frames go to a shared-memory broadcast ring and,
+// when BUS_EXPORT_SOCKET is set, to Unix SEQPACKET clients. Nothing here waits
+// on a reader: the ring overwrites, and a socket client whose buffer is full
+// misses frames and is disconnected after BUS_EXPORT_SLOW_LIMIT in a row.
+class BusExporter {
+public:
+    // Comma-separated BusEventType names, empty disables the exporter
+    static std::string EVENTS() {
+        static std::string value = Confparcer::SETTING<std::string>("BUS_EXPORT_EVENTS", "");
+        return value;
+    }
+    static std::string SHM_NAME() {
+        static std::string value = Confparcer::SETTING<std::string>("BUS_EXPORT_SHM", "/heavengate-bus");
+        return value;
+    }
+    static size_t RING_MB() {
+        static size_t value = Confparcer::SETTING<size_t>("BUS_EXPORT_RING_MB", 16);
+        return value;
+    }
+    static std::string SOCKET_PATH() {
+        static std::string value = Confparcer::SETTING<std::string>("BUS_EXPORT_SOCKET", "");
+        return value;
+    }
+    static size_t SLOW_LIMIT() {
+        static size_t value = Confparcer::SETTING<size_t>("BUS_EXPORT_SLOW_LIMIT", 256);
+        return value;
+    }
+
+    explicit BusExporter(DataBus& bus);
+    ~BusExporter();
+
+    BusExporter(const BusExporter&) = delete;
+    BusExporter& operator=(const BusExporter&) = delete;
+
+    // Returns false when disabled or when neither transport could be opened
+    bool start();
+    void stop();
+    void collect_metrics(metrics::OpenMetricsWriter& writer) const;
+
+    std::atomic<uint64_t> frames_exported{0};
+    std::atomic<uint64_t> bytes_exported{0};
+    std::atomic<uint64_t> frames_oversized{0};
+    std::atomic<uint64_t> socket_frames_dropped{0};
+    std::atomic<uint64_t> socket_clients_dropped{0};
+
+private:
+    struct SocketClient {
+        int fd;
+        size_t consecutive_drops{0};
+    };
+
+    DataBus& bus_;
+    std::array<bool, BUS_EVENT_TYPE_COUNT> selected_{};
+    std::vector<SubscriptionId> subscriptions_;
+
+    // Guards everything below against stop(); only the bus worker exports,
+    // so the ring keeps a single producer
+    mutable std::mutex export_mutex_;
+    uint8_t* map_{nullptr};
+    size_t map_size_{0};
+    busring::RingHeader* header_{nullptr};
+    uint8_t* data_{nullptr};
+    uint64_t capacity_{0};
+    uint64_t sequence_{0};
+    std::vector<uint8_t> frame_;
+
+    int listen_fd_{-1};
+    std::vector<SocketClient> clients_;
+    std::atomic<size_t> client_count_{0};
+    std::atomic<bool> running_{false};
+    std::thread accept_thread_;
+
+    void export_event(const Event& event);
+    void write_ring(const uint8_t* frame, size_t length);
+    void send_clients(const uint8_t* frame, size_t length);
+    bool open_ring();
+    void close_ring();
+    bool open_socket();
+    void close_socket();
+    void accept_loop();
+};
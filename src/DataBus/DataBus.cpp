@@ -9,87 +9,244 @@
 
 #include "DataBus.h"
 #include "../common/logger.h"
+#include "../Runtime/Runtime.h"
 
 DataBus& DataBus::instance() {
     static DataBus instance;
     return instance;
 }
 
-void DataBus::publish(BusEventType type, const std::string& source, const nlohmann::json& data) {
-    Event event;
-    event.type = type;
-    event.source = source;
-    event.data = data;
-    event.timestamp = std::chrono::system_clock::now();
-    event.id = generate_event_id();
+DataBus::DataBus()
+    : requestor_source_(sources_.intern("requestor")) {
+    for (size_t i = 0; i < BUS_EVENT_TYPE_COUNT; ++i) {
+        auto type = static_cast<BusEventType>(i);
+        lanes_[i] = std::make_unique<EventLane>(type, LaneConfig::from_setting(type, MAX_QUEUE_SIZE));
+        dispatch_order_[i] = type;
+    }
+    std::stable_sort(dispatch_order_.begin(), dispatch_order_.end(), [this](BusEventType a, BusEventType b) {
+        return lanes_[a]->config().priority > lanes_[b]->config().priority;
+    });
+
+    for (auto& table : subscribers_) {
+        table = std::make_shared<const SubscriberTable>();
+    }
+
+    if (!EventJournal::DIR().empty()) {
+        journal_ = std::make_unique<EventJournal>(EventJournal::DIR(), EventJournal::EVENTS());
+    }
+}
+
+void DataBus::publish(BusEventType type, const std::string& source, nlohmann::json data) {
+    publish(type, sources_.intern(source), std::move(data));
+}
+
+void DataBus::publish(BusEventType type, SourceId source, nlohmann::json data) {
+    EventPool::Ref event = event_pool_.acquire();
+    event->type = type;
+    event->source = source;
+    event->data = std::move(data);
+    enqueue(std::move(event));
+}
+
+TaskId DataBus::publish_after(std::chrono::steady_clock::duration delay, BusEventType type,
+                              const std::string& source, nlohmann::json data) {
+    SourceId source_id = sources_.intern(source);
+    return Scheduler::the().schedule_once(delay, [this, type, source_id, data = std::move(data)]() mutable {
+        publish(type, source_id, std::move(data));
+    });
+}
 
+void DataBus::enqueue(EventPool::Ref event, bool journal) {
+    BusEventType type = event->type;
+    event->id = next_event_id_++;
+    event->timestamp = std::chrono::system_clock::now();
+
+    // Journaled before the lane push so events the lanes drop are still on record
+    if (journal && journal_ && journal_->wants(type)) {
+        journal_->append(event, sources_.name(event->source));
+    }
+
+    EventPool::Ref displaced;
+    EventLane::PushResult result;
     {
-        std::lock_guard<std::mutex> lock(events_mutex_);
-        events_queue_.push(event);
-        LOG_INFO("Event pushed to the bus by " + source);
-        metrics_.queue_size = events_queue_.size();
-
-        if(metrics_.queue_size >= MAX_QUEUE_SIZE){
-            events_queue_.pop();
-            metrics_.queue_overflow++;
-            LOG_WARN("Queue overflow");
+        std::unique_lock<std::mutex> lock(events_mutex_);
+        EventLane& lane = *lanes_[type];
+
+        // The worker cannot wait for itself to drain a lane, it overfills instead
+        if (lane.config().policy == OverflowPolicy::BLOCK && lane.full() &&
+            std::this_thread::get_id() != worker_id_.load()) {
+            lane.metrics().blocked++;
+            space_cv_.wait(lock, [this, &lane]() {
+                return !lane.full() || !running_.load();
+            });
         }
-    }
-    events_cv_.notify_one();
 
+        result = lane.push(event, displaced);
+
+        switch (result) {
+            case EventLane::PushResult::QUEUED:
+                ++queued_events_;
+                break;
+            case EventLane::PushResult::COALESCED:
+                break;
+            case EventLane::PushResult::EVICTED_OLDEST:
+            case EventLane::PushResult::DROPPED:
+                metrics_.queue_overflow++;
+                metrics_.events_dropped++;
+                if (lane.report_overflow()) {
+                    LOG_WARN(std::string("Queue overflow on lane ") + bus_event_type_name(type));
+                }
+                break;
+            case EventLane::PushResult::SAMPLED_OUT:
+                metrics_.events_dropped++;
+                break;
+        }
+        metrics_.queue_size = queued_events_;
+    }
     metrics_.events_published++;
+
+    switch (result) {
+        case EventLane::PushResult::QUEUED:
+            events_cv_.notify_one();
+            break;
+        case EventLane::PushResult::COALESCED:
+        case EventLane::PushResult::EVICTED_OLDEST:
+            events_cv_.notify_one();
+            fail_lost_request(*displaced);
+            break;
+        case EventLane::PushResult::DROPPED:
+        case EventLane::PushResult::SAMPLED_OUT:
+            fail_lost_request(*event);
+            break;
+    }
 }
 
-SubscriptionId DataBus::subscribe(BusEventType type, EventCallback callback) {
+SubscriptionId DataBus::subscribe(BusEventType type, EventCallback callback, SubscribeOptions options) {
     SubscriptionId id = next_subscription_id_++;
+    if (options.mode == DeliveryMode::EXECUTOR && !options.executor) {
+        options.executor = Runtime::the().executor();
+    }
+    auto subscriber = std::make_shared<Subscriber>(id, type, std::move(callback), std::move(options),
+                                                   metrics_.handler_errors);
+    subscriber->start();
 
     {
         std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-        subscriptions_[type].push_back({id, callback});
+        auto updated = std::make_shared<SubscriberTable>(*std::atomic_load(&subscribers_[type]));
+        updated->add(subscriber);
+        std::atomic_store(&subscribers_[type], std::shared_ptr<const SubscriberTable>(std::move(updated)));
     }
 
     return id;
 }
 
 void DataBus::unsubscribe(SubscriptionId id) {
-    std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-
-    for (auto& [type, subscribers] : subscriptions_) {
-        subscribers.erase(
-            std::remove_if(subscribers.begin(), subscribers.end(),
-                           [id](const auto& sub) { return sub.id == id; }),
-                          subscribers.end()
-        );
+    Subscriber::Ptr removed;
+
+    {
+        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
+        for (auto& table : subscribers_) {
+            auto current = std::atomic_load(&table);
+            auto it = std::find_if(current->all.begin(), current->all.end(),
+                                   [id](const auto& sub) { return sub->id() == id; });
+            if (it == current->all.end()) continue;
+
+            removed = *it;
+            auto updated = std::make_shared<SubscriberTable>();
+            for (const auto& subscriber : current->all) {
+                if (subscriber != removed) updated->add(subscriber);
+            }
+            std::atomic_store(&table, std::shared_ptr<const SubscriberTable>(std::move(updated)));
+            break;
+        }
+    }
+
+    // Outside the lock: joining a DEDICATED thread may wait for a slow handler
+    if (removed) {
+        removed->stop();
     }
 }
 
-nlohmann::json DataBus::request(BusEventType type, const nlohmann::json& data,
+nlohmann::json DataBus::request(BusEventType type, nlohmann::json data,
                                 std::chrono::milliseconds timeout) {
-    std::string correlation_id = generate_correlation_id();
-    auto response_future = setup_response_waiter(correlation_id);
+    // Responses and timeouts are both delivered by the worker, it cannot wait on itself
+    if (std::this_thread::get_id() == worker_id_.load()) {
+        throw std::logic_error("DataBus::request called from a bus handler");
+    }
 
-    publish(type, "requestor", {
-        {"data", data},
-        {"correlation_id", correlation_id},
-        {"is_request", true}
-    });
-    
+    auto response = std::make_shared<std::promise<nlohmann::json>>();
+    auto response_future = response->get_future();
 
-    if (response_future.wait_for(timeout) == std::future_status::ready) {
-        return response_future.get();
-    }
+    request_async(type, std::move(data), [response](RequestStatus status, const nlohmann::json& payload) {
+        if (status == RequestStatus::OK) {
+            response->set_value(payload);
+        } else if (status == RequestStatus::TIMEOUT) {
+            response->set_exception(std::make_exception_ptr(std::runtime_error("Request timeout")));
+        } else {
+            response->set_exception(std::make_exception_ptr(std::runtime_error("DataBus stopped")));
+        }
+    }, timeout);
+
+    return response_future.get();
+}
 
+CorrelationId DataBus::request_async(BusEventType type, nlohmann::json data, ResponseCallback callback,
+                                     std::chrono::milliseconds timeout) {
+    CorrelationId correlation_id = next_correlation_id_++;
     {
-        std::lock_guard<std::mutex> lock(requests_mutex_);
-        pending_requests_.erase(correlation_id);
+        std::unique_lock<std::mutex> lock(requests_mutex_);
+        // Checked under the lock: cleanup() runs after running_ drops and takes it too
+        if (!running_.load()) {
+            lock.unlock();
+            callback(RequestStatus::CANCELLED, nlohmann::json());
+            return INVALID_CORRELATION_ID;
+        }
+
+        PendingRequest pending;
+        pending.callback = std::move(callback);
+        pending.timer = request_timeouts_.schedule(std::chrono::steady_clock::now() + timeout, correlation_id);
+        pending_requests_.insert(correlation_id, std::move(pending));
+        metrics_.requests_pending = pending_requests_.size();
     }
 
-    throw std::runtime_error("Request timeout");
-                                }
+    // enqueue() wakes the worker, which then re-reads the earliest deadline
+    EventPool::Ref event = event_pool_.acquire();
+    event->type = type;
+    event->source = requestor_source_;
+    event->correlation_id = correlation_id;
+    event->is_request = true;
+    event->data = std::move(data);
+    enqueue(std::move(event));
+
+    return correlation_id;
+}
+
+bool DataBus::cancel_request(CorrelationId correlation_id) {
+    std::lock_guard<std::mutex> lock(requests_mutex_);
+    PendingRequest pending;
+    if (!pending_requests_.take(correlation_id, pending)) return false;
+
+    request_timeouts_.cancel(pending.timer);
+    metrics_.requests_pending = pending_requests_.size();
+    return true;
+}
+
+void DataBus::respond(BusEventType type, const std::string& source, CorrelationId correlation_id, nlohmann::json data) {
+    EventPool::Ref event = event_pool_.acquire();
+    event->type = type;
+    event->source = sources_.intern(source);
+    event->correlation_id = correlation_id;
+    event->data = std::move(data);
+    enqueue(std::move(event));
+}
 
                                 void DataBus::start() {
                                     if (running_.exchange(true)) return;
 
+                                    // A journal that fails to start logs why and ignores appends
+                                    if (journal_) {
+                                        journal_->start();
+                                    }
                                     worker_thread_ = std::thread(&DataBus::process_events, this);
                                     LOG_INFO("Bus worker started");
                                 }
@@ -97,44 +254,187 @@ nlohmann::json DataBus::request(BusEventType type, const nlohmann::json& data,
                                 void DataBus::stop() {
                                     if (!running_.exchange(false)) return;
 
+                                    {
+                                        // Taking the lock orders the flag flip before any waiter re-checks it
+                                        std::lock_guard<std::mutex> lock(events_mutex_);
+                                    }
                                     events_cv_.notify_all();
+                                    space_cv_.notify_all();
 
                                     if (worker_thread_.joinable()) {
                                         worker_thread_.join();
                                     }
+                                    if (journal_) {
+                                        journal_->stop();
+                                    }
                                     LOG_INFO("Bus worker stopped");
                                 }
 
+                                size_t DataBus::replay_journal(std::chrono::system_clock::time_point from,
+                                                               std::chrono::system_clock::time_point to) {
+                                    if (EventJournal::DIR().empty()) return 0;
+
+                                    return EventJournal::read(EventJournal::DIR(), from, to, [this](EventJournal::Record&& record) {
+                                        EventPool::Ref event = event_pool_.acquire();
+                                        event->type = record.type;
+                                        event->source = sources_.intern(record.source);
+                                        // Correlation ids are dropped: replayed responses go to subscribers, not to live requests
+                                        event->data = std::move(record.data);
+                                        enqueue(std::move(event), false);
+                                    });
+                                }
+
                                 DataBusMetricsSnapshot DataBus::get_metrics() const {
-                                    size_t queue_size;
-                                    {
-                                        std::lock_guard<std::mutex> lock(events_mutex_);
-                                        queue_size = events_queue_.size();
-                                    }
+                                    // queue_size is kept up to date by publish() and the worker,
+                                    // reading it avoids contending with publishers on events_mutex_
+                                    return DataBusMetricsSnapshot(metrics_, metrics_.queue_size.load());
+                                }
 
-                                    return DataBusMetricsSnapshot(metrics_, queue_size);
+                                void DataBus::collect_metrics(metrics::OpenMetricsWriter& writer) const {
+                                    using metrics::MetricType;
+                                    auto lane_labels = [](const EventLane& lane) {
+                                        return metrics::Labels{{"lane", bus_event_type_name(lane.type())}};
+                                    };
+                                    auto snapshot = get_metrics();
+
+                                    writer.family("heavengate_bus_events_published", MetricType::COUNTER, "Events published to the bus");
+                                    writer.counter("heavengate_bus_events_published", snapshot.events_published);
+                                    writer.family("heavengate_bus_events_processed", MetricType::COUNTER, "Events dispatched to subscribers");
+                                    writer.counter("heavengate_bus_events_processed", snapshot.events_processed);
+                                    writer.family("heavengate_bus_events_dropped", MetricType::COUNTER, "Events dropped by the bus");
+                                    writer.counter("heavengate_bus_events_dropped", snapshot.events_dropped);
+                                    writer.family("heavengate_bus_handler_errors", MetricType::COUNTER, "Subscriber callbacks that threw");
+                                    writer.counter("heavengate_bus_handler_errors", snapshot.handler_errors);
+                                    writer.family("heavengate_bus_queue_overflow", MetricType::COUNTER, "Events evicted on queue overflow");
+                                    writer.counter("heavengate_bus_queue_overflow", snapshot.queue_overflow);
+                                    writer.family("heavengate_bus_queue_size", MetricType::GAUGE, "Events waiting for dispatch");
+                                    writer.gauge("heavengate_bus_queue_size", static_cast<double>(snapshot.queue_size));
+                                    struct LaneCounter {
+                                        const char* name;
+                                        const char* help;
+                                        std::atomic<uint64_t> LaneMetrics::*value;
+                                    };
+                                    static const LaneCounter lane_counters[] = {
+                                        {"heavengate_bus_lane_published", "Events published per lane", &LaneMetrics::published},
+                                        {"heavengate_bus_lane_dispatched", "Events dispatched per lane", &LaneMetrics::dispatched},
+                                        {"heavengate_bus_lane_dropped", "Events dropped by the lane overflow policy", &LaneMetrics::dropped},
+                                        {"heavengate_bus_lane_coalesced", "Events replaced by a newer one with the same key", &LaneMetrics::coalesced},
+                                        {"heavengate_bus_lane_sampled_out", "Events skipped by lane sampling", &LaneMetrics::sampled_out},
+                                        {"heavengate_bus_lane_blocked", "Publishers that waited for room in a lane", &LaneMetrics::blocked},
+                                    };
+                                    for (const auto& counter : lane_counters) {
+                                        writer.family(counter.name, MetricType::COUNTER, counter.help);
+                                        for (const auto& lane : lanes_) {
+                                            writer.counter(counter.name, (lane->metrics().*counter.value).load(), lane_labels(*lane));
+                                        }
+                                    }
+                                    writer.family("heavengate_bus_lane_depth", MetricType::GAUGE, "Events queued per lane");
+                                    for (const auto& lane : lanes_) {
+                                        writer.gauge("heavengate_bus_lane_depth", static_cast<double>(lane->metrics().depth.load()), lane_labels(*lane));
+                                    }
+                                    std::vector<Subscriber::Ptr> subscribers;
+                                    for (const auto& table : subscribers_) {
+                                        auto current = std::atomic_load(&table);
+                                        subscribers.insert(subscribers.end(), current->all.begin(), current->all.end());
+                                    }
+                                    auto subscriber_labels = [](const Subscriber& subscriber) {
+                                        return metrics::Labels{{"lane", bus_event_type_name(subscriber.type())}, {"subscriber", subscriber.name()}};
+                                    };
+                                    struct SubscriberCounter {
+                                        const char* name;
+                                        const char* help;
+                                        std::atomic<uint64_t> Subscriber::*value;
+                                    };
+                                    static const SubscriberCounter subscriber_counters[] = {
+                                        {"heavengate_bus_subscriber_delivered", "Events handled per subscriber", &Subscriber::delivered},
+                                        {"heavengate_bus_subscriber_dropped", "Events evicted from a full subscriber queue", &Subscriber::dropped},
+                                        {"heavengate_bus_subscriber_errors", "Subscriber handler exceptions", &Subscriber::errors},
+                                    };
+                                    for (const auto& counter : subscriber_counters) {
+                                        writer.family(counter.name, MetricType::COUNTER, counter.help);
+                                        for (const auto& subscriber : subscribers) {
+                                            writer.counter(counter.name, ((*subscriber).*counter.value).load(), subscriber_labels(*subscriber));
+                                        }
+                                    }
+                                    writer.family("heavengate_bus_subscriber_lag_seconds", MetricType::SUMMARY, "Event publish to handler start");
+                                    for (const auto& subscriber : subscribers) {
+                                        writer.summary("heavengate_bus_subscriber_lag_seconds", subscriber->lag.snapshot(), subscriber_labels(*subscriber));
+                                    }
+                                    writer.family("heavengate_bus_subscriber_handler_seconds", MetricType::SUMMARY, "Subscriber handler run time");
+                                    for (const auto& subscriber : subscribers) {
+                                        writer.summary("heavengate_bus_subscriber_handler_seconds", subscriber->handler_time.snapshot(), subscriber_labels(*subscriber));
+                                    }
+                                    writer.family("heavengate_bus_requests_pending", MetricType::GAUGE, "Requests waiting for a response");
+                                    writer.gauge("heavengate_bus_requests_pending", static_cast<double>(snapshot.requests_pending));
+                                    writer.family("heavengate_bus_requests_completed", MetricType::COUNTER, "Requests answered before their deadline");
+                                    writer.counter("heavengate_bus_requests_completed", snapshot.requests_completed);
+                                    writer.family("heavengate_bus_requests_timed_out", MetricType::COUNTER, "Requests expired by the timer wheel");
+                                    writer.counter("heavengate_bus_requests_timed_out", snapshot.requests_timed_out);
+                                    if (journal_) {
+                                        writer.family("heavengate_bus_journal_records", MetricType::COUNTER, "Events written to the journal");
+                                        writer.counter("heavengate_bus_journal_records", journal_->records_written.load());
+                                        writer.family("heavengate_bus_journal_bytes", MetricType::COUNTER, "Bytes written to journal segments");
+                                        writer.counter("heavengate_bus_journal_bytes", journal_->bytes_written.load());
+                                        writer.family("heavengate_bus_journal_dropped", MetricType::COUNTER, "Events the journal could not record");
+                                        writer.counter("heavengate_bus_journal_dropped", journal_->records_dropped.load());
+                                        writer.family("heavengate_bus_journal_segments_rotated", MetricType::COUNTER, "Journal segment rotations");
+                                        writer.counter("heavengate_bus_journal_segments_rotated", journal_->segments_rotated.load());
+                                        writer.family("heavengate_bus_journal_commit_seconds", MetricType::SUMMARY, "Journal group commit (msync) time");
+                                        writer.summary("heavengate_bus_journal_commit_seconds", journal_->commit_latency.snapshot());
+                                    }
                                 }
 
                                 DataBus::~DataBus() {
                                     stop();
+
+                                    for (auto& table : subscribers_) {
+                                        for (const auto& subscriber : std::atomic_load(&table)->all) {
+                                            subscriber->stop();
+                                        }
+                                    }
                                 }
 
                                 void DataBus::process_events() {
+                                    worker_id_ = std::this_thread::get_id();
+
                                     while (running_.load()) {
-                                        Event event;
+                                        expire_requests(std::chrono::steady_clock::now());
+
+                                        EventPool::Ref event;
+                                        bool space_freed = false;
 
                                         {
                                             std::unique_lock<std::mutex> lock(events_mutex_);
-                                            events_cv_.wait(lock, [this]() {
-                                                return !events_queue_.empty() || !running_.load();
-                                            });
+                                            auto ready = [this]() {
+                                                return queued_events_ > 0 || !running_.load();
+                                            };
+
+                                            // Sleep until the next event or the earliest request timeout
+                                            auto deadline = next_request_deadline();
+                                            if (deadline == std::chrono::steady_clock::time_point::max()) {
+                                                events_cv_.wait(lock, ready);
+                                            } else if (!events_cv_.wait_until(lock, deadline, ready)) {
+                                                continue;
+                                            }
 
                                             if (!running_.load()) break;
-                                            if (events_queue_.empty()) continue;
+                                            if (queued_events_ == 0) continue;
+
+                                            // Strict priority: telemetry lanes only run when control lanes are empty
+                                            for (BusEventType type : dispatch_order_) {
+                                                EventLane& lane = *lanes_[type];
+                                                if (lane.pop(event)) {
+                                                    lane.metrics().dispatched++;
+                                                    space_freed = lane.config().policy == OverflowPolicy::BLOCK;
+                                                    break;
+                                                }
+                                            }
+                                            --queued_events_;
+                                            metrics_.queue_size = queued_events_;
+                                        }
 
-                                            event = events_queue_.front();
-                                            events_queue_.pop();
-                                            metrics_.queue_size = events_queue_.size();
+                                        if (space_freed) {
+                                            space_cv_.notify_all();
                                         }
 
                                         handle_event(event);
@@ -144,67 +444,110 @@ nlohmann::json DataBus::request(BusEventType type, const nlohmann::json& data,
                                     cleanup();
                                 }
 
-                                void DataBus::handle_event(const Event& event) {
-                                    std::vector<Subscriber> subscribers;
+                                void DataBus::handle_event(const Subscriber::EventPtr& event) {
+                                    // Responses complete their request and are not broadcast
+                                    if (event->correlation_id != INVALID_CORRELATION_ID && !event->is_request) {
+                                        complete_request(event->correlation_id, event->data);
+                                        return;
+                                    }
+
+                                    std::atomic_load(&subscribers_[event->type])->dispatch(event);
+                                }
 
+                                void DataBus::complete_request(CorrelationId correlation_id, const nlohmann::json& response) {
+                                    PendingRequest pending;
                                     {
-                                        std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-                                        auto it = subscriptions_.find(event.type);
-                                        if (it != subscriptions_.end()) {
-                                            subscribers = it->second;
-                                        }
+                                        std::lock_guard<std::mutex> lock(requests_mutex_);
+                                        if (!pending_requests_.take(correlation_id, pending)) return;
+                                        request_timeouts_.cancel(pending.timer);
+                                        metrics_.requests_pending = pending_requests_.size();
                                     }
 
-                                    if (event.data.contains("is_request") && event.data["is_request"] == true) {
-                                        for (const auto& subscriber : subscribers) {
-                                            try {
-                                                subscriber.callback(event);
-                                            } catch (const std::exception& e) {
-                                                metrics_.handler_errors++;
-                                            }
-                                        }
-                                    } else if (event.data.contains("correlation_id")) {
-                                        std::string corr_id = event.data["correlation_id"];
+                                    metrics_.requests_completed++;
+                                    try {
+                                        pending.callback(RequestStatus::OK, response);
+                                    } catch (const std::exception& e) {
+                                        metrics_.handler_errors++;
+                                        LOG_WARN(static_cast< const std::string&>(e.what()));
+                                    }
+                                }
+
+                                void DataBus::fail_request(CorrelationId correlation_id, RequestStatus status) {
+                                    PendingRequest pending;
+                                    {
                                         std::lock_guard<std::mutex> lock(requests_mutex_);
-                                        auto it = pending_requests_.find(corr_id);
-                                        if (it != pending_requests_.end()) {
-                                            it->second.set_value(event.data);
-                                            pending_requests_.erase(it);
-                                        }
-                                    } else {
-                                        for (const auto& subscriber : subscribers) {
-                                            try {
-                                                subscriber.callback(event);
-                                            } catch (const std::exception& e) {
-                                                metrics_.handler_errors++;
-                                                LOG_WARN(static_cast< const std::string&>(e.what()));
+                                        if (!pending_requests_.take(correlation_id, pending)) return;
+                                        request_timeouts_.cancel(pending.timer);
+                                        metrics_.requests_pending = pending_requests_.size();
+                                    }
+
+                                    try {
+                                        pending.callback(status, nlohmann::json());
+                                    } catch (const std::exception& e) {
+                                        metrics_.handler_errors++;
+                                        LOG_WARN(static_cast< const std::string&>(e.what()));
+                                    }
+                                }
+
+                                void DataBus::fail_lost_request(const Event& event) {
+                                    if (event.is_request && event.correlation_id != INVALID_CORRELATION_ID) {
+                                        fail_request(event.correlation_id, RequestStatus::DROPPED);
+                                    }
+                                }
+
+                                void DataBus::expire_requests(std::chrono::steady_clock::time_point now) {
+                                    std::vector<ResponseCallback> expired;
+                                    {
+                                        std::lock_guard<std::mutex> lock(requests_mutex_);
+                                        if (request_timeouts_.empty()) return;
+
+                                        expired_scratch_.clear();
+                                        request_timeouts_.advance(now, [this](CorrelationId&& correlation_id) {
+                                            expired_scratch_.push_back(correlation_id);
+                                        });
+                                        for (CorrelationId correlation_id : expired_scratch_) {
+                                            PendingRequest pending;
+                                            if (pending_requests_.take(correlation_id, pending)) {
+                                                expired.push_back(std::move(pending.callback));
                                             }
                                         }
+                                        metrics_.requests_pending = pending_requests_.size();
+                                    }
+
+                                    // Callbacks run without the lock so they may issue new requests
+                                    for (auto& callback : expired) {
+                                        metrics_.requests_timed_out++;
+                                        try {
+                                            callback(RequestStatus::TIMEOUT, nlohmann::json());
+                                        } catch (const std::exception& e) {
+                                            metrics_.handler_errors++;
+                                            LOG_WARN(static_cast< const std::string&>(e.what()));
+                                        }
                                     }
                                 }
 
-                                std::future<nlohmann::json> DataBus::setup_response_waiter(const std::string& correlation_id) {
+                                std::chrono::steady_clock::time_point DataBus::next_request_deadline() const {
                                     std::lock_guard<std::mutex> lock(requests_mutex_);
-                                    auto [it, inserted] = pending_requests_.emplace(correlation_id, std::promise<nlohmann::json>());
-                                    return it->second.get_future();
+                                    return request_timeouts_.next_expiry();
                                 }
 
                                 void DataBus::cleanup() {
-                                    std::lock_guard<std::mutex> lock(requests_mutex_);
-                                    for (auto& [corr_id, promise] : pending_requests_) {
+                                    std::vector<ResponseCallback> cancelled;
+                                    {
+                                        std::lock_guard<std::mutex> lock(requests_mutex_);
+                                        pending_requests_.for_each([&](CorrelationId, PendingRequest& pending) {
+                                            request_timeouts_.cancel(pending.timer);
+                                            cancelled.push_back(std::move(pending.callback));
+                                        });
+                                        pending_requests_.clear();
+                                        metrics_.requests_pending = 0;
+                                    }
+
+                                    for (auto& callback : cancelled) {
                                         try {
-                                            promise.set_exception(std::make_exception_ptr(std::runtime_error("DataBus stopped")));
+                                            callback(RequestStatus::CANCELLED, nlohmann::json());
                                         } catch (...) {
 
                                         }
                                     }
-                                    pending_requests_.clear();
-                                }
-
-                                std::string DataBus::generate_event_id() {
-                                    return "evt_" + std::to_string(next_event_id_++);
-                                }
-
-                                std::string DataBus::generate_correlation_id() {
-                                    return "corr_" + std::to_string(next_correlation_id_++);
                                 }
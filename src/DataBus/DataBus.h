@@ -17,7 +17,7 @@
 #include <atomic>
 #include <mutex>
 #include <thread>
-#include <queue>
+#include <array>
 #include <condition_variable>
 #include <functional>
 #include <chrono>
@@ -30,7 +30,23 @@
 #include "BusEvent.h"
 #include "subscriptionID.h"
 #include "DataBusMetrics.h"
+#include "EventLane.h"
+#include "Subscriber.h"
+#include "EventPool.h"
+#include "SourceRegistry.h"
+#include "EventJournal.h"
 #include "../common/Confparcer.h"
+#include "../common/FlatHashMap.h"
+#include "../common/TimerWheel.h"
+#include "../common/Scheduler.h"
+#include "../Metrics/OpenMetrics.h"
+
+using CorrelationId = uint64_t;
+constexpr CorrelationId INVALID_CORRELATION_ID = 0;
+
+enum class RequestStatus { OK, TIMEOUT, CANCELLED, DROPPED };
+// Runs on the bus worker thread; the json is the responder's payload
+using ResponseCallback = std::function<void(RequestStatus, const nlohmann::json&)>;
 
 class DataBus {
 public:
@@ -44,51 +60,95 @@ public:
 }
 
     static DataBus& instance();
-    void publish(BusEventType type, const std::string& source, const nlohmann::json& data);
-    SubscriptionId subscribe(BusEventType type, EventCallback callback);
+    // The payload is moved into a pooled Event; pass an rvalue to avoid a copy
+    void publish(BusEventType type, const std::string& source, nlohmann::json data);
+    void publish(BusEventType type, SourceId source, nlohmann::json data);
+    // Publishes from the Scheduler thread once `delay` has passed; cancel with Scheduler::cancel()
+    TaskId publish_after(std::chrono::steady_clock::duration delay, BusEventType type,
+                         const std::string& source, nlohmann::json data);
+    SourceId source_id(const std::string& name) { return sources_.intern(name); }
+    const std::string& source_name(SourceId id) const { return sources_.name(id); }
+    SubscriptionId subscribe(BusEventType type, EventCallback callback,
+                             SubscribeOptions options = SubscribeOptions());
+    // Stops the subscriber; DEDICATED handlers are joined before this returns
     void unsubscribe(SubscriptionId id);
-    nlohmann::json request(BusEventType type, const nlohmann::json& data,
+    // Blocking wrapper over request_async(), throws on timeout or shutdown.
+    // Not callable from a subscriber callback.
+    nlohmann::json request(BusEventType type, nlohmann::json data,
                            std::chrono::milliseconds timeout = std::chrono::seconds(TIMEOUT()));
+    // Publishes `data` as an event with is_request set and returns immediately.
+    // The callback fires exactly once: with the response, on timeout, or on stop().
+    CorrelationId request_async(BusEventType type, nlohmann::json data, ResponseCallback callback,
+                                std::chrono::milliseconds timeout = std::chrono::seconds(TIMEOUT()));
+    // Drops a pending request without invoking its callback
+    bool cancel_request(CorrelationId correlation_id);
+    // Answers a request event, pass its Event::correlation_id
+    void respond(BusEventType type, const std::string& source, CorrelationId correlation_id, nlohmann::json data);
     void start();
     void stop();
+    // Re-publishes journaled events timestamped in [from, to]; they are not journaled again.
+    // Call from a control thread, BLOCK lanes may wait for the worker.
+    size_t replay_journal(std::chrono::system_clock::time_point from,
+                          std::chrono::system_clock::time_point to);
     DataBusMetricsSnapshot get_metrics() const;
+    void collect_metrics(metrics::OpenMetricsWriter& writer) const;
 
 private:
-    DataBus() = default;
+    DataBus();
     ~DataBus();
 
     DataBus(const DataBus&) = delete;
     DataBus& operator=(const DataBus&) = delete;
 
-    struct Subscriber {
-        SubscriptionId id;
-        EventCallback callback;
-    };
-
+    // Declared first so it outlives every Ref held by lanes and subscribers
+    EventPool event_pool_;
+    SourceRegistry sources_;
+    SourceId requestor_source_;
 
-    std::queue<Event> events_queue_;
+    // One lane per BusEventType, drained in dispatch_order_ (highest priority first)
+    std::array<std::unique_ptr<EventLane>, BUS_EVENT_TYPE_COUNT> lanes_;
+    std::array<BusEventType, BUS_EVENT_TYPE_COUNT> dispatch_order_;
+    size_t queued_events_{0};
     mutable std::mutex events_mutex_;
     std::condition_variable events_cv_;
+    // Signalled when a BLOCK lane drains
+    std::condition_variable space_cv_;
+
+    // Copy-on-write per type: the worker reads with atomic_load, writers hold subscriptions_mutex_
+    std::array<std::shared_ptr<const SubscriberTable>, BUS_EVENT_TYPE_COUNT> subscribers_;
+    std::mutex subscriptions_mutex_;
 
-    std::unordered_map<BusEventType, std::vector<Subscriber>> subscriptions_;
-    mutable std::mutex subscriptions_mutex_;
+    struct PendingRequest {
+        ResponseCallback callback;
+        TimerWheel<CorrelationId>::TimerId timer{TimerWheel<CorrelationId>::INVALID_TIMER};
+    };
 
-    std::unordered_map<std::string, std::promise<nlohmann::json>> pending_requests_;
+    // Both guarded by requests_mutex_; lock order is events_mutex_ -> requests_mutex_
+    FlatHashMap<PendingRequest> pending_requests_;
+    TimerWheel<CorrelationId> request_timeouts_;
+    std::vector<CorrelationId> expired_scratch_;
     mutable std::mutex requests_mutex_;
 
     std::atomic<bool> running_{false};
     std::thread worker_thread_;
+    std::atomic<std::thread::id> worker_id_{};
 
     std::atomic<SubscriptionId> next_subscription_id_{1};
     std::atomic<uint64_t> next_event_id_{1};
     std::atomic<uint64_t> next_correlation_id_{1};
 
     DataBusMetricsInternal metrics_;
+    // Set when JOURNAL_DIR is configured
+    std::unique_ptr<EventJournal> journal_;
 
     void process_events();
-    void handle_event(const Event& event);
-    std::future<nlohmann::json> setup_response_waiter(const std::string& correlation_id);
+    void handle_event(const Subscriber::EventPtr& event);
+    void complete_request(CorrelationId correlation_id, const nlohmann::json& response);
+    void fail_request(CorrelationId correlation_id, RequestStatus status);
+    // Fails the pending request carried by an event the lanes discarded
+    void fail_lost_request(const Event& event);
+    void expire_requests(std::chrono::steady_clock::time_point now);
+    std::chrono::steady_clock::time_point next_request_deadline() const;
     void cleanup();
-    std::string generate_event_id();
-    std::string generate_correlation_id();
+    void enqueue(EventPool::Ref event, bool journal = true);
 };
@@ -20,6 +20,9 @@ struct DataBusMetricsInternal {
     std::atomic<uint64_t> handler_errors{0};
     std::atomic<uint64_t> queue_size{0};
     std::atomic<uint64_t> queue_overflow{0};
+    std::atomic<uint64_t> requests_pending{0};
+    std::atomic<uint64_t> requests_completed{0};
+    std::atomic<uint64_t> requests_timed_out{0};
 };
 
 struct DataBusMetricsSnapshot {
@@ -29,6 +32,9 @@ struct DataBusMetricsSnapshot {
     uint64_t handler_errors{0};
     uint64_t queue_size{0};
     uint64_t queue_overflow{0};
+    uint64_t requests_pending{0};
+    uint64_t requests_completed{0};
+    uint64_t requests_timed_out{0};
     
     DataBusMetricsSnapshot() = default;
     
@@ -39,5 +45,8 @@ struct DataBusMetricsSnapshot {
         handler_errors = internal.handler_errors.load();
         queue_size = current_queue_size;
         queue_overflow = internal.queue_overflow.load();
+        requests_pending = internal.requests_pending.load();
+        requests_completed = internal.requests_completed.load();
+        requests_timed_out = internal.requests_timed_out.load();
     }
 };
\ No newline at end of file
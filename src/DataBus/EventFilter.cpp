@@ -0,0 +1,98 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventFilter.cpp
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "EventFilter.h"
+
+EventFilter& EventFilter::where_equals(const std::string& key, const nlohmann::json& value) {
+    clauses_.push_back({ClauseKind::EQUALS, key, value, {}});
+    return *this;
+}
+
+EventFilter& EventFilter::where_in(const std::string& key, const std::vector<nlohmann::json>& values) {
+    Clause clause{ClauseKind::IN_SET, key, nullptr, {}};
+    std::string member;
+    for (const auto& value : values) {
+        if (index_value(value, member)) {
+            clause.members.insert(member);
+        }
+    }
+    clauses_.push_back(std::move(clause));
+    return *this;
+}
+
+EventFilter& EventFilter::where_present(const std::string& key) {
+    clauses_.push_back({ClauseKind::PRESENT, key, nullptr, {}});
+    return *this;
+}
+
+EventFilter& EventFilter::sample(size_t one_in) {
+    sample_every_ = one_in == 0 ? 1 : one_in;
+    if (!sample_counter_) {
+        sample_counter_ = std::make_shared<std::atomic<uint64_t>>(0);
+    }
+    return *this;
+}
+
+bool EventFilter::index_value(const nlohmann::json& value, std::string& out) {
+    switch (value.type()) {
+        // assign/append reuse the capacity of `out`
+        case nlohmann::json::value_t::string:
+            out.assign("s:").append(value.get_ref<const std::string&>());
+            return true;
+        case nlohmann::json::value_t::number_unsigned:
+            out.assign("i:").append(std::to_string(value.get<uint64_t>()));
+            return true;
+        case nlohmann::json::value_t::number_integer:
+            out.assign("i:").append(std::to_string(value.get<int64_t>()));
+            return true;
+        case nlohmann::json::value_t::boolean:
+            out.assign(value.get<bool>() ? "b:1" : "b:0");
+            return true;
+        case nlohmann::json::value_t::number_float:
+        case nlohmann::json::value_t::null:
+            out.assign("v:").append(value.dump());
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool EventFilter::index_key(std::string& key, std::string& value) const {
+    for (const auto& clause : clauses_) {
+        if (clause.kind == ClauseKind::EQUALS && index_value(clause.value, value)) {
+            key = clause.key;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool EventFilter::matches(const Event& event) const {
+    static thread_local std::string member;
+    for (const auto& clause : clauses_) {
+        auto it = event.data.find(clause.key);
+        if (it == event.data.end()) return false;
+
+        switch (clause.kind) {
+            case ClauseKind::EQUALS:
+                if (*it != clause.value) return false;
+                break;
+            case ClauseKind::IN_SET:
+                if (!index_value(*it, member) || clause.members.count(member) == 0) return false;
+                break;
+            case ClauseKind::PRESENT:
+                break;
+        }
+    }
+
+    if (sample_every_ > 1) {
+        return (*sample_counter_)++ % sample_every_ == 0;
+    }
+    return true;
+}
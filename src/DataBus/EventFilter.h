@@ -0,0 +1,60 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventFilter.h
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "../../thirdparty/json.hpp"
+#include "BusEvent.h"
+
+// Predicate evaluated by the dispatcher before a subscriber is invoked.
+// Clauses look at top-level fields of Event::data and are ANDed; an empty filter
+// matches everything. The first where_equals() clause is the index key: the
+// dispatcher hashes it so that exact-match subscribers cost O(matches).
+//
+//   EventFilter().where_equals("server_id", "web-1").sample(10)
+class EventFilter {
+public:
+    EventFilter& where_equals(const std::string& key, const nlohmann::json& value);
+    // Integer and string members are matched by hash, e.g. a set of backend ids
+    EventFilter& where_in(const std::string& key, const std::vector<nlohmann::json>& values);
+    EventFilter& where_present(const std::string& key);
+    // Passes 1 of every `one_in` events that satisfy the other clauses
+    EventFilter& sample(size_t one_in);
+
+    bool empty() const { return clauses_.empty() && sample_every_ <= 1; }
+    bool matches(const Event& event) const;
+
+    // Index key of the first where_equals() clause, false if there is none
+    bool index_key(std::string& key, std::string& value) const;
+    // Canonical form of a field value used by the dispatcher index; numbers of
+    // any signedness compare equal, false for objects and arrays
+    static bool index_value(const nlohmann::json& value, std::string& out);
+
+private:
+    enum class ClauseKind { EQUALS, IN_SET, PRESENT };
+
+    struct Clause {
+        ClauseKind kind;
+        std::string key;
+        nlohmann::json value;
+        std::unordered_set<std::string> members;
+    };
+
+    std::vector<Clause> clauses_;
+    size_t sample_every_{1};
+    // Shared so copies of one filter keep sampling one stream
+    std::shared_ptr<std::atomic<uint64_t>> sample_counter_;
+};
@@ -0,0 +1,428 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventJournal.cpp
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "EventJournal.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+
+#include "../common/generic.h"
+#include "../common/logger.h"
+
+#if ISLINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char SEGMENT_MAGIC[8] = {'H', 'G', 'J', 'O', 'U', 'R', 'N', '1'};
+constexpr uint32_t RECORD_MAGIC = 0x4A524748; // "HGRJ"
+constexpr uint32_t FORMAT_VERSION = 1;
+
+struct SegmentHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t sequence;
+    int64_t created_ns;
+};
+static_assert(sizeof(SegmentHeader) == 32, "journal segment header layout changed");
+
+struct RecordHeader {
+    uint32_t magic;
+    uint32_t payload_size; // source name + CBOR payload
+    uint32_t crc;          // CRC-32 of the payload bytes
+    uint16_t type;
+    uint16_t source_size;
+    uint64_t id;
+    uint64_t correlation_id;
+    int64_t timestamp_ns;
+    uint8_t flags;
+    uint8_t reserved[7];
+};
+static_assert(sizeof(RecordHeader) == 48, "journal record header layout changed");
+
+constexpr uint8_t FLAG_REQUEST = 0x1;
+
+size_t align8(size_t value) {
+    return (value + 7) & ~size_t{7};
+}
+
+uint32_t crc32(const uint8_t* data, size_t size) {
+    static const auto table = []() {
+        std::array<uint32_t, 256> result{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            result[i] = crc;
+        }
+        return result;
+    }();
+
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+int64_t to_ns(std::chrono::system_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+EventJournal::EventJournal(std::string directory, const std::string& event_types)
+    : directory_(std::move(directory)) {
+    std::stringstream stream(event_types);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+
+        bool known = false;
+        for (size_t i = 0; i < BUS_EVENT_TYPE_COUNT; ++i) {
+            if (name == bus_event_type_name(static_cast<BusEventType>(i))) {
+                selected_[i] = true;
+                known = true;
+            }
+        }
+        if (!known && !name.empty()) {
+            LOG_WARN("Unknown event type in JOURNAL_EVENTS: " + name);
+        }
+    }
+}
+
+EventJournal::~EventJournal() {
+    stop();
+}
+
+bool EventJournal::start() {
+#if ISLINUX
+    if (running_.load()) return true;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory_, error);
+    if (error) {
+        LOG_ERROR("Cannot create journal directory " + directory_ + ": " + error.message());
+        return false;
+    }
+
+    auto segments = list_segments(directory_);
+    segment_sequence_ = segments.empty() ? 0 : segments.back().first;
+    segment_size_ = SEGMENT_MB() * 1024 * 1024;
+
+    if (!open_segment()) return false;
+
+    running_ = true;
+    writer_thread_ = std::thread(&EventJournal::run, this);
+    LOG_INFO("Event journal writing to " + directory_);
+    return true;
+#else
+    LOG_WARN("Event journal is only supported on Linux");
+    return false;
+#endif
+}
+
+void EventJournal::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_.exchange(false)) return;
+    }
+    queue_cv_.notify_all();
+
+    if (writer_thread_.joinable()) {
+        writer_thread_.join();
+    }
+    close_segment();
+}
+
+void EventJournal::append(const EventPool::Ref& event, const std::string& source_name) {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!running_.load()) return;
+        if (queue_.size() >= QUEUE_SIZE()) {
+            records_dropped++;
+            return;
+        }
+        queue_.push_back(Pending{event, &source_name});
+    }
+    queue_cv_.notify_one();
+}
+
+void EventJournal::run() {
+    auto flush_interval = std::chrono::milliseconds(FLUSH_MS());
+
+    while (true) {
+        bool stopping;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait_for(lock, flush_interval, [this]() {
+                return !queue_.empty() || !running_.load();
+            });
+
+            Pending pending;
+            while (queue_.pop_front(pending)) {
+                batch_.push_back(std::move(pending));
+            }
+            stopping = !running_.load();
+        }
+
+        for (const auto& pending : batch_) {
+            write_record(pending);
+        }
+        batch_.clear();
+        commit();
+
+        if (stopping) break;
+    }
+}
+
+void EventJournal::write_record(const Pending& pending) {
+#if ISLINUX
+    const Event& event = *pending.event;
+    const std::string& source = *pending.source;
+
+    scratch_.clear();
+    nlohmann::json::to_cbor(event.data, scratch_);
+
+    size_t payload_size = source.size() + scratch_.size();
+    size_t record_size = align8(sizeof(RecordHeader) + payload_size);
+    // Room for the zeroed terminator header must remain
+    size_t usable = segment_size_ - align8(sizeof(SegmentHeader)) - sizeof(RecordHeader);
+    if (record_size > usable) {
+        records_dropped++;
+        LOG_WARN("Journal record larger than a segment, dropped");
+        return;
+    }
+
+    if (map_ == nullptr || write_offset_ + record_size + sizeof(RecordHeader) > segment_size_) {
+        commit();
+        close_segment();
+        if (!open_segment()) {
+            records_dropped++;
+            return;
+        }
+        segments_rotated++;
+    }
+
+    uint8_t* out = map_ + write_offset_;
+    uint8_t* payload = out + sizeof(RecordHeader);
+    std::memcpy(payload, source.data(), source.size());
+    std::memcpy(payload + source.size(), scratch_.data(), scratch_.size());
+
+    RecordHeader header{};
+    header.magic = RECORD_MAGIC;
+    header.payload_size = static_cast<uint32_t>(payload_size);
+    header.crc = crc32(payload, payload_size);
+    header.type = static_cast<uint16_t>(event.type);
+    header.source_size = static_cast<uint16_t>(source.size());
+    header.id = event.id;
+    header.correlation_id = event.correlation_id;
+    header.timestamp_ns = to_ns(event.timestamp);
+    header.flags = event.is_request ? FLAG_REQUEST : 0;
+    std::memcpy(out, &header, sizeof(header));
+
+    write_offset_ += record_size;
+    records_written++;
+    bytes_written += record_size;
+#else
+    (void)pending;
+#endif
+}
+
+void EventJournal::commit() {
+#if ISLINUX
+    if (map_ == nullptr || write_offset_ == synced_offset_) return;
+
+    auto started = std::chrono::steady_clock::now();
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = synced_offset_ & ~(page - 1);
+    if (msync(map_ + begin, write_offset_ - begin, MS_SYNC) != 0) {
+        LOG_ERROR("Journal msync failed: " + std::string(std::strerror(errno)));
+    }
+    synced_offset_ = write_offset_;
+    commit_latency.record(std::chrono::steady_clock::now() - started);
+#endif
+}
+
+bool EventJournal::open_segment() {
+#if ISLINUX
+    std::string path = segment_path(++segment_sequence_);
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR("Cannot open journal segment " + path + ": " + std::strerror(errno));
+        return false;
+    }
+
+    // Reserve the blocks up front so a full disk fails here, not as SIGBUS on a store
+    int error = posix_fallocate(fd_, 0, static_cast<off_t>(segment_size_));
+    if (error != 0) {
+        LOG_ERROR("Cannot allocate journal segment " + path + ": " + std::strerror(error));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+
+    void* map = mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Cannot map journal segment " + path + ": " + std::strerror(errno));
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    map_ = static_cast<uint8_t*>(map);
+
+    SegmentHeader header{};
+    std::memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header.version = FORMAT_VERSION;
+    header.header_size = sizeof(SegmentHeader);
+    header.sequence = segment_sequence_;
+    header.created_ns = to_ns(std::chrono::system_clock::now());
+    std::memcpy(map_, &header, sizeof(header));
+
+    write_offset_ = align8(sizeof(SegmentHeader));
+    synced_offset_ = 0;
+
+    enforce_retention();
+    return true;
+#else
+    return false;
+#endif
+}
+
+void EventJournal::close_segment() {
+#if ISLINUX
+    if (map_ != nullptr) {
+        commit();
+        munmap(map_, segment_size_);
+        map_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+#endif
+}
+
+void EventJournal::enforce_retention() {
+    auto segments = list_segments(directory_);
+    size_t keep = std::max<size_t>(RETENTION_SEGMENTS(), 1);
+    if (segments.size() <= keep) return;
+
+    for (size_t i = 0; i + keep < segments.size(); ++i) {
+        std::error_code error;
+        std::filesystem::remove(segments[i].second, error);
+        if (error) {
+            LOG_WARN("Cannot remove journal segment " + segments[i].second + ": " + error.message());
+        }
+    }
+}
+
+std::string EventJournal::segment_path(uint64_t sequence) const {
+    char name[40];
+    std::snprintf(name, sizeof(name), "journal-%020llu.hgj", static_cast<unsigned long long>(sequence));
+    return (std::filesystem::path(directory_) / name).string();
+}
+
+std::vector<std::pair<uint64_t, std::string>> EventJournal::list_segments(const std::string& directory) {
+    std::vector<std::pair<uint64_t, std::string>> segments;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+        std::string name = entry.path().filename().string();
+        if (name.size() != 32 || name.rfind("journal-", 0) != 0 || entry.path().extension() != ".hgj") continue;
+        try {
+            segments.emplace_back(std::stoull(name.substr(8, 20)), entry.path().string());
+        } catch (const std::exception&) {
+        }
+    }
+    std::sort(segments.begin(), segments.end());
+    return segments;
+}
+
+size_t EventJournal::read(const std::string& directory,
+                          std::chrono::system_clock::time_point from,
+                          std::chrono::system_clock::time_point to,
+                          const Visitor& visitor) {
+    size_t visited = 0;
+#if ISLINUX
+    int64_t from_ns = to_ns(from);
+    int64_t to_ns_inclusive = to_ns(to);
+
+    for (const auto& [sequence, path] : list_segments(directory)) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) continue;
+
+        struct stat info {};
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SegmentHeader)) {
+            ::close(fd);
+            continue;
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map == MAP_FAILED) continue;
+
+        const uint8_t* base = static_cast<const uint8_t*>(map);
+        if (std::memcmp(base, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC)) == 0) {
+            size_t offset = align8(sizeof(SegmentHeader));
+            while (offset + sizeof(RecordHeader) <= size) {
+                RecordHeader header;
+                std::memcpy(&header, base + offset, sizeof(header));
+                if (header.magic != RECORD_MAGIC) break;
+
+                const uint8_t* payload = base + offset + sizeof(RecordHeader);
+                size_t record_size = align8(sizeof(RecordHeader) + header.payload_size);
+                // A torn tail after a crash ends the segment
+                if (offset + record_size > size || header.source_size > header.payload_size ||
+                    header.type >= BUS_EVENT_TYPE_COUNT || crc32(payload, header.payload_size) != header.crc) {
+                    LOG_WARN("Journal segment " + path + " truncated at offset " + std::to_string(offset));
+                    break;
+                }
+                offset += record_size;
+
+                if (header.timestamp_ns < from_ns || header.timestamp_ns > to_ns_inclusive) continue;
+
+                Record record;
+                record.type = static_cast<BusEventType>(header.type);
+                record.source.assign(reinterpret_cast<const char*>(payload), header.source_size);
+                record.id = header.id;
+                record.correlation_id = header.correlation_id;
+                record.is_request = (header.flags & FLAG_REQUEST) != 0;
+                record.timestamp = std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                        std::chrono::nanoseconds(header.timestamp_ns)));
+                try {
+                    record.data = nlohmann::json::from_cbor(payload + header.source_size, payload + header.payload_size);
+                } catch (const std::exception& e) {
+                    LOG_WARN("Undecodable journal record in " + path + ": " + e.what());
+                    continue;
+                }
+
+                visitor(std::move(record));
+                ++visited;
+            }
+        }
+        munmap(map, size);
+    }
+#else
+    (void)directory;
+    (void)from;
+    (void)to;
+    (void)visitor;
+#endif
+    return visited;
+}
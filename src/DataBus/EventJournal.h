@@ -0,0 +1,137 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventJournal.h
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BusEvent.h"
+#include "EventPool.h"
+#include "../common/Confparcer.h"
+#include "../common/RingBuffer.h"
+#include "../Metrics/LatencyHistogram.h"
+
+// Append-only journal of selected bus events in memory-mapped segment files.
+//
+// publish() only hands a Ref to append(), which takes a short lock and never
+// touches the disk. A writer thread encodes batches into the mapped segment and
+// makes each batch durable with one msync (group commit). Segments rotate at
+// JOURNAL_SEGMENT_MB and only the newest JOURNAL_RETENTION_SEGMENTS are kept.
+//
+// Segment layout: SegmentHeader, then records of
+//   RecordHeader | source name | CBOR payload
+// terminated by a zeroed header (files are pre-zeroed). Linux only.
+class EventJournal {
+public:
+    static std::string DIR() {
+        static std::string value = Confparcer::SETTING<std::string>("JOURNAL_DIR", "");
+        return value;
+    }
+    static std::string EVENTS() {
+        static std::string value = Confparcer::SETTING<std::string>("JOURNAL_EVENTS", "REQUEST_CLASSIFIED,REQUEST_ROUTED");
+        return value;
+    }
+    static size_t SEGMENT_MB() {
+        static size_t value = Confparcer::SETTING<size_t>("JOURNAL_SEGMENT_MB", 64);
+        return value;
+    }
+    static size_t RETENTION_SEGMENTS() {
+        static size_t value = Confparcer::SETTING<size_t>("JOURNAL_RETENTION_SEGMENTS", 16);
+        return value;
+    }
+    static size_t FLUSH_MS() {
+        static size_t value = Confparcer::SETTING<size_t>("JOURNAL_FLUSH_MS", 10);
+        return value;
+    }
+    static size_t QUEUE_SIZE() {
+        static size_t value = Confparcer::SETTING<size_t>("JOURNAL_QUEUE_SIZE", 65536);
+        return value;
+    }
+
+    // A decoded record, as handed to replay visitors
+    struct Record {
+        BusEventType type;
+        std::string source;
+        uint64_t id;
+        uint64_t correlation_id;
+        bool is_request;
+        std::chrono::system_clock::time_point timestamp;
+        nlohmann::json data;
+    };
+    using Visitor = std::function<void(Record&&)>;
+
+    EventJournal(std::string directory, const std::string& event_types);
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    bool start();
+    // Flushes everything appended so far before returning
+    void stop();
+
+    bool wants(BusEventType type) const { return selected_[type]; }
+    // Called from publish(); source names are resolved by the writer
+    void append(const EventPool::Ref& event, const std::string& source_name);
+
+    // Reads records in [from, to] from every segment in `directory`, oldest first
+    static size_t read(const std::string& directory,
+                       std::chrono::system_clock::time_point from,
+                       std::chrono::system_clock::time_point to,
+                       const Visitor& visitor);
+
+    std::atomic<uint64_t> records_written{0};
+    std::atomic<uint64_t> bytes_written{0};
+    std::atomic<uint64_t> records_dropped{0};
+    std::atomic<uint64_t> segments_rotated{0};
+    metrics::LatencyHistogram commit_latency;
+
+private:
+    struct Pending {
+        EventPool::Ref event;
+        const std::string* source{nullptr};
+    };
+
+    std::string directory_;
+    std::array<bool, BUS_EVENT_TYPE_COUNT> selected_{};
+
+    RingBuffer<Pending> queue_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::atomic<bool> running_{false};
+    std::thread writer_thread_;
+
+    // Writer thread state
+    int fd_{-1};
+    uint8_t* map_{nullptr};
+    size_t segment_size_{0};
+    size_t write_offset_{0};
+    size_t synced_offset_{0};
+    uint64_t segment_sequence_{0};
+    std::vector<uint8_t> scratch_;
+    std::vector<Pending> batch_;
+
+    void run();
+    void write_record(const Pending& pending);
+    void commit();
+    bool open_segment();
+    void close_segment();
+    void enforce_retention();
+    std::string segment_path(uint64_t sequence) const;
+    static std::vector<std::pair<uint64_t, std::string>> list_segments(const std::string& directory);
+};
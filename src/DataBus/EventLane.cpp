@@ -0,0 +1,211 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventLane.cpp
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "EventLane.h"
+
+#include <sstream>
+#include <vector>
+
+#include "../common/Confparcer.h"
+#include "../common/logger.h"
+
+LaneConfig LaneConfig::defaults(BusEventType type, size_t capacity) {
+    LaneConfig config;
+    config.capacity = capacity;
+
+    switch (type) {
+        case SERVICE_HEALTH_UPDATE:
+            // Only the latest state of each server matters
+            config.priority = 3;
+            config.policy = OverflowPolicy::COALESCE;
+            config.coalesce_key = "server_id";
+            break;
+        case SERVICE_REGISTERED:
+        case REQUEST_CLASSIFIED:
+            config.priority = 3;
+            config.policy = OverflowPolicy::BLOCK;
+            break;
+        case REQUEST_FOR_CLASSIFICATION:
+            // Published from the io_context thread, which must never block
+            config.priority = 2;
+            config.policy = OverflowPolicy::DROP_NEWEST;
+            break;
+        case REQUEST_PROCESSED:
+            config.priority = 1;
+            config.policy = OverflowPolicy::DROP_OLDEST;
+            break;
+        case REQUEST_ROUTED:
+        case NEW_CLIENT_CONNECTION:
+            config.priority = 0;
+            config.policy = OverflowPolicy::DROP_OLDEST;
+            break;
+    }
+    return config;
+}
+
+bool LaneConfig::parse(const std::string& value, LaneConfig& config) {
+    std::vector<std::string> fields;
+    std::stringstream stream(value);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        field.erase(0, field.find_first_not_of(" \t"));
+        field.erase(field.find_last_not_of(" \t") + 1);
+        fields.push_back(field);
+    }
+    if (fields.size() < 3 || fields.size() > 4) return false;
+
+    LaneConfig parsed = config;
+    try {
+        parsed.priority = utils::convertFromString<int>(fields[0]);
+        parsed.capacity = utils::convertFromString<size_t>(fields[1]);
+    } catch (const std::invalid_argument&) {
+        return false;
+    }
+
+    const std::string& policy = fields[2];
+    if (policy == "block") {
+        parsed.policy = OverflowPolicy::BLOCK;
+    } else if (policy == "drop_newest") {
+        parsed.policy = OverflowPolicy::DROP_NEWEST;
+    } else if (policy == "drop_oldest") {
+        parsed.policy = OverflowPolicy::DROP_OLDEST;
+    } else if (policy == "sample") {
+        parsed.policy = OverflowPolicy::SAMPLE;
+        if (fields.size() == 4) {
+            try {
+                parsed.sample_every = utils::convertFromString<size_t>(fields[3]);
+            } catch (const std::invalid_argument&) {
+                return false;
+            }
+        }
+        if (parsed.sample_every == 0) return false;
+    } else if (policy == "coalesce") {
+        parsed.policy = OverflowPolicy::COALESCE;
+        if (fields.size() == 4) parsed.coalesce_key = fields[3];
+        if (parsed.coalesce_key.empty()) return false;
+    } else {
+        return false;
+    }
+
+    if (parsed.capacity == 0) return false;
+    config = parsed;
+    return true;
+}
+
+LaneConfig LaneConfig::from_setting(BusEventType type, size_t default_capacity) {
+    LaneConfig config = defaults(type, default_capacity);
+    std::string name = std::string("BUS_LANE_") + bus_event_type_name(type);
+    std::string value = Confparcer::SETTING<std::string>(name, "");
+
+    if (!value.empty() && !parse(value, config)) {
+        LOG_ERROR("Invalid " + name + " '" + value + "', using defaults");
+    }
+    return config;
+}
+
+EventLane::EventLane(BusEventType type, LaneConfig config)
+    : type_(type), config_(std::move(config)) {}
+
+bool EventLane::coalesce_key_of(const Event& event, std::string& key) const {
+    auto it = event.data.find(config_.coalesce_key);
+    if (it == event.data.end()) return false;
+    key = it->is_string() ? it->get<std::string>() : it->dump();
+    return true;
+}
+
+void EventLane::append(EventPool::Ref& event) {
+    queue_.push_back(std::move(event));
+    metrics_.depth = queue_.size();
+}
+
+EventLane::PushResult EventLane::push(EventPool::Ref& event, EventPool::Ref& displaced) {
+    metrics_.published++;
+
+    switch (config_.policy) {
+        case OverflowPolicy::BLOCK:
+            append(event);
+            return PushResult::QUEUED;
+
+        case OverflowPolicy::SAMPLE:
+            if (sample_counter_++ % config_.sample_every != 0) {
+                metrics_.sampled_out++;
+                return PushResult::SAMPLED_OUT;
+            }
+            [[fallthrough]];
+        case OverflowPolicy::DROP_NEWEST:
+            if (full()) {
+                metrics_.dropped++;
+                return PushResult::DROPPED;
+            }
+            append(event);
+            return PushResult::QUEUED;
+
+        case OverflowPolicy::COALESCE: {
+            std::string key;
+            if (coalesce_key_of(*event, key)) {
+                auto it = latest_by_key_.find(key);
+                if (it != latest_by_key_.end()) {
+                    // Replace in place: the newer state keeps the older queue position
+                    EventPool::Ref& queued = queue_[it->second - head_sequence_];
+                    displaced = std::move(queued);
+                    queued = std::move(event);
+                    metrics_.coalesced++;
+                    return PushResult::COALESCED;
+                }
+                if (!full()) {
+                    latest_by_key_.emplace(std::move(key), head_sequence_ + queue_.size());
+                    append(event);
+                    return PushResult::QUEUED;
+                }
+                // Full with a fresh key: make room like DROP_OLDEST, then index the new event
+                pop(displaced);
+                metrics_.dropped++;
+                latest_by_key_.emplace(std::move(key), head_sequence_ + queue_.size());
+                append(event);
+                return PushResult::EVICTED_OLDEST;
+            }
+        }
+            [[fallthrough]];
+        case OverflowPolicy::DROP_OLDEST:
+            if (full()) {
+                pop(displaced);
+                metrics_.dropped++;
+                append(event);
+                return PushResult::EVICTED_OLDEST;
+            }
+            append(event);
+            return PushResult::QUEUED;
+    }
+    return PushResult::DROPPED;
+}
+
+bool EventLane::pop(EventPool::Ref& out) {
+    if (!queue_.pop_front(out)) return false;
+
+    if (config_.policy == OverflowPolicy::COALESCE) {
+        std::string key;
+        if (coalesce_key_of(*out, key)) {
+            auto it = latest_by_key_.find(key);
+            if (it != latest_by_key_.end() && it->second == head_sequence_) {
+                latest_by_key_.erase(it);
+            }
+        }
+    }
+
+    ++head_sequence_;
+    metrics_.depth = queue_.size();
+    if (queue_.empty()) overflow_reported_ = false;
+    return true;
+}
+
+bool EventLane::report_overflow() {
+    if (overflow_reported_) return false;
+    overflow_reported_ = true;
+    return true;
+}
@@ -0,0 +1,96 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventLane.h
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include "BusEvent.h"
+#include "EventPool.h"
+#include "../common/RingBuffer.h"
+
+// What a full lane does with a new event
+enum class OverflowPolicy {
+    BLOCK,       // publisher waits for room (never the bus worker itself)
+    DROP_NEWEST, // the new event is discarded
+    DROP_OLDEST, // the oldest queued event is evicted
+    SAMPLE,      // only 1 of every sample_every events is queued, full lane drops the newest
+    COALESCE     // a queued event with the same coalesce_key value is replaced in place
+};
+
+struct LaneConfig {
+    int priority{0};           // higher lanes are always drained first
+    size_t capacity{0};
+    OverflowPolicy policy{OverflowPolicy::DROP_OLDEST};
+    size_t sample_every{1};
+    std::string coalesce_key;
+
+    static LaneConfig defaults(BusEventType type, size_t capacity);
+    // BUS_LANE_<TYPE> = priority,capacity,policy[,sample_every|coalesce_key]
+    static LaneConfig from_setting(BusEventType type, size_t default_capacity);
+    static bool parse(const std::string& value, LaneConfig& config);
+};
+
+struct LaneMetrics {
+    std::atomic<uint64_t> published{0};
+    std::atomic<uint64_t> dispatched{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> coalesced{0};
+    std::atomic<uint64_t> sampled_out{0};
+    std::atomic<uint64_t> blocked{0};
+    std::atomic<uint64_t> depth{0};
+};
+
+// One FIFO per BusEventType. Not thread-safe, DataBus guards lanes with events_mutex_.
+class EventLane {
+public:
+    enum class PushResult {
+        QUEUED,
+        COALESCED,     // `displaced` holds the replaced event
+        EVICTED_OLDEST,// `displaced` holds the evicted event
+        DROPPED,       // `event` was not taken
+        SAMPLED_OUT    // `event` was not taken
+    };
+
+    EventLane(BusEventType type, LaneConfig config);
+
+    BusEventType type() const { return type_; }
+    const LaneConfig& config() const { return config_; }
+    LaneMetrics& metrics() { return metrics_; }
+    const LaneMetrics& metrics() const { return metrics_; }
+
+    bool empty() const { return queue_.empty(); }
+    size_t size() const { return queue_.size(); }
+    bool full() const { return queue_.size() >= config_.capacity; }
+
+    // Moves from `event` unless the result is DROPPED or SAMPLED_OUT.
+    // BLOCK lanes always queue, the caller is expected to have waited for room.
+    PushResult push(EventPool::Ref& event, EventPool::Ref& displaced);
+    bool pop(EventPool::Ref& out);
+    // True once per overflow episode, so storms log a single warning
+    bool report_overflow();
+
+private:
+    BusEventType type_;
+    LaneConfig config_;
+    LaneMetrics metrics_;
+
+    RingBuffer<EventPool::Ref> queue_;
+    uint64_t head_sequence_{0};
+    uint64_t sample_counter_{0};
+    bool overflow_reported_{false};
+    // coalesce_key value -> sequence number of the queued event holding it
+    std::unordered_map<std::string, uint64_t> latest_by_key_;
+
+    bool coalesce_key_of(const Event& event, std::string& key) const;
+    void append(EventPool::Ref& event);
+};
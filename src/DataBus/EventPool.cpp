@@ -0,0 +1,54 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventPool.cpp
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "EventPool.h"
+
+EventPool::EventPool(size_t chunk_size)
+    : chunk_size_(chunk_size == 0 ? 1 : chunk_size) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    add_chunk();
+}
+
+void EventPool::add_chunk() {
+    auto chunk = std::make_unique<Node[]>(chunk_size_);
+    for (size_t i = 0; i < chunk_size_; ++i) {
+        chunk[i].pool = this;
+        chunk[i].next = free_;
+        free_ = &chunk[i];
+    }
+    chunks_.push_back(std::move(chunk));
+    capacity_ += chunk_size_;
+    available_ += chunk_size_;
+}
+
+EventPool::Ref EventPool::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!free_) {
+        add_chunk();
+    }
+
+    Node* node = free_;
+    free_ = node->next;
+    node->next = nullptr;
+    node->refs.store(1, std::memory_order_relaxed);
+    available_--;
+    return Ref(node);
+}
+
+void EventPool::release(Node* node) {
+    // Drop the payload now so recycled events do not pin memory
+    node->event.data = nullptr;
+    node->event.correlation_id = 0;
+    node->event.is_request = false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    node->next = free_;
+    free_ = node;
+    available_++;
+}
@@ -0,0 +1,87 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\EventPool.h
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "BusEvent.h"
+
+// Recycles Event objects so publishing does not allocate envelopes. Events are
+// reference counted intrusively: one published event is shared by its lane and
+// every subscriber queue, and returns to the free list when the last Ref drops.
+// The pool must outlive every Ref it handed out.
+class EventPool {
+    struct Node;
+
+public:
+    class Ref {
+    public:
+        Ref() = default;
+        Ref(const Ref& other) : node_(other.node_) {
+            if (node_) node_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+        Ref(Ref&& other) noexcept : node_(std::exchange(other.node_, nullptr)) {}
+        Ref& operator=(Ref other) noexcept {
+            std::swap(node_, other.node_);
+            return *this;
+        }
+        ~Ref() { reset(); }
+
+        void reset() {
+            if (node_ && node_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                node_->pool->release(node_);
+            }
+            node_ = nullptr;
+        }
+
+        // Writable only until the event is published, shared events are read-only
+        Event& operator*() const { return node_->event; }
+        Event* operator->() const { return &node_->event; }
+        explicit operator bool() const { return node_ != nullptr; }
+
+    private:
+        friend class EventPool;
+        explicit Ref(Node* node) : node_(node) {}
+        Node* node_{nullptr};
+    };
+
+    explicit EventPool(size_t chunk_size = 256);
+
+    EventPool(const EventPool&) = delete;
+    EventPool& operator=(const EventPool&) = delete;
+
+    Ref acquire();
+
+    size_t capacity() const { return capacity_.load(std::memory_order_relaxed); }
+    size_t available() const { return available_.load(std::memory_order_relaxed); }
+
+private:
+    struct Node {
+        Event event;
+        std::atomic<uint32_t> refs{0};
+        Node* next{nullptr};
+        EventPool* pool{nullptr};
+    };
+
+    void release(Node* node);
+    void add_chunk();
+
+    size_t chunk_size_;
+    std::mutex mutex_;
+    Node* free_{nullptr};
+    std::vector<std::unique_ptr<Node[]>> chunks_;
+    std::atomic<size_t> capacity_{0};
+    std::atomic<size_t> available_{0};
+};
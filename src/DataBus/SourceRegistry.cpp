@@ -0,0 +1,44 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\SourceRegistry.cpp
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "SourceRegistry.h"
+
+#include "../common/logger.h"
+
+SourceRegistry::SourceRegistry() {
+    names_[UNKNOWN_SOURCE] = "unknown";
+    count_.store(1, std::memory_order_release);
+}
+
+SourceId SourceRegistry::intern(const std::string& name) {
+    size_t count = count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        if (names_[i] == name) return static_cast<SourceId>(i);
+    }
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    count = count_.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < count; ++i) {
+        if (names_[i] == name) return static_cast<SourceId>(i);
+    }
+    if (count == MAX_SOURCES) {
+        LOG_WARN("Bus source table full, publishing '" + name + "' as unknown");
+        return UNKNOWN_SOURCE;
+    }
+
+    // Readers only look below count_, so the slot is written before it is published
+    names_[count] = name;
+    count_.store(count + 1, std::memory_order_release);
+    return static_cast<SourceId>(count);
+}
+
+const std::string& SourceRegistry::name(SourceId id) const {
+    if (id >= count_.load(std::memory_order_acquire)) return names_[UNKNOWN_SOURCE];
+    return names_[id];
+}
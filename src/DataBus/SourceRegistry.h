@@ -0,0 +1,37 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\SourceRegistry.h
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "BusEvent.h"
+
+// Interns publisher names into SourceId. There are only a handful of sources,
+// so lookups scan a fixed table without locking or allocating; only the first
+// publish from a new source takes the mutex.
+class SourceRegistry {
+public:
+    static constexpr size_t MAX_SOURCES = 256;
+    static constexpr SourceId UNKNOWN_SOURCE = 0;
+
+    SourceRegistry();
+
+    // Returns UNKNOWN_SOURCE once the table is full
+    SourceId intern(const std::string& name);
+    const std::string& name(SourceId id) const;
+
+private:
+    std::array<std::string, MAX_SOURCES> names_;
+    std::atomic<size_t> count_{0};
+    std::mutex write_mutex_;
+};
@@ -0,0 +1,165 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\Subscriber.cpp
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "Subscriber.h"
+
+#include <chrono>
+
+#include "../common/logger.h"
+
+Subscriber::Subscriber(SubscriptionId id, BusEventType type, EventCallback callback,
+                       SubscribeOptions options, std::atomic<uint64_t>& error_sink)
+    : id_(id), type_(type), callback_(std::move(callback)), options_(std::move(options)),
+      error_sink_(error_sink) {
+    if (options_.name.empty()) {
+        options_.name = std::to_string(id_);
+    }
+    if (options_.queue_capacity == 0) {
+        options_.queue_capacity = QUEUE_CAPACITY();
+    }
+    if (options_.mode == DeliveryMode::EXECUTOR && !options_.executor) {
+        LOG_WARN("Subscriber " + options_.name + " has no executor, delivering inline");
+        options_.mode = DeliveryMode::INLINE;
+    }
+}
+
+Subscriber::~Subscriber() {
+    stop();
+}
+
+void Subscriber::start() {
+    if (options_.mode == DeliveryMode::DEDICATED && !thread_.joinable()) {
+        // The thread keeps its subscriber alive until stop() lets the loop exit
+        thread_ = std::thread([self = shared_from_this()]() {
+            self->run_queue();
+        });
+    }
+}
+
+void Subscriber::stop() {
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        active_ = false;
+        queue_.clear();
+    }
+    queue_cv_.notify_all();
+
+    if (thread_.joinable()) {
+        if (thread_.get_id() == std::this_thread::get_id()) {
+            // Unsubscribed from its own handler, the loop exits once it returns
+            thread_.detach();
+        } else {
+            thread_.join();
+        }
+    }
+}
+
+void Subscriber::deliver(const EventPtr& event) {
+    if (!active_.load()) return;
+
+    switch (options_.mode) {
+        case DeliveryMode::INLINE:
+            invoke(*event);
+            break;
+
+        case DeliveryMode::DEDICATED: {
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex_);
+                if (queue_.size() >= options_.queue_capacity) {
+                    EventPtr evicted;
+                    queue_.pop_front(evicted);
+                    dropped++;
+                }
+                queue_.push_back(event);
+            }
+            queue_cv_.notify_one();
+            break;
+        }
+
+        case DeliveryMode::EXECUTOR:
+            // The task owns the subscriber, so unsubscribe() cannot free it mid-flight
+            options_.executor([self = shared_from_this(), event]() {
+                if (self->active_.load()) {
+                    self->invoke(*event);
+                }
+            });
+            break;
+    }
+}
+
+void Subscriber::invoke(const Event& event) {
+    auto started = std::chrono::steady_clock::now();
+    auto waited = std::chrono::system_clock::now() - event.timestamp;
+    if (waited > std::chrono::system_clock::duration::zero()) {
+        lag.record(waited);
+    }
+
+    try {
+        callback_(event);
+    } catch (const std::exception& e) {
+        errors++;
+        error_sink_++;
+        LOG_WARN("Subscriber " + options_.name + " failed: " + e.what());
+    }
+
+    handler_time.record(std::chrono::steady_clock::now() - started);
+    delivered++;
+}
+
+void Subscriber::run_queue() {
+    while (true) {
+        EventPtr event;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this]() {
+                return !queue_.empty() || !active_.load();
+            });
+            if (!active_.load()) break;
+
+            queue_.pop_front(event);
+        }
+        invoke(*event);
+    }
+}
+
+void SubscriberTable::add(const Subscriber::Ptr& subscriber) {
+    all.push_back(subscriber);
+
+    std::string key;
+    std::string value;
+    if (subscriber->filter().index_key(key, value)) {
+        indexed[key][value].push_back(subscriber);
+    } else {
+        scanned.push_back(subscriber);
+    }
+}
+
+void SubscriberTable::dispatch(const Subscriber::EventPtr& event) const {
+    for (const auto& subscriber : scanned) {
+        if (subscriber->filter().matches(*event)) {
+            subscriber->deliver(event);
+        }
+    }
+
+    // Reused so steady-state dispatch does not allocate
+    static thread_local std::string value;
+    for (const auto& [key, buckets] : indexed) {
+        auto field = event->data.find(key);
+        if (field == event->data.end() || !EventFilter::index_value(*field, value)) continue;
+
+        auto bucket = buckets.find(value);
+        if (bucket == buckets.end()) continue;
+        for (const auto& subscriber : bucket->second) {
+            // The remaining clauses and sampling still apply
+            if (subscriber->filter().matches(*event)) {
+                subscriber->deliver(event);
+            }
+        }
+    }
+}
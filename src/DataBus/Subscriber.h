@@ -0,0 +1,113 @@
+/*
+ * Filename: d:\HeavenGate\src\DataBus\Subscriber.h
+ * Path: d:\HeavenGate\src\DataBus
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "BusEvent.h"
+#include "EventFilter.h"
+#include "EventPool.h"
+#include "../common/RingBuffer.h"
+#include "subscriptionID.h"
+#include "../common/Confparcer.h"
+#include "../Metrics/LatencyHistogram.h"
+
+// Where a subscriber's callback runs
+enum class DeliveryMode {
+    INLINE,    // on the bus worker, for cheap non-blocking handlers
+    DEDICATED, // on the subscriber's own thread behind a bounded queue
+    EXECUTOR   // posted to an executor, the shared Runtime unless one is supplied
+};
+
+// Runs a task somewhere else, e.g. [&io](auto task) { asio::post(io, std::move(task)); }
+using Executor = std::function<void(std::function<void()>)>;
+
+struct SubscribeOptions {
+    DeliveryMode mode{DeliveryMode::INLINE};
+    Executor executor;         // EXECUTOR only, empty means Runtime::the()
+    size_t queue_capacity{0};  // DEDICATED only, 0 takes BUS_SUBSCRIBER_QUEUE_SIZE
+    std::string name;          // metrics label, defaults to the subscription id
+    EventFilter filter;        // evaluated by the dispatcher, before any queueing
+};
+
+class Subscriber : public std::enable_shared_from_this<Subscriber> {
+public:
+    using Ptr = std::shared_ptr<Subscriber>;
+    using EventPtr = EventPool::Ref;
+
+    static size_t QUEUE_CAPACITY() {
+        static size_t value = Confparcer::SETTING<size_t>("BUS_SUBSCRIBER_QUEUE_SIZE", 1024);
+        return value;
+    }
+
+    // Handler exceptions are counted locally and in `error_sink`
+    Subscriber(SubscriptionId id, BusEventType type, EventCallback callback,
+               SubscribeOptions options, std::atomic<uint64_t>& error_sink);
+    ~Subscriber();
+
+    Subscriber(const Subscriber&) = delete;
+    Subscriber& operator=(const Subscriber&) = delete;
+
+    void start();
+    // No callback starts after stop() returns, except when called from the handler itself
+    void stop();
+    void deliver(const EventPtr& event);
+
+    SubscriptionId id() const { return id_; }
+    BusEventType type() const { return type_; }
+    DeliveryMode mode() const { return options_.mode; }
+    const std::string& name() const { return options_.name; }
+    const EventFilter& filter() const { return options_.filter; }
+
+    std::atomic<uint64_t> delivered{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<uint64_t> errors{0};
+    // Event timestamp -> handler start, includes any queueing
+    metrics::LatencyHistogram lag;
+    metrics::LatencyHistogram handler_time;
+
+private:
+    SubscriptionId id_;
+    BusEventType type_;
+    EventCallback callback_;
+    SubscribeOptions options_;
+    std::atomic<uint64_t>& error_sink_;
+    std::atomic<bool> active_{true};
+
+    RingBuffer<EventPtr> queue_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::thread thread_;
+
+    void invoke(const Event& event);
+    void run_queue();
+};
+
+// Immutable per-type dispatch table, rebuilt copy-on-write by DataBus.
+// Subscribers whose filter has an exact-match clause are bucketed by that
+// field's value; the rest are scanned.
+struct SubscriberTable {
+    std::vector<Subscriber::Ptr> all;
+    std::vector<Subscriber::Ptr> scanned;
+    // field -> canonical value -> subscribers
+    std::unordered_map<std::string, std::unordered_map<std::string, std::vector<Subscriber::Ptr>>> indexed;
+
+    void add(const Subscriber::Ptr& subscriber);
+    // Delivers to every subscriber whose filter matches
+    void dispatch(const Subscriber::EventPtr& event) const;
+};
@@ -0,0 +1,136 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\BackendRegistry.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "BackendRegistry.h"
+#include "LoadBalancer.h"
+#include "../common/logger.h"
+
+BackendRegistry::BackendRegistry(size_t capacity)
+    : capacity_(capacity),
+      nodes_(new std::shared_ptr<BackendNode>[capacity]),
+      healthy_(new std::atomic<uint8_t>[capacity]),
+      weights_(new float[capacity]()),
+      load_(new LoadCell[capacity]),
+      names_(std::make_shared<const NameIndex>()),
+      real_pool_(std::make_shared<const BackendPool>()),
+      honeypot_pool_(std::make_shared<const BackendPool>()) {
+    GroupTable groups;
+    find_or_add_group(groups, DEFAULT_BACKEND_GROUP_NAME);
+    groups_ = std::make_shared<const GroupTable>(std::move(groups));
+    for (size_t i = 0; i < capacity_; ++i) {
+        healthy_[i].store(1, std::memory_order_relaxed);
+    }
+}
+
+BackendId BackendRegistry::add(const std::shared_ptr<BackendNode>& node) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+
+    size_t index = size_.load(std::memory_order_relaxed);
+    if (index >= capacity_) {
+        LOG_ERROR("Backend registry is full (" + std::to_string(capacity_) + "), rejecting " + node->id);
+        return INVALID_BACKEND_ID;
+    }
+
+    auto names = std::atomic_load(&names_);
+    if (names->count(node->id)) {
+        LOG_ERROR("Backend " + node->id + " is already registered");
+        return INVALID_BACKEND_ID;
+    }
+
+    BackendId id = static_cast<BackendId>(index);
+    node->backend_id = id;
+    nodes_[id] = node;
+    weights_[id] = node->weight;
+    healthy_[id].store(1, std::memory_order_relaxed);
+    load_[id].last_request_ns.store(
+        std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+
+    auto updated_names = std::make_shared<NameIndex>(*names);
+    updated_names->emplace(node->id, id);
+
+    auto& pool_slot = node->is_honeypot ? honeypot_pool_ : real_pool_;
+    auto updated_pool = std::make_shared<BackendPool>(*std::atomic_load(&pool_slot));
+    updated_pool->push_back(id);
+
+    auto updated_groups = std::make_shared<GroupTable>(*std::atomic_load(&groups_));
+    auto& group_slot = updated_groups->pools[find_or_add_group(*updated_groups, node->group)][node->is_honeypot];
+    auto updated_group_pool = std::make_shared<BackendPool>(*group_slot);
+    updated_group_pool->push_back(id);
+    group_slot = std::move(updated_group_pool);
+
+    // Publish the slot before the new size, readers never look past size()
+    size_.store(index + 1, std::memory_order_release);
+    std::atomic_store(&names_, std::shared_ptr<const NameIndex>(std::move(updated_names)));
+    std::atomic_store(&pool_slot, std::shared_ptr<const BackendPool>(std::move(updated_pool)));
+    std::atomic_store(&groups_, std::shared_ptr<const GroupTable>(std::move(updated_groups)));
+
+    return id;
+}
+
+BackendId BackendRegistry::find(const std::string& name) const {
+    auto names = std::atomic_load(&names_);
+    auto it = names->find(name);
+    return it != names->end() ? it->second : INVALID_BACKEND_ID;
+}
+
+std::shared_ptr<const BackendPool> BackendRegistry::pool(bool honeypot) const {
+    return std::atomic_load(honeypot ? &honeypot_pool_ : &real_pool_);
+}
+
+std::shared_ptr<const BackendPool> BackendRegistry::pool(BackendGroupId group, bool honeypot) const {
+    auto groups = std::atomic_load(&groups_);
+    return groups->pools[group][honeypot ? 1 : 0];
+}
+
+std::optional<BackendGroupId> BackendRegistry::find_group(const std::string& name) const {
+    auto groups = std::atomic_load(&groups_);
+    for (size_t i = 0; i < groups->names.size(); ++i) {
+        if (groups->names[i] == name) return static_cast<BackendGroupId>(i);
+    }
+    return std::nullopt;
+}
+
+BackendGroupId BackendRegistry::group(const std::string& name) {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto groups = std::atomic_load(&groups_);
+    for (size_t i = 0; i < groups->names.size(); ++i) {
+        if (groups->names[i] == name) return static_cast<BackendGroupId>(i);
+    }
+    auto updated_groups = std::make_shared<GroupTable>(*groups);
+    BackendGroupId id = find_or_add_group(*updated_groups, name);
+    std::atomic_store(&groups_, std::shared_ptr<const GroupTable>(std::move(updated_groups)));
+    return id;
+}
+
+BackendGroupId BackendRegistry::find_or_add_group(GroupTable& table, const std::string& name) {
+    for (size_t i = 0; i < table.names.size(); ++i) {
+        if (table.names[i] == name) return static_cast<BackendGroupId>(i);
+    }
+    table.names.push_back(name);
+    table.pools.push_back({std::make_shared<const BackendPool>(), std::make_shared<const BackendPool>()});
+    return static_cast<BackendGroupId>(table.names.size() - 1);
+}
+
+std::chrono::steady_clock::time_point BackendRegistry::last_request_time(BackendId id) const {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::steady_clock::duration(load_[id].last_request_ns.load(std::memory_order_relaxed)));
+}
+
+void BackendRegistry::acquire(BackendId id) {
+    LoadCell& cell = load_[id];
+    cell.current_clients.fetch_add(1, std::memory_order_relaxed);
+    cell.total_requests.fetch_add(1, std::memory_order_relaxed);
+    cell.last_request_ns.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                               std::memory_order_relaxed);
+}
+
+void BackendRegistry::touch(BackendId id) {
+    load_[id].last_request_ns.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                    std::memory_order_relaxed);
+}
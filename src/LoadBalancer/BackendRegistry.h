@@ -0,0 +1,125 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\BackendRegistry.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#ifndef BACKENDREGISTRY_H
+#define BACKENDREGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "../Metrics/ThreadShard.h"
+#include "../common/Confparcer.h"
+
+class BackendNode;
+
+// Dense backend index, assigned in registration order and never reused
+using BackendId = uint32_t;
+constexpr BackendId INVALID_BACKEND_ID = std::numeric_limits<BackendId>::max();
+
+using BackendPool = std::vector<BackendId>;
+
+// Dense index of a named set of backends that a listener routes to
+using BackendGroupId = uint32_t;
+constexpr BackendGroupId DEFAULT_BACKEND_GROUP = 0;
+constexpr const char* DEFAULT_BACKEND_GROUP_NAME = "default";
+
+// Table of all backends, indexed by BackendId. Capacity is fixed at construction
+// so every array can be read without locks; only registration is serialized.
+//
+// Per-backend hot state is kept as a struct of arrays: health flags are packed so
+// a selection scan touches a few cache lines, while the counters written on every
+// connection get one cache line per backend to avoid false sharing.
+class BackendRegistry {
+public:
+    static size_t CAPACITY() {
+        static size_t value = Confparcer::SETTING<size_t>("MAX_BACKENDS", 4096);
+        return value;
+    }
+
+    explicit BackendRegistry(size_t capacity = CAPACITY());
+
+    BackendRegistry(const BackendRegistry&) = delete;
+    BackendRegistry& operator=(const BackendRegistry&) = delete;
+
+    // Returns INVALID_BACKEND_ID if the registry is full or the name is taken
+    BackendId add(const std::shared_ptr<BackendNode>& node);
+    BackendId find(const std::string& name) const;
+
+    size_t size() const { return size_.load(std::memory_order_acquire); }
+    size_t capacity() const { return capacity_; }
+    bool contains(BackendId id) const { return id < size(); }
+
+    const std::shared_ptr<BackendNode>& node(BackendId id) const { return nodes_[id]; }
+    // Every backend of the kind, whatever its group
+    std::shared_ptr<const BackendPool> pool(bool honeypot) const;
+    std::shared_ptr<const BackendPool> pool(BackendGroupId group, bool honeypot) const;
+
+    // Finds or creates the group; a group may be named before its backends are added
+    BackendGroupId group(const std::string& name);
+    // No value when no backend or listener has named the group
+    std::optional<BackendGroupId> find_group(const std::string& name) const;
+
+    bool is_healthy(BackendId id) const { return healthy_[id].load(std::memory_order_relaxed) != 0; }
+    void set_healthy(BackendId id, bool healthy) { healthy_[id].store(healthy ? 1 : 0, std::memory_order_relaxed); }
+    float weight(BackendId id) const { return weights_[id]; }
+
+    int current_clients(BackendId id) const { return load_[id].current_clients.load(std::memory_order_relaxed); }
+    long total_requests(BackendId id) const { return load_[id].total_requests.load(std::memory_order_relaxed); }
+    std::chrono::steady_clock::time_point last_request_time(BackendId id) const;
+
+    // A connection was routed to the backend
+    void acquire(BackendId id);
+    // A connection assigned earlier is reusing the backend
+    void attach(BackendId id) { load_[id].current_clients.fetch_add(1, std::memory_order_relaxed); }
+    void release(BackendId id) { load_[id].current_clients.fetch_sub(1, std::memory_order_relaxed); }
+    void touch(BackendId id);
+
+private:
+    struct alignas(metrics::kCacheLineSize) LoadCell {
+        std::atomic<int> current_clients{0};
+        std::atomic<long> total_requests{0};
+        std::atomic<int64_t> last_request_ns{0};
+    };
+
+    using NameIndex = std::unordered_map<std::string, BackendId>;
+
+    struct GroupTable {
+        std::vector<std::string> names;
+        // [group][honeypot]
+        std::vector<std::array<std::shared_ptr<const BackendPool>, 2>> pools;
+    };
+
+    // Index of `name` in `table`, appended with empty pools when missing
+    static BackendGroupId find_or_add_group(GroupTable& table, const std::string& name);
+
+    const size_t capacity_;
+    std::atomic<size_t> size_{0};
+
+    std::unique_ptr<std::shared_ptr<BackendNode>[]> nodes_;
+    std::unique_ptr<std::atomic<uint8_t>[]> healthy_;
+    std::unique_ptr<float[]> weights_;
+    std::unique_ptr<LoadCell[]> load_;
+
+    // Copy-on-write, swapped under write_mutex_ and read with atomic_load
+    std::shared_ptr<const NameIndex> names_;
+    std::shared_ptr<const BackendPool> real_pool_;
+    std::shared_ptr<const BackendPool> honeypot_pool_;
+    std::shared_ptr<const GroupTable> groups_;
+    std::mutex write_mutex_;
+};
+
+#endif // BACKENDREGISTRY_H
@@ -0,0 +1,169 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ClientFeatures.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "ClientFeatures.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+
+namespace {
+
+int64_t steady_now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint32_t saturate(double estimate) {
+    return static_cast<uint32_t>(std::min(std::round(estimate), double{std::numeric_limits<uint32_t>::max()}));
+}
+
+} // namespace
+
+ClientFeatureStore::Window::Window(size_t sketch_width, size_t distinct_width)
+    : connections(sketch_width), requests(sketch_width), short_connections(sketch_width),
+      ports(distinct_width), paths(distinct_width) {}
+
+void ClientFeatureStore::Window::clear() {
+    connections.clear();
+    requests.clear();
+    short_connections.clear();
+    ports.clear();
+    paths.clear();
+    busiest.clear();
+}
+
+ClientFeatureStore::ClientFeatureStore(size_t shards)
+    : seed_((uint64_t{std::random_device{}()} << 32) | std::random_device{}()), window_started_(steady_now()) {
+    shards = std::clamp<size_t>(shards, 1, metrics::kMaxShards);
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        for (auto& window : shard->windows) {
+            window = std::make_unique<Window>(SKETCH_WIDTH(), DISTINCT_WIDTH());
+        }
+        shards_.push_back(std::move(shard));
+    }
+}
+
+uint64_t ClientFeatureStore::hash(std::string_view text) const {
+    return sketch::mix(std::hash<std::string_view>{}(text) ^ seed_);
+}
+
+void ClientFeatureStore::record_connection(std::string_view client_ip, uint16_t port) {
+    uint64_t client = hash(client_ip);
+    uint64_t port_hash = sketch::mix(port ^ seed_);
+    Shard& shard = local_shard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    Window& window = shard.window();
+    window.connections.add(client);
+    window.ports.add(client, port_hash);
+    window.busiest.add(client);
+}
+
+void ClientFeatureStore::record_close(std::string_view client_ip, std::chrono::steady_clock::duration lifetime) {
+    if (lifetime >= SHORT_CONNECTION()) return;
+    uint64_t client = hash(client_ip);
+    Shard& shard = local_shard();
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.window().short_connections.add(client);
+}
+
+ClientFeatures ClientFeatureStore::record_request(std::string_view client_ip, std::string_view path) {
+    uint64_t client = hash(client_ip);
+    // The query string does not make a path distinct
+    path = path.substr(0, path.find('?'));
+    uint64_t path_hash = path.empty() ? 0 : hash(path);
+    {
+        Shard& shard = local_shard();
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Window& window = shard.window();
+        window.requests.add(client);
+        if (!path.empty()) window.paths.add(client, path_hash);
+    }
+    return merge(client);
+}
+
+ClientFeatures ClientFeatureStore::features(std::string_view client_ip) const {
+    return merge(hash(client_ip));
+}
+
+ClientFeatures ClientFeatureStore::merge(uint64_t client) const {
+    constexpr size_t CM_DEPTH = sketch::CountMin::DEPTH;
+    constexpr size_t DISTINCT_DEPTH = Distinct::DEPTH;
+    std::array<uint64_t, CM_DEPTH> connections{}, requests{}, short_connections{};
+    std::array<Distinct::Cell, DISTINCT_DEPTH> ports{}, paths{};
+    uint64_t busiest_count = 0;
+    uint64_t busiest_total = 0;
+
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (const auto& window : shard->windows) {
+            for (size_t row = 0; row < CM_DEPTH; ++row) {
+                connections[row] += window->connections.counter(client, row);
+                requests[row] += window->requests.counter(client, row);
+                short_connections[row] += window->short_connections.counter(client, row);
+            }
+            for (size_t row = 0; row < DISTINCT_DEPTH; ++row) {
+                ports[row].merge(window->ports.cell(client, row));
+                paths[row].merge(window->paths.cell(client, row));
+            }
+            if (const auto* entry = window->busiest.find(client)) {
+                busiest_count += entry->count - entry->error;
+            }
+            busiest_total += window->busiest.total();
+        }
+    }
+
+    auto smallest = [](const auto& rows) {
+        return static_cast<uint32_t>(std::min<uint64_t>(*std::min_element(rows.begin(), rows.end()),
+                                                        std::numeric_limits<uint32_t>::max()));
+    };
+    auto distinct = [](const auto& rows) {
+        double estimate = rows[0].estimate();
+        for (size_t row = 1; row < rows.size(); ++row) {
+            estimate = std::min(estimate, rows[row].estimate());
+        }
+        return saturate(estimate);
+    };
+
+    ClientFeatures features;
+    double elapsed = static_cast<double>(steady_now() - window_started_.load(std::memory_order_relaxed)) / 1e9;
+    features.span_s = elapsed + (has_previous_.load(std::memory_order_relaxed) ? WINDOW().count() : 0);
+    features.connections = smallest(connections);
+    features.requests = smallest(requests);
+    features.short_connections = smallest(short_connections);
+    features.distinct_ports = distinct(ports);
+    features.distinct_paths = distinct(paths);
+    if (busiest_total != 0) {
+        // From the guaranteed counts: a client that merely took over an evicted entry has none
+        features.connection_share = static_cast<double>(busiest_count) / static_cast<double>(busiest_total);
+    }
+    return features;
+}
+
+void ClientFeatureStore::rotate() {
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->current ^= 1;
+        shard->window().clear();
+    }
+    window_started_.store(steady_now(), std::memory_order_relaxed);
+    has_previous_.store(true, std::memory_order_relaxed);
+}
+
+size_t ClientFeatureStore::memory_bytes() const {
+    const Window& window = *shards_.front()->windows.front();
+    size_t per_window = window.connections.memory_bytes() + window.requests.memory_bytes() +
+                        window.short_connections.memory_bytes() + window.ports.memory_bytes() +
+                        window.paths.memory_bytes() + sizeof(Window);
+    return shards_.size() * (sizeof(Shard) + 2 * per_window);
+}
@@ -0,0 +1,124 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ClientFeatures.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include "../common/Confparcer.h"
+#include "../common/Sketches.h"
+#include "../Metrics/ThreadShard.h"
+
+// What a client did recently, across every listener, as estimated by
+// ClientFeatureStore. Counts may be too high when clients collide in the
+// sketches, never too low.
+struct ClientFeatures {
+    // Seconds of activity the counts cover, between one and two windows
+    double span_s{0};
+    uint32_t connections{0};
+    uint32_t requests{0};
+    // Connections closed within SHORT_CONNECTION() of their accept
+    uint32_t short_connections{0};
+    uint32_t distinct_ports{0};
+    uint32_t distinct_paths{0};
+    // Share of all accepted connections, counting only what the client is
+    // known to have made; 0 unless it is among the HEAVY_HITTERS busiest
+    double connection_share{0};
+};
+
+// Per-client behaviour in fixed memory, whatever the number of clients: count-min
+// sketches for connection, request and short-connection counts, HyperLogLog
+// cells for distinct ports and paths, and a space-saving list of the busiest
+// clients. Each is kept for the current and the previous window, rotate() drops
+// the older one.
+//
+// Updates go to the calling thread's shard, so I/O threads do not share cache
+// lines; reads merge every shard. A shard has a lock, uncontended unless more
+// threads than shards update the store.
+class ClientFeatureStore {
+public:
+    static constexpr size_t HEAVY_HITTERS = 64;
+
+    // Counters per count-min row
+    static size_t SKETCH_WIDTH() {
+        static size_t value = Confparcer::SETTING<size_t>("FEATURES_SKETCH_WIDTH", 4096);
+        return value;
+    }
+    // HyperLogLog cells per row, 64 bytes each
+    static size_t DISTINCT_WIDTH() {
+        static size_t value = Confparcer::SETTING<size_t>("FEATURES_DISTINCT_WIDTH", 512);
+        return value;
+    }
+    static std::chrono::seconds WINDOW() {
+        static std::chrono::seconds value(Confparcer::SETTING<size_t>("FEATURES_WINDOW_S", 60));
+        return value;
+    }
+    static std::chrono::milliseconds SHORT_CONNECTION() {
+        static std::chrono::milliseconds value(Confparcer::SETTING<size_t>("FEATURES_SHORT_CONNECTION_MS", 1000));
+        return value;
+    }
+
+    // `shards` is capped at metrics::kMaxShards
+    explicit ClientFeatureStore(size_t shards);
+
+    ClientFeatureStore(const ClientFeatureStore&) = delete;
+    ClientFeatureStore& operator=(const ClientFeatureStore&) = delete;
+
+    void record_connection(std::string_view client_ip, uint16_t port);
+    void record_close(std::string_view client_ip, std::chrono::steady_clock::duration lifetime);
+    // Counts the request, `path` may be empty, and returns the client's features
+    // including it
+    ClientFeatures record_request(std::string_view client_ip, std::string_view path);
+    ClientFeatures features(std::string_view client_ip) const;
+
+    // Starts a new window; called every WINDOW()
+    void rotate();
+
+    size_t memory_bytes() const;
+
+private:
+    using Distinct = sketch::DistinctCount<6>;
+
+    struct Window {
+        sketch::CountMin connections;
+        sketch::CountMin requests;
+        sketch::CountMin short_connections;
+        Distinct ports;
+        Distinct paths;
+        sketch::SpaceSaving<HEAVY_HITTERS> busiest;
+
+        Window(size_t sketch_width, size_t distinct_width);
+        void clear();
+    };
+
+    struct alignas(metrics::kCacheLineSize) Shard {
+        mutable std::mutex mutex;
+        std::array<std::unique_ptr<Window>, 2> windows;
+        size_t current{0};
+
+        Window& window() { return *windows[current]; }
+    };
+
+    uint64_t hash(std::string_view text) const;
+    Shard& local_shard() { return *shards_[metrics::thread_shard_index() % shards_.size()]; }
+    ClientFeatures merge(uint64_t client) const;
+
+    // Random per process, so clients cannot pick addresses that collide
+    uint64_t seed_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    // steady_clock nanoseconds when the current window started
+    std::atomic<int64_t> window_started_;
+    std::atomic<bool> has_previous_{false};
+};
@@ -0,0 +1,383 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ClientHello.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "ClientHello.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+namespace {
+
+constexpr uint8_t HANDSHAKE_RECORD = 0x16;
+constexpr uint8_t CLIENT_HELLO = 1;
+constexpr size_t RECORD_HEADER_SIZE = 5;
+constexpr size_t HANDSHAKE_HEADER_SIZE = 4;
+// TLSPlaintext records carry at most 2^14 bytes
+constexpr size_t MAX_RECORD_SIZE = 16384;
+
+constexpr uint16_t SERVER_NAME = 0x0000;
+constexpr uint16_t SUPPORTED_GROUPS = 0x000a;
+constexpr uint16_t EC_POINT_FORMATS = 0x000b;
+constexpr uint16_t SIGNATURE_ALGORITHMS = 0x000d;
+constexpr uint16_t ALPN = 0x0010;
+constexpr uint16_t SUPPORTED_VERSIONS = 0x002b;
+
+// RFC 8701 reserves 0x?a?a with both bytes equal
+bool is_grease(uint16_t value) {
+    return (value & 0x0f0f) == 0x0a0a && (value >> 8) == (value & 0xff);
+}
+
+// Bounds-checked big-endian reads; reading past the end leaves ok false
+struct Reader {
+    const uint8_t* p;
+    const uint8_t* end;
+    bool ok{true};
+
+    size_t left() const { return static_cast<size_t>(end - p); }
+
+    uint8_t u8() {
+        if (left() < 1) return fail();
+        return *p++;
+    }
+
+    uint16_t u16() {
+        if (left() < 2) return fail();
+        uint16_t value = static_cast<uint16_t>(p[0] << 8 | p[1]);
+        p += 2;
+        return value;
+    }
+
+    void skip(size_t length) {
+        if (left() < length) {
+            fail();
+            return;
+        }
+        p += length;
+    }
+
+    // The next `length` bytes as a reader of their own
+    Reader take(size_t length) {
+        if (left() < length) {
+            fail();
+            return Reader{p, p};
+        }
+        Reader part{p, p + length};
+        p += length;
+        return part;
+    }
+
+    std::string_view view() const { return std::string_view(reinterpret_cast<const char*>(p), left()); }
+
+    uint8_t fail() {
+        ok = false;
+        p = end;
+        return 0;
+    }
+};
+
+size_t record_length(const uint8_t* header) {
+    return static_cast<size_t>(header[3] << 8 | header[4]);
+}
+
+// Fingerprints are formatted on the stack and copied out once
+class Text {
+public:
+    // Enough for full cipher, extension, group and signature algorithm lists
+    static constexpr size_t CAPACITY = 4096;
+
+    void put(char c) {
+        if (size_ < CAPACITY) data_[size_++] = c;
+    }
+
+    void put(const char* text) {
+        while (*text) put(*text++);
+    }
+
+    void put_hex4(uint16_t value) {
+        static constexpr char digits[] = "0123456789abcdef";
+        if (size_ + 4 > CAPACITY) return;
+        data_[size_++] = digits[value >> 12];
+        data_[size_++] = digits[(value >> 8) & 0xf];
+        data_[size_++] = digits[(value >> 4) & 0xf];
+        data_[size_++] = digits[value & 0xf];
+    }
+
+    void put_decimal(unsigned value) {
+        auto result = std::to_chars(data_.data() + size_, data_.data() + CAPACITY, value);
+        if (result.ec == std::errc()) size_ = static_cast<size_t>(result.ptr - data_.data());
+    }
+
+    std::string_view view() const { return std::string_view(data_.data(), size_); }
+    void clear() { size_ = 0; }
+
+private:
+    std::array<char, CAPACITY> data_;
+    size_t size_{0};
+};
+
+template<typename List>
+void put_decimal_list(Text& out, const List& list) {
+    for (size_t i = 0; i < list.size; ++i) {
+        if (i) out.put('-');
+        out.put_decimal(list.values[i]);
+    }
+}
+
+void put_hex_list(Text& out, const uint16_t* begin, const uint16_t* end) {
+    for (const uint16_t* value = begin; value != end; ++value) {
+        if (value != begin) out.put(',');
+        out.put_hex4(*value);
+    }
+}
+
+const char* ja4_version(uint16_t version) {
+    switch (version) {
+        case 0x0304: return "13";
+        case 0x0303: return "12";
+        case 0x0302: return "11";
+        case 0x0301: return "10";
+        case 0x0300: return "s3";
+        default: return "00";
+    }
+}
+
+void put_count(Text& out, size_t count) {
+    count = std::min<size_t>(count, 99);
+    out.put(static_cast<char>('0' + count / 10));
+    out.put(static_cast<char>('0' + count % 10));
+}
+
+// First and last character of the first ALPN value; their hex digits when not alphanumeric
+void put_alpn(Text& out, const ClientHello& hello) {
+    if (hello.alpn.empty() || hello.alpn.values[0].empty()) {
+        out.put("00");
+        return;
+    }
+    std::string_view protocol = hello.alpn.values[0];
+    unsigned char first = static_cast<unsigned char>(protocol.front());
+    unsigned char last = static_cast<unsigned char>(protocol.back());
+    if (std::isalnum(first) && std::isalnum(last)) {
+        out.put(static_cast<char>(first));
+        out.put(static_cast<char>(last));
+    } else {
+        static constexpr char digits[] = "0123456789abcdef";
+        out.put(digits[first >> 4]);
+        out.put(digits[last & 0xf]);
+    }
+}
+
+// FNV-1a taking 8 bytes a step, the byte-wise loop is bound by multiply latency
+uint64_t hash_text(std::string_view text) {
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= text.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, text.data() + i, sizeof(word));
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < text.size(); ++i) {
+        hash = (hash ^ static_cast<unsigned char>(text[i])) * 1099511628211ull;
+    }
+    return hash ^ (hash >> 32);
+}
+
+} // namespace
+
+ClientHelloParser::Status ClientHelloParser::parse(const char* data, size_t size) {
+    const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    if (size == 0) return Status::NEED_MORE;
+    // Record type, then the major version of a 3.x record version
+    if (bytes[0] != HANDSHAKE_RECORD || (size > 1 && bytes[1] != 0x03)) return Status::NOT_TLS;
+    if (size < RECORD_HEADER_SIZE) return Status::NEED_MORE;
+
+    size_t first_length = record_length(bytes);
+    if (first_length == 0 || first_length > MAX_RECORD_SIZE) return Status::ERROR;
+    const uint8_t* message = bytes + RECORD_HEADER_SIZE;
+    size_t available = std::min(first_length, size - RECORD_HEADER_SIZE);
+    if (available < HANDSHAKE_HEADER_SIZE) {
+        return available < first_length ? Status::NEED_MORE : Status::ERROR;
+    }
+    if (message[0] != CLIENT_HELLO) return Status::ERROR;
+    size_t message_length = static_cast<size_t>(message[1]) << 16 | static_cast<size_t>(message[2]) << 8 | message[3];
+
+    if (HANDSHAKE_HEADER_SIZE + message_length <= first_length) {
+        // The usual case, parsed in place
+        if (available < HANDSHAKE_HEADER_SIZE + message_length) return Status::NEED_MORE;
+        return parse_body(message + HANDSHAKE_HEADER_SIZE, message_length);
+    }
+
+    // Fragmented over several handshake records: gather the message first
+    size_t needed = HANDSHAKE_HEADER_SIZE + message_length;
+    const uint8_t* record = bytes;
+    const uint8_t* end = bytes + size;
+    fragments_.clear();
+    while (fragments_.size() < needed) {
+        if (static_cast<size_t>(end - record) < RECORD_HEADER_SIZE) return Status::NEED_MORE;
+        size_t length = record_length(record);
+        if (record[0] != HANDSHAKE_RECORD || record[1] != 0x03 || length == 0 || length > MAX_RECORD_SIZE) {
+            return Status::ERROR;
+        }
+        if (static_cast<size_t>(end - record) - RECORD_HEADER_SIZE < length) return Status::NEED_MORE;
+        fragments_.append(reinterpret_cast<const char*>(record) + RECORD_HEADER_SIZE,
+                          std::min(length, needed - fragments_.size()));
+        record += RECORD_HEADER_SIZE + length;
+    }
+    return parse_body(reinterpret_cast<const uint8_t*>(fragments_.data()) + HANDSHAKE_HEADER_SIZE, message_length);
+}
+
+ClientHelloParser::Status ClientHelloParser::parse_body(const uint8_t* data, size_t size) {
+    ClientHello& hello = hello_;
+    hello.ciphers.size = 0;
+    hello.extensions.size = 0;
+    hello.groups.size = 0;
+    hello.point_formats.size = 0;
+    hello.signature_algorithms.size = 0;
+    hello.alpn.size = 0;
+    hello.server_name = {};
+
+    Reader reader{data, data + size};
+    hello.legacy_version = reader.u16();
+    hello.version = hello.legacy_version;
+    reader.skip(32); // random
+    reader.skip(reader.u8()); // legacy_session_id
+
+    Reader ciphers = reader.take(reader.u16());
+    if (ciphers.left() % 2 != 0) return Status::ERROR;
+    while (ciphers.left() != 0) {
+        uint16_t cipher = ciphers.u16();
+        if (!is_grease(cipher)) hello.ciphers.push(cipher);
+    }
+    reader.skip(reader.u8()); // legacy_compression_methods
+    if (!reader.ok) return Status::ERROR;
+    // SSL 3.0 style hellos end here
+    if (reader.left() == 0) return Status::COMPLETE;
+
+    Reader extensions = reader.take(reader.u16());
+    uint16_t highest_version = 0;
+    while (extensions.ok && extensions.left() != 0) {
+        uint16_t type = extensions.u16();
+        Reader body = extensions.take(extensions.u16());
+        if (!extensions.ok) break;
+        if (is_grease(type)) continue;
+        hello.extensions.push(type);
+
+        // A malformed extension body is skipped, it does not change the fingerprint lists
+        switch (type) {
+            case SERVER_NAME: {
+                Reader names = body.take(body.u16());
+                while (names.ok && names.left() != 0) {
+                    uint8_t kind = names.u8();
+                    Reader name = names.take(names.u16());
+                    if (names.ok && kind == 0 && hello.server_name.empty()) hello.server_name = name.view();
+                }
+                break;
+            }
+            case ALPN: {
+                Reader protocols = body.take(body.u16());
+                while (protocols.ok && protocols.left() != 0) {
+                    Reader protocol = protocols.take(protocols.u8());
+                    if (protocols.ok) hello.alpn.push(protocol.view());
+                }
+                break;
+            }
+            case SUPPORTED_GROUPS: {
+                Reader groups = body.take(body.u16());
+                while (groups.left() >= 2) {
+                    uint16_t group = groups.u16();
+                    if (!is_grease(group)) hello.groups.push(group);
+                }
+                break;
+            }
+            case EC_POINT_FORMATS: {
+                Reader formats = body.take(body.u8());
+                while (formats.left() != 0) hello.point_formats.push(formats.u8());
+                break;
+            }
+            case SIGNATURE_ALGORITHMS: {
+                Reader algorithms = body.take(body.u16());
+                while (algorithms.left() >= 2) {
+                    uint16_t algorithm = algorithms.u16();
+                    if (!is_grease(algorithm)) hello.signature_algorithms.push(algorithm);
+                }
+                break;
+            }
+            case SUPPORTED_VERSIONS: {
+                Reader versions = body.take(body.u8());
+                while (versions.left() >= 2) {
+                    uint16_t version = versions.u16();
+                    if (!is_grease(version)) highest_version = std::max(highest_version, version);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    if (!extensions.ok) return Status::ERROR;
+    if (highest_version != 0) hello.version = highest_version;
+    return Status::COMPLETE;
+}
+
+TlsFingerprint TlsFingerprint::from(const ClientHello& hello) {
+    TlsFingerprint fingerprint;
+    Text text;
+
+    text.put_decimal(hello.legacy_version);
+    text.put(',');
+    put_decimal_list(text, hello.ciphers);
+    text.put(',');
+    put_decimal_list(text, hello.extensions);
+    text.put(',');
+    put_decimal_list(text, hello.groups);
+    text.put(',');
+    put_decimal_list(text, hello.point_formats);
+    fingerprint.ja3 = std::string(text.view());
+
+    text.clear();
+    text.put('t');
+    text.put(ja4_version(hello.version));
+    text.put(hello.server_name.empty() ? 'i' : 'd');
+    put_count(text, hello.ciphers.size);
+    put_count(text, hello.extensions.size);
+    put_alpn(text, hello);
+
+    text.put('_');
+    std::array<uint16_t, ClientHello::MAX_CIPHERS> ciphers;
+    uint16_t* ciphers_end = std::copy(hello.ciphers.begin(), hello.ciphers.end(), ciphers.data());
+    std::sort(ciphers.data(), ciphers_end);
+    put_hex_list(text, ciphers.data(), ciphers_end);
+
+    text.put('_');
+    // server_name and ALPN are already in the first part
+    std::array<uint16_t, ClientHello::MAX_EXTENSIONS> extensions;
+    uint16_t* extensions_end = std::copy_if(hello.extensions.begin(), hello.extensions.end(), extensions.data(),
+                                            [](uint16_t type) { return type != SERVER_NAME && type != ALPN; });
+    std::sort(extensions.data(), extensions_end);
+    put_hex_list(text, extensions.data(), extensions_end);
+    if (!hello.signature_algorithms.empty()) {
+        text.put('_');
+        put_hex_list(text, hello.signature_algorithms.begin(), hello.signature_algorithms.end());
+    }
+    fingerprint.ja4_r = std::string(text.view());
+
+    fingerprint.server_name = std::string(hello.server_name);
+    for (std::string_view protocol : hello.alpn) {
+        fingerprint.alpn.emplace_back(protocol);
+    }
+
+    static constexpr char digits[] = "0123456789abcdef";
+    uint64_t hash = hash_text(fingerprint.ja4_r);
+    fingerprint.id.resize(16);
+    for (int i = 15; i >= 0; --i, hash >>= 4) {
+        fingerprint.id[static_cast<size_t>(i)] = digits[hash & 0xf];
+    }
+    return fingerprint;
+}
@@ -0,0 +1,98 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ClientHello.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The fields of a TLS ClientHello that identify the client's TLS stack. GREASE
+// values (RFC 8701) are left out of every list. Views point into the buffer
+// handed to ClientHelloParser::parse(), or into the parser when the message
+// spanned several records, and are valid until either changes.
+struct ClientHello {
+    static constexpr size_t MAX_CIPHERS = 128;
+    static constexpr size_t MAX_EXTENSIONS = 64;
+    static constexpr size_t MAX_GROUPS = 32;
+    static constexpr size_t MAX_POINT_FORMATS = 8;
+    static constexpr size_t MAX_SIGNATURE_ALGORITHMS = 64;
+    static constexpr size_t MAX_ALPN = 8;
+
+    // Fixed capacity, values past it are dropped
+    template<typename T, size_t N>
+    struct List {
+        std::array<T, N> values;
+        size_t size{0};
+
+        void push(T value) {
+            if (size < N) values[size++] = value;
+        }
+        const T* begin() const { return values.data(); }
+        const T* end() const { return values.data() + size; }
+        bool empty() const { return size == 0; }
+    };
+
+    uint16_t legacy_version{0};
+    // Highest entry of supported_versions, legacy_version without it
+    uint16_t version{0};
+    List<uint16_t, MAX_CIPHERS> ciphers;
+    // In the order sent
+    List<uint16_t, MAX_EXTENSIONS> extensions;
+    List<uint16_t, MAX_GROUPS> groups;
+    List<uint8_t, MAX_POINT_FORMATS> point_formats;
+    List<uint16_t, MAX_SIGNATURE_ALGORITHMS> signature_algorithms;
+    List<std::string_view, MAX_ALPN> alpn;
+    // First host_name of server_name, empty without one
+    std::string_view server_name;
+};
+
+// Reads the ClientHello that opens a TLS connection, without terminating TLS,
+// so a pass-through listener still learns who is connecting. parse() takes the
+// client stream from its first byte and is called again, from the first byte,
+// each time more arrives; it does not allocate unless the message is split
+// over several TLS records.
+//  - COMPLETE: hello() describes the message,
+//  - NEED_MORE: the bytes so far are a valid start of a ClientHello,
+//  - NOT_TLS: the stream does not open with a TLS handshake record,
+//  - ERROR: it does, but the ClientHello is malformed.
+class ClientHelloParser {
+public:
+    enum class Status { NEED_MORE, COMPLETE, NOT_TLS, ERROR };
+
+    Status parse(const char* data, size_t size);
+
+    const ClientHello& hello() const { return hello_; }
+
+private:
+    // Parses the handshake message body, after its 4-byte header
+    Status parse_body(const uint8_t* data, size_t size);
+
+    ClientHello hello_;
+    // Handshake bytes gathered from consecutive records
+    std::string fragments_;
+};
+
+// JA3 and JA4 style fingerprints of a ClientHello, in their unhashed forms:
+// the JA3 string before its MD5 and JA4_r, the raw form of JA4. Hashing is
+// left to whoever compares them against fingerprint lists.
+struct TlsFingerprint {
+    // "771,4865-4866,0-23-65281,29-23,0"
+    std::string ja3;
+    // "t13d1516h2_002f,0035,..._0005,000a,..._0403,0804,..."
+    std::string ja4_r;
+    std::string server_name;
+    std::vector<std::string> alpn;
+    // 64-bit hash of ja4_r in hex: a compact key for one client stack
+    std::string id;
+
+    static TlsFingerprint from(const ClientHello& hello);
+};
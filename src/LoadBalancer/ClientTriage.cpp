@@ -0,0 +1,183 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ClientTriage.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "ClientTriage.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include "../../thirdparty/asio/include/asio.hpp"
+#include "../common/logger.h"
+
+namespace {
+
+// IPv4 as ::ffff:a.b.c.d; the prefix length of an IPv4 network grows by 96
+std::optional<std::pair<uint64_t, uint64_t>> address_key(std::string_view text, bool& is_v4) {
+    asio::error_code error;
+    asio::ip::address address = asio::ip::make_address(std::string(text), error);
+    if (error) return std::nullopt;
+
+    asio::ip::address_v6::bytes_type bytes;
+    is_v4 = address.is_v4();
+    if (is_v4) {
+        bytes = asio::ip::make_address_v6(asio::ip::v4_mapped, address.to_v4()).to_bytes();
+    } else {
+        bytes = address.to_v6().to_bytes();
+    }
+    uint64_t high = 0;
+    uint64_t low = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        high = (high << 8) | bytes[i];
+        low = (low << 8) | bytes[i + 8];
+    }
+    return std::make_pair(high, low);
+}
+
+std::string trim(std::string value) {
+    value.erase(0, value.find_first_not_of(" \t"));
+    value.erase(value.find_last_not_of(" \t") + 1);
+    return value;
+}
+
+} // namespace
+
+AddressList::Key AddressList::mask(Key key, unsigned length) {
+    uint64_t high = length >= 64 ? ~uint64_t{0} : length == 0 ? 0 : ~uint64_t{0} << (64 - length);
+    uint64_t low = length <= 64 ? 0 : length >= 128 ? ~uint64_t{0} : ~uint64_t{0} << (128 - length);
+    return {key.first & high, key.second & low};
+}
+
+bool AddressList::add(std::string_view entry, bool is_malicious) {
+    size_t slash = entry.find('/');
+    bool is_v4 = false;
+    auto key = address_key(entry.substr(0, slash), is_v4);
+    if (!key) return false;
+
+    unsigned length = 128;
+    if (slash != std::string_view::npos) {
+        std::string digits(entry.substr(slash + 1));
+        char* end = nullptr;
+        unsigned long value = std::strtoul(digits.c_str(), &end, 10);
+        if (digits.empty() || *end != '\0' || value > (is_v4 ? 32u : 128u)) return false;
+        length = static_cast<unsigned>(value) + (is_v4 ? 96 : 0);
+    }
+
+    auto prefix = std::find_if(prefixes_.begin(), prefixes_.end(),
+                               [length](const Prefix& p) { return p.length <= length; });
+    if (prefix == prefixes_.end() || prefix->length != length) {
+        prefix = prefixes_.insert(prefix, Prefix{length, {}});
+    }
+    auto& entries = prefix->entries;
+    Key masked = mask(*key, length);
+    auto it = std::lower_bound(entries.begin(), entries.end(), masked,
+                               [](const std::pair<Key, bool>& e, const Key& k) { return e.first < k; });
+    if (it != entries.end() && it->first == masked) {
+        it->second = it->second || is_malicious;
+    } else {
+        entries.insert(it, {masked, is_malicious});
+    }
+    return true;
+}
+
+std::optional<bool> AddressList::find(std::string_view address) const {
+    if (prefixes_.empty()) return std::nullopt;
+    bool is_v4 = false;
+    auto key = address_key(address, is_v4);
+    if (!key) return std::nullopt;
+
+    for (const Prefix& prefix : prefixes_) {
+        Key masked = mask(*key, prefix.length);
+        auto it = std::lower_bound(prefix.entries.begin(), prefix.entries.end(), masked,
+                                   [](const std::pair<Key, bool>& e, const Key& k) { return e.first < k; });
+        if (it != prefix.entries.end() && it->first == masked) return it->second;
+    }
+    return std::nullopt;
+}
+
+size_t AddressList::size() const {
+    size_t total = 0;
+    for (const Prefix& prefix : prefixes_) total += prefix.entries.size();
+    return total;
+}
+
+ClientTriage::ClientTriage() {
+    for (bool is_malicious : {false, true}) {
+        std::stringstream stream(is_malicious ? DENY() : ALLOW());
+        std::string entry;
+        while (std::getline(stream, entry, ',')) {
+            entry = trim(entry);
+            if (!entry.empty() && !addresses_.add(entry, is_malicious)) {
+                LOG_WARN(std::string("Invalid network in ") + (is_malicious ? "TRIAGE_DENY" : "TRIAGE_ALLOW") +
+                         ": " + entry);
+            }
+        }
+    }
+    rate_limits_ = MAX_CONNECTION_RATE() > 0 || MAX_REQUEST_RATE() > 0 || MAX_DISTINCT_PORTS() > 0;
+
+    const std::string action = TIMEOUT_ACTION();
+    if (action == "benign") {
+        timeout_verdict_ = false;
+    } else if (action == "malicious") {
+        timeout_verdict_ = true;
+    } else if (action != "close") {
+        LOG_WARN("Unknown CLASSIFICATION_TIMEOUT_ACTION " + action + ", closing unclassified connections");
+    }
+
+    if (!addresses_.empty() || rate_limits_) {
+        LOG_INFO("Triage: " + std::to_string(addresses_.size()) + " listed networks" +
+                 (rate_limits_ ? ", rate limits on" : "") + ", unanswered classifications " +
+                 (timeout_verdict_ ? (*timeout_verdict_ ? "go to honeypots" : "go to real backends") : "close"));
+    }
+}
+
+std::optional<bool> ClientTriage::check_address(const std::string& client_ip) const {
+    return addresses_.find(client_ip);
+}
+
+std::optional<bool> ClientTriage::check_rates(const ClientFeatures& features) const {
+    // Right after startup there is less history than a window, which would
+    // turn a few connections into a high rate
+    double span = std::max(features.span_s, static_cast<double>(ClientFeatureStore::WINDOW().count()));
+    if (MAX_CONNECTION_RATE() > 0 && features.connections / span > MAX_CONNECTION_RATE()) return true;
+    if (MAX_REQUEST_RATE() > 0 && features.requests / span > MAX_REQUEST_RATE()) return true;
+    if (MAX_DISTINCT_PORTS() > 0 && features.distinct_ports > MAX_DISTINCT_PORTS()) return true;
+    return std::nullopt;
+}
+
+void ClientTriage::record(TriageStage stage, std::chrono::steady_clock::duration elapsed) {
+    size_t index = static_cast<size_t>(stage);
+    decisions_[index].increment();
+    latency_[index].record(elapsed);
+}
+
+void ClientTriage::collect_metrics(metrics::OpenMetricsWriter& writer) const {
+    using metrics::MetricType;
+    writer.family("heavengate_lb_triage_decisions", MetricType::COUNTER, "Classifications decided at each stage");
+    for (size_t i = 0; i < TRIAGE_STAGE_COUNT; ++i) {
+        writer.counter("heavengate_lb_triage_decisions", decisions_[i].value(),
+                       {{"stage", stage_to_string(static_cast<TriageStage>(i))}});
+    }
+    writer.family("heavengate_lb_triage_latency_seconds", MetricType::HISTOGRAM, "Time to a decision at each stage");
+    for (size_t i = 0; i < TRIAGE_STAGE_COUNT; ++i) {
+        writer.histogram("heavengate_lb_triage_latency_seconds", latency_[i].snapshot(),
+                         {{"stage", stage_to_string(static_cast<TriageStage>(i))}});
+    }
+}
+
+std::string ClientTriage::stage_to_string(TriageStage stage) {
+    switch (stage) {
+        case TriageStage::ADDRESS_LIST: return "address_list";
+        case TriageStage::RATE_LIMIT: return "rate_limit";
+        case TriageStage::VERDICT_CACHE: return "verdict_cache";
+        case TriageStage::DEEP_INSPECTION: return "deep_inspection";
+        case TriageStage::TIMEOUT_ACTION: return "timeout_action";
+        default: return "unknown";
+    }
+}
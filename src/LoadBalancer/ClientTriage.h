@@ -0,0 +1,134 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ClientTriage.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ClientFeatures.h"
+#include "../common/Confparcer.h"
+#include "../Metrics/LatencyHistogram.h"
+#include "../Metrics/OpenMetrics.h"
+#include "../Metrics/ShardedCounter.h"
+
+// The stages a classification goes through, cheapest first; the first one
+// that decides ends it. The inline ones run on the I/O thread, the classifier
+// gets CLASSIFICATION_TIMEOUT_MS, then CLASSIFICATION_TIMEOUT_ACTION applies.
+enum class TriageStage {
+    ADDRESS_LIST,    // TRIAGE_ALLOW and TRIAGE_DENY
+    RATE_LIMIT,      // TRIAGE_MAX_* over the client's recent behaviour
+    VERDICT_CACHE,   // classified before; TCP listeners only
+    DEEP_INSPECTION, // the classifier's reply over the bus
+    TIMEOUT_ACTION,  // no reply in time
+    COUNT
+};
+
+constexpr size_t TRIAGE_STAGE_COUNT = static_cast<size_t>(TriageStage::COUNT);
+
+struct TriageVerdict {
+    bool is_malicious;
+    // Only DEEP_INSPECTION verdicts are cached and pinned, the others are
+    // taken again for every connection
+    TriageStage stage;
+};
+
+// Addresses and networks with a fixed verdict. The longest matching prefix
+// decides, a deny entry wins over an allow entry of the same length. IPv4 is
+// kept as IPv4-mapped IPv6, so one table serves both.
+class AddressList {
+public:
+    // "10.0.0.0/8", "2001:db8::/32" or a bare address; false when malformed
+    bool add(std::string_view entry, bool is_malicious);
+    std::optional<bool> find(std::string_view address) const;
+    bool empty() const { return prefixes_.empty(); }
+    size_t size() const;
+
+private:
+    using Key = std::pair<uint64_t, uint64_t>;
+
+    struct Prefix {
+        unsigned length;
+        // Sorted by key
+        std::vector<std::pair<Key, bool>> entries;
+    };
+
+    // Longest first
+    std::vector<Prefix> prefixes_;
+
+    static Key mask(Key key, unsigned length);
+};
+
+// The inline stages and the bookkeeping of every stage. Read-only once
+// constructed apart from the counters, so I/O threads share it without locks.
+class ClientTriage {
+public:
+    // Comma-separated networks routed as benign without classification
+    static std::string ALLOW() {
+        static std::string value = Confparcer::SETTING<std::string>("TRIAGE_ALLOW", "");
+        return value;
+    }
+    // Comma-separated networks routed as malicious without classification
+    static std::string DENY() {
+        static std::string value = Confparcer::SETTING<std::string>("TRIAGE_DENY", "");
+        return value;
+    }
+    // Clients over any of these are malicious; 0 disables a limit. Rates are
+    // averaged over ClientFeatureStore's window, so a burst needs a low limit
+    static double MAX_CONNECTION_RATE() {
+        static double value = Confparcer::SETTING<double>("TRIAGE_MAX_CONNECTIONS_PER_S", 0);
+        return value;
+    }
+    static double MAX_REQUEST_RATE() {
+        static double value = Confparcer::SETTING<double>("TRIAGE_MAX_REQUESTS_PER_S", 0);
+        return value;
+    }
+    static size_t MAX_DISTINCT_PORTS() {
+        static size_t value = Confparcer::SETTING<size_t>("TRIAGE_MAX_DISTINCT_PORTS", 0);
+        return value;
+    }
+    // "close", "benign" or "malicious": what a classification the classifier
+    // did not answer in time, or that the bus dropped, turns into
+    static std::string TIMEOUT_ACTION() {
+        static std::string value = Confparcer::SETTING<std::string>("CLASSIFICATION_TIMEOUT_ACTION", "close");
+        return value;
+    }
+
+    ClientTriage();
+
+    ClientTriage(const ClientTriage&) = delete;
+    ClientTriage& operator=(const ClientTriage&) = delete;
+
+    std::optional<bool> check_address(const std::string& client_ip) const;
+    // Malicious when over a limit, no verdict otherwise
+    std::optional<bool> check_rates(const ClientFeatures& features) const;
+    bool has_rate_limits() const { return rate_limits_; }
+    // No value: the connection is closed
+    std::optional<bool> timeout_verdict() const { return timeout_verdict_; }
+
+    void record(TriageStage stage, std::chrono::steady_clock::duration elapsed);
+    void collect_metrics(metrics::OpenMetricsWriter& writer) const;
+
+    static std::string stage_to_string(TriageStage stage);
+
+private:
+    AddressList addresses_;
+    bool rate_limits_{false};
+    std::optional<bool> timeout_verdict_;
+
+    std::array<metrics::ShardedCounter, TRIAGE_STAGE_COUNT> decisions_;
+    // Time to the decision: from accept or the request head for the inline
+    // stages, from the request to the classifier for the others
+    std::array<metrics::LatencyHistogram, TRIAGE_STAGE_COUNT> latency_;
+};
@@ -0,0 +1,478 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\HttpParser.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "HttpParser.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HG_HTTP_SSE2 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+#if HG_HTTP_SSE2
+inline unsigned lowest_bit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+// RFC 9110 tchar, the bytes allowed in methods and header names
+struct TokenTable {
+    bool allowed[256]{};
+
+    constexpr TokenTable() {
+        for (int c = '0'; c <= '9'; ++c) allowed[c] = true;
+        for (int c = 'a'; c <= 'z'; ++c) allowed[c] = true;
+        for (int c = 'A'; c <= 'Z'; ++c) allowed[c] = true;
+        for (char c : {'!', '#', '$', '%', '&', '\'', '*', '+', '-', '.', '^', '_', '`', '|', '~'}) {
+            allowed[static_cast<unsigned char>(c)] = true;
+        }
+    }
+};
+
+constexpr TokenTable TOKEN;
+
+inline bool is_token(char c) {
+    return TOKEN.allowed[static_cast<unsigned char>(c)];
+}
+
+inline char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool equals_ignore_case(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (lower(a[i]) != lower(b[i])) return false;
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) text.remove_suffix(1);
+    return text;
+}
+
+// Calls `visit` with each trimmed, non-empty element of a comma-separated list
+template<typename Visit>
+void for_each_element(std::string_view list, Visit visit) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view element = trim(list.substr(0, comma));
+        if (!element.empty()) visit(element);
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+}
+
+// First '\n' in [p, end), or end
+const char* find_newline(const char* p, const char* end) {
+#if HG_HTTP_SSE2
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (; end - p >= 16; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+        if (mask != 0) return p + lowest_bit(mask);
+    }
+#endif
+    for (; p < end; ++p) {
+        if (*p == '\n') return p;
+    }
+    return end;
+}
+
+// First control byte or DEL in [p, end), or end. Field values allow HTAB and
+// SP; a request target stops at SP as well. Sixteen bytes per step with SSE2.
+template<bool STOP_AT_SPACE>
+const char* find_control(const char* p, const char* end) {
+#if HG_HTTP_SSE2
+    // Bytes at or above the threshold (unsigned) are printable
+    const __m128i threshold = _mm_set1_epi8(STOP_AT_SPACE ? 0x21 : 0x20);
+    const __m128i del = _mm_set1_epi8(0x7f);
+    const __m128i tab = _mm_set1_epi8('\t');
+    for (; end - p >= 16; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i printable = _mm_cmpeq_epi8(_mm_max_epu8(block, threshold), block);
+        unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(printable)) & 0xffffu;
+        mask |= static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, del)));
+        if (!STOP_AT_SPACE) {
+            mask &= ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, tab)));
+        }
+        if (mask != 0) return p + lowest_bit(mask);
+    }
+#endif
+    for (; p < end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == 0x7f) return p;
+        if (STOP_AT_SPACE ? c <= 0x20 : (c < 0x20 && c != '\t')) return p;
+    }
+    return end;
+}
+
+// Consumes CRLF or a bare LF
+bool skip_line_end(const char*& p, const char* end) {
+    if (p < end && *p == '\r') ++p;
+    if (p < end && *p == '\n') {
+        ++p;
+        return true;
+    }
+    return false;
+}
+
+bool parse_decimal(std::string_view text, uint64_t& value) {
+    if (text.empty()) return false;
+    uint64_t result = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        uint64_t digit = static_cast<uint64_t>(c - '0');
+        if (result > (std::numeric_limits<uint64_t>::max() - digit) / 10) return false;
+        result = result * 10 + digit;
+    }
+    value = result;
+    return true;
+}
+
+int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+} // namespace
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    for (size_t i = 0; i < header_count; ++i) {
+        if (equals_ignore_case(headers[i].name, name)) return headers[i].value;
+    }
+    return {};
+}
+
+bool HttpRequest::has_header(std::string_view name) const {
+    for (size_t i = 0; i < header_count; ++i) {
+        if (equals_ignore_case(headers[i].name, name)) return true;
+    }
+    return false;
+}
+
+void HttpRequestParser::reset() {
+    state_ = State::HEAD;
+    error_ = HttpError::NONE;
+    scanned_ = 0;
+    remaining_ = 0;
+    chunk_has_digits_ = false;
+    trailer_bytes_ = 0;
+}
+
+HttpRequestParser::Result HttpRequestParser::parse(const char* data, size_t size) {
+    switch (state_) {
+        case State::HEAD:
+            return parse_head(data, size);
+        case State::BODY: {
+            size_t taken = static_cast<size_t>(std::min<uint64_t>(remaining_, size));
+            remaining_ -= taken;
+            if (remaining_ != 0) return {Status::NEED_MORE, taken};
+            state_ = State::HEAD;
+            return {Status::MESSAGE_COMPLETE, taken};
+        }
+        case State::TUNNEL:
+            return {Status::NEED_MORE, size};
+        case State::FAILED:
+            return {Status::ERROR, 0};
+        default:
+            return parse_chunked(data, size);
+    }
+}
+
+HttpRequestParser::Result HttpRequestParser::parse_head(const char* data, size_t size) {
+    // Resume the search for the blank line where the last call stopped; the
+    // two bytes before it may start a terminator split across reads
+    const char* end = data + size;
+    const char* p = data + std::min(scanned_, size);
+    const char* head_end = nullptr;
+    while (p < end) {
+        const char* newline = find_newline(p, end);
+        if (newline == end) break;
+        const char* next = newline + 1;
+        if (next < end && *next == '\r') ++next;
+        if (next < end && *next == '\n') {
+            head_end = next + 1;
+            break;
+        }
+        if (next >= end) break;
+        p = newline + 1;
+    }
+
+    if (!head_end) {
+        scanned_ = size >= 2 ? size - 2 : 0;
+        return {Status::NEED_MORE, 0};
+    }
+
+    scanned_ = 0;
+    size_t head_length = static_cast<size_t>(head_end - data);
+    HttpError error = parse_head_fields(data, head_length);
+    if (error != HttpError::NONE) return fail(error);
+
+    request_.head_length = head_length;
+    state_ = body_state();
+    if (state_ == State::BODY) remaining_ = request_.content_length;
+    return {Status::HEAD_COMPLETE, head_length};
+}
+
+HttpError HttpRequestParser::parse_head_fields(const char* data, size_t size) {
+    const char* p = data;
+    const char* end = data + size;
+    HttpRequest& request = request_;
+    request.header_count = 0;
+    request.host = {};
+    request.content_length = 0;
+    request.chunked = false;
+    request.upgrade = false;
+
+    // A client may send an empty line before the request line
+    while (p < end && (*p == '\r' || *p == '\n')) ++p;
+
+    const char* method = p;
+    while (p < end && is_token(*p)) ++p;
+    if (p == method || p == end || *p != ' ') return HttpError::BAD_REQUEST_LINE;
+    request.method = std::string_view(method, static_cast<size_t>(p - method));
+    ++p;
+
+    const char* target = p;
+    p = find_control<true>(p, end);
+    if (p == target || p == end || *p != ' ') return HttpError::BAD_REQUEST_LINE;
+    request.target = std::string_view(target, static_cast<size_t>(p - target));
+    ++p;
+
+    static constexpr std::string_view VERSION_PREFIX = "HTTP/1.";
+    if (static_cast<size_t>(end - p) < VERSION_PREFIX.size() + 1 ||
+        std::string_view(p, VERSION_PREFIX.size()) != VERSION_PREFIX) {
+        return HttpError::BAD_VERSION;
+    }
+    p += VERSION_PREFIX.size();
+    if (*p != '0' && *p != '1') return HttpError::BAD_VERSION;
+    request.minor_version = *p - '0';
+    ++p;
+    if (!skip_line_end(p, end)) return HttpError::BAD_REQUEST_LINE;
+
+    bool has_content_length = false;
+    bool has_transfer_encoding = false;
+    bool connection_close = false;
+    bool connection_keep_alive = false;
+    bool connection_upgrade = false;
+    bool has_upgrade = false;
+
+    for (;;) {
+        if (p < end && (*p == '\r' || *p == '\n')) {
+            if (!skip_line_end(p, end)) return HttpError::BAD_HEADER;
+            break;
+        }
+        // Obsolete line folding is rejected rather than unfolded
+        if (p == end || *p == ' ' || *p == '\t') return HttpError::BAD_HEADER;
+
+        const char* name = p;
+        while (p < end && is_token(*p)) ++p;
+        if (p == name || p == end || *p != ':') return HttpError::BAD_HEADER;
+        std::string_view header_name(name, static_cast<size_t>(p - name));
+        ++p;
+
+        const char* value = p;
+        p = find_control<false>(p, end);
+        std::string_view header_value = trim(std::string_view(value, static_cast<size_t>(p - value)));
+        if (!skip_line_end(p, end)) return HttpError::BAD_HEADER;
+
+        if (request.header_count == HttpRequest::MAX_HEADERS) return HttpError::TOO_MANY_HEADERS;
+        request.headers[request.header_count++] = HttpHeader{header_name, header_value};
+
+        if (equals_ignore_case(header_name, "content-length")) {
+            // Repeats are allowed only when every value agrees
+            bool valid = true;
+            for_each_element(header_value, [&](std::string_view element) {
+                uint64_t length = 0;
+                if (!parse_decimal(element, length) ||
+                    (has_content_length && length != request.content_length)) {
+                    valid = false;
+                    return;
+                }
+                request.content_length = length;
+                has_content_length = true;
+            });
+            if (!valid || !has_content_length) return HttpError::BAD_CONTENT_LENGTH;
+        } else if (equals_ignore_case(header_name, "transfer-encoding")) {
+            has_transfer_encoding = true;
+            request.chunked = false;
+            for_each_element(header_value, [&](std::string_view coding) {
+                request.chunked = equals_ignore_case(coding, "chunked");
+            });
+        } else if (equals_ignore_case(header_name, "connection")) {
+            for_each_element(header_value, [&](std::string_view option) {
+                connection_close |= equals_ignore_case(option, "close");
+                connection_keep_alive |= equals_ignore_case(option, "keep-alive");
+                connection_upgrade |= equals_ignore_case(option, "upgrade");
+            });
+        } else if (equals_ignore_case(header_name, "host")) {
+            if (!request.host.empty()) return HttpError::BAD_HEADER;
+            request.host = header_value;
+        } else if (equals_ignore_case(header_name, "upgrade")) {
+            has_upgrade = !header_value.empty();
+        }
+    }
+
+    // Requests the backend could frame differently from us are refused, not forwarded
+    if (has_transfer_encoding && (!request.chunked || has_content_length)) {
+        return HttpError::BAD_TRANSFER_ENCODING;
+    }
+    if (request.minor_version == 1 && request.host.empty()) return HttpError::BAD_HEADER;
+
+    request.keep_alive = request.minor_version == 1 ? !connection_close : connection_keep_alive;
+    request.upgrade = (connection_upgrade && has_upgrade) || request.method == "CONNECT";
+    return HttpError::NONE;
+}
+
+HttpRequestParser::State HttpRequestParser::body_state() const {
+    if (request_.upgrade) return State::TUNNEL;
+    if (request_.chunked) return State::CHUNK_SIZE;
+    return State::BODY;
+}
+
+HttpRequestParser::Result HttpRequestParser::parse_chunked(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        char c = data[i];
+        switch (state_) {
+            case State::CHUNK_SIZE: {
+                int digit = hex_digit(c);
+                if (digit >= 0) {
+                    if (remaining_ > (std::numeric_limits<uint64_t>::max() >> 4)) return fail(HttpError::BAD_CHUNK);
+                    remaining_ = (remaining_ << 4) | static_cast<uint64_t>(digit);
+                    chunk_has_digits_ = true;
+                    ++i;
+                    break;
+                }
+                if (!chunk_has_digits_) return fail(HttpError::BAD_CHUNK);
+                if (c == ';' || c == ' ' || c == '\t') {
+                    state_ = State::CHUNK_EXTENSION;
+                } else if (c == '\r') {
+                    state_ = State::CHUNK_SIZE_LF;
+                } else if (c == '\n') {
+                    state_ = State::CHUNK_SIZE_LF;
+                    continue;
+                } else {
+                    return fail(HttpError::BAD_CHUNK);
+                }
+                ++i;
+                break;
+            }
+            case State::CHUNK_EXTENSION: {
+                // Extensions are forwarded untouched, only their end matters
+                const char* newline = find_newline(data + i, data + size);
+                i = static_cast<size_t>(newline - data);
+                if (i < size) state_ = State::CHUNK_SIZE_LF;
+                break;
+            }
+            case State::CHUNK_SIZE_LF:
+                if (c != '\n') return fail(HttpError::BAD_CHUNK);
+                ++i;
+                chunk_has_digits_ = false;
+                if (remaining_ == 0) {
+                    state_ = State::TRAILER_START;
+                    trailer_bytes_ = 0;
+                } else {
+                    state_ = State::CHUNK_DATA;
+                }
+                break;
+            case State::CHUNK_DATA: {
+                size_t taken = static_cast<size_t>(std::min<uint64_t>(remaining_, size - i));
+                remaining_ -= taken;
+                i += taken;
+                if (remaining_ == 0) state_ = State::CHUNK_DATA_CR;
+                break;
+            }
+            case State::CHUNK_DATA_CR:
+                if (c == '\r') {
+                    state_ = State::CHUNK_DATA_LF;
+                    ++i;
+                } else if (c == '\n') {
+                    state_ = State::CHUNK_DATA_LF;
+                } else {
+                    return fail(HttpError::BAD_CHUNK);
+                }
+                break;
+            case State::CHUNK_DATA_LF:
+                if (c != '\n') return fail(HttpError::BAD_CHUNK);
+                state_ = State::CHUNK_SIZE;
+                ++i;
+                break;
+            case State::TRAILER_START:
+                if (c == '\r') {
+                    state_ = State::TRAILER_END_LF;
+                    ++i;
+                } else if (c == '\n') {
+                    state_ = State::HEAD;
+                    return {Status::MESSAGE_COMPLETE, i + 1};
+                } else {
+                    state_ = State::TRAILER_LINE;
+                }
+                break;
+            case State::TRAILER_LINE: {
+                const char* newline = find_newline(data + i, data + size);
+                size_t line_end = static_cast<size_t>(newline - data);
+                trailer_bytes_ += line_end - i;
+                if (trailer_bytes_ > MAX_TRAILER_BYTES) return fail(HttpError::TRAILERS_TOO_LARGE);
+                i = line_end;
+                if (i < size) {
+                    state_ = State::TRAILER_START;
+                    ++i;
+                }
+                break;
+            }
+            case State::TRAILER_END_LF:
+                if (c != '\n') return fail(HttpError::BAD_CHUNK);
+                state_ = State::HEAD;
+                return {Status::MESSAGE_COMPLETE, i + 1};
+            default:
+                return fail(HttpError::BAD_CHUNK);
+        }
+    }
+    return {Status::NEED_MORE, size};
+}
+
+HttpRequestParser::Result HttpRequestParser::fail(HttpError error) {
+    state_ = State::FAILED;
+    error_ = error;
+    return {Status::ERROR, 0};
+}
+
+const char* HttpRequestParser::error_to_string(HttpError error) {
+    switch (error) {
+        case HttpError::NONE: return "none";
+        case HttpError::BAD_REQUEST_LINE: return "malformed request line";
+        case HttpError::BAD_VERSION: return "unsupported HTTP version";
+        case HttpError::BAD_HEADER: return "malformed header";
+        case HttpError::TOO_MANY_HEADERS: return "too many headers";
+        case HttpError::BAD_CONTENT_LENGTH: return "invalid Content-Length";
+        case HttpError::BAD_TRANSFER_ENCODING: return "invalid Transfer-Encoding";
+        case HttpError::BAD_CHUNK: return "malformed chunk";
+        case HttpError::TRAILERS_TOO_LARGE: return "trailers too large";
+    }
+    return "unknown";
+}
@@ -0,0 +1,127 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\HttpParser.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+// A parsed request head. Every view points into the buffer handed to
+// HttpRequestParser::parse() and is valid until those bytes are moved.
+struct HttpRequest {
+    static constexpr size_t MAX_HEADERS = 64;
+
+    std::string_view method;
+    std::string_view target;
+    // 0 for HTTP/1.0, 1 for HTTP/1.1
+    int minor_version{1};
+    std::array<HttpHeader, MAX_HEADERS> headers;
+    size_t header_count{0};
+    std::string_view host;
+    // Request line, headers and the blank line
+    size_t head_length{0};
+
+    uint64_t content_length{0};
+    bool chunked{false};
+    bool keep_alive{true};
+    // CONNECT or an Upgrade request: the bytes after the head are not HTTP
+    bool upgrade{false};
+
+    // First header named `name`, compared case-insensitively; empty if absent
+    std::string_view header(std::string_view name) const;
+    bool has_header(std::string_view name) const;
+};
+
+enum class HttpError {
+    NONE,
+    BAD_REQUEST_LINE,
+    BAD_VERSION,
+    BAD_HEADER,
+    TOO_MANY_HEADERS,
+    BAD_CONTENT_LENGTH,
+    BAD_TRANSFER_ENCODING,
+    BAD_CHUNK,
+    TRAILERS_TOO_LARGE,
+};
+
+// Incremental HTTP/1.x request framing over a caller-owned receive buffer. It
+// never copies or allocates: the head is parsed in place once it is complete,
+// bodies (Content-Length or chunked) are only counted, so a proxy learns where
+// each pipelined request starts and ends while forwarding the bytes unchanged.
+//
+// The caller feeds the bytes it has not consumed yet and advances by
+// Result::consumed:
+//  - HEAD_COMPLETE: request() describes the head just consumed,
+//  - MESSAGE_COMPLETE: the request ended, the next call starts a new head,
+//  - NEED_MORE: everything consumed is body; an unfinished head consumes
+//    nothing and must be fed again, from its first byte, with more data,
+//  - ERROR: error() says why; the stream cannot be resynchronised.
+// After an upgrade request every later byte is reported as body.
+class HttpRequestParser {
+public:
+    enum class Status { NEED_MORE, HEAD_COMPLETE, MESSAGE_COMPLETE, ERROR };
+
+    struct Result {
+        Status status;
+        size_t consumed;
+    };
+
+    // Trailer section of a chunked body, longer ones are rejected
+    static constexpr size_t MAX_TRAILER_BYTES = 8192;
+
+    Result parse(const char* data, size_t size);
+
+    const HttpRequest& request() const { return request_; }
+    HttpError error() const { return error_; }
+    // True between messages, when no byte of the next request has been seen
+    bool idle() const { return state_ == State::HEAD && scanned_ == 0; }
+    void reset();
+
+    static const char* error_to_string(HttpError error);
+
+private:
+    enum class State {
+        HEAD,
+        BODY,
+        CHUNK_SIZE,
+        CHUNK_EXTENSION,
+        CHUNK_SIZE_LF,
+        CHUNK_DATA,
+        CHUNK_DATA_CR,
+        CHUNK_DATA_LF,
+        TRAILER_START,
+        TRAILER_LINE,
+        TRAILER_END_LF,
+        TUNNEL,
+        FAILED,
+    };
+
+    Result parse_head(const char* data, size_t size);
+    Result parse_chunked(const char* data, size_t size);
+    HttpError parse_head_fields(const char* data, size_t size);
+    Result fail(HttpError error);
+    // Where the parser goes once the head of request_ is consumed
+    State body_state() const;
+
+    State state_{State::HEAD};
+    HttpError error_{HttpError::NONE};
+    // Bytes of an unfinished head already searched for its end
+    size_t scanned_{0};
+    // Body or chunk bytes still to come
+    uint64_t remaining_{0};
+    bool chunk_has_digits_{false};
+    size_t trailer_bytes_{0};
+    HttpRequest request_;
+};
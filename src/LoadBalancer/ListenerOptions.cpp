@@ -0,0 +1,183 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ListenerOptions.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "ListenerOptions.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include "../common/Confparcer.h"
+#include "../common/logger.h"
+
+#if ISLINUX
+#include <arpa/inet.h>
+#include <linux/filter.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+ListenerOptions ListenerOptions::from_settings(const std::string& prefix) {
+    ListenerOptions defaults;
+    ListenerOptions options;
+    auto key = [&prefix](const char* name) { return prefix + "_" + name; };
+    options.address = Confparcer::SETTING<std::string>(key("ADDRESS"), defaults.address);
+    options.dual_stack = Confparcer::SETTING<bool>(key("DUAL_STACK"), defaults.dual_stack);
+    options.backlog = Confparcer::SETTING<int>(key("BACKLOG"), defaults.backlog);
+    options.accept_batch = std::max<size_t>(1, Confparcer::SETTING<size_t>(key("ACCEPT_BATCH"), defaults.accept_batch));
+    options.defer_accept_seconds = Confparcer::SETTING<int>(key("DEFER_ACCEPT_S"), defaults.defer_accept_seconds);
+    options.fastopen_queue = Confparcer::SETTING<int>(key("FASTOPEN_QUEUE"), defaults.fastopen_queue);
+    options.nodelay = Confparcer::SETTING<bool>(key("NODELAY"), defaults.nodelay);
+    options.receive_buffer = Confparcer::SETTING<int>(key("RCVBUF"), defaults.receive_buffer);
+    options.send_buffer = Confparcer::SETTING<int>(key("SNDBUF"), defaults.send_buffer);
+    options.shards = std::max<size_t>(1, Confparcer::SETTING<size_t>(key("SHARDS"), defaults.shards));
+    return options;
+}
+
+std::string ListenerOptions::describe() const {
+    std::string text = "address=" + (address.empty() ? std::string("*") : address) +
+                       " dual_stack=" + (dual_stack ? "on" : "off") +
+                       " backlog=" + std::to_string(backlog) +
+                       " accept_batch=" + std::to_string(accept_batch) +
+                       " defer_accept=" + std::to_string(defer_accept_seconds) + "s" +
+                       " fastopen=" + std::to_string(fastopen_queue) +
+                       " nodelay=" + (nodelay ? "on" : "off") +
+                       " shards=" + std::to_string(shards);
+    if (receive_buffer > 0) text += " rcvbuf=" + std::to_string(receive_buffer);
+    if (send_buffer > 0) text += " sndbuf=" + std::to_string(send_buffer);
+    return text;
+}
+
+#if ISLINUX
+
+namespace {
+
+std::string error_text() {
+    return std::strerror(errno);
+}
+
+// Failing tuning options are logged and skipped, the listener still works without them
+void set_option(int fd, int level, int name, int value, const char* what) {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) != 0) {
+        LOG_WARN(std::string("Cannot set ") + what + " on listener: " + error_text());
+    }
+}
+
+// Picks the reuseport group member by the CPU that received the SYN, so a
+// connection is accepted on the shard matching the NIC queue's CPU
+void attach_cpu_steering(int fd, size_t shards) {
+    sock_filter program[] = {
+        {BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU)},
+        {BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(shards)},
+        {BPF_RET | BPF_A, 0, 0, 0},
+    };
+    sock_fprog filter{static_cast<unsigned short>(sizeof(program) / sizeof(program[0])), program};
+    if (setsockopt(fd, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &filter, sizeof(filter)) != 0) {
+        LOG_WARN("Cannot attach reuseport CPU steering, the kernel hashes instead: " + error_text());
+    }
+}
+
+ListenSocket open_one(int port, const ListenerOptions& options, bool reuse_port) {
+    sockaddr_storage storage;
+    std::memset(&storage, 0, sizeof(storage));
+    socklen_t size = 0;
+    bool ipv6 = false;
+
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&storage);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&storage);
+    if (options.address.empty()) {
+        ipv6 = options.dual_stack;
+    } else if (inet_pton(AF_INET6, options.address.c_str(), &v6->sin6_addr) == 1) {
+        ipv6 = true;
+    } else if (inet_pton(AF_INET, options.address.c_str(), &v4->sin_addr) != 1) {
+        throw std::runtime_error("invalid listen address " + options.address);
+    }
+
+    int fd = socket(ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 && ipv6 && options.address.empty()) {
+        // No IPv6 on this host: a dual-stack wildcard degrades to IPv4
+        ipv6 = false;
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    }
+    if (fd < 0) {
+        throw std::runtime_error("socket failed: " + error_text());
+    }
+
+    if (ipv6) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(static_cast<uint16_t>(port));
+        if (options.address.empty()) v6->sin6_addr = in6addr_any;
+        size = sizeof(sockaddr_in6);
+        set_option(fd, IPPROTO_IPV6, IPV6_V6ONLY, options.dual_stack ? 0 : 1, "IPV6_V6ONLY");
+    } else {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(static_cast<uint16_t>(port));
+        if (options.address.empty()) v4->sin_addr.s_addr = htonl(INADDR_ANY);
+        size = sizeof(sockaddr_in);
+    }
+
+    set_option(fd, SOL_SOCKET, SO_REUSEADDR, 1, "SO_REUSEADDR");
+    if (reuse_port) {
+        set_option(fd, SOL_SOCKET, SO_REUSEPORT, 1, "SO_REUSEPORT");
+    }
+    if (options.receive_buffer > 0) {
+        set_option(fd, SOL_SOCKET, SO_RCVBUF, options.receive_buffer, "SO_RCVBUF");
+    }
+    if (options.send_buffer > 0) {
+        set_option(fd, SOL_SOCKET, SO_SNDBUF, options.send_buffer, "SO_SNDBUF");
+    }
+    if (options.defer_accept_seconds > 0) {
+        set_option(fd, IPPROTO_TCP, TCP_DEFER_ACCEPT, options.defer_accept_seconds, "TCP_DEFER_ACCEPT");
+    }
+    if (options.fastopen_queue > 0) {
+        set_option(fd, IPPROTO_TCP, TCP_FASTOPEN, options.fastopen_queue, "TCP_FASTOPEN");
+    }
+
+    if (bind(fd, reinterpret_cast<sockaddr*>(&storage), size) != 0 ||
+        listen(fd, options.backlog) != 0) {
+        std::string reason = error_text();
+        close(fd);
+        throw std::runtime_error("cannot listen on port " + std::to_string(port) + ": " + reason);
+    }
+    return ListenSocket{fd, ipv6};
+}
+
+} // namespace
+
+std::vector<ListenSocket> open_listen_sockets(int port, const ListenerOptions& options, size_t shards) {
+    shards = std::max<size_t>(shards, 1);
+    std::vector<ListenSocket> sockets;
+    try {
+        for (size_t shard = 0; shard < shards; ++shard) {
+            sockets.push_back(open_one(port, options, shards > 1));
+        }
+    } catch (...) {
+        for (const auto& socket : sockets) {
+            close(socket.fd);
+        }
+        throw;
+    }
+    if (shards > 1) {
+        // The program belongs to the group; attaching it through any member is enough
+        attach_cpu_steering(sockets.front().fd, shards);
+    }
+    return sockets;
+}
+
+void tune_accepted_socket(int fd, const ListenerOptions& options) {
+    if (options.nodelay) {
+        int enable = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+}
+
+#endif
@@ -0,0 +1,57 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\ListenerOptions.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "../common/generic.h"
+
+// Socket tuning for one listening port, shared by the asio and io_uring engines.
+// Every field is read from "<prefix>_<NAME>" settings, so each listener can
+// carry its own profile; the default listener uses the LISTEN prefix.
+struct ListenerOptions {
+    // Empty binds every interface
+    std::string address;
+    // An IPv6 socket that also accepts IPv4-mapped peers; IPv4 only when off or unavailable
+    bool dual_stack{true};
+    int backlog{4096};
+    // Connections taken per accept wakeup before re-arming (asio engine)
+    size_t accept_batch{64};
+    // TCP_DEFER_ACCEPT: wake only once the client has sent data, 0 disables
+    int defer_accept_seconds{0};
+    // TCP_FASTOPEN pending queue length, 0 disables
+    int fastopen_queue{0};
+    bool nodelay{true};
+    // SO_RCVBUF / SO_SNDBUF in bytes, inherited by accepted sockets; 0 keeps the kernel default
+    int receive_buffer{0};
+    int send_buffer{0};
+    // Listening sockets in one SO_REUSEPORT group, each connection steered to
+    // shard (receiving CPU % shards) by a CBPF program (asio engine)
+    size_t shards{1};
+
+    static ListenerOptions from_settings(const std::string& prefix = "LISTEN");
+
+    // One line for the startup log
+    std::string describe() const;
+};
+
+#if ISLINUX
+struct ListenSocket {
+    int fd;
+    bool ipv6;
+};
+
+// Bound and listening sockets for `port`, in SO_REUSEPORT group order when
+// there is more than one. Throws std::runtime_error; nothing leaks on failure.
+std::vector<ListenSocket> open_listen_sockets(int port, const ListenerOptions& options, size_t shards);
+
+// Per-connection options the accepted socket does not inherit
+void tune_accepted_socket(int fd, const ListenerOptions& options);
+#endif
@@ -8,63 +8,100 @@
 #include "LoadBalancer.h"
 #include "../common/logger.h"
 #include <algorithm>
+#include <cctype>
+#include <cstring>
 #include <iostream>
 #include <random>
 #include <functional>
+#include <sstream>
 #include "../API/dashboardAPI.h"
 #include "../common/generic.h"
 
 // ClientConnection implementation
-ClientConnection::ClientConnection(asio::io_context& io_context, const std::string& ip)
-    : client_ip(ip), socket(io_context) {
-    client_id = ip + "_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+ClientConnection::ClientConnection(asio::io_context& io_context, Listener& listener, const std::string& ip)
+    : client_ip(ip), listener(listener), strand(asio::make_strand(io_context)), socket(strand)
+#if HG_COROUTINES
+    , verdict_signal(strand, asio::steady_timer::time_point::max())
+#endif
+{
+    client_id = LoadBalancer::allocate_client_id();
 }
 
 void ClientConnection::start() {
     // Client handling will be implemented in LoadBalancer
 }
 
-void ClientConnection::close() {
-    active = false;
+bool ClientConnection::close() {
+    if (!active.exchange(false)) return false;
     asio::error_code ec;
+#if HG_TLS
+    if (tls) tls->shutdown();
+#endif
     socket.close(ec);
     if (backend_socket) {
         backend_socket->close(ec);
     }
+    return true;
+}
+
+StageLatencySummary StageLatencies::summary() const {
+    StageLatencySummary result;
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; ++i) {
+        result[i] = stages[i].summary();
+    }
+    return result;
 }
 
 // BackendNode implementation
 BackendNode::BackendNode(const std::string& id, const std::string& host, int port,
-                         bool is_honeypot, float weight)
-    : id(id), host(host), port(port), is_honeypot(is_honeypot), weight(weight),
-      last_request_time(std::chrono::steady_clock::now()),
+                         bool is_honeypot, float weight, const std::string& group)
+    : id(id), host(host), port(port), is_honeypot(is_honeypot), weight(weight), group(group),
       last_health_check(std::chrono::steady_clock::now()) {}
 
 // LoadBalancer implementation
 LoadBalancer::LoadBalancer(RoutingStrategy strategy)
-    : strategy_(strategy), running_(false), acceptor_(io_context_) {
+    : strategy_(strategy), running_(false),
+      // One shard per I/O thread
+      client_features_(Runtime::THREADS() != 0 ? Runtime::THREADS() : std::thread::hardware_concurrency()),
+      io_context_(Runtime::the().io_context()) {
 
-    stats_.start_time = std::chrono::steady_clock::now();
+    start_time_ = std::chrono::steady_clock::now();
 
+    SubscribeOptions inline_delivery;
+    inline_delivery.name = "load_balancer_health";
+    inline_delivery.filter.where_present("healthy");
     health_check_sub_ = DataBus::instance().subscribe(
         BusEventType::SERVICE_HEALTH_UPDATE,
         [this](const Event& event) {
             this->handle_health_update(event);
-        }
+        },
+        inline_delivery
     );
 
+    // Verdict handling selects a backend and may call the dashboard, so it runs on the Runtime
+    SubscribeOptions on_runtime;
+    on_runtime.mode = DeliveryMode::EXECUTOR;
+    on_runtime.name = "load_balancer_classification";
+    on_runtime.filter.where_present("client_ip").where_present("classification");
     classification_sub_ = DataBus::instance().subscribe(
         BusEventType::REQUEST_CLASSIFIED,
         [this](const Event& event) {
             this->handle_classification(event);
-        }
+        },
+        on_runtime
     );
 
+    // Response telemetry can lag behind without holding up the bus
+    SubscribeOptions telemetry;
+    telemetry.mode = DeliveryMode::EXECUTOR;
+    telemetry.name = "load_balancer_response_metrics";
+    telemetry.filter.where_present("response_time_ms").where_present("success");
     response_sub_ = DataBus::instance().subscribe(
         BusEventType::REQUEST_PROCESSED,
         [this](const Event& event) {
             this->handle_response_metrics(event);
-        }
+        },
+        telemetry
     );
 }
 
@@ -75,97 +112,314 @@ LoadBalancer::~LoadBalancer() {
     DataBus::instance().unsubscribe(response_sub_);
 }
 
+void LoadBalancer::add_listener(const ListenerProfile& profile) {
+    if (running_.load()) {
+        LOG_ERROR("Listener " + profile.name + " added after start, ignoring it");
+        return;
+    }
+    create_listener(profile);
+}
+
+void LoadBalancer::create_listener(const ListenerProfile& profile) {
+    auto listener = std::make_unique<Listener>();
+    listener->profile = profile;
+    listener->group = backends_.group(profile.backend_group);
+    listener->strategy = profile.strategy;
+    listeners_.push_back(std::move(listener));
+}
+
 void LoadBalancer::start(int port) {
     if (running_.exchange(true)) return;
 
-    try {
-        asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port);
-        acceptor_.open(endpoint.protocol());
-        acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
-        acceptor_.bind(endpoint);
-        acceptor_.listen();
+    if (listeners_.empty()) {
+        ListenerProfile profile;
+        profile.port = port;
+        profile.strategy = strategy_;
+        profile.protocol = protocol_from_string(Confparcer::SETTING<std::string>("LISTEN_PROTOCOL", ""),
+                                                ListenerProtocol::TCP);
+        profile.options = ListenerOptions::from_settings();
+        profile.tls = TlsOptions::from_settings();
+        create_listener(profile);
+    }
+
+    size_t started = 0;
+    for (auto& listener : listeners_) {
+        try {
+            start_listener(*listener);
+            ++started;
+        } catch (const std::exception& e) {
+            LOG_FATAL("Failed to start listener " + listener->profile.name + " on port " +
+                      std::to_string(listener->profile.port) + ": " + std::string(e.what()));
+        }
+    }
 
-        LOG_INFO("LoadBalancer started on port " + std::to_string(port));
+    if (started == 0) {
+        running_ = false;
+        return;
+    }
+    if (!ROUTES_FILE().empty()) {
+        reload_routes();
+        routes_task_ = Scheduler::the().schedule_every(ROUTES_RELOAD_INTERVAL(), [this]() { reload_routes(); });
+    }
+#if HG_TLS
+    bool terminates_tls = std::any_of(listeners_.begin(), listeners_.end(),
+                                      [](const auto& listener) { return listener->tls != nullptr; });
+    if (terminates_tls) {
+        ticket_rotation_task_ = Scheduler::the().schedule_every(TLS_TICKET_ROTATION_INTERVAL(),
+                                                                [this]() { ticket_keys_.rotate(); });
+    }
+#endif
+    features_task_ = Scheduler::the().schedule_every(ClientFeatureStore::WINDOW(),
+                                                     [this]() { client_features_.rotate(); });
+    LOG_INFO("Client features: " + std::to_string(client_features_.memory_bytes() / 1024) + " KiB over " +
+             std::to_string(ClientFeatureStore::WINDOW().count()) + "s windows");
+    start_health_checks();
+}
 
-        server_thread_ = std::thread([this]() {
-            start_accept();
-            io_context_.run();
-        });
+void LoadBalancer::start_listener(Listener& listener) {
+    const ListenerProfile& profile = listener.profile;
+    std::string label = "Listener " + profile.name + " on port " + std::to_string(profile.port);
 
-        start_health_checks();
+    if (profile.tls.enabled()) {
+#if HG_TLS
+        TlsOptions tls = profile.tls;
+        if (tls.alpn.empty() && profile.protocol == ListenerProtocol::HTTP) {
+            tls.alpn.push_back("http/1.1");
+        }
+        listener.tls = std::make_unique<TlsContext>(profile.name, tls, ticket_keys_);
+#else
+        throw std::runtime_error("TLS is configured but this build has no OpenSSL support");
+#endif
+    }
 
-    } catch (const std::exception& e) {
-        LOG_FATAL("Failed to start LoadBalancer: " + std::string(e.what()));
-        running_ = false;
+    if (IO_ENGINE() == "io_uring" && profile.protocol == ListenerProtocol::HTTP) {
+        LOG_WARN(label + " parses HTTP, which only the asio engine does; not using io_uring for it");
+    } else if (IO_ENGINE() == "io_uring" && profile.tls.enabled()) {
+        LOG_WARN(label + " terminates TLS, which only the asio engine does; not using io_uring for it");
+    } else if (IO_ENGINE() == "io_uring") {
+        if (UringEngine::supported()) {
+            try {
+                listener.uring = std::make_unique<UringEngine>(*this, listener);
+                listener.uring->start(profile.port, profile.options);
+                LOG_INFO(label + " started (io_uring)");
+                return;
+            } catch (const std::exception& e) {
+                LOG_ERROR("io_uring engine failed, falling back to asio: " + std::string(e.what()));
+                listener.uring.reset();
+            }
+        } else {
+            LOG_WARN("io_uring is not available, falling back to asio");
+        }
+    }
+
+    open_acceptors(listener);
+#if HG_TLS
+    std::string tls = listener.tls ? listener.tls->options().describe() : profile.tls.describe();
+#else
+    std::string tls = profile.tls.describe();
+#endif
+    LOG_INFO(label + " started (" + profile.options.describe() + ", " + tls + ", " +
+             protocol_to_string(profile.protocol) + ", " +
+             strategy_to_string(listener.strategy.load()) + ", backends: " + profile.backend_group +
+             ", classifier profile: " + profile.classifier_profile + ")");
+
+    for (auto& acceptor : listener.acceptors) {
+        start_accept(listener, *acceptor);
     }
 }
 
 void LoadBalancer::stop() {
     if (!running_.exchange(false)) return;
 
-    io_context_.stop();
-    
-    if (server_thread_.joinable()) {
-        server_thread_.join();
-    }
-    
-    if (health_check_thread_.joinable()) {
-        health_check_thread_.join();
+    Scheduler::the().cancel(health_check_task_);
+    health_check_task_ = INVALID_TASK;
+    Scheduler::the().cancel(routes_task_);
+    routes_task_ = INVALID_TASK;
+    Scheduler::the().cancel(features_task_);
+    features_task_ = INVALID_TASK;
+#if HG_TLS
+    Scheduler::the().cancel(ticket_rotation_task_);
+    ticket_rotation_task_ = INVALID_TASK;
+#endif
+
+    for (auto& listener : listeners_) {
+        stop_listener(*listener);
     }
 
     LOG_INFO("LoadBalancer stopped");
 }
 
-void LoadBalancer::start_accept() {
-    auto client = std::make_shared<ClientConnection>(io_context_, "");
-    
-    acceptor_.async_accept(client->socket,
-        [this, client](const asio::error_code& error) {
-            handle_accept(client, error);
+void LoadBalancer::stop_listener(Listener& listener) {
+    if (listener.uring) {
+        listener.uring->stop();
+    }
+
+    // An acceptor is only touched on its strand; wait for the close unless nothing runs it
+    for (auto& acceptor : listener.acceptors) {
+        if (Runtime::the().running()) {
+            std::promise<void> closed;
+            asio::post(acceptor->get_executor(), [&acceptor, &closed]() {
+                asio::error_code ignored;
+                acceptor->close(ignored);
+                closed.set_value();
+            });
+            closed.get_future().wait();
+        } else {
+            asio::error_code ignored;
+            acceptor->close(ignored);
+        }
+    }
+}
+
+void LoadBalancer::open_acceptors(Listener& listener) {
+    const ListenerOptions& options = listener.profile.options;
+    int port = listener.profile.port;
+    size_t shards = options.shards;
+#if ISLINUX
+    for (const auto& listen_socket : open_listen_sockets(port, options, shards)) {
+        auto acceptor = std::make_unique<asio::ip::tcp::acceptor>(asio::make_strand(io_context_));
+        acceptor->assign(listen_socket.ipv6 ? asio::ip::tcp::v6() : asio::ip::tcp::v4(), listen_socket.fd);
+        listener.acceptors.push_back(std::move(acceptor));
+    }
+#else
+    if (shards > 1) {
+        LOG_WARN("Listener shards need SO_REUSEPORT, using a single listener");
+    }
+    asio::ip::tcp::endpoint endpoint(options.dual_stack ? asio::ip::tcp::v6() : asio::ip::tcp::v4(), port);
+    if (!options.address.empty()) {
+        endpoint.address(asio::ip::make_address(options.address));
+    }
+    auto acceptor = std::make_unique<asio::ip::tcp::acceptor>(asio::make_strand(io_context_));
+    acceptor->open(endpoint.protocol());
+    if (endpoint.protocol() == asio::ip::tcp::v6()) {
+        acceptor->set_option(asio::ip::v6_only(!options.dual_stack));
+    }
+    acceptor->set_option(asio::ip::tcp::acceptor::reuse_address(true));
+    if (options.receive_buffer > 0) {
+        acceptor->set_option(asio::socket_base::receive_buffer_size(options.receive_buffer));
+    }
+    if (options.send_buffer > 0) {
+        acceptor->set_option(asio::socket_base::send_buffer_size(options.send_buffer));
+    }
+    acceptor->bind(endpoint);
+    acceptor->listen(options.backlog);
+    listener.acceptors.push_back(std::move(acceptor));
+#endif
+    // Lets handle_accept() drain the backlog with accept() calls that never block
+    for (auto& acceptor : listener.acceptors) {
+        acceptor->non_blocking(true);
+    }
+}
+
+void LoadBalancer::start_accept(Listener& listener, asio::ip::tcp::acceptor& acceptor, ClientConnection::Ptr client) {
+    if (!client) {
+        client = std::make_shared<ClientConnection>(io_context_, listener, "");
+    }
+
+    acceptor.async_accept(client->socket,
+        [this, &listener, &acceptor, client](const asio::error_code& error) {
+            handle_accept(listener, acceptor, client, error);
         });
 }
 
-void LoadBalancer::handle_accept(ClientConnection::Ptr client, const asio::error_code& error) {
+void LoadBalancer::handle_accept(Listener& listener, asio::ip::tcp::acceptor& acceptor, ClientConnection::Ptr client,
+                                 const asio::error_code& error) {
     if (!error) {
-        // Get client IP
-        asio::error_code ec;
-        auto remote_ep = client->socket.remote_endpoint(ec);
-        if (!ec) {
-            client->client_ip = remote_ep.address().to_string();
+        listener.accept_wakeups.increment();
+        admit_client(std::move(client));
+
+        // Take what else is already queued before going back to the reactor
+        ClientConnection::Ptr next;
+        for (size_t taken = 1; taken < listener.profile.options.accept_batch; ++taken) {
+            next = std::make_shared<ClientConnection>(io_context_, listener, "");
+            asio::error_code ec;
+            acceptor.accept(next->socket, ec);
+            if (ec) break; // would_block: the backlog is empty
+            admit_client(std::move(next));
         }
 
-        // Publish new client connection event
-        DataBus::instance().publish(
-            BusEventType::NEW_CLIENT_CONNECTION,
-            "load_balancer",
-            nlohmann::json{
-                {"client_ip", client->client_ip},
-                {"client_id", client->client_id},
-                {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::system_clock::now().time_since_epoch()).count()}
-            }
-        );
-
-        LOG_INFO("New client connected: " + client->client_ip);
-
-        // Start handling client requests
-        handle_client_request(client);
-        
         // Continue accepting new connections
-        start_accept();
-    } else {
+        start_accept(listener, acceptor, std::move(next));
+    } else if (error != asio::error::operation_aborted) {
         LOG_ERROR("Accept error: " + error.message());
         if (running_.load()) {
-            start_accept();
+            start_accept(listener, acceptor, std::move(client));
+        }
+    }
+}
+
+void LoadBalancer::admit_client(ClientConnection::Ptr client) {
+    client->accepted_at = std::chrono::steady_clock::now();
+    client->listener.connections_accepted.increment();
+
+    asio::error_code ec;
+    if (client->listener.profile.options.nodelay) {
+        client->socket.set_option(asio::ip::tcp::no_delay(true), ec);
+    }
+
+    // Get client IP
+    auto remote_ep = client->socket.remote_endpoint(ec);
+    if (!ec) {
+        auto address = remote_ep.address();
+        // Dual-stack listeners see IPv4 clients as ::ffff:a.b.c.d; keep the plain form
+        if (address.is_v6() && address.to_v6().is_v4_mapped()) {
+            address = asio::ip::make_address_v4(asio::ip::v4_mapped, address.to_v6());
         }
+        client->client_ip = address.to_string();
     }
+    client->verdict_key = client->client_ip;
+
+    announce_client(client->listener, client->client_ip, client->client_id);
+
+    // Start handling client requests
+    handle_client_request(client);
+    performance_.stage_latency.record(LatencyStage::ACCEPT,
+                                      std::chrono::steady_clock::now() - client->accepted_at);
+}
+
+uint64_t LoadBalancer::allocate_client_id() {
+    static std::atomic<uint64_t> next_client_id{1};
+    return next_client_id.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoadBalancer::announce_client(const Listener& listener, const std::string& client_ip, uint64_t client_id) {
+    client_features_.record_connection(client_ip, static_cast<uint16_t>(listener.profile.port));
+
+    // Publish new client connection event
+    DataBus::instance().publish(
+        BusEventType::NEW_CLIENT_CONNECTION,
+        "load_balancer",
+        nlohmann::json{
+            {"client_ip", client_ip},
+            {"client_id", client_id},
+            {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count()}
+        }
+    );
+
+    LOG_INFO("New client connected: " + client_ip);
 }
 
 void LoadBalancer::handle_client_request(ClientConnection::Ptr client) {
-    // Check if client already has assigned backend
-    auto assigned_backend = get_assigned_backend(client->client_ip);
+#if HG_TLS
+    if (client->listener.tls && !client->tls) {
+        start_tls(client);
+        return;
+    }
+#endif
+    if (client->listener.profile.protocol == ListenerProtocol::HTTP) {
+        // Every request gets its own verdict, a backend pinned earlier does not apply
+        read_http_request(client);
+        return;
+    }
+#if HG_COROUTINES
+    asio::co_spawn(client->strand, serve_client(client), asio::detached);
+    return;
+#endif
+    // Address lists, rate limits or an earlier verdict may decide without the classifier
+    BackendId assigned_backend = triage_client(client->listener, client->client_ip, client->verdict_key);
     
-    if (!assigned_backend) {
+    if (assigned_backend == INVALID_BACKEND_ID) {
         // For initial request, send to classifier first
         read_from_client(client);
     } else {
@@ -174,105 +428,651 @@ void LoadBalancer::handle_client_request(ClientConnection::Ptr client) {
     }
 }
 
+#if HG_TLS
+void LoadBalancer::start_tls(const ClientConnection::Ptr& client) {
+    SSL* ssl = client->listener.tls->create_session();
+    if (!ssl) {
+        LOG_ERROR("Cannot start TLS for " + client->client_ip + ": " + tls_error_text());
+        client->listener.tls_handshake_failures.increment();
+        close_client(client);
+        return;
+    }
+    client->tls = std::make_unique<TlsStream>(client->socket, ssl);
+    client->tls->async_handshake(bind_arena(client->arena,
+        [this, client](const asio::error_code& error) {
+            Listener& listener = client->listener;
+            if (error) {
+                listener.tls_handshake_failures.increment();
+                if (error != asio::error::operation_aborted) {
+                    LOG_WARN("TLS handshake with " + client->client_ip + " failed: " + error.message());
+                }
+                close_client(client);
+                return;
+            }
+            listener.tls_handshakes.increment();
+            if (client->tls->resumed()) listener.tls_resumed.increment();
+            if (client->tls->kernel_writes()) listener.tls_kernel_offloaded.increment();
+            performance_.stage_latency.record(LatencyStage::TLS_HANDSHAKE,
+                                              std::chrono::steady_clock::now() - client->accepted_at);
+            handle_client_request(client);
+        }));
+}
+#endif
+
 void LoadBalancer::read_from_client(ClientConnection::Ptr client) {
-    auto buffer = std::make_shared<std::vector<char>>(8192);
-    
-    client->socket.async_read_some(asio::buffer(*buffer),
-        [this, client, buffer](const asio::error_code& error, size_t bytes_read) {
+    auto& buffer = client->upstream_buffer;
+    size_t pending = client->pending_bytes;
+    client->async_read_some(asio::buffer(buffer.data() + pending, buffer.size() - pending), bind_arena(client->arena,
+        [this, client](const asio::error_code& error, size_t bytes_read) {
             if (!error && bytes_read > 0) {
-                // Publish request to classifier
-                std::string request_data(buffer->data(), bytes_read);
-                
-                DataBus::instance().publish(
-                    BusEventType::REQUEST_FOR_CLASSIFICATION,
-                    "load_balancer",
-                    nlohmann::json{
-                        {"client_ip", client->client_ip},
-                        {"client_id", client->client_id},
-                        {"request_data", request_data},
-                        {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::system_clock::now().time_since_epoch()).count()},
-                        {"client_ptr", reinterpret_cast<uintptr_t>(client.get())}
+                // Keep the bytes until the verdict arrives, they go to the backend first
+                client->pending_bytes += bytes_read;
+                if (!inspect_first_bytes(*client)) {
+                    read_from_client(client);
+                    return;
+                }
+                if (client->fingerprint) {
+                    // Classified before with the same TLS stack
+                    BackendId backend = recall_verdict(client->listener, client->client_ip, client->verdict_key,
+                                                       std::chrono::steady_clock::now());
+                    if (backend != INVALID_BACKEND_ID) {
+                        proxy_to_backend(client, backend);
+                        return;
                     }
-                );
-                
-                LOG_DEBUG("Request sent to classifier from client: " + client->client_ip);
-                
-                // Store the received data temporarily
-                // We'll use it when we get classification result
-                // For now, we wait for classification
-                
+                }
+                request_classification(client, client->upstream_buffer.data(), client->pending_bytes);
             } else if (error != asio::error::operation_aborted) {
                 LOG_WARN("Read from client failed: " + error.message());
-                client->close();
+                close_client(client);
             }
-        });
+        }));
+}
+
+void LoadBalancer::request_classification(const ClientConnection::Ptr& client, const char* data, size_t size) {
+    bool is_http = client->listener.profile.protocol == ListenerProtocol::HTTP;
+    auto started = std::chrono::steady_clock::now();
+    ClientFeatures features = client_features_.record_request(
+        client->client_ip, is_http ? std::string_view(client->http.request().target) : std::string_view());
+    if (is_http) {
+        // TCP connections went through these at accept, an HTTP request has its own verdict
+        if (auto verdict = triage_inline(client->client_ip, &features)) {
+            triage_.record(verdict->stage, std::chrono::steady_clock::now() - started);
+            asio::post(client->strand, bind_arena(client->arena, [this, client, verdict]() {
+                settle_http_request(client, verdict);
+            }));
+            return;
+        }
+    }
+
+    client->classification_sent_at = std::chrono::steady_clock::now();
+    performance_.stage_latency.record(LatencyStage::CLASSIFICATION_REQUEST,
+                                      client->classification_sent_at - client->accepted_at);
+    
+    // Ask the classifier; the verdict resumes this connection via handle_verdict(). No
+    // socket operation is pending meanwhile, so the request holds the connection;
+    // close_client() cancels it, a timeout answers it.
+    client->classification_request = publish_classification(client->listener, client->client_ip, client->client_id,
+        std::string(data, size), features,
+        [this, client](RequestStatus status, const nlohmann::json& verdict) {
+            handle_verdict(client, status, verdict);
+        },
+        client->fingerprint ? &*client->fingerprint : nullptr);
+}
+
+bool LoadBalancer::inspect_first_bytes(ClientConnection& client) {
+    auto status = client.client_hello.parse(client.upstream_buffer.data(), client.pending_bytes);
+    if (status == ClientHelloParser::Status::NEED_MORE && client.pending_bytes < client.upstream_buffer.size()) {
+        return false;
+    }
+    if (status == ClientHelloParser::Status::COMPLETE) {
+        client.fingerprint = TlsFingerprint::from(client.client_hello.hello());
+        client.verdict_key = verdict_key(client.client_ip, client.fingerprint->id);
+        client.listener.client_hellos.increment();
+    }
+    return true;
 }
 
-void LoadBalancer::proxy_to_backend(ClientConnection::Ptr client, std::shared_ptr<BackendNode> backend) {
+CorrelationId LoadBalancer::publish_classification(const Listener& listener, const std::string& client_ip,
+                                                   uint64_t client_id, std::string request_data,
+                                                   const ClientFeatures& features, ResponseCallback callback,
+                                                   const TlsFingerprint* fingerprint) {
+    nlohmann::json payload{
+        {"client_ip", client_ip},
+        {"client_id", client_id},
+        {"listener", listener.profile.name},
+        {"port", listener.profile.port},
+        {"profile", listener.profile.classifier_profile},
+        {"request_data", std::move(request_data)},
+        {"timestamp", std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count()},
+        {"features", {
+            {"span_s", features.span_s},
+            {"connections", features.connections},
+            {"requests", features.requests},
+            {"short_connections", features.short_connections},
+            {"distinct_ports", features.distinct_ports},
+            {"distinct_paths", features.distinct_paths},
+            {"connection_share", features.connection_share}
+        }}
+    };
+    if (fingerprint) {
+        // A verdict event carrying "fingerprint" applies to this client stack only
+        payload["tls"] = nlohmann::json{
+            {"fingerprint", fingerprint->id},
+            {"ja3", fingerprint->ja3},
+            {"ja4_r", fingerprint->ja4_r},
+            {"sni", fingerprint->server_name},
+            {"alpn", fingerprint->alpn}
+        };
+    }
+
+    CorrelationId request = DataBus::instance().request_async(
+        BusEventType::REQUEST_FOR_CLASSIFICATION,
+        std::move(payload),
+        std::move(callback),
+        CLASSIFICATION_TIMEOUT()
+    );
+    
+    LOG_DEBUG("Request sent to classifier from client: " + client_ip);
+    return request;
+}
+
+#if HG_COROUTINES
+LoadBalancer::ConnectionTask LoadBalancer::serve_client(ClientConnection::Ptr client) {
+    asio::error_code error;
+    auto on_error = asio::redirect_error(asio::use_awaitable_t<ClientConnection::Strand>(), error);
+
+    BackendId backend = triage_client(client->listener, client->client_ip, client->verdict_key);
+    if (backend == INVALID_BACKEND_ID) {
+        // For initial request, send to classifier first
+        auto& buffer = client->upstream_buffer;
+        do {
+            size_t pending = client->pending_bytes;
+            size_t bytes_read = co_await client->async_read_some(
+                asio::buffer(buffer.data() + pending, buffer.size() - pending), on_error);
+            if (error || bytes_read == 0) {
+                if (error != asio::error::operation_aborted) {
+                    LOG_WARN("Read from client failed: " + error.message());
+                }
+                close_client(client);
+                co_return;
+            }
+            client->pending_bytes += bytes_read;
+        } while (!inspect_first_bytes(*client));
+
+        if (client->fingerprint) {
+            // Classified before with the same TLS stack
+            backend = recall_verdict(client->listener, client->client_ip, client->verdict_key,
+                                     std::chrono::steady_clock::now());
+        }
+    }
+    if (backend == INVALID_BACKEND_ID) {
+        request_classification(client, client->upstream_buffer.data(), client->pending_bytes);
+
+        // resume_client() cancels the signal once a backend is chosen or routing failed
+        co_await client->verdict_signal.async_wait(on_error);
+        backend = client->routed_backend;
+        if (backend != INVALID_BACKEND_ID && !client->active.load()) {
+            // Closed while classifying; close_client() had no backend to release
+            release_backend(backend);
+            co_return;
+        }
+        if (backend == INVALID_BACKEND_ID) {
+            close_client(client);
+            co_return;
+        }
+    }
+
+    // From here on close_client() releases the backend slot
+    client->backend_id = backend;
+    const auto& node = backends_.node(backend);
+
+    client->backend_socket.emplace(client->strand);
+    asio::ip::tcp::endpoint backend_ep(asio::ip::make_address(node->host, error), node->port);
+    if (!error) {
+        client->connect_started_at = std::chrono::steady_clock::now();
+        co_await client->backend_socket->async_connect(backend_ep, on_error);
+    }
+    if (error) {
+        LOG_ERROR("Backend connection failed: " + error.message());
+        close_client(client);
+        co_return;
+    }
+    client->backend_connected_at = std::chrono::steady_clock::now();
+    auto connect_time = client->backend_connected_at - client->connect_started_at;
+    record_backend_stage(backend, LatencyStage::BACKEND_CONNECT, connect_time);
+
+    if (client->pending_bytes != 0) {
+        co_await asio::async_write(*client->backend_socket,
+                                   asio::buffer(client->upstream_buffer.data(), client->pending_bytes), on_error);
+        if (error) {
+            LOG_WARN("Write to backend failed: " + error.message());
+            close_client(client);
+            co_return;
+        }
+        client->pending_bytes = 0;
+    }
+
+    // Both directions share the strand, whichever ends first closes both sockets
+    asio::co_spawn(client->strand, relay(client, false), asio::detached);
+    co_await relay(client, true);
+}
+
+LoadBalancer::ConnectionTask LoadBalancer::relay(ClientConnection::Ptr client, bool from_backend) {
+    auto& buffer = from_backend ? client->downstream_buffer : client->upstream_buffer;
+    asio::error_code error;
+    auto on_error = asio::redirect_error(asio::use_awaitable_t<ClientConnection::Strand>(), error);
+
+    while (client->active.load()) {
+        size_t bytes_read = from_backend
+            ? co_await client->backend_socket->async_read_some(asio::buffer(buffer), on_error)
+            : co_await client->async_read_some(asio::buffer(buffer), on_error);
+        if (error || bytes_read == 0) {
+            if (error != asio::error::operation_aborted && client->active.load()) {
+                LOG_WARN(std::string(from_backend ? "Read from backend" : "Read from client") +
+                         " failed: " + error.message());
+            }
+            break;
+        }
+
+        if (from_backend && !client->first_response_seen) {
+            client->first_response_seen = true;
+            auto first_byte_time = std::chrono::steady_clock::now() - client->backend_connected_at;
+            record_backend_stage(client->backend_id, LatencyStage::FIRST_RESPONSE_BYTE, first_byte_time);
+        }
+
+        if (from_backend) {
+            co_await client->async_write(asio::buffer(buffer.data(), bytes_read), on_error);
+        } else {
+            co_await asio::async_write(*client->backend_socket, asio::buffer(buffer.data(), bytes_read), on_error);
+        }
+        if (error) {
+            if (error != asio::error::operation_aborted && client->active.load()) {
+                LOG_WARN(std::string(from_backend ? "Write to client" : "Write to backend") +
+                         " failed: " + error.message());
+            }
+            break;
+        }
+    }
+    close_client(client);
+}
+#endif
+
+void LoadBalancer::proxy_to_backend(ClientConnection::Ptr client, BackendId backend) {
+    // From here on close_client() releases the backend slot
+    client->backend_id = backend;
+    const auto& node = backends_.node(backend);
+
     try {
         if (!client->backend_socket) {
-            client->backend_socket = std::make_shared<asio::ip::tcp::socket>(io_context_);
+            client->backend_socket.emplace(client->strand);
             
             asio::ip::tcp::endpoint backend_ep(
-                asio::ip::make_address(backend->host), backend->port);
+                asio::ip::make_address(node->host), node->port);
             
-            client->backend_socket->async_connect(backend_ep,
-                [this, client, backend](const asio::error_code& error) {
+            client->connect_started_at = std::chrono::steady_clock::now();
+            client->backend_socket->async_connect(backend_ep, bind_arena(client->arena,
+                [this, client](const asio::error_code& error) {
                     if (!error) {
+                        client->backend_connected_at = std::chrono::steady_clock::now();
+                        auto connect_time = client->backend_connected_at - client->connect_started_at;
+                        record_backend_stage(client->backend_id, LatencyStage::BACKEND_CONNECT, connect_time);
+
                         // Start bidirectional proxying
-                        read_from_client(client);
+                        forward_pending_request(client);
                         read_from_backend(client);
                     } else {
                         LOG_ERROR("Backend connection failed: " + error.message());
-                        client->close();
-                        release_backend(backend->id);
+                        close_client(client);
                     }
-                });
+                }));
         } else {
             // Continue normal proxying
-            read_from_client(client);
+            relay_client_to_backend(client);
             read_from_backend(client);
         }
     } catch (const std::exception& e) {
         LOG_ERROR("Proxy error: " + std::string(e.what()));
-        client->close();
-        release_backend(backend->id);
+        close_client(client);
     }
 }
 
+void LoadBalancer::forward_pending_request(ClientConnection::Ptr client) {
+    if (client->pending_bytes == 0) {
+        relay_client_to_backend(client);
+        return;
+    }
+
+    asio::async_write(*client->backend_socket, asio::buffer(client->upstream_buffer.data(), client->pending_bytes),
+        bind_arena(client->arena, [this, client](const asio::error_code& error, size_t /*bytes_written*/) {
+            if (!error) {
+                client->pending_bytes = 0;
+                relay_client_to_backend(client);
+            } else {
+                LOG_WARN("Write to backend failed: " + error.message());
+                close_client(client);
+            }
+        }));
+}
+
+void LoadBalancer::relay_client_to_backend(ClientConnection::Ptr client) {
+    client->async_read_some(asio::buffer(client->upstream_buffer), bind_arena(client->arena,
+        [this, client](const asio::error_code& error, size_t bytes_read) {
+            if (!error && bytes_read > 0) {
+                asio::async_write(*client->backend_socket, asio::buffer(client->upstream_buffer.data(), bytes_read),
+                    bind_arena(client->arena, [this, client](const asio::error_code& error, size_t /*bytes_written*/) {
+                        if (!error) {
+                            relay_client_to_backend(client);
+                        } else {
+                            LOG_WARN("Write to backend failed: " + error.message());
+                            close_client(client);
+                        }
+                    }));
+            } else if (error != asio::error::operation_aborted) {
+                LOG_WARN("Read from client failed: " + error.message());
+                close_client(client);
+            }
+        }));
+}
+
 void LoadBalancer::read_from_backend(ClientConnection::Ptr client) {
-    auto buffer = std::make_shared<std::vector<char>>(8192);
-    
     if (client->backend_socket && client->backend_socket->is_open()) {
-        client->backend_socket->async_read_some(asio::buffer(*buffer),
-            [this, client, buffer](const asio::error_code& error, size_t bytes_read) {
+        client->backend_socket->async_read_some(asio::buffer(client->downstream_buffer), bind_arena(client->arena,
+            [this, client](const asio::error_code& error, size_t bytes_read) {
                 if (!error && bytes_read > 0) {
+                    if (!client->first_response_seen) {
+                        client->first_response_seen = true;
+                        auto first_byte_time = std::chrono::steady_clock::now() - client->backend_connected_at;
+                        record_backend_stage(client->backend_id, LatencyStage::FIRST_RESPONSE_BYTE, first_byte_time);
+                    }
+
                     // Forward backend response to client
-                    asio::async_write(client->socket, asio::buffer(buffer->data(), bytes_read),
-                        [this, client](const asio::error_code& error, size_t /*bytes_written*/) {
+                    client->async_write(asio::buffer(client->downstream_buffer.data(), bytes_read),
+                        bind_arena(client->arena, [this, client](const asio::error_code& error, size_t /*bytes_written*/) {
                             if (!error) {
                                 read_from_backend(client);
                             } else {
                                 LOG_WARN("Write to client failed: " + error.message());
-                                client->close();
+                                close_client(client);
                             }
-                        });
+                        }));
+                } else if (error == asio::error::eof && client->draining_backend) {
+                    // The drained backend answered everything it was sent
+                    if (client->next_backend != INVALID_BACKEND_ID) {
+                        switch_http_backend(client);
+                    } else {
+                        close_client(client);
+                    }
                 } else if (error != asio::error::operation_aborted) {
                     LOG_WARN("Read from backend failed: " + error.message());
-                    client->close();
+                    close_client(client);
                 }
-            });
+            }));
     }
 }
 
-void LoadBalancer::add_backend(std::shared_ptr<BackendNode> server_ptr) {
-    std::lock_guard<std::mutex> lock(backends_mutex_);
+namespace {
+
+// Answers for requests refused before anything reached a backend
+std::string_view http_error_response(int status) {
+    switch (status) {
+        case 431:
+            return "HTTP/1.1 431 Request Header Fields Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        case 503:
+            return "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+        default:
+            return "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    }
+}
+
+} // namespace
+
+void LoadBalancer::read_http_request(const ClientConnection::Ptr& client) {
+    auto& buffer = client->upstream_buffer;
+    // Everything parsed is forwarded by now; an unfinished head moves to the front
+    size_t kept = client->http_received - client->http_parsed;
+    if (client->http_parsed != 0 && kept != 0) {
+        std::memmove(buffer.data(), buffer.data() + client->http_parsed, kept);
+    }
+    client->http_forwarded = 0;
+    client->http_parsed = 0;
+    client->http_received = kept;
+    if (kept == buffer.size()) {
+        LOG_WARN("Request head from " + client->client_ip + " exceeds " + std::to_string(buffer.size()) + " bytes");
+        reject_http_request(client, 431);
+        return;
+    }
+
+    client->async_read_some(asio::buffer(buffer.data() + kept, buffer.size() - kept), bind_arena(client->arena,
+        [this, client](const asio::error_code& error, size_t bytes_read) {
+            if (!error && bytes_read > 0) {
+                client->http_received += bytes_read;
+                advance_http(client);
+            } else if (error == asio::error::eof && client->backend_socket) {
+                // The client sent its last request, let the backend answer it
+                drain_backend(client);
+            } else if (error != asio::error::operation_aborted) {
+                LOG_WARN("Read from client failed: " + error.message());
+                close_client(client);
+            }
+        }));
+}
+
+void LoadBalancer::advance_http(const ClientConnection::Ptr& client) {
+    char* data = client->upstream_buffer.data();
+    for (;;) {
+        auto result = client->http.parse(data + client->http_parsed, client->http_received - client->http_parsed);
+        client->http_parsed += result.consumed;
+
+        switch (result.status) {
+            case HttpRequestParser::Status::HEAD_COMPLETE:
+                // The previous request was forwarded when it completed, so the head starts at http_forwarded
+                client->listener.http_requests.increment();
+                client->request_group = client->listener.group;
+                if (auto routes = std::atomic_load(&client->listener.routes)) {
+                    if (const RouteTable::Route* route = routes->match(client->http.request())) {
+                        client->request_group = route->group;
+                        client->listener.http_routed.increment();
+                    }
+                }
+                request_classification(client, data + client->http_forwarded,
+                                       client->http_parsed - client->http_forwarded);
+                return;
+            case HttpRequestParser::Status::MESSAGE_COMPLETE:
+            case HttpRequestParser::Status::NEED_MORE:
+                if (client->http_forwarded != client->http_parsed) {
+                    forward_http_bytes(client);
+                    return;
+                }
+                if (result.status == HttpRequestParser::Status::NEED_MORE) {
+                    read_http_request(client);
+                    return;
+                }
+                break;
+            case HttpRequestParser::Status::ERROR:
+                LOG_WARN("Rejected HTTP request from " + client->client_ip + ": " +
+                         HttpRequestParser::error_to_string(client->http.error()));
+                reject_http_request(client, client->http.error() == HttpError::TOO_MANY_HEADERS ? 431 : 400);
+                return;
+        }
+    }
+}
+
+void LoadBalancer::forward_http_bytes(const ClientConnection::Ptr& client) {
+    const char* data = client->upstream_buffer.data() + client->http_forwarded;
+    size_t size = client->http_parsed - client->http_forwarded;
+    asio::async_write(*client->backend_socket, asio::buffer(data, size), bind_arena(client->arena,
+        [this, client](const asio::error_code& error, size_t /*bytes_written*/) {
+            if (!error) {
+                client->http_forwarded = client->http_parsed;
+                advance_http(client);
+            } else {
+                LOG_WARN("Write to backend failed: " + error.message());
+                close_client(client);
+            }
+        }));
+}
+
+void LoadBalancer::handle_request_verdict(const ClientConnection::Ptr& client, RequestStatus status,
+                                          const nlohmann::json& verdict) {
+    std::optional<TriageVerdict> result = read_verdict(client->client_ip, status, verdict,
+                                                       client->classification_sent_at);
+    // The connection's backend is only read and replaced on its strand
+    asio::post(client->strand, bind_arena(client->arena, [this, client, result]() {
+        settle_http_request(client, result);
+    }));
+}
+
+void LoadBalancer::settle_http_request(const ClientConnection::Ptr& client,
+                                       const std::optional<TriageVerdict>& verdict) {
+    BackendId backend = INVALID_BACKEND_ID;
+    if (verdict) {
+        if (client->backend_id != INVALID_BACKEND_ID && verdict->is_malicious == client->is_malicious.load() &&
+            client->request_group == client->backend_group) {
+            // Same verdict and route as the request before, it stays on the same backend
+            if (verdict->stage == TriageStage::DEEP_INSPECTION) {
+                remember_verdict(client->client_ip, client->verdict_key, verdict->is_malicious);
+            }
+            backend = client->backend_id;
+        } else {
+            backend = route_verdict(client->listener, client->request_group, client->client_ip,
+                                    client->verdict_key, *verdict);
+            if (backend != INVALID_BACKEND_ID && backend == client->backend_id) {
+                // Picked the backend the connection holds, whose slot is already counted
+                release_backend(backend);
+            }
+        }
+    }
+    route_http_request(client, backend, verdict ? verdict->is_malicious : false);
+}
+
+void LoadBalancer::route_http_request(const ClientConnection::Ptr& client, BackendId backend, bool is_malicious) {
+    if (!client->active.load()) {
+        // Closed while classifying; close_client() released the backend it had, the
+        // same backend picked again was released by settle_http_request()
+        if (backend != INVALID_BACKEND_ID && backend != client->backend_id) {
+            release_backend(backend);
+        }
+        return;
+    }
+    if (backend == INVALID_BACKEND_ID) {
+        reject_http_request(client, 503);
+        return;
+    }
+    client->is_malicious = is_malicious;
+    client->backend_group = client->request_group;
+    if (backend == client->backend_id) {
+        advance_http(client);
+        return;
+    }
+
+    if (client->backend_id == INVALID_BACKEND_ID) {
+        connect_http_backend(client, backend);
+        return;
+    }
+    client->listener.http_backend_switches.increment();
+    client->next_backend = backend;
+    drain_backend(client);
+}
+
+void LoadBalancer::connect_http_backend(const ClientConnection::Ptr& client, BackendId backend) {
+    // From here on close_client() releases the backend slot
+    client->backend_id = backend;
+    client->first_response_seen = false;
+    const auto& node = backends_.node(backend);
+
+    asio::error_code error;
+    asio::ip::tcp::endpoint backend_ep(asio::ip::make_address(node->host, error), node->port);
+    if (error) {
+        LOG_ERROR("Backend connection failed: " + error.message());
+        close_client(client);
+        return;
+    }
+
+    client->backend_socket.emplace(client->strand);
+    client->connect_started_at = std::chrono::steady_clock::now();
+    client->backend_socket->async_connect(backend_ep, bind_arena(client->arena,
+        [this, client](const asio::error_code& error) {
+            if (error) {
+                LOG_ERROR("Backend connection failed: " + error.message());
+                close_client(client);
+                return;
+            }
+            client->backend_connected_at = std::chrono::steady_clock::now();
+            auto connect_time = client->backend_connected_at - client->connect_started_at;
+            record_backend_stage(client->backend_id, LatencyStage::BACKEND_CONNECT, connect_time);
+
+            read_from_backend(client);
+            advance_http(client);
+        }));
+}
+
+void LoadBalancer::switch_http_backend(const ClientConnection::Ptr& client) {
+    client->draining_backend = false;
+    asio::error_code ignored;
+    client->backend_socket->close(ignored);
+    release_backend(client->backend_id);
+    client->backend_id = INVALID_BACKEND_ID;
+
+    BackendId next = client->next_backend;
+    client->next_backend = INVALID_BACKEND_ID;
+    connect_http_backend(client, next);
+}
+
+void LoadBalancer::drain_backend(const ClientConnection::Ptr& client) {
+    client->draining_backend = true;
+    asio::error_code ignored;
+    client->backend_socket->shutdown(asio::socket_base::shutdown_send, ignored);
+}
+
+void LoadBalancer::reject_http_request(const ClientConnection::Ptr& client, int status) {
+    client->listener.http_rejected.increment();
+    if (client->backend_socket) {
+        // Responses to earlier requests are still on their way, the connection ends after them
+        client->next_backend = INVALID_BACKEND_ID;
+        drain_backend(client);
+        return;
+    }
+
+    std::string_view response = http_error_response(status);
+    client->async_write(asio::buffer(response.data(), response.size()), bind_arena(client->arena,
+        [this, client](const asio::error_code& /*error*/, size_t /*bytes_written*/) {
+            close_client(client);
+        }));
+}
 
-    if (server_ptr->is_honeypot) {
-        honeypot_backends_.push_back(server_ptr);
+void LoadBalancer::close_client(const ClientConnection::Ptr& client) {
+    if (!client->close()) return;
+    finish_client(client->client_ip, client->backend_id, client->accepted_at, client->classification_request);
+}
+
+void LoadBalancer::finish_client(const std::string& client_ip, BackendId backend,
+                                 std::chrono::steady_clock::time_point accepted_at,
+                                 CorrelationId classification_request) {
+    auto lifetime = std::chrono::steady_clock::now() - accepted_at;
+    client_features_.record_close(client_ip, lifetime);
+    if (backend != INVALID_BACKEND_ID) {
+        record_backend_stage(backend, LatencyStage::CLOSE, lifetime);
+        release_backend(backend);
     } else {
-        real_backends_.push_back(server_ptr);
+        performance_.stage_latency.record(LatencyStage::CLOSE, lifetime);
+    }
+
+    if (classification_request != INVALID_CORRELATION_ID) {
+        DataBus::instance().cancel_request(classification_request);
+    }
+}
+
+void LoadBalancer::record_backend_stage(BackendId backend, LatencyStage stage,
+                                        std::chrono::steady_clock::duration elapsed) {
+    performance_.stage_latency.record(stage, elapsed);
+    backends_.node(backend)->latency.record(stage, elapsed);
+}
+
+void LoadBalancer::add_backend(std::shared_ptr<BackendNode> server_ptr) {
+    BackendId backend_id = backends_.add(server_ptr);
+    if (backend_id == INVALID_BACKEND_ID) {
+        return;
     }
 
     DataBus::instance().publish(
@@ -280,6 +1080,7 @@ void LoadBalancer::add_backend(std::shared_ptr<BackendNode> server_ptr) {
         "load_balancer",
         {
             {"server_id", server_ptr->id},
+            {"backend_id", backend_id},
             {"host", server_ptr->host},
             {"port", std::to_string(server_ptr->port)},
             {"is_honeypot", server_ptr->is_honeypot ? "true" : "false"},
@@ -291,391 +1092,578 @@ void LoadBalancer::add_backend(std::shared_ptr<BackendNode> server_ptr) {
              std::to_string(server_ptr->port) + " Is honeypot: " + 
              (server_ptr->is_honeypot ? "true" : "false"));
 
-    DashboardAPI::the().callAgentChange(real_backends_.size(), honeypot_backends_.size());
+    int real_size = static_cast<int>(backends_.pool(false)->size());
+    int honey_size = static_cast<int>(backends_.pool(true)->size());
+    DashboardAPI::the().post([real_size, honey_size]() {
+        DashboardAPI::the().callAgentChange(real_size, honey_size);
+    });
 }
 
-std::shared_ptr<BackendNode> LoadBalancer::select_backend(bool is_malicious, const std::string& client_ip) {
+BackendId LoadBalancer::select_backend(Listener& listener, BackendGroupId group, bool is_malicious,
+                                       const std::string& client_ip) {
     auto start_time = std::chrono::steady_clock::now();
 
-    auto& backends = is_malicious ? honeypot_backends_ : real_backends_;
-
-    if (backends.empty()) {
-        stats_.routing_errors++;
-        performance_.backend_selection_failures++;
-        return nullptr;
+    auto pool = backends_.pool(group, is_malicious);
+    if (pool->empty() && group != listener.group) {
+        // A routed group usually has no honeypots of its own
+        pool = backends_.pool(listener.group, is_malicious);
     }
+    RoutingStrategy strategy = listener.strategy.load(std::memory_order_relaxed);
 
-    std::lock_guard<std::mutex> lock(backends_mutex_);
-
-    std::vector<std::shared_ptr<BackendNode>> healthy_backends;
-    for (const auto& backend : backends) {
-        if (backend->is_healthy.load()) {
-            healthy_backends.push_back(backend);
-        }
+    if (pool->empty()) {
+        counters_.routing_errors.increment();
+        performance_.backend_selection_failures.increment();
+        return INVALID_BACKEND_ID;
     }
 
-    if (healthy_backends.empty()) {
-        stats_.routing_errors++;
-        performance_.backend_selection_failures++;
-        return nullptr;
-    }
+    BackendId selected = INVALID_BACKEND_ID;
 
-    std::shared_ptr<BackendNode> selected;
-
-    switch (strategy_) {
+    switch (strategy) {
         case RoutingStrategy::ROUND_ROBIN:
-            selected = round_robin_selection(healthy_backends);
+            selected = round_robin_selection(*pool);
             break;
         case RoutingStrategy::LEAST_CONNECTIONS:
-            selected = least_connections_selection(healthy_backends);
+            selected = least_connections_selection(*pool);
             break;
         case RoutingStrategy::IP_HASH:
-            selected = ip_hash_selection(healthy_backends, client_ip);
+            selected = ip_hash_selection(*pool, client_ip);
             break;
         case RoutingStrategy::WEIGHTED:
-            selected = weighted_selection(healthy_backends);
+            selected = weighted_selection(*pool);
             break;
         default:
         VERIFY_NOT_REACHED();
     }
 
+    if (selected == INVALID_BACKEND_ID) {
+        // Every backend in the pool is unhealthy
+        counters_.routing_errors.increment();
+        performance_.backend_selection_failures.increment();
+        return INVALID_BACKEND_ID;
+    }
+
     auto end_time = std::chrono::steady_clock::now();
     auto routing_time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
 
-    performance_.total_routing_time_ns += routing_time_ns;
-    performance_.total_routing_operations++;
+    performance_.total_routing_time_ns.add(static_cast<uint64_t>(routing_time_ns));
+    performance_.total_routing_operations.increment();
+    performance_.stage_latency.record(LatencyStage::BACKEND_SELECT, end_time - start_time);
 
-    if (selected) {
-        selected->current_clients++;
-        selected->total_requests++;
-        selected->last_request_time = std::chrono::steady_clock::now();
+    const auto& node = backends_.node(selected);
+    node->latency.record(LatencyStage::BACKEND_SELECT, end_time - start_time);
+    backends_.acquire(selected);
 
-        stats_.total_requests_processed++;
-        if (is_malicious) {
-            stats_.requests_routed_to_honeypot++;
-        } else {
-            stats_.requests_routed_to_real++;
-        }
+    counters_.total_requests_processed.increment();
+    if (is_malicious) {
+        counters_.requests_routed_to_honeypot.increment();
+    } else {
+        counters_.requests_routed_to_real.increment();
+    }
 
-        stats_.strategy_usage[strategy_]++;
+    counters_.strategy_usage[static_cast<size_t>(strategy)].increment();
 
-        DataBus::instance().publish(
-            BusEventType::REQUEST_ROUTED,
-            "load_balancer",
-            nlohmann::json{
-                {"client_ip", client_ip},
-                {"server_id", selected->id},
-                {"is_malicious", is_malicious},
-                {"strategy", static_cast<int>(strategy_)},
-                {"current_connections", selected->current_clients.load()},
-                {"routing_time_ns", routing_time_ns},
-                {"total_requests", selected->total_requests.load()}
-            }
-        );
+    DataBus::instance().publish(
+        BusEventType::REQUEST_ROUTED,
+        "load_balancer",
+        nlohmann::json{
+            {"client_ip", client_ip},
+            {"listener", listener.profile.name},
+            {"server_id", node->id},
+            {"backend_id", selected},
+            {"is_malicious", is_malicious},
+            {"strategy", static_cast<int>(strategy)},
+            {"current_connections", backends_.current_clients(selected)},
+            {"routing_time_ns", routing_time_ns},
+            {"total_requests", backends_.total_requests(selected)}
+        }
+    );
 
+    // The dashboard call is a blocking HTTP request, it runs on the dashboard's own thread
+    DashboardAPI::the().post([client_ip, server_id = node->id, is_malicious]() {
         int err = 0;
-        DashboardAPI::the().callUserRegistered(client_ip, selected->id, is_malicious, &err);
+        DashboardAPI::the().callUserRegistered(client_ip, server_id, is_malicious, &err);
+    });
 
-    } else {
-        stats_.routing_errors++;
+    return selected;
+}
+
+std::string LoadBalancer::verdict_key(const std::string& client_ip, const std::string& fingerprint_id) {
+    return fingerprint_id.empty() ? client_ip : client_ip + "|" + fingerprint_id;
+}
+
+BackendId LoadBalancer::triage_client(Listener& listener, const std::string& client_ip, const std::string& key) {
+    auto started = std::chrono::steady_clock::now();
+    if (auto verdict = triage_inline(client_ip, nullptr)) {
+        BackendId backend = route_verdict(listener, listener.group, client_ip, key, *verdict);
+        triage_.record(verdict->stage, std::chrono::steady_clock::now() - started);
+        return backend;
     }
+    return recall_verdict(listener, client_ip, key, started);
+}
 
-    return selected;
+BackendId LoadBalancer::recall_verdict(Listener& listener, const std::string& client_ip, const std::string& key,
+                                       std::chrono::steady_clock::time_point started) {
+    BackendId backend = route_known_client(listener, client_ip, key);
+    if (backend != INVALID_BACKEND_ID) {
+        triage_.record(TriageStage::VERDICT_CACHE, std::chrono::steady_clock::now() - started);
+    }
+    return backend;
 }
 
-std::shared_ptr<BackendNode> LoadBalancer::get_assigned_backend(const std::string& client_ip) {
-    std::lock_guard<std::mutex> lock(mapping_mutex_);
-    auto it = client_backend_mapping_.find(client_ip);
-    return (it != client_backend_mapping_.end()) ? it->second : nullptr;
+std::optional<TriageVerdict> LoadBalancer::triage_inline(const std::string& client_ip, const ClientFeatures* features) {
+    if (auto listed = triage_.check_address(client_ip)) {
+        return TriageVerdict{*listed, TriageStage::ADDRESS_LIST};
+    }
+    // Ahead of the verdict cache, which would otherwise shield a client classified before it began flooding
+    if (triage_.has_rate_limits()) {
+        auto limited = triage_.check_rates(features ? *features : client_features_.features(client_ip));
+        if (limited) return TriageVerdict{*limited, TriageStage::RATE_LIMIT};
+    }
+    return std::nullopt;
 }
 
-void LoadBalancer::assign_backend_to_client(const std::string& client_ip, std::shared_ptr<BackendNode> backend) {
-    std::lock_guard<std::mutex> lock(mapping_mutex_);
-    client_backend_mapping_[client_ip] = backend;
+BackendId LoadBalancer::route_known_client(Listener& listener, const std::string& client_ip, const std::string& key) {
+    {
+        std::lock_guard<std::mutex> lock(listener.pinned_mutex);
+        auto it = listener.pinned_backends.find(key);
+        if (it != listener.pinned_backends.end()) {
+            backends_.attach(it->second);
+            return it->second;
+        }
+    }
+
+    std::optional<bool> is_malicious;
+    {
+        std::lock_guard<std::mutex> lock(verdict_mutex_);
+        auto it = verdict_cache_.find(key);
+        if (it != verdict_cache_.end()) {
+            is_malicious = it->second;
+        }
+    }
+    if (!is_malicious) {
+        // A TLS stack not classified yet still gets the verdict its address has
+        return key == client_ip ? INVALID_BACKEND_ID : route_known_client(listener, client_ip, client_ip);
+    }
+    // Classified on another port: route here by the same verdict
+    BackendId backend = select_backend(listener, listener.group, *is_malicious, client_ip);
+    if (backend != INVALID_BACKEND_ID) {
+        pin_backend(listener, key, backend);
+    }
+    return backend;
 }
 
-void LoadBalancer::release_backend(const std::string& server_id) {
-    std::lock_guard<std::mutex> lock(backends_mutex_);
+void LoadBalancer::pin_backend(Listener& listener, const std::string& key, BackendId backend) {
+    std::lock_guard<std::mutex> lock(listener.pinned_mutex);
+    listener.pinned_backends[key] = backend;
+}
 
-    auto find_server = [&](const std::vector<std::shared_ptr<BackendNode>>& backends) {
-        for (const auto& server : backends) {
-            if (server->id == server_id) {
-                server->current_clients--;
-                return true;
+bool LoadBalancer::remember_verdict(const std::string& client_ip, const std::string& key, bool is_malicious) {
+    std::string evicted;
+    {
+        std::lock_guard<std::mutex> lock(verdict_mutex_);
+        auto [it, inserted] = verdict_cache_.emplace(key, is_malicious);
+        if (!inserted && it->second == is_malicious) return false;
+        it->second = is_malicious;
+        if (inserted && key != client_ip) {
+            auto& keys = fingerprint_verdicts_[client_ip];
+            keys.push_back(key);
+            if (keys.size() > MAX_FINGERPRINT_VERDICTS) {
+                evicted = std::move(keys.front());
+                keys.erase(keys.begin());
+                verdict_cache_.erase(evicted);
             }
         }
-        return false;
-    };
+    }
+    // Routes picked under the old verdict point at the wrong pool now
+    for (auto& listener : listeners_) {
+        std::lock_guard<std::mutex> lock(listener->pinned_mutex);
+        listener->pinned_backends.erase(key);
+        if (!evicted.empty()) {
+            listener->pinned_backends.erase(evicted);
+        }
+    }
+    return true;
+}
 
-    if (!find_server(real_backends_)) {
-        find_server(honeypot_backends_);
+void LoadBalancer::release_backend(BackendId backend) {
+    if (backends_.contains(backend)) {
+        backends_.release(backend);
     }
 }
 
 void LoadBalancer::handle_classification(const Event& event) {
-    if (event.data.contains("client_ip") && event.data.contains("classification")) {
-        std::string client_ip = event.data["client_ip"];
-        bool is_malicious = event.data["classification"] == "malicious";
-        
-        // Get client pointer if available
-        uintptr_t client_ptr_val = 0;
-        if (event.data.contains("client_ptr")) {
-            client_ptr_val = event.data["client_ptr"];
+    // Unsolicited verdicts only update the cache, live connections are resumed by handle_verdict().
+    // Each listener picks a backend for the client on its next connection.
+    bool is_malicious = event.data["classification"] == "malicious";
+    // A verdict naming a TLS fingerprint applies to that client stack only
+    std::string key = verdict_key(event.data["client_ip"], event.data.value("fingerprint", std::string()));
+    if (remember_verdict(event.data["client_ip"], key, is_malicious)) {
+        LOG_INFO("Client classified: " + event.data["client_ip"].get<std::string>() + " as " +
+                 (is_malicious ? "malicious" : "benign"));
+    }
+}
+
+void LoadBalancer::handle_verdict(ClientConnection::Ptr client, RequestStatus status, const nlohmann::json& verdict) {
+    if (client->listener.profile.protocol == ListenerProtocol::HTTP) {
+        handle_request_verdict(client, status, verdict);
+        return;
+    }
+    std::optional<TriageVerdict> result = read_verdict(client->client_ip, status, verdict,
+                                                       client->classification_sent_at);
+    BackendId backend = INVALID_BACKEND_ID;
+    if (result) {
+        backend = route_verdict(client->listener, client->listener.group, client->client_ip, client->verdict_key,
+                                *result);
+    }
+    if (backend != INVALID_BACKEND_ID) {
+        client->is_malicious = result->is_malicious;
+    }
+    resume_client(client, backend);
+}
+
+std::optional<TriageVerdict> LoadBalancer::read_verdict(const std::string& client_ip, RequestStatus status,
+                                                        const nlohmann::json& verdict,
+                                                        std::chrono::steady_clock::time_point sent_at) {
+    auto elapsed = std::chrono::steady_clock::now() - sent_at;
+    if (status == RequestStatus::OK && verdict.contains("classification")) {
+        performance_.stage_latency.record(LatencyStage::VERDICT, elapsed);
+        triage_.record(TriageStage::DEEP_INSPECTION, elapsed);
+        return TriageVerdict{verdict["classification"] == "malicious", TriageStage::DEEP_INSPECTION};
+    }
+
+    std::string reason = status == RequestStatus::OK        ? ": malformed classifier reply" :
+                         status == RequestStatus::TIMEOUT   ? ": classifier timed out" :
+                         status == RequestStatus::CANCELLED ? ": request cancelled" : ": request dropped";
+    // Out of the classifier's budget; a cancelled request belongs to a closed connection
+    bool over_budget = status == RequestStatus::TIMEOUT || status == RequestStatus::DROPPED;
+    if (over_budget) {
+        triage_.record(TriageStage::TIMEOUT_ACTION, elapsed);
+        if (auto fallback = triage_.timeout_verdict()) {
+            LOG_WARN("No verdict for client " + client_ip + reason + ", routed as " +
+                     (*fallback ? "malicious" : "benign"));
+            return TriageVerdict{*fallback, TriageStage::TIMEOUT_ACTION};
         }
+    }
+    LOG_WARN("No verdict for client " + client_ip + reason);
+    counters_.routing_errors.increment();
+    return std::nullopt;
+}
 
-        LOG_INFO("Client classified: " + client_ip + " as " + 
-                 (is_malicious ? "malicious" : "benign"));
+BackendId LoadBalancer::route_verdict(Listener& listener, BackendGroupId group, const std::string& client_ip,
+                                      const std::string& key, const TriageVerdict& verdict) {
+    if (verdict.stage == TriageStage::DEEP_INSPECTION) {
+        return apply_verdict(listener, group, client_ip, key, verdict.is_malicious);
+    }
+    // Decided again on the next connection, so a rate limit or a timeout does not stick
+    BackendId backend = select_backend(listener, group, verdict.is_malicious, client_ip);
+    if (backend == INVALID_BACKEND_ID) {
+        LOG_ERROR("No available backend for client: " + client_ip);
+    }
+    return backend;
+}
 
-        // Select backend based on classification
-        auto backend = select_backend(is_malicious, client_ip);
-        if (backend) {
-            assign_backend_to_client(client_ip, backend);
-            
-            // If we have client pointer, we can resume request processing
-            if (client_ptr_val != 0) {
-                TODO();
-                // Note: In real implementation, you'd need to map client_ptr_val back to ClientConnection
-                // This might require maintaining a registry of active connections
+BackendId LoadBalancer::apply_verdict(Listener& listener, BackendGroupId group, const std::string& client_ip,
+                                      const std::string& key, bool is_malicious) {
+    LOG_INFO("Client classified: " + client_ip + " as " + 
+             (is_malicious ? "malicious" : "benign"));
+    remember_verdict(client_ip, key, is_malicious);
+
+    // Select backend based on classification
+    BackendId backend = select_backend(listener, group, is_malicious, client_ip);
+    if (backend != INVALID_BACKEND_ID) {
+        // A route picks the group per request, the client as a whole has no single backend
+        if (group == listener.group) {
+            pin_backend(listener, key, backend);
+        }
+    } else {
+        LOG_ERROR("No available backend for client: " + client_ip);
+    }
+    return backend;
+}
+
+void LoadBalancer::resume_client(const ClientConnection::Ptr& client, BackendId backend) {
+    // Verdicts arrive on the bus worker, sockets belong to the connection's strand
+    asio::post(client->strand, bind_arena(client->arena, [this, client, backend]() {
+#if HG_COROUTINES
+        client->routed_backend = backend;
+        client->verdict_signal.cancel();
+#else
+        if (!client->active.load()) {
+            // Closed while classifying; close_client() had no backend to release
+            if (backend != INVALID_BACKEND_ID) {
+                release_backend(backend);
             }
+            return;
+        }
+        if (backend == INVALID_BACKEND_ID) {
+            close_client(client);
         } else {
-            LOG_ERROR("No available backend for client: " + client_ip);
+            proxy_to_backend(client, backend);
         }
-    }
+#endif
+    }));
 }
 
 // Selection strategy implementations
-std::shared_ptr<BackendNode> LoadBalancer::round_robin_selection(const std::vector<std::shared_ptr<BackendNode>>& backends) {
-    if (backends.empty()) return nullptr;
-    size_t index = round_robin_index_++ % backends.size();
-    return backends[index];
+BackendId LoadBalancer::round_robin_selection(const BackendPool& pool) {
+    if (pool.empty()) return INVALID_BACKEND_ID;
+    size_t start = round_robin_index_++;
+    for (size_t i = 0; i < pool.size(); ++i) {
+        BackendId id = pool[(start + i) % pool.size()];
+        if (backends_.is_healthy(id)) return id;
+    }
+    return INVALID_BACKEND_ID;
 }
 
-std::shared_ptr<BackendNode> LoadBalancer::least_connections_selection(const std::vector<std::shared_ptr<BackendNode>>& backends) {
-    if (backends.empty()) return nullptr;
-    return *std::min_element(backends.begin(), backends.end(),
-                             [](const auto& a, const auto& b) {
-                                 return a->current_clients.load() < b->current_clients.load();
-                             });
+BackendId LoadBalancer::least_connections_selection(const BackendPool& pool) {
+    BackendId best = INVALID_BACKEND_ID;
+    int best_clients = 0;
+    for (BackendId id : pool) {
+        if (!backends_.is_healthy(id)) continue;
+        int clients = backends_.current_clients(id);
+        if (best == INVALID_BACKEND_ID || clients < best_clients) {
+            best = id;
+            best_clients = clients;
+        }
+    }
+    return best;
 }
 
-std::shared_ptr<BackendNode> LoadBalancer::ip_hash_selection(const std::vector<std::shared_ptr<BackendNode>>& backends, const std::string& client_ip) {
-    if (backends.empty()) return nullptr;
+BackendId LoadBalancer::ip_hash_selection(const BackendPool& pool, const std::string& client_ip) {
+    if (pool.empty()) return INVALID_BACKEND_ID;
     if (client_ip.empty()) {
-        return round_robin_selection(backends);
+        return round_robin_selection(pool);
     }
 
     std::hash<std::string> hasher;
     size_t hash = hasher(client_ip);
-    size_t index = hash % backends.size();
 
-    return backends[index];
+    // Probe forward from the hashed slot so a dead backend only moves its own clients
+    for (size_t i = 0; i < pool.size(); ++i) {
+        BackendId id = pool[(hash + i) % pool.size()];
+        if (backends_.is_healthy(id)) return id;
+    }
+    return INVALID_BACKEND_ID;
 }
 
-std::shared_ptr<BackendNode> LoadBalancer::weighted_selection(const std::vector<std::shared_ptr<BackendNode>>& backends) {
-    if (backends.empty()) return nullptr;
+BackendId LoadBalancer::weighted_selection(const BackendPool& pool) {
+    if (pool.empty()) return INVALID_BACKEND_ID;
+
+    double total_weight = 0.0;
+    for (BackendId id : pool) {
+        if (backends_.is_healthy(id)) total_weight += backends_.weight(id);
+    }
 
-    int total_weight = 0;
-    for (const auto& backend : backends) {
-        total_weight += backend->weight;
+    if (total_weight <= 0.0) {
+        return round_robin_selection(pool);
     }
 
-    if (total_weight == 0) {
-        return round_robin_selection(backends);
+    thread_local std::mt19937 gen(std::random_device{}());
+    std::uniform_real_distribution<> dis(0.0, total_weight);
+
+    double random_weight = dis(gen);
+    double current_weight = 0.0;
+    BackendId last_healthy = INVALID_BACKEND_ID;
+
+    for (BackendId id : pool) {
+        if (!backends_.is_healthy(id)) continue;
+        last_healthy = id;
+        current_weight += backends_.weight(id);
+        if (random_weight < current_weight) {
+            return id;
+        }
     }
 
-    static std::random_device rd;
-    static std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(1, total_weight);
+    return last_healthy;
+}
 
-    int random_weight = dis(gen);
-    int current_weight = 0;
+void LoadBalancer::reload_routes() {
+    const std::string path = ROUTES_FILE();
+    std::error_code error;
+    auto mtime = std::filesystem::last_write_time(path, error);
+    if (error) {
+        // Reported once, until the file is back
+        if (routes_mtime_ != std::filesystem::file_time_type::min()) {
+            LOG_ERROR("Routes file " + path + " is unreadable, keeping the current routes: " + error.message());
+            routes_mtime_ = std::filesystem::file_time_type::min();
+        }
+        return;
+    }
+    if (routes_mtime_ == mtime) return;
+    routes_mtime_ = mtime;
 
-    for (const auto& backend : backends) {
-        current_weight += backend->weight;
-        if (random_weight <= current_weight) {
-            return backend;
+    // Every table compiles before any is published, so a bad file changes no listener
+    std::vector<std::shared_ptr<const RouteTable>> tables(listeners_.size());
+    try {
+        std::vector<RouteRule> rules = RouteRule::parse_file(path);
+        for (size_t i = 0; i < listeners_.size(); ++i) {
+            const ListenerProfile& profile = listeners_[i]->profile;
+            if (profile.protocol != ListenerProtocol::HTTP) continue;
+            std::vector<RouteRule> own;
+            for (const RouteRule& rule : rules) {
+                if (rule.listener.empty() || rule.listener == profile.name) own.push_back(rule);
+            }
+            if (!own.empty()) tables[i] = std::make_shared<const RouteTable>(own, backends_);
         }
+    } catch (const std::exception& e) {
+        LOG_ERROR("Routes file " + path + " not applied, keeping the current routes: " + std::string(e.what()));
+        return;
     }
 
-    return backends.back();
+    for (size_t i = 0; i < listeners_.size(); ++i) {
+        if (listeners_[i]->profile.protocol != ListenerProtocol::HTTP) continue;
+        std::atomic_store(&listeners_[i]->routes, tables[i]);
+        LOG_INFO("Listener " + listeners_[i]->profile.name + ": " +
+                 std::to_string(tables[i] ? tables[i]->size() : 0) + " routes from " + path);
+    }
 }
 
 // Health checking implementation
 void LoadBalancer::start_health_checks(std::chrono::seconds interval) {
-    if (running_.exchange(true)) return;
+    // Checks only start connects, the waiting happens on io_context_
+    auto run_checks = [this]() {
+        asio::post(io_context_, [this]() { perform_health_checks(); });
+    };
+    run_checks();
+    health_check_task_ = Scheduler::the().schedule_every(interval, run_checks, interval / 10);
+}
+
+void LoadBalancer::perform_health_checks() {
+    for (BackendId id = 0; id < backends_.size(); ++id) {
+        check_server_health(id);
+    }
+}
+
+void LoadBalancer::check_server_health(BackendId backend) {
+    const auto& server = backends_.node(backend);
+
+    asio::error_code error;
+    auto address = asio::ip::make_address(server->host, error);
+    if (error) {
+        LOG_WARN("Health check failed for " + server->id + ": " + error.message());
+        update_health(backend, false);
+        return;
+    }
+
+    // The timeout and the connect completion share a strand, both touch the socket
+    auto strand = asio::make_strand(io_context_);
+    auto socket = std::make_shared<asio::ip::tcp::socket>(strand);
+    auto timeout = std::make_shared<asio::steady_timer>(strand, std::chrono::seconds(2));
 
-    health_check_thread_ = std::thread([this, interval]() {
-        while (running_.load()) {
-            perform_health_checks();
-            std::this_thread::sleep_for(interval);
+    // Closing the socket aborts a connect that outlived the timeout
+    timeout->async_wait([socket](const asio::error_code& error) {
+        if (!error) {
+            asio::error_code ignored;
+            socket->close(ignored);
         }
     });
+    socket->async_connect(asio::ip::tcp::endpoint(address, server->port),
+        [this, backend, socket, timeout](const asio::error_code& error) {
+            timeout->cancel();
+            asio::error_code ignored;
+            socket->close(ignored);
+            update_health(backend, !error);
+        });
 }
 
-void LoadBalancer::perform_health_checks() {
-    std::lock_guard<std::mutex> lock(backends_mutex_);
-
-    auto check_backends = [this](std::vector<std::shared_ptr<BackendNode>>& backends) {
-        for (auto& backend : backends) {
-            bool was_healthy = backend->is_healthy.load();
-            bool is_healthy = check_server_health(backend);
-
-            backend->is_healthy = is_healthy;
-            backend->last_health_check = std::chrono::steady_clock::now();
-
-            if (was_healthy != is_healthy) {
-                DataBus::instance().publish(
-                    BusEventType::SERVICE_HEALTH_UPDATE,
-                    "load_balancer",
-                    {
-                        {"server_id", backend->id},
-                        {"host", backend->host},
-                        {"port", std::to_string(backend->port)},
-                        {"is_honeypot", backend->is_honeypot},
-                        {"healthy", is_healthy},
-                        {"current_connections", backend->current_clients.load()}
-                    }
-                );
-                
-                LOG_INFO("Backend " + backend->id + " health changed: " + 
-                         (is_healthy ? "healthy" : "unhealthy"));
-            }
-        }
-    };
+void LoadBalancer::update_health(BackendId backend, bool is_healthy) {
+    const auto& server = backends_.node(backend);
+    bool was_healthy = backends_.is_healthy(backend);
 
-    check_backends(real_backends_);
-    check_backends(honeypot_backends_);
-}
+    backends_.set_healthy(backend, is_healthy);
+    server->last_health_check = std::chrono::steady_clock::now();
 
-bool LoadBalancer::check_server_health(const std::shared_ptr<BackendNode>& server) {
-    try {
-        // TCP connection check with timeout
-        asio::io_context io_context;
-        asio::ip::tcp::socket socket(io_context);
-        asio::ip::tcp::endpoint endpoint(
-            asio::ip::make_address(server->host), 
-            server->port
+    if (was_healthy != is_healthy) {
+        DataBus::instance().publish(
+            BusEventType::SERVICE_HEALTH_UPDATE,
+            "load_balancer",
+            {
+                {"server_id", server->id},
+                {"backend_id", backend},
+                {"host", server->host},
+                {"port", std::to_string(server->port)},
+                {"is_honeypot", server->is_honeypot},
+                {"healthy", is_healthy},
+                {"current_connections", backends_.current_clients(backend)}
+            }
         );
-        
-        // Use async connect with timeout
-        bool connected = false;
-        std::promise<bool> connect_promise;
-        std::future<bool> connect_future = connect_promise.get_future();
-        
-        socket.async_connect(endpoint,
-            [&](const asio::error_code& error) {
-                if (!error) {
-                    connected = true;
-                }
-                connect_promise.set_value(!error);
-            });
-        
-        // Run io_context with timeout
-        io_context.run_for(std::chrono::seconds(2));
-        
-        if (socket.is_open()) {
-            socket.close();
-        }
-        
-        return connected;
-        
-    } catch (const std::exception& e) {
-        LOG_WARN("Health check failed for " + server->id + ": " + e.what());
-        return false;
+
+        LOG_INFO("Backend " + server->id + " health changed: " +
+                 (is_healthy ? "healthy" : "unhealthy"));
     }
 }
 
 // Event handlers
 void LoadBalancer::handle_health_update(const Event& event) {
-    if (event.data.contains("server_id") && event.data.contains("healthy")) {
-        std::string server_id = event.data["server_id"];
-        bool healthy = event.data["healthy"];
+    BackendId backend = backend_from_event(event);
+    if (backends_.contains(backend)) {
+        backends_.set_healthy(backend, event.data["healthy"].get<bool>());
+    }
+}
 
-        std::lock_guard<std::mutex> lock(backends_mutex_);
+void LoadBalancer::handle_response_metrics(const Event& event) {
+    BackendId backend = backend_from_event(event);
+    if (!backends_.contains(backend)) return;
 
-        auto update_health = [&](std::vector<std::shared_ptr<BackendNode>>& backends) {
-            for (auto& backend : backends) {
-                if (backend->id == server_id) {
-                    backend->is_healthy = healthy;
-                    return true;
-                }
-            }
-            return false;
-        };
+    bool success = event.data["success"];
+    auto response_time = std::chrono::milliseconds(event.data["response_time_ms"]);
 
-        if (!update_health(real_backends_)) {
-            update_health(honeypot_backends_);
-        }
+    if (success) {
+        mark_request_success(backend, response_time);
+    } else {
+        mark_request_failure(backend);
     }
 }
 
-void LoadBalancer::handle_response_metrics(const Event& event) {
-    if (event.data.contains("server_id") && event.data.contains("response_time_ms") && event.data.contains("success")) {
-        std::string server_id = event.data["server_id"];
-        bool success = event.data["success"];
-        auto response_time = std::chrono::milliseconds(event.data["response_time_ms"]);
-
-        if (success) {
-            mark_request_success(server_id, response_time);
-        } else {
-            mark_request_failure(server_id);
-        }
+BackendId LoadBalancer::backend_from_event(const Event& event) const {
+    if (event.data.contains("backend_id")) {
+        return event.data["backend_id"].get<BackendId>();
     }
+    if (event.data.contains("server_id")) {
+        return backends_.find(event.data["server_id"].get<std::string>());
+    }
+    return INVALID_BACKEND_ID;
 }
 
-void LoadBalancer::mark_request_success(const std::string& server_id, std::chrono::milliseconds response_time) {
-    std::lock_guard<std::mutex> lock(backends_mutex_);
-    
-    auto update_server = [&](std::vector<std::shared_ptr<BackendNode>>& backends) {
-        for (auto& backend : backends) {
-            if (backend->id == server_id) {
-                // Update server metrics for successful request
-                backend->last_request_time = std::chrono::steady_clock::now();
-                return true;
-            }
-        }
-        return false;
-    };
-    
-    update_server(real_backends_) || update_server(honeypot_backends_);
+void LoadBalancer::mark_request_success(BackendId backend, std::chrono::milliseconds response_time) {
+    // Update server metrics for successful request
+    backends_.touch(backend);
 }
 
-void LoadBalancer::mark_request_failure(const std::string& server_id) {
-    std::lock_guard<std::mutex> lock(backends_mutex_);
-    
-    auto update_server = [&](std::vector<std::shared_ptr<BackendNode>>& backends) {
-        for (auto& backend : backends) {
-            if (backend->id == server_id) {
-                // Update server metrics for failed request
-                // Could implement circuit breaker pattern here
-                return true;
-            }
-        }
-        return false;
-    };
-    
-    update_server(real_backends_) || update_server(honeypot_backends_);
+void LoadBalancer::mark_request_failure(BackendId backend) {
+    // Update server metrics for failed request
+    // Could implement circuit breaker pattern here
+    (void)backend;
 }
 
 // Statistics and utility methods
 LoadBalancerStats LoadBalancer::get_stats() const {
-    std::lock_guard<std::mutex> lock(backends_mutex_);
-
-    LoadBalancerStats stats = stats_;
-    stats.total_real_backends = real_backends_.size();
-    stats.total_honeypot_backends = honeypot_backends_.size();
+    LoadBalancerStats stats;
+    stats.start_time = start_time_;
+    stats.total_requests_processed = counters_.total_requests_processed.value();
+    stats.requests_routed_to_real = counters_.requests_routed_to_real.value();
+    stats.requests_routed_to_honeypot = counters_.requests_routed_to_honeypot.value();
+    stats.routing_errors = counters_.routing_errors.value();
+    for (size_t i = 0; i < ROUTING_STRATEGY_COUNT; ++i) {
+        stats.strategy_usage[static_cast<RoutingStrategy>(i)] = counters_.strategy_usage[i].value();
+    }
     stats.total_connections = 0;
     stats.healthy_real_backends = 0;
     stats.healthy_honeypot_backends = 0;
 
-    for (const auto& backend : real_backends_) {
-        if (backend->is_healthy.load()) stats.healthy_real_backends++;
-        stats.total_connections += backend->current_clients.load();
+    auto real_pool = backends_.pool(false);
+    auto honeypot_pool = backends_.pool(true);
+    stats.total_real_backends = real_pool->size();
+    stats.total_honeypot_backends = honeypot_pool->size();
+
+    for (BackendId id : *real_pool) {
+        if (backends_.is_healthy(id)) stats.healthy_real_backends++;
+        stats.total_connections += backends_.current_clients(id);
     }
 
-    for (const auto& backend : honeypot_backends_) {
-        if (backend->is_healthy.load()) stats.healthy_honeypot_backends++;
-        stats.total_connections += backend->current_clients.load();
+    for (BackendId id : *honeypot_pool) {
+        if (backends_.is_healthy(id)) stats.healthy_honeypot_backends++;
+        stats.total_connections += backends_.current_clients(id);
     }
 
     return stats;
@@ -685,11 +1673,273 @@ const PerformanceMetrics& LoadBalancer::get_performance_metrics() const {
     return performance_;
 }
 
+StageLatencySummary LoadBalancer::get_latency_summary() const {
+    return performance_.stage_latency.summary();
+}
+
+std::vector<std::pair<std::string, StageLatencySummary>> LoadBalancer::get_backend_latency_summaries() const {
+    std::vector<std::pair<std::string, StageLatencySummary>> result;
+    result.reserve(backends_.size());
+    for (BackendId id = 0; id < backends_.size(); ++id) {
+        const auto& backend = backends_.node(id);
+        result.emplace_back(backend->id, backend->latency.summary());
+    }
+    return result;
+}
+
+void LoadBalancer::collect_metrics(metrics::OpenMetricsWriter& writer) const {
+    using metrics::MetricType;
+
+    const BackendId backend_count = static_cast<BackendId>(backends_.size());
+    auto uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time_).count();
+
+    writer.family("heavengate_lb_uptime_seconds", MetricType::GAUGE, "Load balancer uptime");
+    writer.gauge("heavengate_lb_uptime_seconds", uptime);
+
+    writer.family("heavengate_lb_requests", MetricType::COUNTER, "Requests routed to a backend");
+    writer.counter("heavengate_lb_requests", counters_.total_requests_processed.value());
+
+    writer.family("heavengate_lb_requests_routed", MetricType::COUNTER, "Requests routed by target pool");
+    writer.counter("heavengate_lb_requests_routed", counters_.requests_routed_to_real.value(), {{"pool", "real"}});
+    writer.counter("heavengate_lb_requests_routed", counters_.requests_routed_to_honeypot.value(), {{"pool", "honeypot"}});
+
+    writer.family("heavengate_lb_routing_errors", MetricType::COUNTER, "Requests that could not be routed");
+    writer.counter("heavengate_lb_routing_errors", counters_.routing_errors.value());
+
+    writer.family("heavengate_lb_strategy_usage", MetricType::COUNTER, "Backend selections by routing strategy");
+    for (size_t i = 0; i < ROUTING_STRATEGY_COUNT; ++i) {
+        writer.counter("heavengate_lb_strategy_usage", counters_.strategy_usage[i].value(),
+                       {{"strategy", strategy_to_string(static_cast<RoutingStrategy>(i))}});
+    }
+
+    writer.family("heavengate_lb_routing_operations", MetricType::COUNTER, "Backend selections performed");
+    writer.counter("heavengate_lb_routing_operations", performance_.total_routing_operations.value());
+
+    writer.family("heavengate_lb_routing_time_seconds", MetricType::COUNTER, "Time spent selecting backends");
+    writer.float_counter("heavengate_lb_routing_time_seconds",
+                         static_cast<double>(performance_.total_routing_time_ns.value()) / 1e9);
+
+    writer.family("heavengate_lb_backend_selection_failures", MetricType::COUNTER, "Selections with no healthy backend");
+    writer.counter("heavengate_lb_backend_selection_failures", performance_.backend_selection_failures.value());
+
+    writer.family("heavengate_lb_client_features_bytes", MetricType::GAUGE, "Fixed memory of the client feature sketches");
+    writer.gauge("heavengate_lb_client_features_bytes", static_cast<double>(client_features_.memory_bytes()));
+
+    std::vector<const UringEngine*> uring_engines;
+    writer.family("heavengate_lb_accept_wakeups", MetricType::COUNTER, "Accept completions, each followed by a drain of the backlog");
+    for (const auto& listener : listeners_) {
+        writer.counter("heavengate_lb_accept_wakeups", listener->accept_wakeups.value(),
+                       {{"listener", listener->profile.name}});
+        if (listener->uring) uring_engines.push_back(listener->uring.get());
+    }
+    writer.family("heavengate_lb_accepted_connections", MetricType::COUNTER, "Connections accepted by the asio engine");
+    for (const auto& listener : listeners_) {
+        writer.counter("heavengate_lb_accepted_connections", listener->connections_accepted.value(),
+                       {{"listener", listener->profile.name}});
+    }
+    if (!uring_engines.empty()) {
+        UringEngine::collect_metrics(writer, uring_engines);
+    }
+
+    auto http_counter = [this, &writer](const std::string& name, const std::string& help,
+                                        metrics::ShardedCounter Listener::*counter) {
+        writer.family(name, MetricType::COUNTER, help);
+        for (const auto& listener : listeners_) {
+            if (listener->profile.protocol != ListenerProtocol::HTTP) continue;
+            writer.counter(name, ((*listener).*counter).value(), {{"listener", listener->profile.name}});
+        }
+    };
+    http_counter("heavengate_lb_http_requests", "HTTP requests parsed, each classified and routed",
+                 &Listener::http_requests);
+    http_counter("heavengate_lb_http_rejected", "HTTP requests refused as malformed, oversized or unroutable",
+                 &Listener::http_rejected);
+    http_counter("heavengate_lb_http_backend_switches", "Keep-alive connections moved to another backend by a later request",
+                 &Listener::http_backend_switches);
+    http_counter("heavengate_lb_http_routed", "HTTP requests sent to a backend group by a route rule",
+                 &Listener::http_routed);
+
+    writer.family("heavengate_lb_client_hellos", MetricType::COUNTER,
+                  "TCP connections that opened with a TLS ClientHello, fingerprinted for classification");
+    for (const auto& listener : listeners_) {
+        if (listener->profile.protocol != ListenerProtocol::TCP) continue;
+        writer.counter("heavengate_lb_client_hellos", listener->client_hellos.value(),
+                       {{"listener", listener->profile.name}});
+    }
+
+#if HG_TLS
+    auto tls_counter = [this, &writer](const std::string& name, const std::string& help,
+                                       metrics::ShardedCounter Listener::*counter) {
+        writer.family(name, MetricType::COUNTER, help);
+        for (const auto& listener : listeners_) {
+            if (!listener->tls) continue;
+            writer.counter(name, ((*listener).*counter).value(), {{"listener", listener->profile.name}});
+        }
+    };
+    tls_counter("heavengate_lb_tls_handshakes", "TLS handshakes completed; their rate is the handshake rate",
+                &Listener::tls_handshakes);
+    tls_counter("heavengate_lb_tls_handshake_failures", "TLS handshakes that failed or were cut short",
+                &Listener::tls_handshake_failures);
+    tls_counter("heavengate_lb_tls_resumed", "TLS handshakes that resumed a session from the cache or a ticket",
+                &Listener::tls_resumed);
+    tls_counter("heavengate_lb_tls_kernel_offloaded", "TLS connections whose records the kernel encrypts",
+                &Listener::tls_kernel_offloaded);
+
+    writer.family("heavengate_lb_tls_resumption_ratio", MetricType::GAUGE,
+                  "Resumed over completed TLS handshakes since start");
+    for (const auto& listener : listeners_) {
+        if (!listener->tls) continue;
+        uint64_t handshakes = listener->tls_handshakes.value();
+        double ratio = handshakes ? static_cast<double>(listener->tls_resumed.value()) / handshakes : 0.0;
+        writer.gauge("heavengate_lb_tls_resumption_ratio", ratio, {{"listener", listener->profile.name}});
+    }
+    writer.family("heavengate_lb_tls_cached_sessions", MetricType::GAUGE, "Sessions held by the TLS session cache");
+    for (const auto& listener : listeners_) {
+        if (!listener->tls) continue;
+        writer.gauge("heavengate_lb_tls_cached_sessions", listener->tls->cached_sessions(),
+                     {{"listener", listener->profile.name}});
+    }
+#endif
+
+    writer.family("heavengate_lb_handler_heap_allocations", MetricType::COUNTER,
+                  "Connection async operations that did not fit the per-connection arena");
+    writer.counter("heavengate_lb_handler_heap_allocations",
+                   HandlerArena::heap_fallbacks().load(std::memory_order_relaxed));
+
+    size_t healthy[2] = {0, 0};
+    size_t total[2] = {0, 0};
+    long connections = 0;
+    for (BackendId id = 0; id < backend_count; ++id) {
+        bool is_honeypot = backends_.node(id)->is_honeypot;
+        total[is_honeypot]++;
+        healthy[is_honeypot] += backends_.is_healthy(id) ? 1 : 0;
+        connections += backends_.current_clients(id);
+    }
+
+    writer.family("heavengate_lb_backends", MetricType::GAUGE, "Registered backends");
+    writer.gauge("heavengate_lb_backends", total[0], {{"pool", "real"}, {"state", "total"}});
+    writer.gauge("heavengate_lb_backends", healthy[0], {{"pool", "real"}, {"state", "healthy"}});
+    writer.gauge("heavengate_lb_backends", total[1], {{"pool", "honeypot"}, {"state", "total"}});
+    writer.gauge("heavengate_lb_backends", healthy[1], {{"pool", "honeypot"}, {"state", "healthy"}});
+
+    writer.family("heavengate_lb_connections", MetricType::GAUGE, "Client connections assigned to backends");
+    writer.gauge("heavengate_lb_connections", static_cast<double>(connections));
+
+    writer.family("heavengate_lb_stage_latency_seconds", MetricType::HISTOGRAM, "Request lifecycle stage latency");
+    for (size_t i = 0; i < LATENCY_STAGE_COUNT; ++i) {
+        writer.histogram("heavengate_lb_stage_latency_seconds", performance_.stage_latency.stages[i].snapshot(),
+                         {{"stage", stage_to_string(static_cast<LatencyStage>(i))}});
+    }
+    triage_.collect_metrics(writer);
+
+    auto backend_labels = [](const BackendNode& backend) {
+        return metrics::Labels{{"backend", backend.id}, {"pool", backend.is_honeypot ? "honeypot" : "real"}};
+    };
+
+    writer.family("heavengate_backend_up", MetricType::GAUGE, "Backend health check state");
+    for (BackendId id = 0; id < backend_count; ++id) {
+        writer.gauge("heavengate_backend_up", backends_.is_healthy(id) ? 1 : 0, backend_labels(*backends_.node(id)));
+    }
+
+    writer.family("heavengate_backend_connections", MetricType::GAUGE, "Client connections assigned to the backend");
+    for (BackendId id = 0; id < backend_count; ++id) {
+        writer.gauge("heavengate_backend_connections", backends_.current_clients(id), backend_labels(*backends_.node(id)));
+    }
+
+    writer.family("heavengate_backend_requests", MetricType::COUNTER, "Requests routed to the backend");
+    for (BackendId id = 0; id < backend_count; ++id) {
+        writer.counter("heavengate_backend_requests", static_cast<uint64_t>(backends_.total_requests(id)),
+                       backend_labels(*backends_.node(id)));
+    }
+
+    writer.family("heavengate_backend_stage_latency_seconds", MetricType::SUMMARY, "Per-backend stage latency");
+    for (BackendId id = 0; id < backend_count; ++id) {
+        const auto& backend = backends_.node(id);
+        for (LatencyStage stage : {LatencyStage::BACKEND_SELECT, LatencyStage::BACKEND_CONNECT,
+                                   LatencyStage::FIRST_RESPONSE_BYTE, LatencyStage::CLOSE}) {
+            auto labels = backend_labels(*backend);
+            labels.emplace_back("stage", stage_to_string(stage));
+            writer.summary("heavengate_backend_stage_latency_seconds",
+                           backend->latency.stages[static_cast<size_t>(stage)].snapshot(), labels);
+        }
+    }
+}
+
 void LoadBalancer::set_routing_strategy(RoutingStrategy strategy) {
     strategy_ = strategy;
+    for (auto& listener : listeners_) {
+        listener->strategy = strategy;
+    }
     LOG_INFO("Routing strategy changed to: " + strategy_to_string(strategy));
 }
 
+std::string LoadBalancer::protocol_to_string(ListenerProtocol protocol) {
+    switch (protocol) {
+        case ListenerProtocol::TCP: return "tcp";
+        case ListenerProtocol::HTTP: return "http";
+    }
+    return "unknown";
+}
+
+ListenerProtocol LoadBalancer::protocol_from_string(const std::string& name, ListenerProtocol fallback) {
+    std::string key;
+    for (char c : name) {
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (key == "tcp") return ListenerProtocol::TCP;
+    if (key == "http") return ListenerProtocol::HTTP;
+    if (!key.empty()) {
+        LOG_WARN("Unknown listener protocol '" + name + "', using " + protocol_to_string(fallback));
+    }
+    return fallback;
+}
+
+RoutingStrategy LoadBalancer::strategy_from_string(const std::string& name, RoutingStrategy fallback) {
+    std::string key;
+    for (char c : name) {
+        if (c == ' ' || c == '-') c = '_';
+        key += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (key == "round_robin") return RoutingStrategy::ROUND_ROBIN;
+    if (key == "least_connections") return RoutingStrategy::LEAST_CONNECTIONS;
+    if (key == "ip_hash") return RoutingStrategy::IP_HASH;
+    if (key == "weighted") return RoutingStrategy::WEIGHTED;
+    if (!key.empty()) {
+        LOG_WARN("Unknown routing strategy '" + name + "', using " + strategy_to_string(fallback));
+    }
+    return fallback;
+}
+
+std::vector<ListenerProfile> ListenerProfile::from_settings(RoutingStrategy default_strategy) {
+    std::vector<ListenerProfile> profiles;
+    std::string names = Confparcer::SETTING<std::string>("LISTENERS", "");
+    std::stringstream stream(names);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (name.empty()) continue;
+
+        std::string prefix = "LISTENER_";
+        for (char c : name) {
+            prefix += static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+        }
+
+        ListenerProfile profile;
+        profile.name = name;
+        profile.port = Confparcer::SETTING<int>(prefix + "_PORT", profile.port);
+        profile.strategy = LoadBalancer::strategy_from_string(
+            Confparcer::SETTING<std::string>(prefix + "_STRATEGY", ""), default_strategy);
+        profile.protocol = LoadBalancer::protocol_from_string(
+            Confparcer::SETTING<std::string>(prefix + "_PROTOCOL", ""), profile.protocol);
+        profile.backend_group = Confparcer::SETTING<std::string>(prefix + "_BACKENDS", profile.backend_group);
+        profile.classifier_profile = Confparcer::SETTING<std::string>(prefix + "_CLASSIFIER_PROFILE", name);
+        profile.options = ListenerOptions::from_settings(prefix);
+        profile.tls = TlsOptions::from_settings(prefix);
+        profiles.push_back(std::move(profile));
+    }
+    return profiles;
+}
+
 std::string LoadBalancer::strategy_to_string(RoutingStrategy strategy) {
     switch (strategy) {
         case RoutingStrategy::ROUND_ROBIN: return "Round Robin";
@@ -698,4 +1948,19 @@ std::string LoadBalancer::strategy_to_string(RoutingStrategy strategy) {
         case RoutingStrategy::WEIGHTED: return "Weighted";
         default: VERIFY_NOT_REACHED();
     }
+}
+
+std::string LoadBalancer::stage_to_string(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::ACCEPT: return "accept";
+        case LatencyStage::TLS_HANDSHAKE: return "tls_handshake";
+        case LatencyStage::CLASSIFICATION_REQUEST: return "classification_request";
+        case LatencyStage::VERDICT: return "verdict";
+        case LatencyStage::BACKEND_SELECT: return "backend_select";
+        case LatencyStage::BACKEND_CONNECT: return "backend_connect";
+        case LatencyStage::FIRST_RESPONSE_BYTE: return "first_response_byte";
+        case LatencyStage::CLOSE: return "close";
+        case LatencyStage::COUNT: break;
+    }
+    return "unknown";
 }
\ No newline at end of file
@@ -16,23 +16,155 @@
 #include <thread>
 #include <chrono>
 #include <unordered_map>
+#include <array>
+#include <filesystem>
+#include <optional>
 #include "../../thirdparty/asio/include/asio.hpp"
 #include "../DataBus/DataBus.h"
+#include "../Metrics/LatencyHistogram.h"
+#include "../Metrics/OpenMetrics.h"
+#include "../Metrics/ShardedCounter.h"
+#include "BackendRegistry.h"
+#include "ClientFeatures.h"
+#include "ClientTriage.h"
+#include "ClientHello.h"
+#include "HttpParser.h"
+#include "ListenerOptions.h"
+#include "RouteTable.h"
+#include "TlsContext.h"
+#include "TlsStream.h"
+#include "UringEngine.h"
+#include "../Runtime/Runtime.h"
+#include "../common/generic.h"
+#include "../common/HandlerArena.h"
+
+// Request lifecycle stages tracked by latency histograms
+enum class LatencyStage {
+    ACCEPT,                 // accept completion handling
+    TLS_HANDSHAKE,          // accept -> TLS handshake finished, TLS listeners only
+    CLASSIFICATION_REQUEST, // accept -> first bytes published to the classifier
+    VERDICT,                // classification request -> verdict received
+    BACKEND_SELECT,         // backend selection
+    BACKEND_CONNECT,        // connect started -> backend connected
+    FIRST_RESPONSE_BYTE,    // backend connected -> first response byte
+    CLOSE,                  // accept -> connection closed
+    COUNT
+};
+
+constexpr size_t LATENCY_STAGE_COUNT = static_cast<size_t>(LatencyStage::COUNT);
+
+using StageLatencySummary = std::array<metrics::LatencySummary, LATENCY_STAGE_COUNT>;
+
+struct StageLatencies {
+    std::array<metrics::LatencyHistogram, LATENCY_STAGE_COUNT> stages;
+
+    void record(LatencyStage stage, std::chrono::steady_clock::duration elapsed) {
+        stages[static_cast<size_t>(stage)].record(elapsed);
+    }
+
+    StageLatencySummary summary() const;
+};
+
+struct Listener;
 
 class ClientConnection : public std::enable_shared_from_this<ClientConnection> {
 public:
     using Ptr = std::shared_ptr<ClientConnection>;
     
+    using Strand = asio::strand<asio::io_context::executor_type>;
+    // Typed on the strand rather than asio's type-erased executor, which
+    // allocates to track outstanding work on every operation
+    using Socket = asio::basic_stream_socket<asio::ip::tcp, Strand>;
+
+    static constexpr size_t RELAY_BUFFER_SIZE = 8192;
+
     std::string client_ip;
-    std::string client_id;
-    asio::ip::tcp::socket socket;
-    std::shared_ptr<asio::ip::tcp::socket> backend_socket;
+    // Process-unique, assigned from a counter
+    uint64_t client_id;
+    // The port it came in on, owned by the LoadBalancer
+    Listener& listener;
+    // Serializes every completion on this connection, the runtime io_context is multi-threaded
+    Strand strand;
+    Socket socket;
+    std::optional<Socket> backend_socket;
+#if HG_TLS
+    // TLS listeners: the client side of socket, set when the handshake starts
+    std::unique_ptr<TlsStream> tls;
+#endif
     std::atomic<bool> is_malicious{false};
     std::atomic<bool> active{true};
+
+    // Operation memory for every async call on this connection, see HandlerArena
+    HandlerArena arena;
+    // One buffer per direction, each direction has a single read or write in flight
+    std::array<char, RELAY_BUFFER_SIZE> upstream_buffer;   // client -> backend
+    std::array<char, RELAY_BUFFER_SIZE> downstream_buffer; // backend -> client
+    // First bytes, held in upstream_buffer while waiting for the verdict and
+    // forwarded once the backend is connected
+    size_t pending_bytes{0};
+    BackendId backend_id{INVALID_BACKEND_ID};
+    // Outstanding classifier request, cancelled if the client goes away first
+    CorrelationId classification_request{INVALID_CORRELATION_ID};
+    // What verdicts and pins for this connection are stored under: the client
+    // IP, narrowed to one TLS client stack once a ClientHello was fingerprinted
+    std::string verdict_key;
+
+    // TCP listeners: the TLS ClientHello the stream opened with, read from
+    // upstream_buffer before the first bytes go to the classifier
+    ClientHelloParser client_hello;
+    std::optional<TlsFingerprint> fingerprint;
+
+    // HTTP listeners: request framing of the client stream. upstream_buffer
+    // holds [http_forwarded, http_received); bytes before http_parsed belong to
+    // a routed request, or are the head waiting for its verdict.
+    HttpRequestParser http;
+    size_t http_forwarded{0};
+    size_t http_parsed{0};
+    size_t http_received{0};
+    // The backend was half-closed and is finishing its responses; the
+    // connection then moves to next_backend, or ends if there is none
+    bool draining_backend{false};
+    BackendId next_backend{INVALID_BACKEND_ID};
+    // Group the route table picked for the request awaiting its verdict, and
+    // the one the current backend was selected from
+    BackendGroupId request_group{DEFAULT_BACKEND_GROUP};
+    BackendGroupId backend_group{DEFAULT_BACKEND_GROUP};
+
+    // Lifecycle timestamps for the stage latency histograms
+    std::chrono::steady_clock::time_point accepted_at;
+    std::chrono::steady_clock::time_point classification_sent_at;
+    std::chrono::steady_clock::time_point connect_started_at;
+    std::chrono::steady_clock::time_point backend_connected_at;
+    bool first_response_seen{false};
+
+#if HG_COROUTINES
+    // Never expires on its own; the verdict path cancels it to resume serve_client()
+    asio::steady_timer verdict_signal;
+    BackendId routed_backend{INVALID_BACKEND_ID};
+#endif
     
-    ClientConnection(asio::io_context& io_context, const std::string& ip);
+    ClientConnection(asio::io_context& io_context, Listener& listener, const std::string& ip);
     void start();
-    void close();
+    // Returns false if the connection was already closed
+    bool close();
+
+    // Client reads and writes, through TLS on TLS listeners; writes go to the
+    // socket itself once the kernel seals the records
+    template<typename Token>
+    auto async_read_some(asio::mutable_buffer buffer, Token&& token) {
+#if HG_TLS
+        if (tls) return tls->async_read_some(buffer, std::forward<Token>(token));
+#endif
+        return socket.async_read_some(buffer, std::forward<Token>(token));
+    }
+
+    template<typename Token>
+    auto async_write(asio::const_buffer buffer, Token&& token) {
+#if HG_TLS
+        if (tls && !tls->kernel_writes()) return asio::async_write(*tls, buffer, std::forward<Token>(token));
+#endif
+        return asio::async_write(socket, buffer, std::forward<Token>(token));
+    }
 };
 
 class BackendNode {
@@ -44,14 +176,16 @@ public:
     int port;
     bool is_honeypot;
     float weight;
-    std::atomic<bool> is_healthy{true};
-    std::atomic<int> current_clients{0};
-    std::atomic<long> total_requests{0};
-    std::chrono::steady_clock::time_point last_request_time;
+    // Backend group the node serves, see ListenerProfile::backend_group
+    std::string group;
+    // Assigned by BackendRegistry; health and load counters live there
+    BackendId backend_id{INVALID_BACKEND_ID};
     std::chrono::steady_clock::time_point last_health_check;
+    StageLatencies latency;
 
     BackendNode(const std::string& id, const std::string& host, int port,
-                bool is_honeypot = false, float weight = 1.0f);
+                bool is_honeypot = false, float weight = 1.0f,
+                const std::string& group = DEFAULT_BACKEND_GROUP_NAME);
 };
 
 enum class RoutingStrategy {
@@ -61,6 +195,78 @@ enum class RoutingStrategy {
     WEIGHTED
 };
 
+constexpr size_t ROUTING_STRATEGY_COUNT = static_cast<size_t>(RoutingStrategy::WEIGHTED) + 1;
+
+// TCP routes a connection once, on its first bytes; HTTP frames the stream
+// and classifies and routes every request of a keep-alive connection
+enum class ListenerProtocol {
+    TCP,
+    HTTP
+};
+
+// One listening port and how its connections are routed
+struct ListenerProfile {
+    std::string name{"default"};
+    int port{80};
+    RoutingStrategy strategy{RoutingStrategy::ROUND_ROBIN};
+    ListenerProtocol protocol{ListenerProtocol::TCP};
+    // Only backends registered in this group serve the port
+    std::string backend_group{DEFAULT_BACKEND_GROUP_NAME};
+    // Sent with every classification request so the classifier can pick its model
+    std::string classifier_profile{"default"};
+    ListenerOptions options;
+    // TLS termination, off unless <prefix>_TLS_CERT is set
+    TlsOptions tls;
+
+    // The profiles named in LISTENERS (e.g. "http,ssh"), each read from
+    // LISTENER_<NAME>_* settings; empty when LISTENERS is unset
+    static std::vector<ListenerProfile> from_settings(RoutingStrategy default_strategy);
+};
+
+// A started ListenerProfile. Listeners live as long as their LoadBalancer, so
+// connections keep a plain reference.
+struct Listener {
+    ListenerProfile profile;
+    BackendGroupId group{DEFAULT_BACKEND_GROUP};
+    std::atomic<RoutingStrategy> strategy{RoutingStrategy::ROUND_ROBIN};
+
+    // asio engine: one acceptor per reuseport shard, each on its own strand
+    std::vector<std::unique_ptr<asio::ip::tcp::acceptor>> acceptors;
+    // Set when IO_ENGINE=io_uring took over this port
+    std::unique_ptr<UringEngine> uring;
+
+    // Backend each classified client was routed to on this port
+    std::unordered_map<std::string, BackendId> pinned_backends;
+    std::mutex pinned_mutex;
+
+    // HTTP protocol only: rules from ROUTES_FILE for this listener, replaced
+    // whole on reload and read with std::atomic_load; null when there are none
+    std::shared_ptr<const RouteTable> routes;
+#if HG_TLS
+    // Set when the profile terminates TLS
+    std::unique_ptr<TlsContext> tls;
+#endif
+
+    // Accepted connections over accept completions is the mean accept batch
+    metrics::ShardedCounter accept_wakeups;
+    metrics::ShardedCounter connections_accepted;
+
+    // HTTP protocol only
+    metrics::ShardedCounter http_requests;
+    metrics::ShardedCounter http_rejected;
+    metrics::ShardedCounter http_backend_switches;
+    metrics::ShardedCounter http_routed;
+
+    // TCP protocol only: connections that opened with a TLS ClientHello
+    metrics::ShardedCounter client_hellos;
+
+    // TLS only; resumed over completed handshakes is the resumption ratio
+    metrics::ShardedCounter tls_handshakes;
+    metrics::ShardedCounter tls_handshake_failures;
+    metrics::ShardedCounter tls_resumed;
+    metrics::ShardedCounter tls_kernel_offloaded;
+};
+
 struct LoadBalancerStats {
     size_t total_requests_processed{0};
     size_t requests_routed_to_real{0};
@@ -75,87 +281,275 @@ struct LoadBalancerStats {
     std::unordered_map<RoutingStrategy, size_t> strategy_usage;
 };
 
+// Live counters behind LoadBalancerStats, aggregated by get_stats()
+struct LoadBalancerCounters {
+    metrics::ShardedCounter total_requests_processed;
+    metrics::ShardedCounter requests_routed_to_real;
+    metrics::ShardedCounter requests_routed_to_honeypot;
+    metrics::ShardedCounter routing_errors;
+    std::array<metrics::ShardedCounter, ROUTING_STRATEGY_COUNT> strategy_usage;
+};
+
 struct PerformanceMetrics {
-    std::atomic<long long> total_routing_time_ns{0};
-    std::atomic<long> total_routing_operations{0};
-    std::atomic<long> backend_selection_failures{0};
+    metrics::ShardedCounter total_routing_time_ns;
+    metrics::ShardedCounter total_routing_operations;
+    metrics::ShardedCounter backend_selection_failures;
+    StageLatencies stage_latency;
 };
 
 class LoadBalancer {
 public:
+    static std::chrono::milliseconds CLASSIFICATION_TIMEOUT() {
+        static std::chrono::milliseconds value(Confparcer::SETTING<size_t>("CLASSIFICATION_TIMEOUT_MS", 500));
+        return value;
+    }
+
+    // "asio" (epoll) or "io_uring"; io_uring falls back to asio when the kernel lacks it
+    static std::string IO_ENGINE() {
+        static std::string value = Confparcer::SETTING<std::string>("IO_ENGINE", "asio");
+        return value;
+    }
+
+    // L7 rules for HTTP listeners, see RouteRule::parse_file; empty disables routing
+    static std::string ROUTES_FILE() {
+        static std::string value = Confparcer::SETTING<std::string>("ROUTES_FILE", "");
+        return value;
+    }
+
+    // How often ROUTES_FILE is checked for changes
+    static std::chrono::seconds ROUTES_RELOAD_INTERVAL() {
+        static std::chrono::seconds value(Confparcer::SETTING<size_t>("ROUTES_RELOAD_S", 5));
+        return value;
+    }
+
+    // How often a new session ticket key is put in service, and how many keys
+    // are kept to open tickets issued before
+    static std::chrono::seconds TLS_TICKET_ROTATION_INTERVAL() {
+        static std::chrono::seconds value(Confparcer::SETTING<size_t>("TLS_TICKET_ROTATION_S", 3600));
+        return value;
+    }
+
+    static size_t TLS_TICKET_KEYS() {
+        static size_t value = Confparcer::SETTING<size_t>("TLS_TICKET_KEYS", 2);
+        return value;
+    }
+
     LoadBalancer(RoutingStrategy strategy = RoutingStrategy::ROUND_ROBIN);
     ~LoadBalancer();
 
+    // Listeners are added before start(); each shares the runtime, the backend
+    // health state and the verdict cache with the others
+    void add_listener(const ListenerProfile& profile);
+    // Starts every listener; with none added, a default one on `port` using
+    // the LISTEN_* options and the balancer's strategy
     void start(int port = 80);
+    // Stops accepting; open connections finish on the Runtime, which must be
+    // stopped before the balancer is destroyed
     void stop();
     
     void add_backend(std::shared_ptr<BackendNode> server_ptr);
+    // Applies to every listener
     void set_routing_strategy(RoutingStrategy strategy);
     
     LoadBalancerStats get_stats() const;
     const PerformanceMetrics& get_performance_metrics() const;
+    StageLatencySummary get_latency_summary() const;
+    std::vector<std::pair<std::string, StageLatencySummary>> get_backend_latency_summaries() const;
+    // Lock-free, safe to call from the metrics exporter thread
+    void collect_metrics(metrics::OpenMetricsWriter& writer) const;
     
+    // Process-unique id for a new client connection, whichever engine accepted it
+    static uint64_t allocate_client_id();
+
     static std::string strategy_to_string(RoutingStrategy strategy);
+    static RoutingStrategy strategy_from_string(const std::string& name, RoutingStrategy fallback);
+    static std::string protocol_to_string(ListenerProtocol protocol);
+    static ListenerProtocol protocol_from_string(const std::string& name, ListenerProtocol fallback);
+    static std::string stage_to_string(LatencyStage stage);
 
 private:
+    // Drives the proxy path itself and shares routing and bookkeeping with the asio engine
+    friend class UringEngine;
+
+    // Used by the default listener and by profiles that do not set one
     RoutingStrategy strategy_;
     std::atomic<bool> running_{false};
     
-    std::vector<std::shared_ptr<BackendNode>> real_backends_;
-    std::vector<std::shared_ptr<BackendNode>> honeypot_backends_;
-    mutable std::mutex backends_mutex_;
+    BackendRegistry backends_;
     
-    std::unordered_map<std::string, std::shared_ptr<BackendNode>> client_backend_mapping_;
-    mutable std::mutex mapping_mutex_;
-    
-    LoadBalancerStats stats_;
+    // Last classification per client IP, shared by every listener so a client
+    // classified on one port is routed without reclassification on the others
+    std::unordered_map<std::string, bool> verdict_cache_;
+    // Fingerprint-keyed entries of verdict_cache_ per client IP, oldest first, under verdict_mutex_;
+    // a client rotating its ClientHello keeps only the last MAX_FINGERPRINT_VERDICTS of them
+    std::unordered_map<std::string, std::vector<std::string>> fingerprint_verdicts_;
+    static constexpr size_t MAX_FINGERPRINT_VERDICTS = 8;
+    mutable std::mutex verdict_mutex_;
+
+    // Recent behaviour of every client, on any listener; its window is rotated by features_task_
+    ClientFeatureStore client_features_;
+    TaskId features_task_{INVALID_TASK};
+    // Address lists and rate limits checked before the classifier, and what every stage decided
+    ClientTriage triage_;
+
+    LoadBalancerCounters counters_;
+    std::chrono::steady_clock::time_point start_time_;
     PerformanceMetrics performance_;
     
     std::atomic<size_t> round_robin_index_{0};
     
-    asio::io_context io_context_;
-    asio::ip::tcp::acceptor acceptor_;
-    std::thread server_thread_;
-    std::thread health_check_thread_;
+    // The shared Runtime's io_context
+    asio::io_context& io_context_;
+    std::vector<std::unique_ptr<Listener>> listeners_;
+    TaskId health_check_task_{INVALID_TASK};
+    TaskId routes_task_{INVALID_TASK};
+    // Modification time of the routes file last compiled, successfully or not
+    std::optional<std::filesystem::file_time_type> routes_mtime_;
+#if HG_TLS
+    // Shared by every TLS listener, rotated by ticket_rotation_task_
+    TicketKeyRing ticket_keys_{TLS_TICKET_KEYS()};
+    TaskId ticket_rotation_task_{INVALID_TASK};
+#endif
     
     // DataBus subscriptions
     SubscriptionId health_check_sub_;
     SubscriptionId classification_sub_;
     SubscriptionId response_sub_;
 
-    void start_accept();
-    void handle_accept(ClientConnection::Ptr client, const asio::error_code& error);
+    // add_listener() without the started check, start() uses it for the default listener
+    void create_listener(const ListenerProfile& profile);
+    void start_listener(Listener& listener);
+    void stop_listener(Listener& listener);
+    void open_acceptors(Listener& listener);
+    // `client` is a connection left over from a drained batch, reused for the next accept
+    void start_accept(Listener& listener, asio::ip::tcp::acceptor& acceptor, ClientConnection::Ptr client = nullptr);
+    void handle_accept(Listener& listener, asio::ip::tcp::acceptor& acceptor, ClientConnection::Ptr client,
+                       const asio::error_code& error);
+    void admit_client(ClientConnection::Ptr client);
     
-    std::shared_ptr<BackendNode> select_backend(bool is_malicious, const std::string& client_ip);
-    std::shared_ptr<BackendNode> get_assigned_backend(const std::string& client_ip);
-    void assign_backend_to_client(const std::string& client_ip, std::shared_ptr<BackendNode> backend);
+    // Falls back to the listener's own group when `group` has no backend of the kind
+    BackendId select_backend(Listener& listener, BackendGroupId group, bool is_malicious,
+                             const std::string& client_ip);
+    // The key a client's verdict is cached and pinned under, see ClientConnection::verdict_key
+    static std::string verdict_key(const std::string& client_ip, const std::string& fingerprint_id);
+    // Backend for a client classified earlier, on this port or another one, by `key` or
+    // else by its IP; INVALID_BACKEND_ID when it still has to be classified. Counts the connection.
+    BackendId route_known_client(Listener& listener, const std::string& client_ip, const std::string& key);
+    // The inline stages for a new TCP connection, then route_known_client(); INVALID_BACKEND_ID
+    // sends its first bytes to the classifier
+    BackendId triage_client(Listener& listener, const std::string& client_ip, const std::string& key);
+    // route_known_client(), counting a hit as a VERDICT_CACHE decision taken since `started`;
+    // every verdict cache lookup goes through it
+    BackendId recall_verdict(Listener& listener, const std::string& client_ip, const std::string& key,
+                             std::chrono::steady_clock::time_point started);
+    // Address lists, then rate limits over `features`, or over the client's current
+    // ones when null; no value when neither decides
+    std::optional<TriageVerdict> triage_inline(const std::string& client_ip, const ClientFeatures* features);
+    void pin_backend(Listener& listener, const std::string& key, BackendId backend);
+    // Returns false when the client already had the same verdict
+    bool remember_verdict(const std::string& client_ip, const std::string& key, bool is_malicious);
     
-    void release_backend(const std::string& server_id);
+    void release_backend(BackendId backend);
     
-    // Selection strategies
-    std::shared_ptr<BackendNode> round_robin_selection(const std::vector<std::shared_ptr<BackendNode>>& backends);
-    std::shared_ptr<BackendNode> least_connections_selection(const std::vector<std::shared_ptr<BackendNode>>& backends);
-    std::shared_ptr<BackendNode> ip_hash_selection(const std::vector<std::shared_ptr<BackendNode>>& backends, const std::string& client_ip);
-    std::shared_ptr<BackendNode> weighted_selection(const std::vector<std::shared_ptr<BackendNode>>& backends);
+    // Selection strategies, unhealthy backends in the pool are skipped
+    BackendId round_robin_selection(const BackendPool& pool);
+    BackendId least_connections_selection(const BackendPool& pool);
+    BackendId ip_hash_selection(const BackendPool& pool, const std::string& client_ip);
+    BackendId weighted_selection(const BackendPool& pool);
     
-    // Health checking
+    // Compiles ROUTES_FILE for every HTTP listener when it changed since the
+    // last call; a file that does not load leaves the current tables in place
+    void reload_routes();
+
+    // Health checking, driven by the Scheduler and run as async connects on io_context_
     void start_health_checks(std::chrono::seconds interval = std::chrono::seconds(30));
     void perform_health_checks();
-    bool check_server_health(const std::shared_ptr<BackendNode>& server);
+    void check_server_health(BackendId backend);
+    void update_health(BackendId backend, bool is_healthy);
     
     // Event handlers
     void handle_health_update(const Event& event);
     void handle_classification(const Event& event);
+    void handle_verdict(ClientConnection::Ptr client, RequestStatus status, const nlohmann::json& verdict);
+    // The classification in a classifier reply, or CLASSIFICATION_TIMEOUT_ACTION's when the
+    // reply timed out or was dropped; logs and counts a missing one
+    std::optional<TriageVerdict> read_verdict(const std::string& client_ip, RequestStatus status,
+                                              const nlohmann::json& verdict,
+                                              std::chrono::steady_clock::time_point sent_at);
+    // Selects a backend from `group` for a verdict, through apply_verdict() when it is
+    // the classifier's; INVALID_BACKEND_ID if there is none
+    BackendId route_verdict(Listener& listener, BackendGroupId group, const std::string& client_ip,
+                            const std::string& key, const TriageVerdict& verdict);
+    // Caches the verdict under `key`, then selects a backend from `group`. It is pinned
+    // on this port unless a route picked a group other than the listener's.
+    BackendId apply_verdict(Listener& listener, BackendGroupId group, const std::string& client_ip,
+                            const std::string& key, bool is_malicious);
+    // Hands the routing decision to the connection's strand, INVALID_BACKEND_ID closes it
+    void resume_client(const ClientConnection::Ptr& client, BackendId backend);
     void handle_response_metrics(const Event& event);
+    // Resolves "backend_id", falling back to a name lookup of "server_id"
+    BackendId backend_from_event(const Event& event) const;
     
-    void mark_request_success(const std::string& server_id, std::chrono::milliseconds response_time);
-    void mark_request_failure(const std::string& server_id);
+    void mark_request_success(BackendId backend, std::chrono::milliseconds response_time);
+    void mark_request_failure(BackendId backend);
     
+    // Connection bookkeeping shared by the asio and io_uring engines
+    void announce_client(const Listener& listener, const std::string& client_ip, uint64_t client_id);
+    // `features`, with this request counted, go in the payload as "features".
+    // `fingerprint`, when the connection opened with a TLS ClientHello, goes in the payload as "tls".
+    CorrelationId publish_classification(const Listener& listener, const std::string& client_ip, uint64_t client_id,
+                                         std::string request_data, const ClientFeatures& features,
+                                         ResponseCallback callback, const TlsFingerprint* fingerprint = nullptr);
+    // Records the end of a connection and releases what it held
+    void finish_client(const std::string& client_ip, BackendId backend,
+                       std::chrono::steady_clock::time_point accepted_at, CorrelationId classification_request);
+    void record_backend_stage(BackendId backend, LatencyStage stage, std::chrono::steady_clock::duration elapsed);
+
     // Proxy functionality
-    void proxy_to_backend(ClientConnection::Ptr client, std::shared_ptr<BackendNode> backend);
+    void request_classification(const ClientConnection::Ptr& client, const char* data, size_t size);
+    // Fingerprints a TLS ClientHello at the start of the pending bytes. False
+    // while one is still incomplete and the buffer has room for the rest.
+    bool inspect_first_bytes(ClientConnection& client);
+#if HG_COROUTINES
+    // The whole connection as one coroutine on the client strand. Coroutine
+    // frames and their operations come from asio's per-thread recycling cache,
+    // so no hop allocates.
+    using ConnectionTask = asio::awaitable<void, ClientConnection::Strand>;
+    ConnectionTask serve_client(ClientConnection::Ptr client);
+    ConnectionTask relay(ClientConnection::Ptr client, bool from_backend);
+#endif
+#if HG_TLS
+    // Runs the handshake of a TLS listener's connection, then handle_client_request() again
+    void start_tls(const ClientConnection::Ptr& client);
+#endif
+    void proxy_to_backend(ClientConnection::Ptr client, BackendId backend);
     void handle_client_request(ClientConnection::Ptr client);
     void read_from_client(ClientConnection::Ptr client);
+    void forward_pending_request(ClientConnection::Ptr client);
+    void relay_client_to_backend(ClientConnection::Ptr client);
     void read_from_backend(ClientConnection::Ptr client);
+    void close_client(const ClientConnection::Ptr& client);
+
+    // HTTP listeners, on the client strand: each request head is held back
+    // until its own verdict, then forwarded with its body. A request routed to
+    // another backend waits until the current one has answered and closed, so
+    // responses reach the client in request order.
+    void read_http_request(const ClientConnection::Ptr& client);
+    // Runs the parser over the buffered bytes until it needs a verdict, a write or a read
+    void advance_http(const ClientConnection::Ptr& client);
+    void forward_http_bytes(const ClientConnection::Ptr& client);
+    void handle_request_verdict(const ClientConnection::Ptr& client, RequestStatus status,
+                                const nlohmann::json& verdict);
+    // Routes the request awaiting `verdict`, whichever stage gave it; no verdict rejects it
+    void settle_http_request(const ClientConnection::Ptr& client, const std::optional<TriageVerdict>& verdict);
+    void route_http_request(const ClientConnection::Ptr& client, BackendId backend, bool is_malicious);
+    void connect_http_backend(const ClientConnection::Ptr& client, BackendId backend);
+    void switch_http_backend(const ClientConnection::Ptr& client);
+    // Half-closes the backend so it finishes what it was sent; read_from_backend()
+    // then moves to next_backend or closes the connection
+    void drain_backend(const ClientConnection::Ptr& client);
+    // Answers with `status` when nothing was forwarded yet, otherwise drains and closes
+    void reject_http_request(const ClientConnection::Ptr& client, int status);
 };
 
 #endif // LOADBALANCER_H
\ No newline at end of file
@@ -0,0 +1,502 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\RegexDfa.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "RegexDfa.h"
+
+#include <algorithm>
+#include <bitset>
+#include <map>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+using ByteSet = std::bitset<256>;
+
+struct Node {
+    enum Kind { SET, EMPTY, CONCAT, ALTERNATE, REPEAT };
+    Kind kind;
+    uint32_t set{0};
+    int left{-1};
+    int right{-1};
+    // max < 0 is unbounded
+    int min{0};
+    int max{0};
+};
+
+// Recursive descent over the pattern into a syntax tree of byte sets
+class Parser {
+public:
+    Parser(std::string_view pattern, const std::string& full) : pattern_(pattern), full_(full) {}
+
+    std::vector<Node> nodes;
+    std::vector<ByteSet> sets;
+
+    int parse() {
+        int root = alternation();
+        if (pos_ != pattern_.size()) error("unbalanced ')'");
+        return root;
+    }
+
+private:
+    std::string_view pattern_;
+    const std::string& full_;
+    size_t pos_{0};
+
+    [[noreturn]] void error(const std::string& what) const {
+        throw std::invalid_argument("regex '" + full_ + "': " + what);
+    }
+
+    bool at_end() const { return pos_ >= pattern_.size(); }
+    char peek() const { return pattern_[pos_]; }
+
+    int add(Node node) {
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size() - 1);
+    }
+
+    int add_set(const ByteSet& set) {
+        sets.push_back(set);
+        return add(Node{Node::SET, static_cast<uint32_t>(sets.size() - 1)});
+    }
+
+    int alternation() {
+        int left = concatenation();
+        while (!at_end() && peek() == '|') {
+            ++pos_;
+            int right = concatenation();
+            left = add(Node{Node::ALTERNATE, 0, left, right});
+        }
+        return left;
+    }
+
+    int concatenation() {
+        int result = -1;
+        while (!at_end() && peek() != '|' && peek() != ')') {
+            int next = repetition();
+            result = result < 0 ? next : add(Node{Node::CONCAT, 0, result, next});
+        }
+        return result < 0 ? add(Node{Node::EMPTY}) : result;
+    }
+
+    int repetition() {
+        int atom_node = atom();
+        while (!at_end()) {
+            int min = 0;
+            int max = 0;
+            char c = peek();
+            if (c == '*') {
+                min = 0;
+                max = -1;
+                ++pos_;
+            } else if (c == '+') {
+                min = 1;
+                max = -1;
+                ++pos_;
+            } else if (c == '?') {
+                min = 0;
+                max = 1;
+                ++pos_;
+            } else if (c == '{') {
+                ++pos_;
+                min = number();
+                max = min;
+                if (!at_end() && peek() == ',') {
+                    ++pos_;
+                    max = (!at_end() && peek() == '}') ? -1 : number();
+                }
+                if (at_end() || peek() != '}') error("unterminated {}");
+                ++pos_;
+                if (max >= 0 && max < min) error("{m,n} with n < m");
+            } else {
+                break;
+            }
+            if (!at_end() && (peek() == '?' || peek() == '+')) error("lazy and possessive quantifiers are not supported");
+            atom_node = add(Node{Node::REPEAT, 0, atom_node, -1, min, max});
+        }
+        return atom_node;
+    }
+
+    int number() {
+        int value = 0;
+        size_t start = pos_;
+        while (!at_end() && peek() >= '0' && peek() <= '9') {
+            value = value * 10 + (peek() - '0');
+            if (value > RegexDfa::MAX_REPEAT) error("repeat count above " + std::to_string(RegexDfa::MAX_REPEAT));
+            ++pos_;
+        }
+        if (pos_ == start) error("expected a number in {}");
+        return value;
+    }
+
+    int atom() {
+        char c = peek();
+        switch (c) {
+            case '(': {
+                ++pos_;
+                if (pattern_.substr(pos_, 2) == "?:") {
+                    pos_ += 2;
+                } else if (!at_end() && peek() == '?') {
+                    error("lookaround and group flags are not supported");
+                }
+                int inner = alternation();
+                if (at_end() || peek() != ')') error("missing ')'");
+                ++pos_;
+                return inner;
+            }
+            case '[':
+                ++pos_;
+                return add_set(bracket());
+            case '.': {
+                ++pos_;
+                ByteSet any;
+                any.set();
+                any.reset('\n');
+                return add_set(any);
+            }
+            case '\\':
+                ++pos_;
+                return add_set(escape(false));
+            case '*':
+            case '+':
+            case '?':
+            case '{':
+                error(std::string("nothing to repeat before '") + c + "'");
+            case '^':
+            case '$':
+                error("anchors are only supported at the start and end of the pattern");
+            default: {
+                ++pos_;
+                ByteSet literal;
+                literal.set(static_cast<unsigned char>(c));
+                return add_set(literal);
+            }
+        }
+    }
+
+    static int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // After a backslash; in a bracket class \b is a backspace rather than an error
+    ByteSet escape(bool in_class) {
+        if (at_end()) error("trailing backslash");
+        char c = pattern_[pos_++];
+        ByteSet set;
+        auto range = [&set](int from, int to) {
+            for (int b = from; b <= to; ++b) set.set(static_cast<size_t>(b));
+        };
+        switch (c) {
+            case 'd': range('0', '9'); return set;
+            case 'D': range('0', '9'); return set.flip();
+            case 'w': range('0', '9'); range('a', 'z'); range('A', 'Z'); set.set('_'); return set;
+            case 'W': range('0', '9'); range('a', 'z'); range('A', 'Z'); set.set('_'); return set.flip();
+            case 's': for (char s : {' ', '\t', '\n', '\r', '\f', '\v'}) set.set(static_cast<unsigned char>(s)); return set;
+            case 'S': for (char s : {' ', '\t', '\n', '\r', '\f', '\v'}) set.set(static_cast<unsigned char>(s)); return set.flip();
+            case 'n': set.set('\n'); return set;
+            case 'r': set.set('\r'); return set;
+            case 't': set.set('\t'); return set;
+            case 'x': {
+                int high = pos_ < pattern_.size() ? hex_value(pattern_[pos_]) : -1;
+                int low = pos_ + 1 < pattern_.size() ? hex_value(pattern_[pos_ + 1]) : -1;
+                if (high < 0 || low < 0) error("\\x needs two hex digits");
+                pos_ += 2;
+                set.set(static_cast<size_t>(high * 16 + low));
+                return set;
+            }
+            case 'b':
+                if (!in_class) error("word boundaries are not supported");
+                set.set('\b');
+                return set;
+            default:
+                if (c >= '0' && c <= '9') {
+                    error(std::string("\\") + c + " is not supported");
+                }
+                if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+                    error(std::string("unknown escape \\") + c);
+                }
+                set.set(static_cast<unsigned char>(c));
+                return set;
+        }
+    }
+
+    ByteSet bracket() {
+        ByteSet set;
+        bool negate = !at_end() && peek() == '^';
+        if (negate) ++pos_;
+        bool first = true;
+        while (!at_end() && (peek() != ']' || first)) {
+            first = false;
+            ByteSet item;
+            int low = -1;
+            if (peek() == '\\') {
+                ++pos_;
+                item = escape(true);
+                if (item.count() == 1) {
+                    for (int b = 0; b < 256; ++b) {
+                        if (item.test(static_cast<size_t>(b))) low = b;
+                    }
+                }
+            } else {
+                low = static_cast<unsigned char>(pattern_[pos_++]);
+                item.set(static_cast<size_t>(low));
+            }
+            // A range needs single-byte ends; a trailing '-' is a literal
+            if (low >= 0 && pos_ + 1 < pattern_.size() && peek() == '-' && pattern_[pos_ + 1] != ']') {
+                ++pos_;
+                int high;
+                if (peek() == '\\') {
+                    ++pos_;
+                    ByteSet end = escape(true);
+                    if (end.count() != 1) error("class range ends in a class");
+                    high = 0;
+                    while (!end.test(static_cast<size_t>(high))) ++high;
+                } else {
+                    high = static_cast<unsigned char>(pattern_[pos_++]);
+                }
+                if (high < low) error("reversed class range");
+                for (int b = low; b <= high; ++b) item.set(static_cast<size_t>(b));
+            }
+            set |= item;
+        }
+        if (at_end()) error("missing ']'");
+        ++pos_;
+        return negate ? set.flip() : set;
+    }
+};
+
+struct NfaState {
+    enum Kind { CHARS, SPLIT, MATCH };
+    Kind kind;
+    uint32_t set{0};
+    int out{-1};
+    int out1{-1};
+};
+
+// Thompson construction: every fragment has one entry and a list of dangling exits
+class NfaBuilder {
+public:
+    static constexpr size_t MAX_NFA_STATES = 65536;
+
+    NfaBuilder(const std::vector<Node>& nodes, const std::string& pattern) : nodes_(nodes), pattern_(pattern) {}
+
+    std::vector<NfaState> states;
+
+    int build(int root) {
+        Fragment fragment = fragment_of(root);
+        int match = add(NfaState{NfaState::MATCH});
+        patch(fragment, match);
+        return fragment.start;
+    }
+
+private:
+    // A dangling exit: (state, 0 for out / 1 for out1)
+    using Exit = std::pair<int, int>;
+
+    struct Fragment {
+        int start;
+        std::vector<Exit> exits;
+    };
+
+    const std::vector<Node>& nodes_;
+    const std::string& pattern_;
+
+    int add(NfaState state) {
+        if (states.size() >= MAX_NFA_STATES) {
+            throw std::invalid_argument("regex '" + pattern_ + "': pattern too large");
+        }
+        states.push_back(state);
+        return static_cast<int>(states.size() - 1);
+    }
+
+    void patch(const Fragment& fragment, int target) {
+        for (const Exit& exit : fragment.exits) {
+            (exit.second == 0 ? states[exit.first].out : states[exit.first].out1) = target;
+        }
+    }
+
+    Fragment concat(Fragment first, Fragment second) {
+        patch(first, second.start);
+        return Fragment{first.start, std::move(second.exits)};
+    }
+
+    Fragment empty() {
+        int split = add(NfaState{NfaState::SPLIT});
+        return Fragment{split, {{split, 0}}};
+    }
+
+    Fragment optional(Fragment inner) {
+        int split = add(NfaState{NfaState::SPLIT, 0, inner.start});
+        inner.exits.emplace_back(split, 1);
+        return Fragment{split, std::move(inner.exits)};
+    }
+
+    Fragment star(Fragment inner) {
+        int split = add(NfaState{NfaState::SPLIT, 0, inner.start});
+        patch(inner, split);
+        return Fragment{split, {{split, 1}}};
+    }
+
+    Fragment fragment_of(int index) {
+        const Node& node = nodes_[index];
+        switch (node.kind) {
+            case Node::SET: {
+                int state = add(NfaState{NfaState::CHARS, node.set});
+                return Fragment{state, {{state, 0}}};
+            }
+            case Node::EMPTY:
+                return empty();
+            case Node::CONCAT:
+                return concat(fragment_of(node.left), fragment_of(node.right));
+            case Node::ALTERNATE: {
+                Fragment left = fragment_of(node.left);
+                Fragment right = fragment_of(node.right);
+                int split = add(NfaState{NfaState::SPLIT, 0, left.start, right.start});
+                left.exits.insert(left.exits.end(), right.exits.begin(), right.exits.end());
+                return Fragment{split, std::move(left.exits)};
+            }
+            case Node::REPEAT: {
+                // x{m,n} is m copies of x followed by n-m optional ones, or by x* when unbounded
+                Fragment result = empty();
+                for (int i = 0; i < node.min; ++i) {
+                    result = concat(std::move(result), fragment_of(node.left));
+                }
+                if (node.max < 0) {
+                    result = concat(std::move(result), star(fragment_of(node.left)));
+                } else {
+                    for (int i = node.min; i < node.max; ++i) {
+                        result = concat(std::move(result), optional(fragment_of(node.left)));
+                    }
+                }
+                return result;
+            }
+        }
+        return empty();
+    }
+};
+
+// Bytes that every byte set treats alike share a class
+uint32_t build_byte_classes(const std::vector<ByteSet>& sets, std::array<uint8_t, 256>& byte_class,
+                            std::vector<int>& representative) {
+    std::map<std::vector<bool>, uint32_t> classes;
+    for (int b = 0; b < 256; ++b) {
+        std::vector<bool> signature(sets.size());
+        for (size_t s = 0; s < sets.size(); ++s) {
+            signature[s] = sets[s].test(static_cast<size_t>(b));
+        }
+        auto [it, inserted] = classes.emplace(std::move(signature), static_cast<uint32_t>(classes.size()));
+        if (inserted) representative.push_back(b);
+        byte_class[static_cast<size_t>(b)] = static_cast<uint8_t>(it->second);
+    }
+    return static_cast<uint32_t>(classes.size());
+}
+
+// Sorted CHARS and MATCH states reachable from `seeds` through SPLIT states
+std::vector<int> closure(const std::vector<NfaState>& states, const std::vector<int>& seeds) {
+    std::vector<int> result;
+    std::vector<int> stack(seeds.begin(), seeds.end());
+    std::vector<bool> seen(states.size());
+    while (!stack.empty()) {
+        int state = stack.back();
+        stack.pop_back();
+        if (state < 0 || seen[static_cast<size_t>(state)]) continue;
+        seen[static_cast<size_t>(state)] = true;
+        const NfaState& nfa = states[static_cast<size_t>(state)];
+        if (nfa.kind == NfaState::SPLIT) {
+            stack.push_back(nfa.out);
+            stack.push_back(nfa.out1);
+        } else {
+            result.push_back(state);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+RegexDfa::RegexDfa(std::string_view pattern) : pattern_(pattern) {
+    bool anchored_start = !pattern.empty() && pattern.front() == '^';
+    if (anchored_start) pattern.remove_prefix(1);
+    if (!pattern.empty() && pattern.back() == '$') {
+        size_t backslashes = 0;
+        for (size_t i = pattern.size() - 1; i > 0 && pattern[i - 1] == '\\'; --i) ++backslashes;
+        if (backslashes % 2 == 0) {
+            anchored_end_ = true;
+            pattern.remove_suffix(1);
+        }
+    }
+
+    Parser parser(pattern, pattern_);
+    int root = parser.parse();
+    NfaBuilder nfa(parser.nodes, pattern_);
+    int nfa_start = nfa.build(root);
+
+    std::vector<int> representative;
+    class_count_ = build_byte_classes(parser.sets, byte_class_, representative);
+
+    // Unanchored patterns restart at every byte, as if prefixed with .*
+    std::vector<int> start_set = closure(nfa.states, {nfa_start});
+    std::map<std::vector<int>, uint32_t> ids;
+    std::vector<std::vector<int>> pending;
+    auto state_of = [&](std::vector<int> set) -> uint32_t {
+        if (set.empty()) return DEAD;
+        auto it = ids.find(set);
+        if (it != ids.end()) return it->second;
+        if (accepting_.size() >= MAX_STATES) {
+            throw std::invalid_argument("regex '" + pattern_ + "': automaton exceeds " +
+                                        std::to_string(MAX_STATES) + " states");
+        }
+        uint32_t id = static_cast<uint32_t>(accepting_.size());
+        bool accepts = std::any_of(set.begin(), set.end(), [&](int s) {
+            return nfa.states[static_cast<size_t>(s)].kind == NfaState::MATCH;
+        });
+        accepting_.push_back(accepts ? 1 : 0);
+        transitions_.resize(accepting_.size() * class_count_, DEAD);
+        ids.emplace(set, id);
+        pending.push_back(std::move(set));
+        return id;
+    };
+
+    accepting_.push_back(0);
+    transitions_.assign(class_count_, DEAD);
+    start_ = state_of(start_set);
+
+    for (size_t next = 0; next < pending.size(); ++next) {
+        std::vector<int> set = pending[next];
+        uint32_t id = ids[set];
+        for (uint32_t c = 0; c < class_count_; ++c) {
+            size_t byte = static_cast<size_t>(representative[c]);
+            std::vector<int> seeds;
+            for (int s : set) {
+                const NfaState& state = nfa.states[static_cast<size_t>(s)];
+                if (state.kind == NfaState::CHARS && parser.sets[state.set].test(byte)) {
+                    seeds.push_back(state.out);
+                }
+            }
+            if (!anchored_start) {
+                seeds.push_back(nfa_start);
+            }
+            transitions_[id * class_count_ + c] = state_of(closure(nfa.states, seeds));
+        }
+    }
+}
+
+bool RegexDfa::matches(std::string_view input) const {
+    uint32_t state = start_;
+    for (char c : input) {
+        if (accepting_[state] && !anchored_end_) return true;
+        state = transitions_[state * class_count_ + byte_class_[static_cast<unsigned char>(c)]];
+        if (state == DEAD) return false;
+    }
+    return accepting_[state] != 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\RegexDfa.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A regular expression compiled ahead of time into a deterministic automaton,
+// so matching is one table lookup per input byte with no backtracking and no
+// allocation. Bytes are folded into equivalence classes to keep the table small.
+//
+// Syntax: literals, '.', [] classes with ranges and negation, \d \w \s and
+// their negations, \xHH, groups ( ) and (?: ), '|', and the * + ? {m} {m,}
+// {m,n} quantifiers. '^' and '$' anchor only at the very start and end of the
+// pattern; without '^' the pattern may match anywhere. Backreferences,
+// lookaround and lazy quantifiers have no DFA form and are rejected.
+class RegexDfa {
+public:
+    static constexpr size_t MAX_STATES = 4096;
+    static constexpr int MAX_REPEAT = 256;
+
+    // Throws std::invalid_argument for unsupported syntax or a pattern whose
+    // automaton would exceed MAX_STATES
+    explicit RegexDfa(std::string_view pattern);
+
+    bool matches(std::string_view input) const;
+
+    size_t state_count() const { return accepting_.size(); }
+    const std::string& pattern() const { return pattern_; }
+
+private:
+    // State 0 never accepts and never leaves
+    static constexpr uint32_t DEAD = 0;
+
+    std::string pattern_;
+    std::array<uint8_t, 256> byte_class_{};
+    uint32_t class_count_{0};
+    uint32_t start_{DEAD};
+    // Without '$', reaching an accepting state is a match; with it, only the final state counts
+    bool anchored_end_{false};
+    // [state * class_count_ + class]
+    std::vector<uint32_t> transitions_;
+    std::vector<uint8_t> accepting_;
+};
@@ -0,0 +1,247 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\RouteTable.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "RouteTable.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// Longest host name kept on the stack for lower-casing, longer ones only match catch-all rules
+constexpr size_t MAX_HOST_LENGTH = 255;
+
+inline char lower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string to_lower(std::string_view text) {
+    std::string result(text);
+    for (char& c : result) c = lower(c);
+    return result;
+}
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// The path of a request target: origin-form up to the query, or the path
+// part of an absolute-form target. Targets carry no fragment (RFC 9112 3.2).
+std::string_view target_path(std::string_view target) {
+    if (!target.empty() && target.front() != '/') {
+        size_t scheme = target.find("://");
+        if (scheme == std::string_view::npos) return {};
+        size_t slash = target.find('/', scheme + 3);
+        if (slash == std::string_view::npos) return "/";
+        target.remove_prefix(slash);
+    }
+    return target.substr(0, target.find('?'));
+}
+
+} // namespace
+
+std::vector<RouteRule> RouteRule::parse_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("cannot open routes file " + path);
+
+    std::vector<RouteRule> rules;
+    std::string line;
+    size_t number = 0;
+    while (std::getline(file, line)) {
+        ++number;
+        auto fail = [&](const std::string& reason) {
+            throw std::runtime_error(path + ":" + std::to_string(number) + ": " + reason);
+        };
+
+        RouteRule rule;
+        bool any_field = false;
+        std::string_view rest(line);
+        while (true) {
+            while (!rest.empty() && is_space(rest.front())) rest.remove_prefix(1);
+            if (rest.empty() || rest.front() == '#') break;
+            size_t end = 0;
+            while (end < rest.size() && !is_space(rest[end])) ++end;
+            std::string_view field = rest.substr(0, end);
+            rest.remove_prefix(end);
+
+            size_t equals = field.find('=');
+            if (equals == std::string_view::npos || equals == 0) {
+                fail("expected name=value, got '" + std::string(field) + "'");
+            }
+            std::string_view key = field.substr(0, equals);
+            std::string value(field.substr(equals + 1));
+            if (value.empty()) fail("empty value for " + std::string(key));
+
+            if (key == "name") rule.name = value;
+            else if (key == "backends") rule.backend_group = value;
+            else if (key == "listener") rule.listener = value;
+            else if (key == "host") rule.host = value;
+            else if (key == "path") rule.path_prefix = value;
+            else if (key == "regex") rule.path_regex = value;
+            else if (key == "method") rule.method = value;
+            else if (key == "header") rule.header = value;
+            else fail("unknown field " + std::string(key));
+            any_field = true;
+        }
+        if (!any_field) continue;
+
+        if (rule.backend_group.empty()) fail("rule has no backends=");
+        if (!rule.path_prefix.empty() && rule.path_prefix.front() != '/') fail("path must start with '/'");
+        if (rule.name.empty()) rule.name = "line" + std::to_string(number);
+        rules.push_back(std::move(rule));
+    }
+    return rules;
+}
+
+void RouteTable::PathTrie::insert(std::string_view prefix, uint32_t rule) {
+    uint32_t node = 0;
+    while (!prefix.empty()) {
+        // Indices only: `nodes` may grow below
+        auto& edges = nodes[node].edges;
+        auto edge = std::lower_bound(edges.begin(), edges.end(), prefix.front(),
+                                     [](const TrieNode::Edge& e, char c) { return e.label.front() < c; });
+        if (edge == edges.end() || edge->label.front() != prefix.front()) {
+            uint32_t child = static_cast<uint32_t>(nodes.size());
+            edges.insert(edge, TrieNode::Edge{std::string(prefix), child});
+            nodes.emplace_back();
+            node = child;
+            break;
+        }
+
+        size_t common = 0;
+        size_t limit = std::min(edge->label.size(), prefix.size());
+        while (common < limit && edge->label[common] == prefix[common]) ++common;
+        prefix.remove_prefix(common);
+        if (common == edge->label.size()) {
+            node = edge->child;
+            continue;
+        }
+
+        // Split the edge where the prefixes diverge
+        uint32_t middle = static_cast<uint32_t>(nodes.size());
+        TrieNode split;
+        split.edges.push_back(TrieNode::Edge{edge->label.substr(common), edge->child});
+        edge->label.resize(common);
+        edge->child = middle;
+        nodes.push_back(std::move(split));
+        node = middle;
+    }
+    // Rules are inserted in file order, so the list stays ascending
+    nodes[node].rules.push_back(rule);
+}
+
+template<typename Accept>
+uint32_t RouteTable::PathTrie::first(std::string_view path, uint32_t best, Accept accept) const {
+    uint32_t node = 0;
+    while (true) {
+        for (uint32_t rule : nodes[node].rules) {
+            if (rule >= best) break;
+            if (accept(rule)) {
+                best = rule;
+                break;
+            }
+        }
+        if (path.empty()) break;
+
+        const auto& edges = nodes[node].edges;
+        auto edge = std::lower_bound(edges.begin(), edges.end(), path.front(),
+                                     [](const TrieNode::Edge& e, char c) { return e.label.front() < c; });
+        if (edge == edges.end() || edge->label.front() != path.front()) break;
+        if (path.compare(0, edge->label.size(), edge->label) != 0) break;
+        path.remove_prefix(edge->label.size());
+        node = edge->child;
+    }
+    return best;
+}
+
+RouteTable::RouteTable(const std::vector<RouteRule>& rules, const BackendRegistry& backends) {
+    rules_.reserve(rules.size());
+    for (const RouteRule& rule : rules) {
+        uint32_t index = static_cast<uint32_t>(rules_.size());
+        auto group = backends.find_group(rule.backend_group);
+        if (!group) {
+            throw std::invalid_argument("route " + rule.name + ": unknown backend group " + rule.backend_group);
+        }
+        CompiledRule compiled;
+        compiled.route = Route{rule.name, *group};
+        compiled.method = rule.method;
+        compiled.header = rule.header;
+        if (!rule.path_regex.empty()) {
+            try {
+                compiled.regex = std::make_unique<RegexDfa>(rule.path_regex);
+            } catch (const std::invalid_argument& e) {
+                throw std::invalid_argument("route " + rule.name + ": " + e.what());
+            }
+        }
+        rules_.push_back(std::move(compiled));
+
+        PathTrie* trie = &any_host_;
+        if (!rule.host.empty() && rule.host != "*") {
+            bool wildcard = rule.host.size() > 2 && rule.host.compare(0, 2, "*.") == 0;
+            std::string host = to_lower(wildcard ? rule.host.substr(2) : rule.host);
+            if (host.empty() || host.size() > MAX_HOST_LENGTH || host.find('*') != std::string::npos) {
+                throw std::invalid_argument("route " + rule.name + ": bad host " + rule.host);
+            }
+            auto& table = wildcard ? wildcard_hosts_ : exact_hosts_;
+            auto found = table.find(host);
+            if (found == table.end()) {
+                host_names_.push_back(std::move(host));
+                found = table.emplace(host_names_.back(), PathTrie{}).first;
+            }
+            trie = &found->second;
+            has_wildcards_ |= wildcard;
+        }
+        trie->insert(rule.path_prefix, index);
+    }
+}
+
+uint32_t RouteTable::first_in(const PathTrie& trie, const HttpRequest& request, std::string_view path,
+                              uint32_t best) const {
+    return trie.first(path, best, [&](uint32_t index) {
+        const CompiledRule& rule = rules_[index];
+        if (!rule.method.empty() && request.method != rule.method) return false;
+        if (!rule.header.empty() && !request.has_header(rule.header)) return false;
+        return !rule.regex || rule.regex->matches(path);
+    });
+}
+
+const RouteTable::Route* RouteTable::match(const HttpRequest& request) const {
+    std::string_view path = target_path(request.target);
+    uint32_t best = NO_RULE;
+
+    // Host names are case-insensitive and may carry a port
+    std::string_view raw_host = request.host;
+    size_t colon = raw_host.rfind(':');
+    if (colon != std::string_view::npos && raw_host.find(']', colon) == std::string_view::npos) {
+        raw_host = raw_host.substr(0, colon);
+    }
+    if (!raw_host.empty() && raw_host.back() == '.') raw_host.remove_suffix(1);
+
+    char buffer[MAX_HOST_LENGTH];
+    if (!raw_host.empty() && raw_host.size() <= MAX_HOST_LENGTH) {
+        for (size_t i = 0; i < raw_host.size(); ++i) buffer[i] = lower(raw_host[i]);
+        std::string_view host(buffer, raw_host.size());
+
+        if (!exact_hosts_.empty()) {
+            auto found = exact_hosts_.find(host);
+            if (found != exact_hosts_.end()) best = first_in(found->second, request, path, best);
+        }
+        if (has_wildcards_) {
+            // "a.b.example.com" tries "b.example.com", then "example.com", then "com"
+            for (size_t dot = host.find('.'); dot != std::string_view::npos; dot = host.find('.', dot + 1)) {
+                auto found = wildcard_hosts_.find(host.substr(dot + 1));
+                if (found != wildcard_hosts_.end()) best = first_in(found->second, request, path, best);
+            }
+        }
+    }
+    best = first_in(any_host_, request, path, best);
+
+    return best == NO_RULE ? nullptr : &rules_[best].route;
+}
@@ -0,0 +1,111 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\RouteTable.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "BackendRegistry.h"
+#include "HttpParser.h"
+#include "RegexDfa.h"
+
+// One L7 rule as written in the routes file. Empty conditions match anything;
+// the first rule, in file order, whose conditions all hold picks the group.
+struct RouteRule {
+    std::string name;
+    // Only HTTP listeners with this name use the rule; empty for all of them
+    std::string listener;
+    // "api.example.com", or "*.example.com" for any subdomain (not the apex)
+    std::string host;
+    std::string path_prefix;
+    // Searched in the path, see RegexDfa for the syntax
+    std::string path_regex;
+    std::string method;
+    // Header that must be present, whatever its value
+    std::string header;
+    std::string backend_group;
+
+    // Lines of `name=value` fields, '#' starts a comment:
+    //   name=api backends=api host=*.example.com path=/v1/ method=GET
+    // Throws std::runtime_error naming the line of the first bad entry.
+    static std::vector<RouteRule> parse_file(const std::string& path);
+};
+
+// Rules compiled for one listener into lookup structures, so a request costs
+// one hash probe per host label and one walk of its path rather than a scan of
+// every rule:
+//  - exact hosts and wildcard suffixes in hash maps, plus a bucket of rules for any host,
+//  - in each bucket, a radix trie over path prefixes whose nodes list the rules ending there,
+//  - a DFA per path regex, run only for rules that survived the cheaper checks.
+// Immutable once built; LoadBalancer publishes a new table to replace it.
+class RouteTable {
+public:
+    struct Route {
+        std::string name;
+        BackendGroupId group;
+    };
+
+    // Throws std::invalid_argument when a rule does not compile or names a
+    // group no backend or listener belongs to; `backends` is not changed
+    RouteTable(const std::vector<RouteRule>& rules, const BackendRegistry& backends);
+
+    RouteTable(const RouteTable&) = delete;
+    RouteTable& operator=(const RouteTable&) = delete;
+
+    // The first matching rule, nullptr when none applies
+    const Route* match(const HttpRequest& request) const;
+
+    size_t size() const { return rules_.size(); }
+
+private:
+    static constexpr uint32_t NO_RULE = UINT32_MAX;
+
+    struct CompiledRule {
+        Route route;
+        std::string method;
+        std::string header;
+        std::unique_ptr<RegexDfa> regex;
+    };
+
+    // Radix trie node: `edges` are sorted by their first byte and never share one
+    struct TrieNode {
+        struct Edge {
+            std::string label;
+            uint32_t child;
+        };
+        std::vector<Edge> edges;
+        // Rules whose prefix ends at this node, ascending
+        std::vector<uint32_t> rules;
+    };
+
+    struct PathTrie {
+        std::vector<TrieNode> nodes{1};
+
+        void insert(std::string_view prefix, uint32_t rule);
+        // Lowest rule below `best` on the path of `path` that `accept` approves, else `best`
+        template<typename Accept>
+        uint32_t first(std::string_view path, uint32_t best, Accept accept) const;
+    };
+
+    uint32_t first_in(const PathTrie& trie, const HttpRequest& request, std::string_view path,
+                      uint32_t best) const;
+
+    std::vector<CompiledRule> rules_;
+    // Owns the host names the maps are keyed by, so lookups need no std::string
+    std::deque<std::string> host_names_;
+    std::unordered_map<std::string_view, PathTrie> exact_hosts_;
+    // Keyed by the suffix after "*.", e.g. "example.com"
+    std::unordered_map<std::string_view, PathTrie> wildcard_hosts_;
+    PathTrie any_host_;
+    bool has_wildcards_{false};
+};
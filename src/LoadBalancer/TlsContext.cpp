@@ -0,0 +1,204 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\TlsContext.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "TlsContext.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+#if HG_TLS
+#include <openssl/core_names.h>
+#include <openssl/err.h>
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+
+#if OPENSSL_VERSION_NUMBER < 0x30000000L
+#error "TLS termination needs OpenSSL 3.0 or newer"
+#endif
+#endif
+
+TlsOptions TlsOptions::from_settings(const std::string& prefix) {
+    TlsOptions defaults;
+    TlsOptions options;
+    auto key = [&prefix](const char* name) { return prefix + "_" + name; };
+    options.certificate_file = Confparcer::SETTING<std::string>(key("TLS_CERT"), defaults.certificate_file);
+    // The key may sit in the certificate file
+    options.private_key_file = Confparcer::SETTING<std::string>(key("TLS_KEY"), options.certificate_file);
+    options.ktls = Confparcer::SETTING<bool>(key("KTLS"), defaults.ktls);
+
+    std::stringstream protocols(Confparcer::SETTING<std::string>(key("TLS_ALPN"), ""));
+    std::string protocol;
+    while (std::getline(protocols, protocol, ',')) {
+        protocol.erase(0, protocol.find_first_not_of(" \t"));
+        protocol.erase(protocol.find_last_not_of(" \t") + 1);
+        if (!protocol.empty()) options.alpn.push_back(protocol);
+    }
+    return options;
+}
+
+std::string TlsOptions::describe() const {
+    if (!enabled()) return "tls=off";
+    std::string text = "tls=" + certificate_file + " ktls=" + (ktls ? "on" : "off") + " alpn=";
+    for (size_t i = 0; i < alpn.size(); ++i) {
+        text += (i ? "," : "") + alpn[i];
+    }
+    return text + (alpn.empty() ? "none" : "");
+}
+
+#if HG_TLS
+
+std::string tls_error_text() {
+    unsigned long code = ERR_get_error();
+    if (code == 0) return "unknown error";
+    char text[256];
+    ERR_error_string_n(code, text, sizeof(text));
+    ERR_clear_error();
+    return text;
+}
+
+TicketKeyRing::TicketKeyRing(size_t retained)
+    : retained_(std::max<size_t>(1, retained)), keys_(std::make_shared<const Keys>(1, generate())) {}
+
+void TicketKeyRing::rotate() {
+    auto keys = std::make_shared<Keys>();
+    keys->reserve(retained_);
+    keys->push_back(generate());
+    for (const Key& key : *std::atomic_load(&keys_)) {
+        if (keys->size() == retained_) break;
+        keys->push_back(key);
+    }
+    std::atomic_store(&keys_, std::shared_ptr<const Keys>(std::move(keys)));
+}
+
+TicketKeyRing::Key TicketKeyRing::generate() {
+    Key key;
+    if (RAND_bytes(key.name.data(), static_cast<int>(key.name.size())) != 1 ||
+        RAND_bytes(key.aes_key.data(), static_cast<int>(key.aes_key.size())) != 1 ||
+        RAND_bytes(key.hmac_key.data(), static_cast<int>(key.hmac_key.size())) != 1) {
+        throw std::runtime_error("cannot generate a session ticket key: " + tls_error_text());
+    }
+    return key;
+}
+
+TlsContext::TlsContext(const std::string& name, const TlsOptions& options, const TicketKeyRing& tickets)
+    : options_(options), tickets_(tickets) {
+    std::unique_ptr<SSL_CTX, decltype(&SSL_CTX_free)> context(SSL_CTX_new(TLS_server_method()), &SSL_CTX_free);
+    if (!context) throw std::runtime_error("cannot create a TLS context: " + tls_error_text());
+
+    SSL_CTX_set_min_proto_version(context.get(), TLS1_2_VERSION);
+    // Clients often close without close_notify, that is an ordinary end of stream here
+    uint64_t flags = SSL_OP_NO_RENEGOTIATION | SSL_OP_CIPHER_SERVER_PREFERENCE | SSL_OP_IGNORE_UNEXPECTED_EOF;
+#ifdef SSL_OP_ENABLE_KTLS
+    if (options.ktls) flags |= SSL_OP_ENABLE_KTLS;
+#endif
+    SSL_CTX_set_options(context.get(), flags);
+    // Writes are retried from a relay buffer that may be refilled in place; idle
+    // connections give their record buffers back
+    SSL_CTX_set_mode(context.get(), SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER | SSL_MODE_RELEASE_BUFFERS);
+
+    if (SSL_CTX_use_certificate_chain_file(context.get(), options.certificate_file.c_str()) != 1) {
+        throw std::runtime_error("cannot load certificate " + options.certificate_file + ": " + tls_error_text());
+    }
+    if (SSL_CTX_use_PrivateKey_file(context.get(), options.private_key_file.c_str(), SSL_FILETYPE_PEM) != 1 ||
+        SSL_CTX_check_private_key(context.get()) != 1) {
+        throw std::runtime_error("cannot load private key " + options.private_key_file + ": " + tls_error_text());
+    }
+
+    // Sessions resumed by ID must have been issued by this listener
+    std::string session_context = name.substr(0, SSL_MAX_SID_CTX_LENGTH);
+    SSL_CTX_set_session_id_context(context.get(), reinterpret_cast<const unsigned char*>(session_context.data()),
+                                   static_cast<unsigned int>(session_context.size()));
+    SSL_CTX_set_session_cache_mode(context.get(), SSL_SESS_CACHE_SERVER);
+    SSL_CTX_sess_set_cache_size(context.get(), static_cast<long>(SESSION_CACHE_SIZE()));
+    SSL_CTX_set_timeout(context.get(), SESSION_LIFETIME_S());
+    SSL_CTX_set_tlsext_ticket_key_evp_cb(context.get(), &TlsContext::ticket_key);
+
+    for (const std::string& protocol : options.alpn) {
+        if (protocol.size() > 255) throw std::runtime_error("ALPN protocol name too long: " + protocol);
+        alpn_wire_ += static_cast<char>(protocol.size());
+        alpn_wire_ += protocol;
+    }
+    if (!alpn_wire_.empty()) {
+        SSL_CTX_set_alpn_select_cb(context.get(), &TlsContext::select_alpn, this);
+    }
+
+    SSL_CTX_set_app_data(context.get(), this);
+    context_ = context.release();
+}
+
+TlsContext::~TlsContext() {
+    SSL_CTX_free(context_);
+}
+
+SSL* TlsContext::create_session() const {
+    return SSL_new(context_);
+}
+
+long TlsContext::cached_sessions() const {
+    return SSL_CTX_sess_number(context_);
+}
+
+int TlsContext::select_alpn(SSL* /*ssl*/, const unsigned char** out, unsigned char* out_length,
+                            const unsigned char* offered, unsigned int offered_length, void* arg) {
+    const auto* self = static_cast<const TlsContext*>(arg);
+    unsigned char* selected = nullptr;
+    // Walks our list in order, so our preference wins
+    int result = SSL_select_next_proto(&selected, out_length,
+                                       reinterpret_cast<const unsigned char*>(self->alpn_wire_.data()),
+                                       static_cast<unsigned int>(self->alpn_wire_.size()), offered, offered_length);
+    if (result != OPENSSL_NPN_NEGOTIATED) {
+        // RFC 7301: no protocol in common is a no_application_protocol alert
+        return SSL_TLSEXT_ERR_ALERT_FATAL;
+    }
+    *out = selected;
+    return SSL_TLSEXT_ERR_OK;
+}
+
+int TlsContext::ticket_key(SSL* ssl, unsigned char* name, unsigned char* iv, EVP_CIPHER_CTX* cipher,
+                           EVP_MAC_CTX* mac, int encrypt) {
+    const auto* self = static_cast<const TlsContext*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
+    auto keys = self->tickets_.keys();
+
+    const TicketKeyRing::Key* key = nullptr;
+    bool newest = true;
+    if (encrypt) {
+        key = &keys->front();
+        if (RAND_bytes(iv, EVP_MAX_IV_LENGTH) != 1) return -1;
+        std::memcpy(name, key->name.data(), key->name.size());
+    } else {
+        for (size_t i = 0; i < keys->size(); ++i) {
+            if (std::memcmp(name, (*keys)[i].name.data(), (*keys)[i].name.size()) == 0) {
+                key = &(*keys)[i];
+                newest = i == 0;
+                break;
+            }
+        }
+        // Sealed with a retired key: a full handshake, which issues a new ticket
+        if (!key) return 0;
+    }
+
+    OSSL_PARAM params[] = {
+        OSSL_PARAM_construct_octet_string(OSSL_MAC_PARAM_KEY, const_cast<unsigned char*>(key->hmac_key.data()),
+                                          key->hmac_key.size()),
+        OSSL_PARAM_construct_utf8_string(OSSL_MAC_PARAM_DIGEST, const_cast<char*>("SHA256"), 0),
+        OSSL_PARAM_construct_end(),
+    };
+    if (EVP_MAC_CTX_set_params(mac, params) != 1) return -1;
+
+    int initialized = encrypt
+        ? EVP_EncryptInit_ex(cipher, EVP_aes_256_cbc(), nullptr, key->aes_key.data(), iv)
+        : EVP_DecryptInit_ex(cipher, EVP_aes_256_cbc(), nullptr, key->aes_key.data(), iv);
+    if (initialized != 1) return -1;
+    // 2 accepts the ticket and reissues it under the newest key
+    return newest ? 1 : 2;
+}
+
+#endif
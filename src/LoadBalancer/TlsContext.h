@@ -0,0 +1,122 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\TlsContext.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../common/Confparcer.h"
+#include "../common/generic.h"
+
+#if HG_TLS
+#include <openssl/ssl.h>
+#endif
+
+// TLS termination for one listening port, read from "<prefix>_TLS_*" settings
+// like ListenerOptions. Off unless a certificate is configured.
+struct TlsOptions {
+    // PEM certificate chain, leaf first
+    std::string certificate_file;
+    std::string private_key_file;
+    // ALPN protocols accepted, most preferred first; empty leaves ALPN unanswered
+    std::vector<std::string> alpn;
+    // Let OpenSSL hand record encryption to the kernel after the handshake
+    bool ktls{true};
+
+    bool enabled() const { return !certificate_file.empty(); }
+
+    static TlsOptions from_settings(const std::string& prefix = "LISTEN");
+
+    // One line for the startup log
+    std::string describe() const;
+};
+
+#if HG_TLS
+
+// Session ticket keys shared by every TLS listener. The first key seals new
+// tickets, the rest only open tickets issued before the last rotations, so a
+// ticket stays valid for up to `retained` rotation periods. Keys live in this
+// process only: tickets do not survive a restart.
+class TicketKeyRing {
+public:
+    struct Key {
+        std::array<unsigned char, 16> name;
+        std::array<unsigned char, 32> aes_key;
+        std::array<unsigned char, 32> hmac_key;
+    };
+    using Keys = std::vector<Key>;
+
+    explicit TicketKeyRing(size_t retained = 2);
+
+    TicketKeyRing(const TicketKeyRing&) = delete;
+    TicketKeyRing& operator=(const TicketKeyRing&) = delete;
+
+    // Puts a fresh key first and drops the oldest beyond `retained`
+    void rotate();
+
+    // Lock-free, called from the handshake
+    std::shared_ptr<const Keys> keys() const { return std::atomic_load(&keys_); }
+
+private:
+    static Key generate();
+
+    size_t retained_;
+    std::shared_ptr<const Keys> keys_;
+};
+
+// The OpenSSL server context of one TLS listener:
+//  - a session cache shared by every connection of the listener, for TLS 1.2 session IDs,
+//  - stateless TLS 1.3 and 1.2 session tickets sealed with the TicketKeyRing,
+//  - ALPN answered from TlsOptions::alpn,
+//  - kernel TLS requested when TlsOptions::ktls is set.
+class TlsContext {
+public:
+    // Throws std::runtime_error when the certificate or key do not load
+    TlsContext(const std::string& name, const TlsOptions& options, const TicketKeyRing& tickets);
+    ~TlsContext();
+
+    TlsContext(const TlsContext&) = delete;
+    TlsContext& operator=(const TlsContext&) = delete;
+
+    // A server-side SSL for a new connection, nullptr if OpenSSL is out of memory
+    SSL* create_session() const;
+
+    const TlsOptions& options() const { return options_; }
+    // Sessions held by the cache right now
+    long cached_sessions() const;
+
+    static size_t SESSION_CACHE_SIZE() {
+        static size_t value = Confparcer::SETTING<size_t>("TLS_SESSION_CACHE_SIZE", 20480);
+        return value;
+    }
+
+    static long SESSION_LIFETIME_S() {
+        static long value = Confparcer::SETTING<long>("TLS_SESSION_LIFETIME_S", 7200);
+        return value;
+    }
+
+private:
+    static int select_alpn(SSL* ssl, const unsigned char** out, unsigned char* out_length,
+                           const unsigned char* offered, unsigned int offered_length, void* arg);
+    static int ticket_key(SSL* ssl, unsigned char* name, unsigned char* iv, EVP_CIPHER_CTX* cipher,
+                          EVP_MAC_CTX* mac, int encrypt);
+
+    SSL_CTX* context_{nullptr};
+    TlsOptions options_;
+    const TicketKeyRing& tickets_;
+    // options_.alpn in wire format, length-prefixed
+    std::string alpn_wire_;
+};
+
+// The text of the oldest queued OpenSSL error, which is then cleared
+std::string tls_error_text();
+
+#endif
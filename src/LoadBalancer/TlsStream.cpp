@@ -0,0 +1,97 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\TlsStream.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "TlsStream.h"
+
+#if HG_TLS
+#include <cerrno>
+#include <openssl/err.h>
+
+TlsStream::TlsStream(Socket& socket, SSL* ssl) : socket_(socket), ssl_(ssl) {
+    // OpenSSL must get EAGAIN rather than block a runtime thread
+    asio::error_code ignored;
+    socket_.non_blocking(true, ignored);
+    SSL_set_fd(ssl_, static_cast<int>(socket_.native_handle()));
+    SSL_set_accept_state(ssl_);
+}
+
+TlsStream::~TlsStream() {
+    SSL_free(ssl_);
+}
+
+TlsStream::Want TlsStream::step(Kind kind, void* data, size_t size, size_t& done, asio::error_code& error) {
+    ERR_clear_error();
+    errno = 0;
+    int result = 0;
+    done = 0;
+    switch (kind) {
+        case Kind::HANDSHAKE:
+            result = SSL_do_handshake(ssl_);
+            break;
+        case Kind::READ:
+            result = SSL_read_ex(ssl_, data, size, &done);
+            break;
+        case Kind::WRITE:
+            result = SSL_write_ex(ssl_, data, size, &done);
+            break;
+    }
+
+    if (result == 1) {
+        error = asio::error_code();
+        if (kind == Kind::HANDSHAKE) {
+#ifndef OPENSSL_NO_KTLS
+            kernel_writes_ = BIO_get_ktls_send(SSL_get_wbio(ssl_));
+            kernel_reads_ = BIO_get_ktls_recv(SSL_get_rbio(ssl_));
+#endif
+        }
+        return Want::NOTHING;
+    }
+
+    done = 0;
+    switch (SSL_get_error(ssl_, result)) {
+        case SSL_ERROR_WANT_READ:
+            return Want::READ;
+        case SSL_ERROR_WANT_WRITE:
+            return Want::WRITE;
+        case SSL_ERROR_ZERO_RETURN:
+            error = asio::error::eof;
+            break;
+        case SSL_ERROR_SYSCALL:
+            error = errno != 0 ? asio::error_code(errno, asio::error::get_system_category())
+                               : asio::error_code(asio::error::eof);
+            break;
+        default: {
+            unsigned long code = ERR_get_error();
+            error = code != 0 ? asio::error_code(static_cast<int>(code), asio::error::get_ssl_category())
+                              : asio::error_code(asio::error::connection_aborted);
+            break;
+        }
+    }
+    ERR_clear_error();
+    return Want::NOTHING;
+}
+
+bool TlsStream::resumed() const {
+    return SSL_session_reused(ssl_) == 1;
+}
+
+std::string_view TlsStream::alpn_protocol() const {
+    const unsigned char* protocol = nullptr;
+    unsigned int length = 0;
+    SSL_get0_alpn_selected(ssl_, &protocol, &length);
+    return std::string_view(reinterpret_cast<const char*>(protocol), length);
+}
+
+void TlsStream::shutdown() {
+    if (SSL_is_init_finished(ssl_) != 1) return;
+    SSL_shutdown(ssl_);
+    ERR_clear_error();
+}
+
+#endif
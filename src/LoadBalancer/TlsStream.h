@@ -0,0 +1,132 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\TlsStream.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include "../common/generic.h"
+
+#if HG_TLS
+#include <cstddef>
+#include <string_view>
+#include <openssl/ssl.h>
+#include "../../thirdparty/asio/include/asio.hpp"
+#include "../../thirdparty/asio/include/asio/ssl/error.hpp"
+
+// The server side of TLS on an accepted socket, an asio AsyncStream. OpenSSL
+// reads and writes the descriptor itself, put in non-blocking mode, and the
+// stream waits for readiness on the socket whenever it asks to; so OpenSSL can
+// hand the record layer to kernel TLS once the handshake is done.
+// kernel_writes() then says plaintext written to the socket itself is sealed by
+// the kernel, and the caller may write there directly. Reads keep going through
+// the stream even when kernel_reads(): the kernel hands alerts and other
+// non-data records back as errors that OpenSSL has to interpret.
+//
+// Every operation runs on the socket's strand; one read and one write may be
+// in flight at a time, as on the plain socket.
+class TlsStream {
+public:
+    using Socket = asio::basic_stream_socket<asio::ip::tcp, asio::strand<asio::io_context::executor_type>>;
+    using executor_type = Socket::executor_type;
+
+    // Takes ownership of `ssl`
+    TlsStream(Socket& socket, SSL* ssl);
+    ~TlsStream();
+
+    TlsStream(const TlsStream&) = delete;
+    TlsStream& operator=(const TlsStream&) = delete;
+
+    executor_type get_executor() { return socket_.get_executor(); }
+
+    // void(asio::error_code)
+    template<typename Token>
+    auto async_handshake(Token&& token) {
+        return asio::async_compose<Token, void(asio::error_code)>(
+            Operation<Kind::HANDSHAKE>(*this, nullptr, 0), token, socket_);
+    }
+
+    // void(asio::error_code, size_t); only the first buffer of the sequence is used
+    template<typename MutableBufferSequence, typename Token>
+    auto async_read_some(const MutableBufferSequence& buffers, Token&& token) {
+        asio::mutable_buffer buffer = *asio::buffer_sequence_begin(buffers);
+        return asio::async_compose<Token, void(asio::error_code, size_t)>(
+            Operation<Kind::READ>(*this, buffer.data(), buffer.size()), token, socket_);
+    }
+
+    template<typename ConstBufferSequence, typename Token>
+    auto async_write_some(const ConstBufferSequence& buffers, Token&& token) {
+        asio::const_buffer buffer = *asio::buffer_sequence_begin(buffers);
+        return asio::async_compose<Token, void(asio::error_code, size_t)>(
+            Operation<Kind::WRITE>(*this, const_cast<void*>(buffer.data()), buffer.size()), token, socket_);
+    }
+
+    // Valid once the handshake completed
+    bool kernel_reads() const { return kernel_reads_; }
+    bool kernel_writes() const { return kernel_writes_; }
+    bool resumed() const;
+    // Empty when the client offered no protocol we accept
+    std::string_view alpn_protocol() const;
+
+    // Sends close_notify if the socket takes it without blocking
+    void shutdown();
+
+private:
+    enum class Kind { HANDSHAKE, READ, WRITE };
+    enum class Want { NOTHING, READ, WRITE };
+
+    // One OpenSSL call; `done` and `error` are its outcome unless it wants the socket
+    Want step(Kind kind, void* data, size_t size, size_t& done, asio::error_code& error);
+
+    template<Kind KIND>
+    struct Operation {
+        TlsStream& stream;
+        void* data;
+        size_t size;
+        size_t done{0};
+        asio::error_code result;
+        bool started{false};
+        bool finished{false};
+
+        Operation(TlsStream& stream, void* data, size_t size) : stream(stream), data(data), size(size) {}
+
+        template<typename Self>
+        void operator()(Self& self, asio::error_code error = {}) {
+            if (!error && !finished) {
+                Want want = stream.step(KIND, data, size, done, result);
+                if (want != Want::NOTHING) {
+                    started = true;
+                    stream.socket_.async_wait(want == Want::READ ? Socket::wait_read : Socket::wait_write,
+                                              std::move(self));
+                    return;
+                }
+                finished = true;
+                if (!started) {
+                    // Done without waiting: complete from the strand rather than inside the initiating call
+                    started = true;
+                    asio::post(stream.socket_.get_executor(), std::move(self));
+                    return;
+                }
+            } else if (error) {
+                result = error;
+                done = 0;
+            }
+
+            if constexpr (KIND == Kind::HANDSHAKE) {
+                self.complete(result);
+            } else {
+                self.complete(result, done);
+            }
+        }
+    };
+
+    Socket& socket_;
+    SSL* ssl_;
+    bool kernel_reads_{false};
+    bool kernel_writes_{false};
+};
+
+#endif
@@ -0,0 +1,962 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\UringEngine.cpp
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "UringEngine.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+
+#include "LoadBalancer.h"
+#include "../common/logger.h"
+
+#if ISLINUX
+#include <arpa/inet.h>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+#if ISLINUX
+
+namespace {
+
+constexpr uint16_t BUFFER_GROUP = 0;
+// Largest buffer ring the 16-bit buffer ids can address
+constexpr size_t MAX_BUFFERS = 32768;
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+uint64_t pack(uint32_t slot, uint8_t operation) {
+    return (static_cast<uint64_t>(slot) << 8) | operation;
+}
+
+size_t round_up_pow2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+std::string error_text(int negative_errno) {
+    return std::strerror(-negative_errno);
+}
+
+} // namespace
+
+// The mmap'd submission and completion queues plus the provided buffer ring
+struct UringEngine::Ring {
+    int fd{-1};
+
+    void* sq_map{MAP_FAILED};
+    size_t sq_map_size{0};
+    void* cq_map{MAP_FAILED};
+    size_t cq_map_size{0};
+    io_uring_sqe* sqes{static_cast<io_uring_sqe*>(MAP_FAILED)};
+    size_t sqes_size{0};
+
+    unsigned sq_entries{0};
+    unsigned* sq_head{nullptr};
+    unsigned* sq_tail{nullptr};
+    unsigned sq_mask{0};
+    // SQEs prepared since the last io_uring_enter()
+    unsigned sq_local_tail{0};
+    unsigned unsubmitted{0};
+
+    unsigned* cq_head{nullptr};
+    unsigned* cq_tail{nullptr};
+    unsigned cq_mask{0};
+    io_uring_cqe* cqes{nullptr};
+
+    io_uring_buf_ring* buffer_ring{static_cast<io_uring_buf_ring*>(MAP_FAILED)};
+    size_t buffer_ring_size{0};
+    char* buffers{static_cast<char*>(MAP_FAILED)};
+    size_t buffers_size{0};
+    unsigned buffer_count{0};
+    uint16_t buffer_tail{0};
+    // Buffer ids waiting for provide_returned(), without a buffer ring
+    std::vector<uint16_t> returned;
+
+    ~Ring() {
+        if (fd >= 0) close(fd);
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+        if (cq_map != MAP_FAILED && cq_map != sq_map) munmap(cq_map, cq_map_size);
+        if (sq_map != MAP_FAILED) munmap(sq_map, sq_map_size);
+        if (buffer_ring != MAP_FAILED) munmap(buffer_ring, buffer_ring_size);
+        if (buffers != MAP_FAILED) munmap(buffers, buffers_size);
+    }
+
+    void setup(unsigned entries) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        // One thread submits and reaps, so the kernel can skip cross-task wakeups
+        params.flags = IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN;
+        fd = io_uring_setup(entries, &params);
+        if (fd < 0 && errno == EINVAL) {
+            std::memset(&params, 0, sizeof(params));
+            fd = io_uring_setup(entries, &params);
+        }
+        if (fd < 0) {
+            throw std::runtime_error("io_uring_setup failed: " + std::string(std::strerror(errno)));
+        }
+
+        sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_map = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_map) {
+            sq_map_size = cq_map_size = std::max(sq_map_size, cq_map_size);
+        }
+
+        sq_map = mmap(nullptr, sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sq_map == MAP_FAILED) throw std::runtime_error("io_uring SQ mmap failed");
+        cq_map = single_map ? sq_map
+                            : mmap(nullptr, cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        if (cq_map == MAP_FAILED) throw std::runtime_error("io_uring CQ mmap failed");
+        sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE,
+                                               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED) throw std::runtime_error("io_uring SQE mmap failed");
+
+        auto* sq = static_cast<char*>(sq_map);
+        sq_entries = params.sq_entries;
+        sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        // SQE i always sits in array slot i
+        auto* sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        for (unsigned i = 0; i < sq_entries; ++i) {
+            sq_array[i] = i;
+        }
+        sq_local_tail = *sq_tail;
+
+        auto* cq = static_cast<char*>(cq_map);
+        cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    }
+
+    // `mapped` registers a buffer ring; otherwise buffers are handed over with
+    // IORING_OP_PROVIDE_BUFFERS, which costs an SQE per run of returned ids
+    void setup_buffers(size_t count, bool mapped) {
+        buffer_count = static_cast<unsigned>(std::min(round_up_pow2(std::max<size_t>(count, 1)), MAX_BUFFERS));
+        buffers_size = static_cast<size_t>(buffer_count) * BUFFER_SIZE;
+        buffers = static_cast<char*>(mmap(nullptr, buffers_size, PROT_READ | PROT_WRITE,
+                                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buffers == MAP_FAILED) throw std::runtime_error("receive buffers mmap failed");
+
+        if (!mapped) {
+            returned.reserve(buffer_count);
+            provide_range(0, buffer_count);
+            return;
+        }
+
+        buffer_ring_size = buffer_count * sizeof(io_uring_buf);
+        buffer_ring = static_cast<io_uring_buf_ring*>(mmap(nullptr, buffer_ring_size, PROT_READ | PROT_WRITE,
+                                                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (buffer_ring == MAP_FAILED) throw std::runtime_error("buffer ring mmap failed");
+
+        io_uring_buf_reg registration;
+        std::memset(&registration, 0, sizeof(registration));
+        registration.ring_addr = reinterpret_cast<uint64_t>(buffer_ring);
+        registration.ring_entries = buffer_count;
+        registration.bgid = BUFFER_GROUP;
+        if (io_uring_register(fd, IORING_REGISTER_PBUF_RING, &registration, 1) != 0) {
+            throw std::runtime_error("IORING_REGISTER_PBUF_RING failed: " + std::string(std::strerror(errno)));
+        }
+
+        for (unsigned buffer = 0; buffer < buffer_count; ++buffer) {
+            provide(static_cast<uint16_t>(buffer));
+        }
+    }
+
+    char* buffer(uint16_t id) {
+        return buffers + static_cast<size_t>(id) * BUFFER_SIZE;
+    }
+
+    // Hands buffer `id` back to the kernel for the next multishot recv
+    void provide(uint16_t id) {
+        if (buffer_ring == MAP_FAILED) {
+            returned.push_back(id);
+            return;
+        }
+        io_uring_buf& entry = buffer_ring->bufs[buffer_tail & (buffer_count - 1)];
+        entry.addr = reinterpret_cast<uint64_t>(buffer(id));
+        entry.len = BUFFER_SIZE;
+        entry.bid = id;
+        ++buffer_tail;
+        __atomic_store_n(&buffer_ring->tail, buffer_tail, __ATOMIC_RELEASE);
+    }
+
+    // Queues PROVIDE_BUFFERS for the ids returned since the last call, one SQE
+    // per run of consecutive ids. Must precede SQEs that expect the buffers back.
+    void provide_returned() {
+        if (returned.empty()) return;
+        std::sort(returned.begin(), returned.end());
+        size_t first = 0;
+        for (size_t i = 1; i <= returned.size(); ++i) {
+            if (i == returned.size() || returned[i] != returned[i - 1] + 1) {
+                provide_range(returned[first], static_cast<unsigned>(i - first));
+                first = i;
+            }
+        }
+        returned.clear();
+    }
+
+    void provide_range(unsigned first, unsigned count) {
+        io_uring_sqe* sqe = next_sqe();
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = static_cast<int>(count);
+        sqe->addr = reinterpret_cast<uint64_t>(buffer(static_cast<uint16_t>(first)));
+        sqe->len = BUFFER_SIZE;
+        sqe->off = first;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->user_data = pack(0, OP_PROVIDE);
+    }
+
+    // Zeroed SQE; submits what is queued first if the SQ is full
+    io_uring_sqe* next_sqe() {
+        while (sq_local_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) >= sq_entries) {
+            enter(0);
+        }
+        io_uring_sqe* sqe = &sqes[sq_local_tail & sq_mask];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++sq_local_tail;
+        ++unsubmitted;
+        return sqe;
+    }
+
+    // Publishes queued SQEs and optionally waits for `wait` completions
+    void enter(unsigned wait) {
+        __atomic_store_n(sq_tail, sq_local_tail, __ATOMIC_RELEASE);
+        for (;;) {
+            int result = io_uring_enter(fd, unsubmitted, wait, wait != 0 ? IORING_ENTER_GETEVENTS : 0);
+            if (result >= 0) {
+                unsubmitted -= std::min<unsigned>(static_cast<unsigned>(result), unsubmitted);
+                return;
+            }
+            // EBUSY/EAGAIN: the CQ is full, the caller reaps and comes back
+            if (errno != EINTR) return;
+        }
+    }
+};
+
+// Some kernels accept IORING_REGISTER_PBUF_RING but then fail every recv that
+// selects from the ring with ENOBUFS, so the probe receives one byte through it
+bool UringEngine::buffer_ring_delivers() {
+    static const bool result = []() {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) != 0) return false;
+        bool delivered = false;
+        try {
+            Ring probe;
+            probe.setup(8);
+            probe.setup_buffers(1, true);
+            if (write(pair[1], "x", 1) == 1) {
+                io_uring_sqe* sqe = probe.next_sqe();
+                sqe->opcode = IORING_OP_RECV;
+                sqe->fd = pair[0];
+                sqe->flags = IOSQE_BUFFER_SELECT;
+                sqe->buf_group = BUFFER_GROUP;
+                probe.enter(1);
+                if (*probe.cq_head != __atomic_load_n(probe.cq_tail, __ATOMIC_ACQUIRE)) {
+                    delivered = probe.cqes[*probe.cq_head & probe.cq_mask].res == 1;
+                }
+            }
+        } catch (const std::exception&) {
+        }
+        close(pair[0]);
+        close(pair[1]);
+        return delivered;
+    }();
+    return result;
+}
+
+bool UringEngine::supported() {
+    static const bool result = []() {
+        utsname name;
+        int major = 0;
+        int minor = 0;
+        // Multishot recv needs 6.0; earlier features come with it
+        if (uname(&name) != 0 || std::sscanf(name.release, "%d.%d", &major, &minor) != 2 ||
+            major < 6) {
+            return false;
+        }
+        try {
+            Ring probe;
+            probe.setup(8);
+            probe.setup_buffers(1, false);
+            return true;
+        } catch (const std::exception& e) {
+            LOG_WARN("io_uring probe failed: " + std::string(e.what()));
+            return false;
+        }
+    }();
+    return result;
+}
+
+UringEngine::UringEngine(LoadBalancer& balancer, Listener& listener)
+    : balancer_(balancer), listener_(listener) {
+}
+
+UringEngine::~UringEngine() {
+    stop();
+}
+
+void UringEngine::start(int port, const ListenerOptions& options) {
+    if (running_.load()) return;
+
+    options_ = options;
+    listen_fd_ = open_listen_sockets(port, options_, 1).front().fd;
+    wake_fd_ = eventfd(0, EFD_CLOEXEC);
+
+    // A single-issuer ring belongs to the thread that creates it
+    std::promise<void> ready;
+    auto started = ready.get_future();
+    running_ = true;
+    thread_ = std::thread([this, &ready]() {
+        try {
+            ring_ = std::make_unique<Ring>();
+            ring_->setup(static_cast<unsigned>(ENTRIES()));
+            ring_->setup_buffers(BUFFERS(), buffer_ring_delivers());
+        } catch (...) {
+            ring_.reset();
+            ready.set_exception(std::current_exception());
+            return;
+        }
+        ready.set_value();
+        run();
+    });
+
+    try {
+        started.get();
+    } catch (...) {
+        running_ = false;
+        thread_.join();
+        close(listen_fd_);
+        close(wake_fd_);
+        listen_fd_ = wake_fd_ = -1;
+        throw;
+    }
+    LOG_INFO("io_uring engine listening on port " + std::to_string(port) + " with " +
+             std::to_string(ring_->buffer_count) + " receive buffers" +
+             (ring_->buffer_ring == MAP_FAILED ? " (provided with PROVIDE_BUFFERS)" : ""));
+}
+
+void UringEngine::stop() {
+    if (!running_.exchange(false)) return;
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        LOG_WARN("Cannot wake the io_uring thread: " + std::string(std::strerror(errno)));
+    }
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    close(listen_fd_);
+    close(wake_fd_);
+    listen_fd_ = wake_fd_ = -1;
+    ring_.reset();
+    LOG_INFO("io_uring engine stopped");
+}
+
+void UringEngine::run() {
+    arm_accept();
+    arm_wake();
+
+    while (running_.load()) {
+        ring_->enter(1);
+        enters_.fetch_add(1, std::memory_order_relaxed);
+
+        unsigned head = *ring_->cq_head;
+        while (head != __atomic_load_n(ring_->cq_tail, __ATOMIC_ACQUIRE)) {
+            const io_uring_cqe& cqe = ring_->cqes[head & ring_->cq_mask];
+            uint64_t user_data = cqe.user_data;
+            int result = cqe.res;
+            uint32_t flags = cqe.flags;
+            __atomic_store_n(ring_->cq_head, ++head, __ATOMIC_RELEASE);
+
+            completions_.fetch_add(1, std::memory_order_relaxed);
+            handle_completion(user_data, result, flags);
+        }
+        ring_->provide_returned();
+        restart_starved();
+    }
+
+    shutdown_connections();
+}
+
+void UringEngine::handle_completion(uint64_t user_data, int result, uint32_t flags) {
+    uint32_t slot = static_cast<uint32_t>(user_data >> 8);
+    switch (static_cast<Operation>(user_data & 0xFF)) {
+        case OP_ACCEPT:
+            if (result >= 0) {
+                on_accept(result);
+            } else if (result != -ECANCELED) {
+                LOG_ERROR("Accept error: " + error_text(result));
+            }
+            if (!(flags & IORING_CQE_F_MORE) && running_.load()) {
+                arm_accept();
+            }
+            break;
+        case OP_WAKE:
+            on_verdicts();
+            if (running_.load()) {
+                arm_wake();
+            }
+            break;
+        case OP_RECV_CLIENT:
+            on_recv(slot, false, result, flags);
+            break;
+        case OP_RECV_BACKEND:
+            on_recv(slot, true, result, flags);
+            break;
+        case OP_SEND_CLIENT:
+            on_send(slot, false, result);
+            break;
+        case OP_SEND_BACKEND:
+            on_send(slot, true, result);
+            break;
+        case OP_CONNECT:
+            on_connect(slot, result);
+            break;
+        case OP_CANCEL:
+            complete_operation(slot);
+            break;
+        case OP_PROVIDE:
+            if (result < 0) {
+                LOG_ERROR("Cannot return receive buffers: " + error_text(result));
+            }
+            break;
+    }
+}
+
+void UringEngine::arm_accept() {
+    io_uring_sqe* sqe = ring_->next_sqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listen_fd_;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = pack(0, OP_ACCEPT);
+}
+
+void UringEngine::arm_wake() {
+    io_uring_sqe* sqe = ring_->next_sqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = wake_fd_;
+    sqe->addr = reinterpret_cast<uint64_t>(&wake_value_);
+    sqe->len = sizeof(wake_value_);
+    sqe->off = static_cast<uint64_t>(-1);
+    sqe->user_data = pack(0, OP_WAKE);
+}
+
+void UringEngine::arm_recv(uint32_t slot, bool from_backend) {
+    Connection& connection = *connections_[slot];
+    Direction& direction = from_backend ? connection.downstream : connection.upstream;
+    io_uring_sqe* sqe = ring_->next_sqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = from_backend ? connection.backend_fd : connection.client_fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->user_data = pack(slot, from_backend ? OP_RECV_BACKEND : OP_RECV_CLIENT);
+    direction.receiving = true;
+    ++connection.operations;
+}
+
+void UringEngine::cancel(uint32_t slot, uint64_t target_user_data) {
+    io_uring_sqe* sqe = ring_->next_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = target_user_data;
+    sqe->user_data = pack(slot, OP_CANCEL);
+    ++connections_[slot]->operations;
+}
+
+void UringEngine::cancel_fd(uint32_t slot, int fd) {
+    io_uring_sqe* sqe = ring_->next_sqe();
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = fd;
+    sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+    sqe->user_data = pack(slot, OP_CANCEL);
+    ++connections_[slot]->operations;
+}
+
+void UringEngine::flush(uint32_t slot, bool to_backend) {
+    Connection& connection = *connections_[slot];
+    Direction& direction = to_backend ? connection.upstream : connection.downstream;
+    if (direction.in_flight != 0 || direction.queued.empty()) return;
+
+    // Linked so the kernel sends them in order without a round trip per chunk
+    size_t count = direction.queued.size();
+    for (size_t i = 0; i < count; ++i) {
+        const Chunk& chunk = direction.queued[i];
+        io_uring_sqe* sqe = ring_->next_sqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = to_backend ? connection.backend_fd : connection.client_fd;
+        sqe->addr = reinterpret_cast<uint64_t>(ring_->buffer(chunk.buffer) + chunk.offset);
+        sqe->len = chunk.length;
+        sqe->msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        if (i + 1 < count) {
+            sqe->flags = IOSQE_IO_LINK;
+        }
+        sqe->user_data = pack(slot, to_backend ? OP_SEND_BACKEND : OP_SEND_CLIENT);
+        ++connection.operations;
+    }
+    direction.in_flight = count;
+}
+
+void UringEngine::on_accept(int fd) {
+    uint32_t slot;
+    if (!free_slots_.empty()) {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    } else {
+        slot = static_cast<uint32_t>(connections_.size());
+        connections_.push_back(std::make_unique<Connection>());
+    }
+
+    Connection& connection = *connections_[slot];
+    connection.accepted_at = std::chrono::steady_clock::now();
+    connection.client_id = LoadBalancer::allocate_client_id();
+    connection.client_fd = fd;
+    connection.state = State::CLASSIFYING;
+    tune_accepted_socket(fd, options_);
+
+    sockaddr_storage peer;
+    socklen_t peer_size = sizeof(peer);
+    char text[INET6_ADDRSTRLEN] = "";
+    if (getpeername(fd, reinterpret_cast<sockaddr*>(&peer), &peer_size) == 0) {
+        const auto& v6 = reinterpret_cast<sockaddr_in6*>(&peer)->sin6_addr;
+        if (peer.ss_family != AF_INET6) {
+            inet_ntop(AF_INET, &reinterpret_cast<sockaddr_in*>(&peer)->sin_addr, text, sizeof(text));
+        } else if (IN6_IS_ADDR_V4MAPPED(&v6)) {
+            // Dual-stack listeners see IPv4 clients as ::ffff:a.b.c.d; keep the plain form
+            inet_ntop(AF_INET, &v6.s6_addr[12], text, sizeof(text));
+        } else {
+            inet_ntop(AF_INET6, &v6, text, sizeof(text));
+        }
+    }
+    connection.client_ip = text;
+    accepted_.fetch_add(1, std::memory_order_relaxed);
+    live_connections_.fetch_add(1, std::memory_order_relaxed);
+
+    balancer_.announce_client(listener_, connection.client_ip, connection.client_id);
+
+    arm_recv(slot, false);
+    // Address lists, rate limits or an earlier verdict may route it straight away
+    BackendId assigned = balancer_.triage_client(listener_, connection.client_ip, connection.client_ip);
+    if (assigned != INVALID_BACKEND_ID) {
+        connect_backend(slot, assigned);
+    }
+    balancer_.performance_.stage_latency.record(LatencyStage::ACCEPT,
+                                                std::chrono::steady_clock::now() - connection.accepted_at);
+}
+
+void UringEngine::on_recv(uint32_t slot, bool from_backend, int result, uint32_t flags) {
+    Connection& connection = *connections_[slot];
+    Direction& direction = from_backend ? connection.downstream : connection.upstream;
+
+    if (result > 0) {
+        uint16_t buffer = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        ++buffers_out_;
+        if (connection.state == State::CLOSING) {
+            recycle_buffer(buffer);
+        } else {
+            direction.queued.push_back(Chunk{buffer, 0, static_cast<uint32_t>(result)});
+            bytes_relayed_.fetch_add(static_cast<uint64_t>(result), std::memory_order_relaxed);
+
+            if (!from_backend && connection.state == State::CLASSIFYING &&
+                connection.classification_request == INVALID_CORRELATION_ID) {
+                // The first bytes go to the classifier and wait in the queue for the backend
+                connection.classification_sent_at = std::chrono::steady_clock::now();
+                balancer_.performance_.stage_latency.record(LatencyStage::CLASSIFICATION_REQUEST,
+                    connection.classification_sent_at - connection.accepted_at);
+                // Known clients are routed at accept, by IP: a fingerprint only informs the
+                // classifier here, and only when the ClientHello came in the first chunk
+                std::optional<TlsFingerprint> fingerprint;
+                ClientHelloParser client_hello;
+                if (client_hello.parse(ring_->buffer(buffer), static_cast<size_t>(result)) ==
+                    ClientHelloParser::Status::COMPLETE) {
+                    fingerprint = TlsFingerprint::from(client_hello.hello());
+                    listener_.client_hellos.increment();
+                }
+                connection.classification_request = balancer_.publish_classification(
+                    listener_, connection.client_ip, connection.client_id,
+                    std::string(ring_->buffer(buffer), static_cast<size_t>(result)),
+                    balancer_.client_features_.record_request(connection.client_ip, {}),
+                    [this, slot, client_id = connection.client_id](RequestStatus status, const nlohmann::json& verdict) {
+                        {
+                            std::lock_guard<std::mutex> lock(verdicts_mutex_);
+                            verdicts_.push_back(Verdict{slot, client_id, status, verdict});
+                        }
+                        uint64_t one = 1;
+                        if (write(wake_fd_, &one, sizeof(one)) < 0) {
+                            LOG_WARN("Cannot wake the io_uring thread: " + std::string(std::strerror(errno)));
+                        }
+                    },
+                    fingerprint ? &*fingerprint : nullptr);
+            }
+
+            if (from_backend && !connection.first_response_seen) {
+                connection.first_response_seen = true;
+                balancer_.record_backend_stage(connection.backend, LatencyStage::FIRST_RESPONSE_BYTE,
+                                               std::chrono::steady_clock::now() - connection.backend_connected_at);
+            }
+
+            if (connection.state == State::RELAYING) {
+                flush(slot, !from_backend);
+            }
+            if (direction.queued.size() >= MAX_QUEUED_CHUNKS && direction.receiving && !direction.paused) {
+                direction.paused = true;
+                cancel(slot, pack(slot, from_backend ? OP_RECV_BACKEND : OP_RECV_CLIENT));
+            }
+        }
+    } else if (result == -ENOBUFS) {
+        starvations_.fetch_add(1, std::memory_order_relaxed);
+        direction.starved = true;
+        starved_.push_back((static_cast<uint64_t>(slot) << 1) | (from_backend ? 1 : 0));
+    } else if (result == 0 && connection.state != State::CLOSING) {
+        // A half-close: stop reading this side but keep relaying the other way
+        direction.eof = true;
+        if (connection.state == State::RELAYING) {
+            settle_eof(slot);
+        } else if (connection.state == State::CLASSIFYING &&
+                   connection.classification_request == INVALID_CORRELATION_ID) {
+            // Closed before sending anything, there is nothing to route
+            close_connection(slot);
+        }
+    } else if (!(result == -ECANCELED && direction.paused)) {
+        if (result < 0 && result != -ECANCELED && connection.state != State::CLOSING) {
+            LOG_WARN(std::string(from_backend ? "Read from backend" : "Read from client") +
+                     " failed: " + error_text(result));
+        }
+        close_connection(slot);
+    }
+
+    if (!(flags & IORING_CQE_F_MORE)) {
+        direction.receiving = false;
+        if (connection.state != State::CLOSING && !direction.starved && !direction.eof) {
+            if (direction.paused && direction.queued.size() <= MAX_QUEUED_CHUNKS / 2) {
+                direction.paused = false;
+            }
+            if (!direction.paused) {
+                arm_recv(slot, from_backend);
+            }
+        }
+        complete_operation(slot);
+    }
+}
+
+void UringEngine::on_send(uint32_t slot, bool to_backend, int result) {
+    Connection& connection = *connections_[slot];
+    Direction& direction = to_backend ? connection.upstream : connection.downstream;
+
+    Chunk chunk;
+    --direction.in_flight;
+    direction.queued.pop_front(chunk);
+    recycle_buffer(chunk.buffer);
+
+    if (result < 0 || static_cast<uint32_t>(result) != chunk.length) {
+        // Later sends of a broken chain complete with -ECANCELED
+        if (connection.state != State::CLOSING && result != -ECANCELED) {
+            LOG_WARN(std::string(to_backend ? "Write to backend" : "Write to client") + " failed: " +
+                     (result < 0 ? error_text(result) : std::string("short write")));
+        }
+        close_connection(slot);
+    } else if (connection.state == State::RELAYING) {
+        if (direction.in_flight == 0) {
+            flush(slot, to_backend);
+        }
+        if (direction.paused && !direction.receiving && direction.queued.size() <= MAX_QUEUED_CHUNKS / 2) {
+            direction.paused = false;
+            if (!direction.eof) {
+                arm_recv(slot, !to_backend);
+            }
+        }
+        settle_eof(slot);
+    }
+    complete_operation(slot);
+}
+
+void UringEngine::connect_backend(uint32_t slot, BackendId backend) {
+    Connection& connection = *connections_[slot];
+    // From here on close_connection() releases the backend slot
+    connection.backend = backend;
+    const auto& node = balancer_.backends_.node(backend);
+
+    std::memset(&connection.backend_address, 0, sizeof(connection.backend_address));
+    auto* v4 = reinterpret_cast<sockaddr_in*>(&connection.backend_address);
+    auto* v6 = reinterpret_cast<sockaddr_in6*>(&connection.backend_address);
+    if (inet_pton(AF_INET, node->host.c_str(), &v4->sin_addr) == 1) {
+        v4->sin_family = AF_INET;
+        v4->sin_port = htons(static_cast<uint16_t>(node->port));
+        connection.backend_address_size = sizeof(sockaddr_in);
+    } else if (inet_pton(AF_INET6, node->host.c_str(), &v6->sin6_addr) == 1) {
+        v6->sin6_family = AF_INET6;
+        v6->sin6_port = htons(static_cast<uint16_t>(node->port));
+        connection.backend_address_size = sizeof(sockaddr_in6);
+    } else {
+        LOG_ERROR("Backend connection failed: invalid address " + node->host);
+        close_connection(slot);
+        return;
+    }
+
+    connection.backend_fd = socket(connection.backend_address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (connection.backend_fd < 0) {
+        LOG_ERROR("Backend connection failed: " + std::string(std::strerror(errno)));
+        close_connection(slot);
+        return;
+    }
+
+    connection.state = State::CONNECTING;
+    connection.connect_started_at = std::chrono::steady_clock::now();
+    io_uring_sqe* sqe = ring_->next_sqe();
+    sqe->opcode = IORING_OP_CONNECT;
+    sqe->fd = connection.backend_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&connection.backend_address);
+    sqe->off = connection.backend_address_size;
+    sqe->user_data = pack(slot, OP_CONNECT);
+    ++connection.operations;
+}
+
+void UringEngine::on_connect(uint32_t slot, int result) {
+    Connection& connection = *connections_[slot];
+    if (connection.state != State::CLOSING) {
+        if (result < 0) {
+            LOG_ERROR("Backend connection failed: " + error_text(result));
+            close_connection(slot);
+        } else {
+            connection.state = State::RELAYING;
+            connection.backend_connected_at = std::chrono::steady_clock::now();
+            balancer_.record_backend_stage(connection.backend, LatencyStage::BACKEND_CONNECT,
+                                           connection.backend_connected_at - connection.connect_started_at);
+            arm_recv(slot, true);
+            flush(slot, true);
+            // The client may have finished sending while it was classified
+            settle_eof(slot);
+        }
+    }
+    complete_operation(slot);
+}
+
+void UringEngine::on_verdicts() {
+    {
+        std::lock_guard<std::mutex> lock(verdicts_mutex_);
+        verdicts_batch_.swap(verdicts_);
+    }
+    for (auto& verdict : verdicts_batch_) {
+        // The connection may have closed, and its slot been reused, since it asked
+        if (verdict.slot >= connections_.size()) continue;
+        Connection& connection = *connections_[verdict.slot];
+        if (connection.client_id != verdict.client_id || connection.state != State::CLASSIFYING) continue;
+
+        connection.classification_request = INVALID_CORRELATION_ID;
+        auto result = balancer_.read_verdict(connection.client_ip, verdict.status, verdict.payload,
+                                             connection.classification_sent_at);
+        BackendId backend = INVALID_BACKEND_ID;
+        if (result) {
+            backend = balancer_.route_verdict(listener_, listener_.group, connection.client_ip,
+                                              connection.client_ip, *result);
+        }
+        if (backend == INVALID_BACKEND_ID) {
+            close_connection(verdict.slot);
+        } else {
+            connect_backend(verdict.slot, backend);
+        }
+    }
+    verdicts_batch_.clear();
+}
+
+void UringEngine::close_connection(uint32_t slot) {
+    Connection& connection = *connections_[slot];
+    if (connection.state == State::CLOSING) return;
+    connection.state = State::CLOSING;
+    live_connections_.fetch_sub(1, std::memory_order_relaxed);
+
+    balancer_.finish_client(connection.client_ip, connection.backend, connection.accepted_at,
+                            connection.classification_request);
+    connection.classification_request = INVALID_CORRELATION_ID;
+
+    // The slot is released when the cancellations and everything they cancel have completed
+    cancel_fd(slot, connection.client_fd);
+    if (connection.backend_fd >= 0) {
+        cancel_fd(slot, connection.backend_fd);
+    }
+}
+
+void UringEngine::settle_eof(uint32_t slot) {
+    Connection& connection = *connections_[slot];
+    for (bool to_backend : {true, false}) {
+        Direction& direction = to_backend ? connection.upstream : connection.downstream;
+        if (!direction.eof || direction.shut || direction.in_flight != 0 || !direction.queued.empty()) continue;
+        // Everything the side sent is delivered: let the other one see the EOF
+        direction.shut = true;
+        if (shutdown(to_backend ? connection.backend_fd : connection.client_fd, SHUT_WR) < 0 && errno != ENOTCONN) {
+            LOG_WARN(std::string(to_backend ? "Shutdown of backend" : "Shutdown of client") +
+                     " failed: " + std::string(std::strerror(errno)));
+            close_connection(slot);
+            return;
+        }
+    }
+    if (connection.upstream.shut && connection.downstream.shut) {
+        close_connection(slot);
+    }
+}
+
+void UringEngine::complete_operation(uint32_t slot) {
+    Connection& connection = *connections_[slot];
+    if (--connection.operations == 0 && connection.state == State::CLOSING) {
+        release_slot(slot);
+    }
+}
+
+void UringEngine::release_slot(uint32_t slot) {
+    Connection& connection = *connections_[slot];
+    Chunk chunk;
+    while (connection.upstream.queued.pop_front(chunk)) {
+        recycle_buffer(chunk.buffer);
+    }
+    while (connection.downstream.queued.pop_front(chunk)) {
+        recycle_buffer(chunk.buffer);
+    }
+    close(connection.client_fd);
+    if (connection.backend_fd >= 0) {
+        close(connection.backend_fd);
+    }
+
+    // Keep the object, and the capacity of its queues, for the next connection
+    connection.client_id = 0;
+    connection.client_fd = -1;
+    connection.backend_fd = -1;
+    connection.backend = INVALID_BACKEND_ID;
+    connection.first_response_seen = false;
+    for (Direction* direction : {&connection.upstream, &connection.downstream}) {
+        direction->in_flight = 0;
+        direction->receiving = false;
+        direction->starved = false;
+        direction->paused = false;
+        direction->eof = false;
+        direction->shut = false;
+    }
+    free_slots_.push_back(slot);
+}
+
+void UringEngine::recycle_buffer(uint16_t buffer) {
+    --buffers_out_;
+    ring_->provide(buffer);
+}
+
+void UringEngine::restart_starved() {
+    // Returned buffers are already queued ahead of the recvs re-armed here
+    if (starved_.empty() || buffers_out_ >= ring_->buffer_count) return;
+    for (uint64_t entry : starved_) {
+        uint32_t slot = static_cast<uint32_t>(entry >> 1);
+        bool from_backend = (entry & 1) != 0;
+        Connection& connection = *connections_[slot];
+        Direction& direction = from_backend ? connection.downstream : connection.upstream;
+        // Stale when the slot was released, or re-armed, since it starved
+        if (!direction.starved || direction.receiving || connection.state == State::CLOSING) continue;
+        direction.starved = false;
+        if (!direction.paused) {
+            arm_recv(slot, from_backend);
+        }
+    }
+    starved_.clear();
+}
+
+void UringEngine::shutdown_connections() {
+    for (uint32_t slot = 0; slot < connections_.size(); ++slot) {
+        Connection& connection = *connections_[slot];
+        if (connection.client_fd < 0) continue;
+        if (connection.state != State::CLOSING) {
+            live_connections_.fetch_sub(1, std::memory_order_relaxed);
+            balancer_.finish_client(connection.client_ip, connection.backend, connection.accepted_at,
+                                    connection.classification_request);
+        }
+        close(connection.client_fd);
+        if (connection.backend_fd >= 0) {
+            close(connection.backend_fd);
+        }
+    }
+    connections_.clear();
+    free_slots_.clear();
+    starved_.clear();
+    buffers_out_ = 0;
+}
+
+void UringEngine::collect_metrics(metrics::OpenMetricsWriter& writer, const std::vector<const UringEngine*>& engines) {
+    using metrics::MetricType;
+    auto write = [&writer, &engines](const std::string& name, MetricType type, const std::string& help,
+                                     auto value) {
+        writer.family(name, type, help);
+        for (const UringEngine* engine : engines) {
+            metrics::Labels labels{{"listener", engine->listener_.profile.name}};
+            if (type == MetricType::GAUGE) {
+                writer.gauge(name, static_cast<double>(value(*engine)), labels);
+            } else {
+                writer.counter(name, static_cast<uint64_t>(value(*engine)), labels);
+            }
+        }
+    };
+    write("heavengate_uring_accepted_connections", MetricType::COUNTER, "Connections accepted by the io_uring engine",
+          [](const UringEngine& engine) { return engine.accepted_.load(std::memory_order_relaxed); });
+    write("heavengate_uring_connections", MetricType::GAUGE, "Open io_uring engine connections",
+          [](const UringEngine& engine) { return engine.live_connections_.load(std::memory_order_relaxed); });
+    write("heavengate_uring_enter_calls", MetricType::COUNTER, "io_uring_enter() calls made by the ring thread",
+          [](const UringEngine& engine) { return engine.enters_.load(std::memory_order_relaxed); });
+    write("heavengate_uring_completions", MetricType::COUNTER, "Completion queue entries processed",
+          [](const UringEngine& engine) { return engine.completions_.load(std::memory_order_relaxed); });
+    write("heavengate_uring_buffer_starvations", MetricType::COUNTER, "Receives stopped because the buffer ring was empty",
+          [](const UringEngine& engine) { return engine.starvations_.load(std::memory_order_relaxed); });
+    write("heavengate_uring_received_bytes", MetricType::COUNTER, "Bytes received for relaying, both directions",
+          [](const UringEngine& engine) { return engine.bytes_relayed_.load(std::memory_order_relaxed); });
+}
+
+#else // !ISLINUX
+
+struct UringEngine::Ring {};
+
+bool UringEngine::supported() {
+    return false;
+}
+
+UringEngine::UringEngine(LoadBalancer& balancer, Listener& listener)
+    : balancer_(balancer), listener_(listener) {
+}
+
+UringEngine::~UringEngine() = default;
+
+void UringEngine::start(int /*port*/, const ListenerOptions& /*options*/) {
+    throw std::runtime_error("io_uring is only available on Linux");
+}
+
+void UringEngine::stop() {
+}
+
+void UringEngine::collect_metrics(metrics::OpenMetricsWriter& /*writer*/, const std::vector<const UringEngine*>& /*engines*/) {
+}
+
+#endif
@@ -0,0 +1,218 @@
+/*
+ * Filename: d:\HeavenGate\src\LoadBalancer\UringEngine.h
+ * Path: d:\HeavenGate\src\LoadBalancer
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../common/Confparcer.h"
+#include "../common/RingBuffer.h"
+#include "../common/generic.h"
+#include "../DataBus/DataBus.h"
+#include "../Metrics/OpenMetrics.h"
+#include "BackendRegistry.h"
+#include "ListenerOptions.h"
+
+#if ISLINUX
+#include <sys/socket.h>
+#endif
+
+class LoadBalancer;
+struct Listener;
+
+// Linux io_uring engine for the proxy path, selected with IO_ENGINE=io_uring.
+//
+// One ring thread owns the listener and every connection it accepts:
+//  - a multishot accept on the listener,
+//  - a multishot recv per socket that picks buffers from a provided buffer
+//    ring registered with the kernel (or, where the ring does not work, from
+//    buffers handed over with PROVIDE_BUFFERS), so an idle connection holds
+//    no buffer,
+//  - sends of received buffers straight from that ring, queued sends to the
+//    same socket submitted as one IOSQE_IO_LINK chain.
+// Each submit/wait is a single io_uring_enter() for the whole batch instead of
+// a syscall and a wakeup per read.
+//
+// Routing, classification and bookkeeping are shared with the asio engine
+// through LoadBalancer; verdicts arrive on the bus worker and are handed to
+// the ring thread through an eventfd. Health checks stay on asio.
+class UringEngine {
+public:
+    static size_t ENTRIES() {
+        static size_t value = Confparcer::SETTING<size_t>("URING_ENTRIES", 4096);
+        return value;
+    }
+    // Provided receive buffers shared by all connections; rounded up to a power of two
+    static size_t BUFFERS() {
+        static size_t value = Confparcer::SETTING<size_t>("URING_BUFFERS", 4096);
+        return value;
+    }
+    static constexpr size_t BUFFER_SIZE = 8192;
+    // A direction with this many received chunks not yet sent stops receiving
+    // until half of them are sent, so one slow peer cannot drain the buffer ring
+    static constexpr size_t MAX_QUEUED_CHUNKS = 32;
+
+    // True when the kernel has every io_uring feature the engine uses
+    static bool supported();
+
+    // Serves one listener; each listener on this engine gets its own ring thread
+    UringEngine(LoadBalancer& balancer, Listener& listener);
+    ~UringEngine();
+
+    UringEngine(const UringEngine&) = delete;
+    UringEngine& operator=(const UringEngine&) = delete;
+
+    // Throws std::runtime_error if the ring or the listener cannot be set up.
+    // The multishot accept already drains the backlog, so accept_batch and
+    // shards do not apply: the single ring thread owns one listening socket.
+    void start(int port, const ListenerOptions& options);
+    // Closes the listener and every connection, then joins the ring thread
+    void stop();
+
+    // Writes each family once, with a sample per engine labelled by its listener
+    static void collect_metrics(metrics::OpenMetricsWriter& writer, const std::vector<const UringEngine*>& engines);
+
+private:
+    enum Operation : uint8_t {
+        OP_ACCEPT = 1,
+        OP_WAKE,
+        OP_RECV_CLIENT,
+        OP_RECV_BACKEND,
+        OP_SEND_CLIENT,
+        OP_SEND_BACKEND,
+        OP_CONNECT,
+        OP_CANCEL,
+        OP_PROVIDE,
+    };
+
+    // Received bytes waiting to be sent, still in provided buffer `buffer`
+    struct Chunk {
+        uint16_t buffer{0};
+        uint32_t offset{0};
+        uint32_t length{0};
+    };
+
+    // Bytes flowing in one direction: received on one socket, sent on the other
+    struct Direction {
+        RingBuffer<Chunk> queued;
+        // Sends submitted and not completed, always the oldest queued chunks
+        size_t in_flight{0};
+        bool receiving{false};
+        // The multishot recv stopped because the buffer ring ran dry
+        bool starved{false};
+        // The recv was cancelled for backpressure, see MAX_QUEUED_CHUNKS
+        bool paused{false};
+        // The sending side closed its half; nothing more will be received
+        bool eof{false};
+        // The EOF was passed on with shutdown(SHUT_WR) once the queue drained
+        bool shut{false};
+    };
+
+    enum class State { CLASSIFYING, CONNECTING, RELAYING, CLOSING };
+
+    struct Connection {
+        uint64_t client_id{0};
+        std::string client_ip;
+        int client_fd{-1};
+        int backend_fd{-1};
+        State state{State::CLASSIFYING};
+        BackendId backend{INVALID_BACKEND_ID};
+        CorrelationId classification_request{INVALID_CORRELATION_ID};
+#if ISLINUX
+        sockaddr_storage backend_address{};
+        socklen_t backend_address_size{0};
+#endif
+        Direction upstream;   // client -> backend
+        Direction downstream; // backend -> client
+        // SQEs submitted for this slot whose last CQE has not arrived
+        size_t operations{0};
+        bool first_response_seen{false};
+
+        std::chrono::steady_clock::time_point accepted_at;
+        std::chrono::steady_clock::time_point classification_sent_at;
+        std::chrono::steady_clock::time_point connect_started_at;
+        std::chrono::steady_clock::time_point backend_connected_at;
+    };
+
+    // Classifier reply handed from the bus worker to the ring thread
+    struct Verdict {
+        uint32_t slot;
+        uint64_t client_id;
+        RequestStatus status;
+        nlohmann::json payload;
+    };
+
+    struct Ring;
+
+    // False when the kernel takes a buffer ring but never selects from it
+    static bool buffer_ring_delivers();
+
+    LoadBalancer& balancer_;
+    Listener& listener_;
+    std::unique_ptr<Ring> ring_;
+    ListenerOptions options_;
+    int listen_fd_{-1};
+    int wake_fd_{-1};
+    uint64_t wake_value_{0};
+
+    // Slots are reused only once every operation on them has completed,
+    // so a slot index in user_data never refers to a newer connection
+    std::vector<std::unique_ptr<Connection>> connections_;
+    std::vector<uint32_t> free_slots_;
+    // (slot << 1 | from_backend) of recvs to re-arm once buffers are returned
+    std::vector<uint64_t> starved_;
+    // Provided buffers currently held by connections rather than the kernel
+    size_t buffers_out_{0};
+
+    std::mutex verdicts_mutex_;
+    std::vector<Verdict> verdicts_;
+    std::vector<Verdict> verdicts_batch_;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> enters_{0};
+    std::atomic<uint64_t> completions_{0};
+    std::atomic<uint64_t> starvations_{0};
+    std::atomic<uint64_t> bytes_relayed_{0};
+    std::atomic<size_t> live_connections_{0};
+
+    void run();
+    void handle_completion(uint64_t user_data, int result, uint32_t flags);
+
+    void arm_accept();
+    void arm_wake();
+    void arm_recv(uint32_t slot, bool from_backend);
+    void cancel(uint32_t slot, uint64_t target_user_data);
+    void cancel_fd(uint32_t slot, int fd);
+    void flush(uint32_t slot, bool to_backend);
+
+    void on_accept(int fd);
+    void on_recv(uint32_t slot, bool from_backend, int result, uint32_t flags);
+    void on_send(uint32_t slot, bool to_backend, int result);
+    void on_connect(uint32_t slot, int result);
+    void on_verdicts();
+
+    void connect_backend(uint32_t slot, BackendId backend);
+    void close_connection(uint32_t slot);
+    // Passes a drained EOF on to the other side, and closes once both halves are shut
+    void settle_eof(uint32_t slot);
+    // Drops one outstanding operation and frees the slot once a closing connection has none
+    void complete_operation(uint32_t slot);
+    void release_slot(uint32_t slot);
+    void recycle_buffer(uint16_t buffer);
+    void restart_starved();
+    void shutdown_connections();
+};
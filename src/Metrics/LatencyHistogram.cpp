@@ -0,0 +1,107 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\LatencyHistogram.cpp
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace metrics {
+
+uint64_t bucket_upper_bound(size_t index) {
+    if (index < kSubBucketCount) {
+        return index;
+    }
+    size_t offset = index - kSubBucketCount;
+    unsigned magnitude = static_cast<unsigned>(offset / kSubBucketHalf) + kSubBucketBits;
+    uint64_t sub_bucket = offset % kSubBucketHalf + kSubBucketHalf;
+    unsigned shift = magnitude - (kSubBucketBits - 1);
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+HistogramSnapshot::HistogramSnapshot() : counts_(kBucketCount, 0) {}
+
+double HistogramSnapshot::mean() const {
+    return count_ ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+}
+
+uint64_t HistogramSnapshot::value_at_percentile(double percentile) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    percentile = std::clamp(percentile, 0.0, 100.0);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(count_)));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        seen += counts_[i];
+        if (seen >= rank) {
+            return std::min(bucket_upper_bound(i), max_);
+        }
+    }
+    return max_;
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    for (size_t i = 0; i < counts_.size(); ++i) {
+        counts_[i] += other.counts_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+    max_ = std::max(max_, other.max_);
+}
+
+LatencySummary HistogramSnapshot::summary() const {
+    LatencySummary result;
+    result.count = count_;
+    result.p50_ns = value_at_percentile(50.0);
+    result.p99_ns = value_at_percentile(99.0);
+    result.p999_ns = value_at_percentile(99.9);
+    result.max_ns = max_;
+    result.mean_ns = mean();
+    return result;
+}
+
+LatencyHistogram::~LatencyHistogram() {
+    for (auto& slot : shards_) {
+        delete slot.load(std::memory_order_acquire);
+    }
+}
+
+LatencyHistogram::Shard& LatencyHistogram::allocate_shard(size_t index) {
+    Shard* fresh = new Shard();
+    Shard* expected = nullptr;
+    if (!shards_[index].compare_exchange_strong(expected, fresh,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+        // Another thread sharing this slot won the race
+        delete fresh;
+        return *expected;
+    }
+    return *fresh;
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot result;
+    for (const auto& slot : shards_) {
+        const Shard* shard = slot.load(std::memory_order_acquire);
+        if (!shard) continue;
+
+        for (size_t i = 0; i < kBucketCount; ++i) {
+            uint64_t n = shard->counts[i].load(std::memory_order_relaxed);
+            result.counts_[i] += n;
+            result.count_ += n;
+        }
+        result.sum_ += shard->sum.load(std::memory_order_relaxed);
+        result.max_ = std::max(result.max_, shard->max.load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+} // namespace metrics
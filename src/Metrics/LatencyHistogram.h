@@ -0,0 +1,126 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\LatencyHistogram.h
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "ThreadShard.h"
+
+// Log-linear (HDR-style) histogram of nanosecond latencies.
+// Every power-of-two range is split into 16 linear sub-buckets, which keeps the
+// relative error of any reported value under ~6% for values from 1ns up to ~2.4h.
+namespace metrics {
+
+constexpr unsigned kSubBucketBits = 5;
+constexpr uint64_t kSubBucketCount = uint64_t{1} << kSubBucketBits;
+constexpr uint64_t kSubBucketHalf = kSubBucketCount / 2;
+constexpr unsigned kMaxValueBits = 43;
+constexpr uint64_t kMaxTrackableValue = (uint64_t{1} << kMaxValueBits) - 1;
+constexpr size_t kBucketCount = kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketHalf;
+
+inline size_t bucket_index(uint64_t value) {
+    if (value < kSubBucketCount) {
+        return static_cast<size_t>(value);
+    }
+    if (value > kMaxTrackableValue) {
+        value = kMaxTrackableValue;
+    }
+    unsigned magnitude = 63 - static_cast<unsigned>(__builtin_clzll(value));
+    unsigned shift = magnitude - (kSubBucketBits - 1);
+    return static_cast<size_t>(kSubBucketCount + (magnitude - kSubBucketBits) * kSubBucketHalf +
+                               ((value >> shift) - kSubBucketHalf));
+}
+
+// Highest value that falls into the given bucket
+uint64_t bucket_upper_bound(size_t index);
+
+struct LatencySummary {
+    uint64_t count{0};
+    uint64_t p50_ns{0};
+    uint64_t p99_ns{0};
+    uint64_t p999_ns{0};
+    uint64_t max_ns{0};
+    double mean_ns{0.0};
+};
+
+class HistogramSnapshot {
+public:
+    HistogramSnapshot();
+
+    uint64_t count() const { return count_; }
+    uint64_t sum() const { return sum_; }
+    uint64_t max() const { return max_; }
+    double mean() const;
+    uint64_t value_at_percentile(double percentile) const;
+    const std::vector<uint64_t>& buckets() const { return counts_; }
+
+    void merge(const HistogramSnapshot& other);
+    LatencySummary summary() const;
+
+private:
+    friend class LatencyHistogram;
+
+    std::vector<uint64_t> counts_;
+    uint64_t count_{0};
+    uint64_t sum_{0};
+    uint64_t max_{0};
+};
+
+// Lock-free recorder. Each thread writes into its own lazily allocated shard, so the
+// hot path is a few relaxed atomic adds on a cache line nobody else touches; shards
+// are only merged when somebody reads the histogram.
+class LatencyHistogram {
+public:
+    LatencyHistogram() = default;
+    ~LatencyHistogram();
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t value_ns) {
+        Shard& shard = local_shard();
+        shard.counts[bucket_index(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        shard.sum.fetch_add(value_ns, std::memory_order_relaxed);
+        uint64_t current = shard.max.load(std::memory_order_relaxed);
+        while (value_ns > current &&
+               !shard.max.compare_exchange_weak(current, value_ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    template<typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> elapsed) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        record(ns > 0 ? static_cast<uint64_t>(ns) : 0);
+    }
+
+    HistogramSnapshot snapshot() const;
+    LatencySummary summary() const { return snapshot().summary(); }
+
+private:
+    struct alignas(kCacheLineSize) Shard {
+        std::array<std::atomic<uint64_t>, kBucketCount> counts{};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> max{0};
+    };
+
+    Shard& local_shard() {
+        size_t index = thread_shard_index();
+        Shard* shard = shards_[index].load(std::memory_order_acquire);
+        return shard ? *shard : allocate_shard(index);
+    }
+
+    Shard& allocate_shard(size_t index);
+
+    std::array<std::atomic<Shard*>, kMaxShards> shards_{};
+};
+
+} // namespace metrics
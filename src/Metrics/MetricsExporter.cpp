@@ -0,0 +1,147 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\MetricsExporter.cpp
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "MetricsExporter.h"
+#include "../common/logger.h"
+#include <algorithm>
+#include <istream>
+
+namespace {
+
+constexpr const char* kContentType = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+constexpr size_t kMaxRequestSize = 8192;
+
+std::string http_response(const std::string& status, const std::string& content_type, const std::string& body) {
+    return "HTTP/1.1 " + status + "\r\n"
+           "Content-Type: " + content_type + "\r\n"
+           "Content-Length: " + std::to_string(body.size()) + "\r\n"
+           "Connection: close\r\n\r\n" + body;
+}
+
+} // namespace
+
+MetricsExporter& MetricsExporter::the() {
+    static MetricsExporter instance;
+    return instance;
+}
+
+MetricsExporter::MetricsExporter()
+    : collectors_(std::make_shared<const CollectorList>()), acceptor_(io_context_) {}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::add_collector(const std::string& name, Collector collector) {
+    std::lock_guard<std::mutex> lock(collectors_write_mutex_);
+    auto updated = std::make_shared<CollectorList>(*std::atomic_load(&collectors_));
+    updated->emplace_back(name, std::move(collector));
+    std::atomic_store(&collectors_, std::shared_ptr<const CollectorList>(std::move(updated)));
+}
+
+void MetricsExporter::remove_collector(const std::string& name) {
+    std::lock_guard<std::mutex> lock(collectors_write_mutex_);
+    auto updated = std::make_shared<CollectorList>(*std::atomic_load(&collectors_));
+    updated->erase(std::remove_if(updated->begin(), updated->end(),
+                                  [&](const auto& entry) { return entry.first == name; }),
+                   updated->end());
+    std::atomic_store(&collectors_, std::shared_ptr<const CollectorList>(std::move(updated)));
+}
+
+std::string MetricsExporter::render() const {
+    auto collectors = std::atomic_load(&collectors_);
+
+    metrics::OpenMetricsWriter writer;
+    for (const auto& [name, collector] : *collectors) {
+        try {
+            collector(writer);
+        } catch (const std::exception& e) {
+            LOG_WARN("Metrics collector " + name + " failed: " + e.what());
+        }
+    }
+    return writer.finish();
+}
+
+void MetricsExporter::start(int port) {
+    if (running_.exchange(true)) return;
+
+    try {
+        asio::ip::tcp::endpoint endpoint(asio::ip::tcp::v4(), port);
+        acceptor_.open(endpoint.protocol());
+        acceptor_.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+        acceptor_.bind(endpoint);
+        acceptor_.listen();
+
+        LOG_INFO("Metrics exporter started on port " + std::to_string(port));
+
+        server_thread_ = std::thread([this]() {
+            start_accept();
+            io_context_.run();
+        });
+    } catch (const std::exception& e) {
+        LOG_ERROR("Failed to start metrics exporter: " + std::string(e.what()));
+        running_ = false;
+    }
+}
+
+void MetricsExporter::stop() {
+    if (!running_.exchange(false)) return;
+
+    io_context_.stop();
+    if (server_thread_.joinable()) {
+        server_thread_.join();
+    }
+
+    LOG_INFO("Metrics exporter stopped");
+}
+
+void MetricsExporter::start_accept() {
+    auto socket = std::make_shared<asio::ip::tcp::socket>(io_context_);
+
+    acceptor_.async_accept(*socket, [this, socket](const asio::error_code& error) {
+        if (!error) {
+            serve(socket);
+        } else if (error != asio::error::operation_aborted) {
+            LOG_WARN("Metrics accept error: " + error.message());
+        }
+
+        if (running_.load()) {
+            start_accept();
+        }
+    });
+}
+
+void MetricsExporter::serve(std::shared_ptr<asio::ip::tcp::socket> socket) {
+    auto request = std::make_shared<asio::streambuf>(kMaxRequestSize);
+
+    asio::async_read_until(*socket, *request, "\r\n\r\n",
+        [this, socket, request](const asio::error_code& error, size_t /*bytes_read*/) {
+            if (error) return;
+
+            std::istream stream(request.get());
+            std::string method, target;
+            stream >> method >> target;
+
+            auto response = std::make_shared<std::string>();
+            if (method != "GET") {
+                *response = http_response("405 Method Not Allowed", "text/plain", "Method not allowed\n");
+            } else if (target == "/metrics") {
+                *response = http_response("200 OK", kContentType, render());
+            } else {
+                *response = http_response("404 Not Found", "text/plain", "Not found\n");
+            }
+
+            asio::async_write(*socket, asio::buffer(*response),
+                [socket, response](const asio::error_code& /*error*/, size_t /*bytes_written*/) {
+                    asio::error_code ec;
+                    socket->shutdown(asio::ip::tcp::socket::shutdown_both, ec);
+                    socket->close(ec);
+                });
+        });
+}
@@ -0,0 +1,65 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\MetricsExporter.h
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "../../thirdparty/asio/include/asio.hpp"
+#include "OpenMetrics.h"
+#include "../common/Confparcer.h"
+
+// Embedded HTTP endpoint serving GET /metrics in the OpenMetrics text format.
+// Runs its own io_context on a dedicated thread. Collectors must only read
+// atomics and copy-on-write snapshots, so a scrape never takes a lock that the
+// routing path also takes.
+class MetricsExporter {
+public:
+    using Collector = std::function<void(metrics::OpenMetricsWriter&)>;
+
+    static int PORT() {
+        static int value = Confparcer::SETTING<int>("METRICS_PORT", 9464);
+        return value;
+    }
+
+    static MetricsExporter& the();
+
+    void add_collector(const std::string& name, Collector collector);
+    void remove_collector(const std::string& name);
+
+    void start(int port = PORT());
+    void stop();
+
+    std::string render() const;
+
+private:
+    using CollectorList = std::vector<std::pair<std::string, Collector>>;
+
+    MetricsExporter();
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void start_accept();
+    void serve(std::shared_ptr<asio::ip::tcp::socket> socket);
+
+    std::shared_ptr<const CollectorList> collectors_;
+    std::mutex collectors_write_mutex_;
+
+    std::atomic<bool> running_{false};
+    asio::io_context io_context_;
+    asio::ip::tcp::acceptor acceptor_;
+    std::thread server_thread_;
+};
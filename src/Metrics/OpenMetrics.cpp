@@ -0,0 +1,137 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\OpenMetrics.cpp
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "OpenMetrics.h"
+#include <array>
+#include <cmath>
+#include <cstdio>
+
+namespace metrics {
+
+namespace {
+
+// Bucket bounds of exported histograms, in nanoseconds
+constexpr std::array<uint64_t, 14> kHistogramBounds = {
+    1000, 5000, 10000, 50000, 100000, 500000,
+    1000000, 5000000, 10000000, 50000000, 100000000, 500000000,
+    1000000000, 5000000000
+};
+
+std::string escape_label(const std::string& value) {
+    std::string result;
+    result.reserve(value.size());
+    for (char c : value) {
+        switch (c) {
+            case '\\': result += "\\\\"; break;
+            case '"': result += "\\\""; break;
+            case '\n': result += "\\n"; break;
+            default: result += c;
+        }
+    }
+    return result;
+}
+
+std::string format_double(double value) {
+    if (std::isnan(value)) return "NaN";
+    if (std::isinf(value)) return value > 0 ? "+Inf" : "-Inf";
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    return buffer;
+}
+
+std::string ns_to_seconds(uint64_t ns) {
+    return format_double(static_cast<double>(ns) / 1e9);
+}
+
+const char* type_name(MetricType type) {
+    switch (type) {
+        case MetricType::COUNTER: return "counter";
+        case MetricType::GAUGE: return "gauge";
+        case MetricType::HISTOGRAM: return "histogram";
+        case MetricType::SUMMARY: return "summary";
+    }
+    return "unknown";
+}
+
+Labels with_label(const Labels& labels, const std::string& key, const std::string& value) {
+    Labels result = labels;
+    result.emplace_back(key, value);
+    return result;
+}
+
+} // namespace
+
+void OpenMetricsWriter::family(const std::string& name, MetricType type, const std::string& help) {
+    if (name == current_family_) return;
+    current_family_ = name;
+    out_ += "# TYPE " + name + " " + type_name(type) + "\n";
+    out_ += "# HELP " + name + " " + help + "\n";
+}
+
+void OpenMetricsWriter::sample(const std::string& name, const Labels& labels, const std::string& value) {
+    out_ += name;
+    if (!labels.empty()) {
+        out_ += '{';
+        for (size_t i = 0; i < labels.size(); ++i) {
+            if (i) out_ += ',';
+            out_ += labels[i].first + "=\"" + escape_label(labels[i].second) + "\"";
+        }
+        out_ += '}';
+    }
+    out_ += ' ';
+    out_ += value;
+    out_ += '\n';
+}
+
+void OpenMetricsWriter::counter(const std::string& name, uint64_t value, const Labels& labels) {
+    sample(name + "_total", labels, std::to_string(value));
+}
+
+void OpenMetricsWriter::float_counter(const std::string& name, double value, const Labels& labels) {
+    sample(name + "_total", labels, format_double(value));
+}
+
+void OpenMetricsWriter::gauge(const std::string& name, double value, const Labels& labels) {
+    sample(name, labels, format_double(value));
+}
+
+void OpenMetricsWriter::histogram(const std::string& name, const HistogramSnapshot& snapshot, const Labels& labels) {
+    const auto& buckets = snapshot.buckets();
+    uint64_t cumulative = 0;
+    size_t index = 0;
+
+    for (uint64_t bound : kHistogramBounds) {
+        while (index < buckets.size() && bucket_upper_bound(index) <= bound) {
+            cumulative += buckets[index++];
+        }
+        sample(name + "_bucket", with_label(labels, "le", ns_to_seconds(bound)), std::to_string(cumulative));
+    }
+    sample(name + "_bucket", with_label(labels, "le", "+Inf"), std::to_string(snapshot.count()));
+    sample(name + "_count", labels, std::to_string(snapshot.count()));
+    sample(name + "_sum", labels, ns_to_seconds(snapshot.sum()));
+}
+
+void OpenMetricsWriter::summary(const std::string& name, const HistogramSnapshot& snapshot, const Labels& labels) {
+    if (snapshot.count() > 0) {
+        for (double quantile : {0.5, 0.99, 0.999}) {
+            sample(name, with_label(labels, "quantile", format_double(quantile)),
+                   ns_to_seconds(snapshot.value_at_percentile(quantile * 100.0)));
+        }
+    }
+    sample(name + "_count", labels, std::to_string(snapshot.count()));
+    sample(name + "_sum", labels, ns_to_seconds(snapshot.sum()));
+}
+
+std::string OpenMetricsWriter::finish() {
+    out_ += "# EOF\n";
+    current_family_.clear();
+    return std::move(out_);
+}
+
+} // namespace metrics
@@ -0,0 +1,51 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\OpenMetrics.h
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "LatencyHistogram.h"
+
+namespace metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+enum class MetricType {
+    COUNTER,
+    GAUGE,
+    HISTOGRAM,
+    SUMMARY
+};
+
+// Builds an OpenMetrics text exposition. Samples of one family must be written
+// back to back: the family header is emitted when the family name changes.
+class OpenMetricsWriter {
+public:
+    void family(const std::string& name, MetricType type, const std::string& help);
+
+    void counter(const std::string& name, uint64_t value, const Labels& labels = {});
+    void float_counter(const std::string& name, double value, const Labels& labels = {});
+    void gauge(const std::string& name, double value, const Labels& labels = {});
+    // Latency histograms are recorded in nanoseconds and exported in seconds
+    void histogram(const std::string& name, const HistogramSnapshot& snapshot, const Labels& labels = {});
+    void summary(const std::string& name, const HistogramSnapshot& snapshot, const Labels& labels = {});
+
+    // Terminates the exposition and returns it
+    std::string finish();
+
+private:
+    void sample(const std::string& name, const Labels& labels, const std::string& value);
+
+    std::string out_;
+    std::string current_family_;
+};
+
+} // namespace metrics
@@ -0,0 +1,49 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\ShardedCounter.h
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include "ThreadShard.h"
+
+namespace metrics {
+
+// Monotonic counter split into per-thread cells, one cache line each.
+// Increments are relaxed adds on the caller's own cell, so handler threads never
+// bounce a shared line; the cells are summed only when the value is read.
+class ShardedCounter {
+public:
+    ShardedCounter() = default;
+    ShardedCounter(const ShardedCounter&) = delete;
+    ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+    void add(uint64_t n) {
+        cells_[thread_shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void increment() { add(1); }
+
+    uint64_t value() const {
+        uint64_t total = 0;
+        for (const auto& cell : cells_) {
+            total += cell.value.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+private:
+    struct alignas(kCacheLineSize) Cell {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::array<Cell, kMaxShards> cells_{};
+};
+
+} // namespace metrics
@@ -0,0 +1,31 @@
+/*
+ * Filename: d:\HeavenGate\src\Metrics\ThreadShard.h
+ * Path: d:\HeavenGate\src\Metrics
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace metrics {
+
+// Cache line size used to pad hot counters
+constexpr size_t kCacheLineSize = 64;
+
+// Upper bound on shards per metric. With more threads than shards several threads
+// share a shard, which stays correct (shards are atomic) but may contend.
+constexpr size_t kMaxShards = 64;
+
+// Shard slot of the calling thread, assigned on first use
+inline size_t thread_shard_index() {
+    static std::atomic<size_t> next_index{0};
+    thread_local size_t index = next_index.fetch_add(1, std::memory_order_relaxed) % kMaxShards;
+    return index;
+}
+
+} // namespace metrics
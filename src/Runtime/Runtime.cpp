@@ -0,0 +1,306 @@
+/*
+ * Filename: d:\HeavenGate\src\Runtime\Runtime.cpp
+ * Path: d:\HeavenGate\src\Runtime
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "Runtime.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "../common/generic.h"
+#include "../common/logger.h"
+
+#if ISLINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+thread_local void* current_runtime = nullptr;
+thread_local size_t current_worker = 0;
+
+// Parses a sysfs CPU list such as "0-3,8,10-11"
+std::vector<int> parse_cpu_list(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+        }
+    }
+    return cpus;
+}
+
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#if ISLINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+        }
+    }
+#endif
+    if (cpus.empty()) {
+        for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+            cpus.push_back(static_cast<int>(cpu));
+        }
+    }
+    return cpus;
+}
+
+// Allowed CPUs grouped by NUMA node; a single group when sysfs has no topology
+std::vector<std::vector<int>> numa_nodes(const std::vector<int>& allowed) {
+    std::vector<std::vector<int>> nodes;
+    std::error_code error;
+    std::vector<std::pair<int, std::filesystem::path>> found;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4) continue;
+        try {
+            found.emplace_back(std::stoi(name.substr(4)), entry.path());
+        } catch (const std::exception&) {
+        }
+    }
+    std::sort(found.begin(), found.end());
+
+    for (const auto& [id, path] : found) {
+        std::ifstream file(path / "cpulist");
+        std::string list;
+        std::getline(file, list);
+        std::vector<int> cpus;
+        for (int cpu : parse_cpu_list(list)) {
+            if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end()) cpus.push_back(cpu);
+        }
+        if (!cpus.empty()) nodes.push_back(std::move(cpus));
+    }
+    if (nodes.empty()) nodes.push_back(allowed);
+    return nodes;
+}
+
+} // namespace
+
+Runtime& Runtime::the() {
+    static Runtime instance;
+    return instance;
+}
+
+Runtime::~Runtime() {
+    stop();
+}
+
+void Runtime::place_workers(size_t count) {
+    auto cpus = allowed_cpus();
+    auto nodes = NUMA_AWARE() ? numa_nodes(cpus) : std::vector<std::vector<int>>{cpus};
+
+    for (size_t i = 0; i < count; ++i) {
+        auto worker = std::make_unique<Worker>();
+        worker->index = i;
+        // Round-robin over nodes so every node's memory bandwidth is used
+        worker->node = static_cast<int>(i % nodes.size());
+        const auto& node_cpus = nodes[worker->node];
+        if (PIN_THREADS()) {
+            worker->cpu = node_cpus[(i / nodes.size()) % node_cpus.size()];
+        }
+        workers_.push_back(std::move(worker));
+    }
+
+    for (auto& worker : workers_) {
+        for (size_t offset = 1; offset < count; ++offset) {
+            size_t victim = (worker->index + offset) % count;
+            if (workers_[victim]->node == worker->node) worker->victims.push_back(victim);
+        }
+        for (size_t offset = 1; offset < count; ++offset) {
+            size_t victim = (worker->index + offset) % count;
+            if (workers_[victim]->node != worker->node) worker->victims.push_back(victim);
+        }
+    }
+}
+
+void Runtime::start() {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    if (running_.load()) return;
+
+    if (workers_.empty()) {
+        size_t count = THREADS() != 0 ? THREADS() : allowed_cpus().size();
+        place_workers(std::max<size_t>(count, 1));
+    }
+    io_context_.restart();
+    work_guard_.emplace(io_context_.get_executor());
+
+    {
+        std::lock_guard<std::mutex> lock(early_mutex_);
+        running_ = true;
+        for (auto& task : early_tasks_) {
+            push(*workers_[next_worker_++ % workers_.size()], std::move(task));
+        }
+        early_tasks_.clear();
+    }
+
+    for (auto& worker : workers_) {
+        worker->thread = std::thread([this, raw = worker.get()]() { run(*raw); });
+#if ISLINUX
+        if (worker->cpu >= 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(worker->cpu, &set);
+            if (pthread_setaffinity_np(worker->thread.native_handle(), sizeof(set), &set) != 0) {
+                LOG_WARN("Cannot pin runtime worker " + std::to_string(worker->index) +
+                         " to CPU " + std::to_string(worker->cpu));
+            }
+        }
+#endif
+    }
+    LOG_INFO("Runtime started with " + std::to_string(workers_.size()) + " workers");
+}
+
+void Runtime::stop() {
+    std::lock_guard<std::mutex> lifecycle(lifecycle_mutex_);
+    {
+        std::lock_guard<std::mutex> lock(early_mutex_);
+        if (!running_.exchange(false)) return;
+    }
+
+    work_guard_.reset();
+    io_context_.stop();
+    for (auto& worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+        std::lock_guard<std::mutex> lock(worker->mutex);
+        worker->tasks.clear();
+    }
+    pending_ = 0;
+    LOG_INFO("Runtime stopped");
+}
+
+void Runtime::post(Task task) {
+    if (!running_.load()) {
+        std::lock_guard<std::mutex> lock(early_mutex_);
+        if (!running_.load()) {
+            early_tasks_.push_back(std::move(task));
+            return;
+        }
+    }
+
+    // Work spawned on a worker stays local and warm in its cache, unless stolen
+    size_t index = current_runtime == this ? current_worker : next_worker_++ % workers_.size();
+    push(*workers_[index], std::move(task));
+}
+
+void Runtime::push(Worker& worker, Task task) {
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+    }
+    // Pairs with the parked_/pending_ check in run(): one side always sees the other
+    pending_.fetch_add(1);
+    if (parked_.load() != 0) {
+        asio::post(io_context_, []() {});
+    }
+}
+
+Runtime::Executor Runtime::executor() {
+    return [this](Task task) {
+        post(std::move(task));
+    };
+}
+
+bool Runtime::take(Worker& worker, Task& task) {
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (!worker.tasks.empty()) {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+            pending_.fetch_sub(1);
+            return true;
+        }
+    }
+
+    for (size_t victim_index : worker.victims) {
+        Worker& victim = *workers_[victim_index];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.tasks.empty()) continue;
+
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        pending_.fetch_sub(1);
+        worker.stolen++;
+        return true;
+    }
+    return false;
+}
+
+void Runtime::run(Worker& worker) {
+    current_runtime = this;
+    current_worker = worker.index;
+
+    Task task;
+    uint64_t ticks = 0;
+    while (running_.load()) {
+        bool worked = false;
+        if (take(worker, task)) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                LOG_ERROR("Runtime task failed: " + std::string(e.what()));
+            }
+            task = nullptr;
+            worker.executed++;
+            worked = true;
+        }
+
+        // Ready io completions get a turn even while tasks keep coming
+        if (!worked || (++ticks & 31) == 0) {
+            if (io_context_.poll_one() != 0) worked = true;
+        }
+        if (worked) continue;
+
+        parked_.fetch_add(1);
+        if (pending_.load() == 0 && running_.load()) {
+            worker.parked++;
+            io_context_.run_one();
+        }
+        parked_.fetch_sub(1);
+    }
+
+    current_runtime = nullptr;
+}
+
+void Runtime::collect_metrics(metrics::OpenMetricsWriter& writer) const {
+    using metrics::MetricType;
+    auto labels = [](const Worker& worker) {
+        return metrics::Labels{{"worker", std::to_string(worker.index)}};
+    };
+    writer.family("heavengate_runtime_tasks_executed", MetricType::COUNTER, "Tasks run per runtime worker");
+    for (const auto& worker : workers_) {
+        writer.counter("heavengate_runtime_tasks_executed", worker->executed.load(), labels(*worker));
+    }
+    writer.family("heavengate_runtime_tasks_stolen", MetricType::COUNTER, "Tasks taken from another worker's queue");
+    for (const auto& worker : workers_) {
+        writer.counter("heavengate_runtime_tasks_stolen", worker->stolen.load(), labels(*worker));
+    }
+    writer.family("heavengate_runtime_parks", MetricType::COUNTER, "Times a worker went idle");
+    for (const auto& worker : workers_) {
+        writer.counter("heavengate_runtime_parks", worker->parked.load(), labels(*worker));
+    }
+    writer.family("heavengate_runtime_pending_tasks", MetricType::GAUGE, "Tasks queued and not yet started");
+    writer.gauge("heavengate_runtime_pending_tasks", static_cast<double>(pending_.load()));
+}
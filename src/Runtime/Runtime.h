@@ -0,0 +1,109 @@
+/*
+ * Filename: d:\HeavenGate\src\Runtime\Runtime.h
+ * Path: d:\HeavenGate\src\Runtime
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "../../thirdparty/asio/include/asio.hpp"
+#include "../common/Confparcer.h"
+#include "../Metrics/OpenMetrics.h"
+
+// Process-wide worker pool shared by every subsystem.
+//
+// Each worker owns a task deque: it pops its own work LIFO and, when empty,
+// steals FIFO from the others (same NUMA node first). The same workers also run
+// the shared io_context, so socket completions and posted tasks are balanced
+// over one set of threads. An idle worker parks inside io_context::run_one(),
+// and post() wakes it with an empty handler, so there is a single wake path.
+//
+// Handlers on the shared io_context may run on any worker concurrently: state
+// shared between completions must be serialized with a strand.
+class Runtime {
+public:
+    using Task = std::function<void()>;
+    using Executor = std::function<void(Task)>;
+
+    // 0 sizes the pool to the CPUs this process may run on
+    static size_t THREADS() {
+        static size_t value = Confparcer::SETTING<size_t>("RUNTIME_THREADS", 0);
+        return value;
+    }
+    static bool PIN_THREADS() {
+        static bool value = Confparcer::SETTING<bool>("RUNTIME_PIN_THREADS", false);
+        return value;
+    }
+    // Spreads pinned workers over NUMA nodes and steals within a node first
+    static bool NUMA_AWARE() {
+        static bool value = Confparcer::SETTING<bool>("RUNTIME_NUMA", false);
+        return value;
+    }
+
+    static Runtime& the();
+
+    void start();
+    // Joins the workers; queued tasks and pending io handlers are dropped
+    void stop();
+    bool running() const { return running_.load(); }
+
+    void post(Task task);
+    Executor executor();
+    asio::io_context& io_context() { return io_context_; }
+    size_t size() const { return workers_.size(); }
+
+    void collect_metrics(metrics::OpenMetricsWriter& writer) const;
+
+private:
+    Runtime() = default;
+    ~Runtime();
+
+    Runtime(const Runtime&) = delete;
+    Runtime& operator=(const Runtime&) = delete;
+
+    struct Worker {
+        size_t index{0};
+        int cpu{-1};  // -1 when not pinned
+        int node{0};
+        std::mutex mutex;
+        std::deque<Task> tasks;
+        // Victims in steal order, same node first
+        std::vector<size_t> victims;
+        std::thread thread;
+
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> parked{0};
+    };
+
+    asio::io_context io_context_;
+    std::optional<asio::executor_work_guard<asio::io_context::executor_type>> work_guard_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    // Tasks queued but not yet taken, and workers parked in run_one()
+    std::atomic<size_t> pending_{0};
+    std::atomic<size_t> parked_{0};
+    std::atomic<size_t> next_worker_{0};
+    std::atomic<bool> running_{false};
+    std::mutex lifecycle_mutex_;
+
+    // Tasks posted before start(), handed to the workers when they exist
+    std::mutex early_mutex_;
+    std::vector<Task> early_tasks_;
+
+    void place_workers(size_t count);
+    void run(Worker& worker);
+    bool take(Worker& worker, Task& task);
+    void push(Worker& worker, Task task);
+};
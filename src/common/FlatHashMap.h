@@ -0,0 +1,123 @@
+/*
+ * Filename: d:\HeavenGate\src\common\FlatHashMap.h
+ * Path: d:\HeavenGate\src\common
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Open-addressing hash map for non-zero 64-bit keys (0 marks an empty slot).
+// Linear probing with backward-shift deletion, so there are no tombstones and
+// lookups stay short under constant insert/erase churn. Not thread-safe.
+template<typename Value>
+class FlatHashMap {
+public:
+    explicit FlatHashMap(size_t initial_capacity = 64) {
+        size_t capacity = 16;
+        while (capacity < initial_capacity) capacity <<= 1;
+        slots_.resize(capacity);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    Value* find(uint64_t key) {
+        size_t index = slot_for(key);
+        while (slots_[index].key != 0) {
+            if (slots_[index].key == key) return &slots_[index].value;
+            index = (index + 1) & mask();
+        }
+        return nullptr;
+    }
+
+    // Returns false if the key is already present
+    bool insert(uint64_t key, Value value) {
+        if ((size_ + 1) * 2 > slots_.size()) {
+            grow();
+        }
+        size_t index = slot_for(key);
+        while (slots_[index].key != 0) {
+            if (slots_[index].key == key) return false;
+            index = (index + 1) & mask();
+        }
+        slots_[index].key = key;
+        slots_[index].value = std::move(value);
+        ++size_;
+        return true;
+    }
+
+    // Moves the value out into `out` and removes the key
+    bool take(uint64_t key, Value& out) {
+        size_t index = slot_for(key);
+        while (slots_[index].key != key) {
+            if (slots_[index].key == 0) return false;
+            index = (index + 1) & mask();
+        }
+        out = std::move(slots_[index].value);
+        erase_at(index);
+        return true;
+    }
+
+    template<typename Fn>
+    void for_each(Fn&& fn) {
+        for (auto& slot : slots_) {
+            if (slot.key != 0) fn(slot.key, slot.value);
+        }
+    }
+
+    void clear() {
+        for (auto& slot : slots_) {
+            slot = Slot{};
+        }
+        size_ = 0;
+    }
+
+private:
+    struct Slot {
+        uint64_t key{0};
+        Value value{};
+    };
+
+    size_t mask() const { return slots_.size() - 1; }
+
+    size_t slot_for(uint64_t key) const {
+        // Fibonacci hashing spreads sequential ids across the table
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> 32) & mask();
+    }
+
+    void erase_at(size_t index) {
+        size_t hole = index;
+        size_t next = (hole + 1) & mask();
+        while (slots_[next].key != 0) {
+            size_t home = slot_for(slots_[next].key);
+            // Shift back entries whose probe sequence passes through the hole
+            if (((next - home) & mask()) >= ((next - hole) & mask())) {
+                slots_[hole] = std::move(slots_[next]);
+                hole = next;
+            }
+            next = (next + 1) & mask();
+        }
+        slots_[hole] = Slot{};
+        --size_;
+    }
+
+    void grow() {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.clear();
+        slots_.resize(old.size() * 2);
+        size_ = 0;
+        for (auto& slot : old) {
+            if (slot.key != 0) insert(slot.key, std::move(slot.value));
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t size_{0};
+};
@@ -0,0 +1,145 @@
+/*
+ * Filename: d:\HeavenGate\src\common\HandlerArena.h
+ * Path: d:\HeavenGate\src\common
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Fixed slab of handler-sized blocks owned by one connection. asio allocates
+// every operation through the handler's associated allocator, so wrapping the
+// completion handlers with bind_arena() keeps an idle-to-busy connection off
+// the global heap entirely; the slab goes away with the connection.
+//
+// Blocks are claimed with a CAS on an occupancy mask: asio frees operation
+// memory on whichever io thread completed it, not on the connection's strand.
+// Requests that are too large or find the slab full fall back to the heap and
+// are counted in heap_fallbacks().
+class HandlerArena {
+public:
+    static constexpr size_t SLOTS = 8;
+    static constexpr size_t SLOT_SIZE = 512;
+
+    HandlerArena() = default;
+    HandlerArena(const HandlerArena&) = delete;
+    HandlerArena& operator=(const HandlerArena&) = delete;
+
+    void* allocate(size_t size) {
+        if (size <= SLOT_SIZE) {
+            uint32_t used = used_.load(std::memory_order_relaxed);
+            while (used != FULL) {
+                uint32_t slot = lowest_free(used);
+                if (used_.compare_exchange_weak(used, used | (1u << slot), std::memory_order_acquire)) {
+                    return slots_[slot].bytes;
+                }
+            }
+        }
+        heap_fallbacks().fetch_add(1, std::memory_order_relaxed);
+        return ::operator new(size);
+    }
+
+    void deallocate(void* pointer) {
+        auto* block = static_cast<unsigned char*>(pointer);
+        auto* first = slots_[0].bytes;
+        if (block >= first && block < first + sizeof(slots_)) {
+            uint32_t slot = static_cast<uint32_t>((block - first) / sizeof(Slot));
+            used_.fetch_and(~(1u << slot), std::memory_order_release);
+            return;
+        }
+        ::operator delete(pointer);
+    }
+
+    // Process-wide count of allocations the slabs could not serve
+    static std::atomic<uint64_t>& heap_fallbacks() {
+        static std::atomic<uint64_t> count{0};
+        return count;
+    }
+
+private:
+    static_assert(SLOTS <= 32, "occupancy mask is 32 bits");
+    static constexpr uint32_t FULL = SLOTS == 32 ? ~0u : (1u << SLOTS) - 1;
+
+    static uint32_t lowest_free(uint32_t used) {
+        uint32_t slot = 0;
+        while (used & (1u << slot)) {
+            ++slot;
+        }
+        return slot;
+    }
+
+    struct alignas(std::max_align_t) Slot {
+        unsigned char bytes[SLOT_SIZE];
+    };
+
+    Slot slots_[SLOTS];
+    std::atomic<uint32_t> used_{0};
+};
+
+// Standard allocator over a HandlerArena, exposed to asio as a handler's
+// associated allocator
+template<typename T>
+class HandlerAllocator {
+public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerArena& arena) noexcept : arena_(&arena) {}
+
+    template<typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : arena_(other.arena_) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(arena_->allocate(sizeof(T) * count));
+    }
+
+    void deallocate(T* pointer, size_t /*count*/) {
+        arena_->deallocate(pointer);
+    }
+
+    template<typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept { return arena_ == other.arena_; }
+    template<typename U>
+    bool operator!=(const HandlerAllocator<U>& other) const noexcept { return arena_ != other.arena_; }
+
+private:
+    template<typename> friend class HandlerAllocator;
+    HandlerArena* arena_;
+};
+
+// Completion handler whose operation memory comes from a HandlerArena. The
+// arena must outlive the operation, which holds when the handler keeps its
+// owner alive (e.g. captures the connection's shared_ptr).
+template<typename Handler>
+class ArenaHandler {
+public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    ArenaHandler(HandlerArena& arena, Handler handler)
+        : arena_(arena), handler_(std::move(handler)) {}
+
+    allocator_type get_allocator() const noexcept {
+        return allocator_type(arena_);
+    }
+
+    template<typename... Args>
+    void operator()(Args&&... args) {
+        handler_(std::forward<Args>(args)...);
+    }
+
+private:
+    HandlerArena& arena_;
+    Handler handler_;
+};
+
+template<typename Handler>
+ArenaHandler<std::decay_t<Handler>> bind_arena(HandlerArena& arena, Handler&& handler) {
+    return ArenaHandler<std::decay_t<Handler>>(arena, std::forward<Handler>(handler));
+}
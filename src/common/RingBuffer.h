@@ -0,0 +1,65 @@
+/*
+ * Filename: d:\HeavenGate\src\common\RingBuffer.h
+ * Path: d:\HeavenGate\src\common
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Growable FIFO on a power-of-two circular array. Unlike std::deque it never
+// frees or allocates once it has reached its working size, so a queue that is
+// drained and refilled all day stays allocation-free. Not thread-safe.
+template<typename T>
+class RingBuffer {
+public:
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void push_back(T value) {
+        if (size_ == slots_.size()) {
+            grow();
+        }
+        slots_[(head_ + size_) & (slots_.size() - 1)] = std::move(value);
+        ++size_;
+    }
+
+    // Moves the oldest element into `out`, the slot is reset to T{}
+    bool pop_front(T& out) {
+        if (size_ == 0) return false;
+        out = std::move(slots_[head_]);
+        slots_[head_] = T{};
+        head_ = (head_ + 1) & (slots_.size() - 1);
+        --size_;
+        return true;
+    }
+
+    // Element `index` positions after the oldest one
+    T& operator[](size_t index) { return slots_[(head_ + index) & (slots_.size() - 1)]; }
+    const T& operator[](size_t index) const { return slots_[(head_ + index) & (slots_.size() - 1)]; }
+
+    void clear() {
+        T discarded;
+        while (pop_front(discarded)) {
+        }
+    }
+
+private:
+    void grow() {
+        std::vector<T> grown(slots_.empty() ? 16 : slots_.size() * 2);
+        for (size_t i = 0; i < size_; ++i) {
+            grown[i] = std::move((*this)[i]);
+        }
+        slots_ = std::move(grown);
+        head_ = 0;
+    }
+
+    std::vector<T> slots_;
+    size_t head_{0};
+    size_t size_{0};
+};
@@ -0,0 +1,150 @@
+/*
+ * Filename: d:\HeavenGate\src\common\Scheduler.cpp
+ * Path: d:\HeavenGate\src\common
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#include "Scheduler.h"
+#include "logger.h"
+
+Scheduler& Scheduler::the() {
+    static Scheduler instance;
+    return instance;
+}
+
+Scheduler::Scheduler()
+    : random_(std::random_device{}()) {
+}
+
+Scheduler::~Scheduler() {
+    stop();
+}
+
+TaskId Scheduler::schedule_once(Clock::duration delay, Task task) {
+    Entry entry;
+    entry.task = std::make_shared<Task>(std::move(task));
+    return add(delay, std::move(entry));
+}
+
+TaskId Scheduler::schedule_every(Clock::duration interval, Task task, Clock::duration jitter) {
+    Entry entry;
+    entry.task = std::make_shared<Task>(std::move(task));
+    entry.interval = std::max(interval, Clock::duration(wheel_.tick()));
+    entry.jitter = jitter;
+
+    Clock::duration first;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        first = next_delay(entry);
+    }
+    return add(first, std::move(entry));
+}
+
+TaskId Scheduler::add(Clock::duration delay, Entry entry) {
+    TaskId id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = next_id_++;
+        entry.timer = wheel_.schedule(Clock::now() + delay, id);
+        entries_.insert(id, std::move(entry));
+    }
+    // The new deadline may be earlier than the one the thread sleeps towards
+    wake_cv_.notify_one();
+    return id;
+}
+
+bool Scheduler::cancel(TaskId id) {
+    // running_task_ holds INVALID_TASK while idle, there is nothing to wait for
+    if (id == INVALID_TASK) return false;
+    std::unique_lock<std::mutex> lock(mutex_);
+    Entry entry;
+    bool found = entries_.take(id, entry);
+    if (found) {
+        wheel_.cancel(entry.timer);
+    }
+
+    if (running_task_ == id && std::this_thread::get_id() != thread_id_.load()) {
+        idle_cv_.wait(lock, [this, id]() { return running_task_ != id; });
+        found = true;
+    }
+    lock.unlock();
+    // The callable may own resources whose destructors take other locks
+    entry.task.reset();
+    return found;
+}
+
+void Scheduler::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread(&Scheduler::run, this);
+}
+
+void Scheduler::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_.exchange(false)) return;
+    }
+    wake_cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t Scheduler::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+Scheduler::Clock::duration Scheduler::next_delay(const Entry& entry) {
+    if (entry.jitter <= Clock::duration::zero()) return entry.interval;
+    std::uniform_int_distribution<Clock::rep> spread(0, entry.jitter.count());
+    return entry.interval + Clock::duration(spread(random_));
+}
+
+void Scheduler::run() {
+    thread_id_ = std::this_thread::get_id();
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    while (running_.load()) {
+        auto now = Clock::now();
+        wheel_.advance(now, [this](TaskId&& id) {
+            due_.push_back(id);
+        });
+
+        for (size_t i = 0; i < due_.size(); ++i) {
+            TaskId id = due_[i];
+            Entry* entry = entries_.find(id);
+            if (entry == nullptr) continue;
+
+            std::shared_ptr<Task> task = entry->task;
+            if (entry->interval > Clock::duration::zero()) {
+                entry->timer = wheel_.schedule(now + next_delay(*entry), id);
+            } else {
+                Entry finished;
+                entries_.take(id, finished);
+            }
+
+            running_task_ = id;
+            lock.unlock();
+            try {
+                (*task)();
+            } catch (const std::exception& e) {
+                LOG_ERROR("Scheduled task failed: " + std::string(e.what()));
+            }
+            task.reset();
+            lock.lock();
+            running_task_ = INVALID_TASK;
+            idle_cv_.notify_all();
+        }
+        due_.clear();
+
+        auto deadline = wheel_.next_expiry();
+        if (deadline == Clock::time_point::max()) {
+            wake_cv_.wait(lock);
+        } else {
+            wake_cv_.wait_until(lock, deadline);
+        }
+    }
+}
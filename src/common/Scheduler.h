@@ -0,0 +1,87 @@
+/*
+ * Filename: d:\HeavenGate\src\common\Scheduler.h
+ * Path: d:\HeavenGate\src\common
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "FlatHashMap.h"
+#include "TimerWheel.h"
+
+using TaskId = uint64_t;
+constexpr TaskId INVALID_TASK = 0;
+
+// Process-wide timer service: one thread sleeping until the earliest deadline
+// in a TimerWheel, instead of a sleeping thread per periodic job.
+//
+// Tasks run on the scheduler thread one at a time and must not block for long;
+// hand slow work to an io_context or executor from the task. A periodic task is
+// re-armed before it runs, relative to when it fired, so a slow run delays the
+// next one rather than queueing a burst.
+class Scheduler {
+public:
+    using Task = std::function<void()>;
+    using Clock = std::chrono::steady_clock;
+
+    static Scheduler& the();
+
+    TaskId schedule_once(Clock::duration delay, Task task);
+    // Fires every `interval` plus a uniform random [0, jitter], first after one interval
+    TaskId schedule_every(Clock::duration interval, Task task,
+                          Clock::duration jitter = Clock::duration::zero());
+    // The task does not start after this returns, and a run in progress on the
+    // scheduler thread is waited for (unless cancel() is called from the task)
+    bool cancel(TaskId id);
+
+    void start();
+    // Pending tasks are kept but do not fire until start() is called again
+    void stop();
+    size_t size() const;
+
+private:
+    Scheduler();
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    struct Entry {
+        // Shared so firing a periodic task does not copy the callable
+        std::shared_ptr<Task> task;
+        Clock::duration interval{Clock::duration::zero()};
+        Clock::duration jitter{Clock::duration::zero()};
+        TimerWheel<TaskId>::TimerId timer{TimerWheel<TaskId>::INVALID_TIMER};
+    };
+
+    // All guarded by mutex_
+    FlatHashMap<Entry> entries_;
+    TimerWheel<TaskId> wheel_;
+    std::vector<TaskId> due_;
+    TaskId running_task_{INVALID_TASK};
+    TaskId next_id_{1};
+    std::mt19937_64 random_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable idle_cv_;
+
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::atomic<std::thread::id> thread_id_{};
+
+    TaskId add(Clock::duration delay, Entry entry);
+    Clock::duration next_delay(const Entry& entry);
+    void run();
+};
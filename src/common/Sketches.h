@@ -0,0 +1,239 @@
+/*
+ * Filename: d:\HeavenGate\src\common\Sketches.h
+ * Path: d:\HeavenGate\src\common
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Fixed-size summaries of a stream of keys. Their memory is set at construction
+// and does not grow with the number of distinct keys; the price is estimates
+// that may be too high when keys collide, never too low. Keys are given as
+// 64-bit hashes, mixed by the caller. Not thread-safe.
+
+namespace sketch {
+
+// Final mix of splitmix64: spreads a weak hash over every bit
+inline uint64_t mix(uint64_t value) {
+    value ^= value >> 30;
+    value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27;
+    value *= 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+// Column of `row` for a key: double hashing over the two halves of its hash
+inline size_t column(uint64_t hash, size_t row, size_t mask) {
+    uint64_t step = (hash >> 32) | 1;
+    return static_cast<size_t>((hash + row * step) & mask);
+}
+
+// Count-min sketch: DEPTH rows of counters, a key adds to one counter per row
+// and its count is the smallest of them. Updates are conservative: only the
+// counters below the key's new count are raised, which keeps keys that share
+// counters with busy ones much closer to their own count. Counters saturate
+// instead of wrapping.
+class CountMin {
+public:
+    static constexpr size_t DEPTH = 4;
+
+    // `width` is rounded up to a power of two
+    explicit CountMin(size_t width) : mask_(round_up(width) - 1), counters_(DEPTH * (mask_ + 1), 0) {}
+
+    void add(uint64_t hash, uint32_t count = 1) {
+        std::array<uint32_t*, DEPTH> cells;
+        uint32_t smallest = std::numeric_limits<uint32_t>::max();
+        for (size_t row = 0; row < DEPTH; ++row) {
+            cells[row] = &counters_[row * (mask_ + 1) + column(hash, row, mask_)];
+            smallest = std::min(smallest, *cells[row]);
+        }
+        uint32_t raised = smallest > std::numeric_limits<uint32_t>::max() - count
+            ? std::numeric_limits<uint32_t>::max() : smallest + count;
+        for (uint32_t* cell : cells) {
+            *cell = std::max(*cell, raised);
+        }
+    }
+
+    uint32_t estimate(uint64_t hash) const {
+        uint32_t smallest = std::numeric_limits<uint32_t>::max();
+        for (size_t row = 0; row < DEPTH; ++row) {
+            smallest = std::min(smallest, counter(hash, row));
+        }
+        return smallest;
+    }
+
+    // The key's counter in one row; sketches of the same width are merged by
+    // summing these before taking the smallest
+    uint32_t counter(uint64_t hash, size_t row) const {
+        return counters_[row * (mask_ + 1) + column(hash, row, mask_)];
+    }
+
+    void clear() { std::fill(counters_.begin(), counters_.end(), 0); }
+    size_t memory_bytes() const { return counters_.size() * sizeof(uint32_t); }
+
+    static size_t round_up(size_t width) {
+        size_t size = 1;
+        while (size < width) size <<= 1;
+        return size;
+    }
+
+private:
+    size_t mask_;
+    std::vector<uint32_t> counters_;
+};
+
+// HyperLogLog with 2^P one-byte registers. Small counts, which is most of what
+// a single client produces, use linear counting.
+template<unsigned P>
+struct HyperLogLog {
+    static constexpr size_t REGISTERS = size_t{1} << P;
+
+    std::array<uint8_t, REGISTERS> registers{};
+
+    void add(uint64_t hash) {
+        size_t index = static_cast<size_t>(hash >> (64 - P));
+        uint64_t rest = (hash << P) | (uint64_t{1} << (P - 1));
+        uint8_t rank = static_cast<uint8_t>(count_leading_zeros(rest) + 1);
+        registers[index] = std::max(registers[index], rank);
+    }
+
+    void merge(const HyperLogLog& other) {
+        for (size_t i = 0; i < REGISTERS; ++i) {
+            registers[i] = std::max(registers[i], other.registers[i]);
+        }
+    }
+
+    double estimate() const {
+        double sum = 0;
+        size_t zeros = 0;
+        for (uint8_t rank : registers) {
+            // rank <= 65 - P
+            sum += 1.0 / static_cast<double>(uint64_t{1} << rank);
+            zeros += rank == 0;
+        }
+        const double m = static_cast<double>(REGISTERS);
+        double raw = alpha() * m * m / sum;
+        if (raw <= 2.5 * m && zeros != 0) {
+            return m * std::log(m / static_cast<double>(zeros));
+        }
+        return raw;
+    }
+
+    void clear() { registers.fill(0); }
+
+private:
+    static constexpr double alpha() {
+        return REGISTERS == 16 ? 0.673 : REGISTERS == 32 ? 0.697 : REGISTERS == 64 ? 0.709
+                                                                  : 0.7213 / (1.0 + 1.079 / REGISTERS);
+    }
+
+    static unsigned count_leading_zeros(uint64_t value) {
+        unsigned zeros = 0;
+        for (uint64_t bit = uint64_t{1} << 63; bit != 0 && (value & bit) == 0; bit >>= 1) {
+            ++zeros;
+        }
+        return zeros;
+    }
+};
+
+// Distinct items per key in fixed memory: a count-min layout whose cells are
+// HyperLogLogs instead of counters. Keys sharing a cell in every row are
+// counted together.
+template<unsigned P>
+class DistinctCount {
+public:
+    static constexpr size_t DEPTH = 2;
+    using Cell = HyperLogLog<P>;
+
+    // `width` is rounded up to a power of two
+    explicit DistinctCount(size_t width) : mask_(CountMin::round_up(width) - 1), cells_(DEPTH * (mask_ + 1)) {}
+
+    void add(uint64_t key_hash, uint64_t item_hash) {
+        for (size_t row = 0; row < DEPTH; ++row) {
+            cells_[row * (mask_ + 1) + column(key_hash, row, mask_)].add(item_hash);
+        }
+    }
+
+    // Merged by taking the register-wise maximum of these before estimating each row
+    const Cell& cell(uint64_t key_hash, size_t row) const {
+        return cells_[row * (mask_ + 1) + column(key_hash, row, mask_)];
+    }
+
+    void clear() {
+        for (Cell& cell : cells_) cell.clear();
+    }
+
+    size_t memory_bytes() const { return cells_.size() * sizeof(Cell); }
+
+private:
+    size_t mask_;
+    std::vector<Cell> cells_;
+};
+
+// Space-saving top-K (Metwally et al.): the K keys seen most, each with an
+// upper bound of its count. A new key evicts the smallest entry and inherits
+// its count as its error, so every key counted more than total()/K times is
+// present and count - error is a lower bound.
+template<size_t K>
+class SpaceSaving {
+public:
+    struct Entry {
+        uint64_t key{0};
+        uint64_t count{0};
+        uint64_t error{0};
+    };
+
+    void add(uint64_t key, uint64_t count = 1) {
+        total_ += count;
+        size_t smallest = 0;
+        for (size_t i = 0; i < size_; ++i) {
+            if (entries_[i].key == key) {
+                entries_[i].count += count;
+                return;
+            }
+            if (entries_[i].count < entries_[smallest].count) smallest = i;
+        }
+        if (size_ < K) {
+            entries_[size_++] = Entry{key, count, 0};
+            return;
+        }
+        Entry& evicted = entries_[smallest];
+        evicted.key = key;
+        evicted.error = evicted.count;
+        evicted.count += count;
+    }
+
+    // The tracked entry of `key`, nullptr if it has none
+    const Entry* find(uint64_t key) const {
+        for (size_t i = 0; i < size_; ++i) {
+            if (entries_[i].key == key) return &entries_[i];
+        }
+        return nullptr;
+    }
+
+    const Entry* begin() const { return entries_.data(); }
+    const Entry* end() const { return entries_.data() + size_; }
+    uint64_t total() const { return total_; }
+
+    void clear() {
+        size_ = 0;
+        total_ = 0;
+    }
+
+private:
+    std::array<Entry, K> entries_{};
+    size_t size_{0};
+    uint64_t total_{0};
+};
+
+} // namespace sketch
@@ -0,0 +1,245 @@
+/*
+ * Filename: d:\HeavenGate\src\common\TimerWheel.h
+ * Path: d:\HeavenGate\src\common
+ * Created Date: Saturday, October 17th 2026
+ * Author: mmonastyrskiy
+ * 
+ * Copyright (c) 2026 Your Company
+ */
+
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Hierarchical timer wheel: 4 levels of 64 slots. With the default 1ms tick
+// level 0 covers 64ms and level 3 about 4.6 hours; later deadlines are parked in
+// the last level and re-placed when they cascade. Scheduling and cancelling are
+// O(1), advancing costs O(elapsed ticks + expired timers).
+//
+// Timers carry a Payload instead of a callback so the owner decides what to run
+// and where (typically outside its own lock). Not thread-safe.
+template<typename Payload>
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = uint64_t;
+    static constexpr TimerId INVALID_TIMER = 0;
+
+    explicit TimerWheel(std::chrono::milliseconds tick = std::chrono::milliseconds(1),
+                        Clock::time_point start = Clock::now())
+        : tick_(tick), start_(start) {
+        heads_.fill(NIL);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    std::chrono::milliseconds tick() const { return tick_; }
+
+    TimerId schedule(Clock::time_point deadline, Payload payload) {
+        uint32_t index = allocate_node();
+        Node& node = nodes_[index];
+        node.payload = std::move(payload);
+        node.expiry = std::max(ticks_until(deadline), current_tick_ + 1);
+        place(index, current_tick_ + 1);
+        ++size_;
+        return make_id(index, node.generation);
+    }
+
+    TimerId schedule_after(Clock::duration delay, Payload payload) {
+        return schedule(Clock::now() + delay, std::move(payload));
+    }
+
+    // Returns false if the timer already fired or was cancelled
+    bool cancel(TimerId id, Payload* out = nullptr) {
+        uint32_t index = static_cast<uint32_t>(id & 0xffffffffu) - 1;
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (id == INVALID_TIMER || index >= nodes_.size()) return false;
+
+        Node& node = nodes_[index];
+        if (node.generation != generation || node.slot == NIL) return false;
+
+        unlink(index);
+        if (out) *out = std::move(node.payload);
+        release_node(index);
+        --size_;
+        return true;
+    }
+
+    // Fires every timer due at `now`; on_expired(Payload&&) may schedule new timers
+    template<typename Fn>
+    size_t advance(Clock::time_point now, Fn&& on_expired) {
+        uint64_t target = ticks_at(now);
+        size_t fired = 0;
+
+        if (size_ == 0) {
+            current_tick_ = std::max(current_tick_, target);
+            return 0;
+        }
+
+        while (current_tick_ < target) {
+            uint64_t tick = current_tick_ + 1;
+
+            // Cascade higher levels whose block starts at this tick, coarsest first
+            for (unsigned level = LEVELS - 1; level >= 1; --level) {
+                if ((tick & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) == 0) {
+                    cascade(level, tick);
+                }
+            }
+
+            current_tick_ = tick;
+            uint32_t slot = static_cast<uint32_t>(tick & SLOT_MASK);
+            uint32_t index = heads_[slot];
+            heads_[slot] = NIL;
+
+            while (index != NIL) {
+                uint32_t next = nodes_[index].next;
+                Payload payload = std::move(nodes_[index].payload);
+                nodes_[index].slot = NIL;
+                release_node(index);
+                --size_;
+                ++fired;
+                on_expired(std::move(payload));
+                index = next;
+            }
+
+            if (size_ == 0) {
+                current_tick_ = target;
+            }
+        }
+        return fired;
+    }
+
+    // Earliest moment something may expire; wheels report cascade points early
+    Clock::time_point next_expiry() const {
+        if (size_ == 0) return Clock::time_point::max();
+
+        uint64_t best = std::numeric_limits<uint64_t>::max();
+        for (uint64_t d = 1; d <= SLOTS; ++d) {
+            uint64_t tick = current_tick_ + d;
+            if (heads_[tick & SLOT_MASK] != NIL) {
+                best = tick;
+                break;
+            }
+        }
+        for (unsigned level = 1; level < LEVELS; ++level) {
+            unsigned shift = SLOT_BITS * level;
+            uint64_t block = current_tick_ >> shift;
+            for (uint64_t d = 1; d <= SLOTS; ++d) {
+                uint64_t candidate = (block + d) << shift;
+                if (candidate >= best) break;
+                if (heads_[level * SLOTS + ((block + d) & SLOT_MASK)] != NIL) {
+                    best = candidate;
+                    break;
+                }
+            }
+        }
+        return start_ + tick_ * best;
+    }
+
+private:
+    static constexpr unsigned SLOT_BITS = 6;
+    static constexpr uint64_t SLOTS = uint64_t{1} << SLOT_BITS;
+    static constexpr uint64_t SLOT_MASK = SLOTS - 1;
+    static constexpr unsigned LEVELS = 4;
+    static constexpr uint32_t NIL = std::numeric_limits<uint32_t>::max();
+
+    struct Node {
+        Payload payload{};
+        uint64_t expiry{0};
+        uint32_t generation{0};
+        uint32_t prev{NIL};
+        uint32_t next{NIL};
+        uint32_t slot{NIL};
+    };
+
+    static TimerId make_id(uint32_t index, uint32_t generation) {
+        return (static_cast<uint64_t>(generation) << 32) | (index + 1);
+    }
+
+    uint64_t ticks_at(Clock::time_point when) const {
+        if (when <= start_) return 0;
+        return static_cast<uint64_t>((when - start_) / tick_);
+    }
+
+    uint64_t ticks_until(Clock::time_point deadline) const {
+        if (deadline <= start_) return 0;
+        auto elapsed = deadline - start_;
+        uint64_t ticks = static_cast<uint64_t>(elapsed / tick_);
+        return elapsed % tick_ == Clock::duration::zero() ? ticks : ticks + 1;
+    }
+
+    // Puts a node into the slot matching its expiry relative to `base`
+    void place(uint32_t index, uint64_t base) {
+        Node& node = nodes_[index];
+        uint64_t expiry = std::max(node.expiry, base);
+        uint64_t delta = expiry - base;
+
+        unsigned level = 0;
+        while (level < LEVELS - 1 && delta >= (uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+        // Beyond the last level: park at its far end, the node is re-placed on cascade
+        uint64_t horizon = (uint64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+        uint64_t position = delta > horizon ? base + horizon : expiry;
+
+        uint32_t slot = static_cast<uint32_t>(level * SLOTS + ((position >> (SLOT_BITS * level)) & SLOT_MASK));
+        node.slot = slot;
+        node.prev = NIL;
+        node.next = heads_[slot];
+        if (node.next != NIL) nodes_[node.next].prev = index;
+        heads_[slot] = index;
+    }
+
+    void cascade(unsigned level, uint64_t tick) {
+        uint32_t slot = static_cast<uint32_t>(level * SLOTS + ((tick >> (SLOT_BITS * level)) & SLOT_MASK));
+        uint32_t index = heads_[slot];
+        heads_[slot] = NIL;
+        while (index != NIL) {
+            uint32_t next = nodes_[index].next;
+            place(index, tick);
+            index = next;
+        }
+    }
+
+    void unlink(uint32_t index) {
+        Node& node = nodes_[index];
+        if (node.prev != NIL) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.slot] = node.next;
+        }
+        if (node.next != NIL) nodes_[node.next].prev = node.prev;
+        node.slot = NIL;
+    }
+
+    uint32_t allocate_node() {
+        if (!free_.empty()) {
+            uint32_t index = free_.back();
+            free_.pop_back();
+            return index;
+        }
+        nodes_.emplace_back();
+        return static_cast<uint32_t>(nodes_.size() - 1);
+    }
+
+    void release_node(uint32_t index) {
+        Node& node = nodes_[index];
+        node.payload = Payload{};
+        node.slot = NIL;
+        ++node.generation;
+        free_.push_back(index);
+    }
+
+    std::chrono::milliseconds tick_;
+    Clock::time_point start_;
+    uint64_t current_tick_{0};
+    size_t size_{0};
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> free_;
+    std::array<uint32_t, LEVELS * SLOTS> heads_;
+};
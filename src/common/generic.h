@@ -17,6 +17,11 @@
     #endif
 #endif
 
+// Set to 1 by the HEAVENGATE_COROUTINES CMake option, which also selects C++20
+#ifndef HG_COROUTINES
+    #define HG_COROUTINES 0
+#endif
+
 #define TODO() do{ LOG_FATAL("TODO REACHED");} while(0)
 #define VERIFY_NOT_REACHED() do{ LOG_FATAL("UNEXPECTED REACHED");} while(0)
 
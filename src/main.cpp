@@ -12,9 +12,19 @@
 #include <thread>
 #include <chrono>
 #include "LoadBalancer/LoadBalancer.h"
+#include "Classifier/StatisticalClassifier.h"
 #include "DataBus/DataBus.h"
+#include "DataBus/BusExporter.h"
 #include "AppManager/AppManager.h"
+#include "API/dashboardAPI.h"
+#include "Metrics/MetricsExporter.h"
 #include "common/logger.h"
+#include "common/generic.h"
+#include "common/Scheduler.h"
+#include "Runtime/Runtime.h"
+#if ISLINUX
+#include <pthread.h>
+#endif
 
 std::atomic<bool> running{true};
 
@@ -25,6 +35,31 @@ void signalHandler(int sig) {
     }
 }
 
+#if ISLINUX
+// Blocked in every thread (the mask is inherited), main collects them with sigwait()
+sigset_t shutdownSignals() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    return signals;
+}
+#endif
+
+void waitForShutdown() {
+#if ISLINUX
+    sigset_t signals = shutdownSignals();
+    int sig = 0;
+    sigwait(&signals, &sig);
+    std::cout << "\n🛑 Received " << (sig == SIGINT ? "SIGINT" : "SIGTERM") << ", shutting down..." << std::endl;
+#else
+    std::signal(SIGINT, signalHandler);
+    while (running) {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+#endif
+}
+
 void printStats(const LoadBalancer& balancer) {
     auto stats = balancer.get_stats();
     const auto& metrics = balancer.get_performance_metrics(); // const reference
@@ -42,26 +77,78 @@ void printStats(const LoadBalancer& balancer) {
     std::cout << "🍯 Active Honeypots: " << stats.healthy_honeypot_backends << "/" << stats.total_honeypot_backends << std::endl;
     std::cout << "🔗 Total Connections: " << stats.total_connections << std::endl;
     
-    if (metrics.total_routing_operations > 0) {
-        double avg_routing_time = static_cast<double>(metrics.total_routing_time_ns) / 
-                                 metrics.total_routing_operations / 1000.0; // convert to microseconds
+    auto routing_operations = metrics.total_routing_operations.value();
+    if (routing_operations > 0) {
+        double avg_routing_time = static_cast<double>(metrics.total_routing_time_ns.value()) / 
+                                 routing_operations / 1000.0; // convert to microseconds
         std::cout << "⚡ Avg Routing Time: " << avg_routing_time << " μs" << std::endl;
     }
+
+    auto latency = balancer.get_latency_summary();
+    std::cout << "⏲️  Stage latency (p50 / p99 / p999, μs):" << std::endl;
+    for (size_t i = 0; i < latency.size(); ++i) {
+        const auto& stage = latency[i];
+        if (stage.count == 0) continue;
+        std::cout << "   - " << LoadBalancer::stage_to_string(static_cast<LatencyStage>(i)) << ": "
+                  << stage.p50_ns / 1000.0 << " / " << stage.p99_ns / 1000.0 << " / "
+                  << stage.p999_ns / 1000.0 << " (" << stage.count << ")" << std::endl;
+    }
     std::cout << "================================\n" << std::endl;
 }
 
+nlohmann::json latencyToJson(const StageLatencySummary& latency) {
+    nlohmann::json stages = nlohmann::json::array();
+    for (size_t i = 0; i < latency.size(); ++i) {
+        const auto& stage = latency[i];
+        stages.push_back({
+            {"stage", LoadBalancer::stage_to_string(static_cast<LatencyStage>(i))},
+            {"count", stage.count},
+            {"p50Us", stage.p50_ns / 1000.0},
+            {"p99Us", stage.p99_ns / 1000.0},
+            {"p999Us", stage.p999_ns / 1000.0}
+        });
+    }
+    return stages;
+}
+
+void sendLatency(const LoadBalancer& balancer) {
+    nlohmann::json backends = nlohmann::json::array();
+    for (const auto& [id, latency] : balancer.get_backend_latency_summaries()) {
+        backends.push_back({{"id", id}, {"stages", latencyToJson(latency)}});
+    }
+
+    nlohmann::json latency = {
+        {"stages", latencyToJson(balancer.get_latency_summary())},
+        {"backends", backends}
+    };
+    // Only the summary is taken here, the blocking POST goes to the dashboard's thread
+    DashboardAPI::the().post([latency = std::move(latency)]() {
+        int err = 0;
+        DashboardAPI::the().callLatencyUpdate(latency, &err);
+    });
+}
+
 int main() {
+#if ISLINUX
+    // Must precede any thread creation so no other thread takes the signal
+    sigset_t signals = shutdownSignals();
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+#endif
+    Scheduler::the().start();
+    Runtime::the().start();
+
     AppManager manager;
     manager.start_all();
 
     std::cout << "🚀 Starting HeavenGate Load Balancer" << std::endl;
-    std::cout << "📍 Listening on port 80" << std::endl;
-    
-    std::signal(SIGINT, signalHandler);
     
     try {
         // Создаем балансировщик с стратегией IP_HASH для sticky sessions
         LoadBalancer balancer(RoutingStrategy::IP_HASH);
+        // Destroyed before the balancer, so no runtime handler outlives it on any exit path
+        struct RuntimeGuard {
+            ~RuntimeGuard() { Runtime::the().stop(); }
+        } runtime_guard;
 
         // Добавляем реальные бэкенды
         balancer.add_backend(std::make_shared<BackendNode>(
@@ -81,44 +168,88 @@ int main() {
         std::cout << "   - 3 real servers (8080, 8081, 8082)" << std::endl;
         std::cout << "   - 2 honeypot servers (9090, 9091)" << std::endl;
 
-        // Запускаем балансировщик на порту 80
+        // Порты из LISTENERS; без них — один слушатель на порту 80
+        auto listeners = ListenerProfile::from_settings(RoutingStrategy::IP_HASH);
+        for (const auto& profile : listeners) {
+            balancer.add_listener(profile);
+            std::cout << "📍 Listening on port " << profile.port << " (" << profile.name << ")" << std::endl;
+        }
+        if (listeners.empty()) {
+            std::cout << "📍 Listening on port 80" << std::endl;
+        }
         balancer.start(80);
 
+        // OpenMetrics endpoint для Prometheus
+        MetricsExporter::the().add_collector("load_balancer", [&balancer](metrics::OpenMetricsWriter& writer) {
+            balancer.collect_metrics(writer);
+        });
+        MetricsExporter::the().add_collector("data_bus", [](metrics::OpenMetricsWriter& writer) {
+            DataBus::instance().collect_metrics(writer);
+        });
+        MetricsExporter::the().add_collector("runtime", [](metrics::OpenMetricsWriter& writer) {
+            Runtime::the().collect_metrics(writer);
+        });
+        // In-process GBDT scoring of classification requests (CLASSIFIER_MODEL)
+        classifier::StatisticalClassifier statistical_classifier(DataBus::instance());
+        if (statistical_classifier.start()) {
+            MetricsExporter::the().add_collector("statistical_classifier",
+                [&statistical_classifier](metrics::OpenMetricsWriter& writer) {
+                    statistical_classifier.collect_metrics(writer);
+                });
+        }
+        // Shared-memory export of bus events for out-of-process readers (BUS_EXPORT_EVENTS)
+        BusExporter bus_exporter(DataBus::instance());
+        if (bus_exporter.start()) {
+            MetricsExporter::the().add_collector("bus_exporter", [&bus_exporter](metrics::OpenMetricsWriter& writer) {
+                bus_exporter.collect_metrics(writer);
+            });
+        }
+        MetricsExporter::the().start();
+
         std::cout << "\n✅ Load Balancer started successfully!" << std::endl;
         std::cout << "💡 Press Ctrl+C to stop the server\n" << std::endl;
 
         // Статистика каждые 30 секунд
-        auto last_stats_time = std::chrono::steady_clock::now();
-        const auto stats_interval = std::chrono::seconds(30);
-
-        // Основной цикл
-        while (running) {
-            std::this_thread::sleep_for(std::chrono::seconds(1));
-            
-            // Периодический вывод статистики
-            auto now = std::chrono::steady_clock::now();
-            if (now - last_stats_time >= stats_interval) {
+        // The Scheduler only times it: the summaries are taken on a runtime worker and
+        // the dashboard POST runs on DashboardAPI's own thread
+        TaskId stats_task = Scheduler::the().schedule_every(std::chrono::seconds(30), [&balancer]() {
+            Runtime::the().post([&balancer]() {
                 printStats(balancer);
-                last_stats_time = now;
-            }
-        }
+                sendLatency(balancer);
+            });
+        });
+
+        waitForShutdown();
+        Scheduler::the().cancel(stats_task);
 
         // Остановка балансировщика
         std::cout << "🛑 Stopping Load Balancer..." << std::endl;
+        MetricsExporter::the().stop();
+        MetricsExporter::the().remove_collector("load_balancer");
+        MetricsExporter::the().remove_collector("bus_exporter");
+        MetricsExporter::the().remove_collector("statistical_classifier");
+        bus_exporter.stop();
+        statistical_classifier.stop();
         balancer.stop();
+        // Open connections are dropped here, while the balancer still exists
+        Runtime::the().stop();
         
         // Финальная статистика
         std::cout << "\n📈 === Final Statistics ===" << std::endl;
         printStats(balancer);
 
     } catch (const std::exception& e) {
+        MetricsExporter::the().stop();
         std::cerr << "❌ Fatal Error: " << e.what() << std::endl;
         LOG_ERROR("Main application error: " + std::string(e.what()));
         manager.stop_all();
+        Runtime::the().stop();
+        Scheduler::the().stop();
         return 1;
     }
 
     std::cout << "✅ HeavenGate stopped gracefully" << std::endl;
     manager.stop_all();
+    Scheduler::the().stop();
     return 0;
 }
\ No newline at end of file
@@ -169,6 +169,9 @@
                     updateAllStats();
                     updateChartData();
                     updateRequestsTable();
+                    if (data.data.latency) {
+                        updateLatencyTable(data.data.latency);
+                    }
                     break;
                     
                 case 'new_request':
@@ -195,6 +198,10 @@
                     updateAgentsStats();
                     break;
                     
+                case 'latency_update':
+                    updateLatencyTable(data.data);
+                    break;
+                    
                 case 'ping':
                     break;
                     
@@ -261,6 +268,23 @@
             document.getElementById('honeypots').textContent = agents.honeypots || 0;
         }
 
+        // Обновление таблицы задержек по этапам
+        function updateLatencyTable(latency) {
+            const tableBody = document.getElementById('latency-table-body');
+            tableBody.innerHTML = '';
+
+            (latency.stages || []).forEach(stage => {
+                const row = document.createElement('tr');
+                [stage.stage, stage.p50Us, stage.p99Us, stage.p999Us, stage.count].forEach(value => {
+                    const cell = document.createElement('td');
+                    cell.textContent = typeof value === 'number' && !Number.isInteger(value)
+                        ? value.toFixed(1) : value;
+                    row.appendChild(cell);
+                });
+                tableBody.appendChild(row);
+            });
+        }
+
         // Функция обновления статуса соединения
         function updateConnectionStatus(connected) {
             const statusElement = document.getElementById('connection-status') || createConnectionStatusElement();
@@ -0,0 +1,89 @@
+/*
+ * Filename: d:\HeavenGate\tests\EventPoolAllocations.cpp
+ * Path: d:\HeavenGate\tests
+ * Created Date: Sunday, October 18th 2026
+ * Author: mmonastyrskiy
+ *
+ * Copyright (c) 2026 Your Company
+ */
+
+// Once the event pool and the lane rings have grown to the peak backlog,
+// publishing must not allocate. Counts every operator new in the process
+// while a pre-built payload is published and dispatched.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+
+#include "DataBus/DataBus.h"
+
+namespace {
+
+std::atomic<bool> counting{false};
+std::atomic<size_t> allocations{0};
+
+void* counted_new(size_t size) {
+    if (counting.load(std::memory_order_relaxed)) {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new(size_t size) { return counted_new(size); }
+void* operator new[](size_t size) { return counted_new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+int main() {
+    constexpr size_t EVENTS = 512;
+    constexpr int WARMUP_ROUNDS = 3;
+    constexpr int ROUNDS = 20;
+
+    DataBus& bus = DataBus::instance();
+    std::atomic<size_t> delivered{0};
+    // Holds the worker on the first event of a round, so every round peaks at
+    // the same backlog whatever the scheduling
+    std::atomic<bool> gate{true};
+
+    SubscribeOptions options;
+    options.mode = DeliveryMode::INLINE;
+    options.name = "allocation_test";
+    bus.subscribe(BusEventType::REQUEST_ROUTED, [&](const Event&) {
+        while (!gate.load(std::memory_order_acquire)) std::this_thread::yield();
+        delivered.fetch_add(1, std::memory_order_relaxed);
+    }, options);
+    bus.start();
+
+    SourceId source = bus.source_id("allocation_test");
+    // A scalar: copying an object payload into publish() allocates by itself
+    const nlohmann::json payload = 42;
+
+    auto round = [&]() {
+        size_t target = delivered.load() + EVENTS;
+        gate.store(false, std::memory_order_release);
+        for (size_t i = 0; i < EVENTS; ++i) {
+            bus.publish(BusEventType::REQUEST_ROUTED, source, payload);
+        }
+        gate.store(true, std::memory_order_release);
+        while (delivered.load() < target) std::this_thread::yield();
+    };
+
+    for (int i = 0; i < WARMUP_ROUNDS; ++i) round();
+
+    counting = true;
+    for (int i = 0; i < ROUNDS; ++i) round();
+    counting = false;
+
+    bus.stop();
+
+    size_t counted = allocations.load();
+    std::printf("%zu allocations over %zu published events\n", counted, EVENTS * ROUNDS);
+    return counted == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}